@@ -0,0 +1,67 @@
+#!/bin/bash
+# =========================================
+# ALIN 插件宿主测试 (Plugin Host Flow Tests)
+# =========================================
+#
+# - 进程内宿主的输出与逐行 fork 的旧路径一致
+# - 有状态的插件 (agg_count) 计入全部事件
+# - 插件在 configure() 中注册的退出汇总在宿主中照常输出
+# - 同一节点用于多个槽位时各槽位的状态互不影响
+#
+# 使用方式:
+#   make test                        # 编译后运行全部测试
+#   ./alin/flows/test_host.sh        # 只运行本组 (需已 make stream host)
+
+source "$(dirname "$0")/test_lib.sh"
+
+HOST="$BIN_DIR/alin_host"
+export ALIN_FILTER_LEVEL=WARN
+export ALIN_METRICS_DIR=
+
+run_host() {
+    "$HOST" -a "$WORK_DIR/active" -n "$NODES_DIR" -s "$WORK_DIR/state" "$@" 2>>"$WORK_DIR/host.log"
+}
+
+# ===== 与逐行路径一致 =====
+section "宿主与逐行路径的输出一致"
+printf 'timeout\nrefused\n# 注释\nevent 1\n' > "$WORK_DIR/patterns.txt"
+export ALIN_MATCH_PATTERNS="$WORK_DIR/patterns.txt"
+gen_logs 300 > "$WORK_DIR/logs.jsonl"
+make_topology "$WORK_DIR/active" 01_parse:parse_json 02_filter:filter_level 03_match:match_keywords
+per_line "$WORK_DIR/logs.jsonl" "$WORK_DIR/active/01_parse" "$WORK_DIR/active/02_filter" "$WORK_DIR/active/03_match" \
+    > "$WORK_DIR/expected.jsonl"
+run_host "$WORK_DIR/logs.jsonl" > "$WORK_DIR/out.jsonl"
+check_same "文件输入" "$WORK_DIR/expected.jsonl" "$WORK_DIR/out.jsonl"
+run_host < "$WORK_DIR/logs.jsonl" > "$WORK_DIR/out.jsonl"
+check_same "stdin 输入" "$WORK_DIR/expected.jsonl" "$WORK_DIR/out.jsonl"
+
+# ===== 有状态的插件 =====
+section "agg_count 在宿主中计入全部事件"
+make_topology "$WORK_DIR/active" 01_parse:parse_json 02_agg:agg_count
+gen_logs 5000 > "$WORK_DIR/logs.jsonl"
+mkdir -p "$WORK_DIR/state"
+ALIN_STATE_FILE="$WORK_DIR/state/agg_count.state" run_host "$WORK_DIR/logs.jsonl" > "$WORK_DIR/out.jsonl"
+check_equal "输出条数" 5000 "$(wc -l < "$WORK_DIR/out.jsonl")"
+check_equal "最后一条的累计数" '"total":5000' "$(tail -1 "$WORK_DIR/out.jsonl" | grep -o '"total":[0-9]*')"
+check_equal "ERROR 计数" "\"ERROR\":$(grep -c '"level":"ERROR"' "$WORK_DIR/logs.jsonl")" \
+    "$(tail -1 "$WORK_DIR/out.jsonl" | grep -o '"ERROR":[0-9]*')"
+
+# ===== 退出汇总 =====
+section "插件的退出汇总在宿主中输出"
+make_topology "$WORK_DIR/active" 01_parse:parse_json 02_sample:sampler
+: > "$WORK_DIR/host.log"
+ALIN_SAMPLE_LEVELS=DEBUG=0 run_host "$WORK_DIR/logs.jsonl" > "$WORK_DIR/out.jsonl"
+check_equal "sampler 汇总" 1 "$(grep -c '^\[SAMPLE\] kept [0-9]*, dropped [0-9]*' "$WORK_DIR/host.log")"
+
+# ===== 同一节点的多个槽位 =====
+section "同一节点的多个槽位各自计数"
+# 两条分支各有一个 agg_group: 各自计入全部事件，而不是共用一张分组表
+make_topology "$WORK_DIR/active" 01_parse:parse_json 02_fork/a/01_group:agg_group 02_fork/b/01_group:agg_group
+: > "$WORK_DIR/host.log"
+ALIN_GROUP_BY=level ALIN_GROUP_DROP=1 run_host "$WORK_DIR/logs.jsonl" > "$WORK_DIR/out.jsonl"
+check_equal "加载了私有副本" 1 "$(grep -c 'Loaded a private copy of agg_group_[0-9a-f]* for 02_fork/b/01_group' "$WORK_DIR/host.log")"
+errors=$(grep -c '"level":"ERROR"' "$WORK_DIR/logs.jsonl")
+check_equal "两个槽位的 ERROR 分组" "$(printf '"count":%d\n"count":%d' "$errors" "$errors")" \
+    "$(grep '"level":"ERROR"' "$WORK_DIR/out.jsonl" | grep -o '"count":[0-9]*')"
+
+finish
@@ -0,0 +1,76 @@
+#!/bin/bash
+# =========================================
+# ALIN 热替换测试 (Hot-Swap Flow Tests)
+# =========================================
+#
+# - 运行中热替换槽位时记录不丢失、不重复、不乱序 (运行器与宿主)
+# - 换下的有状态节点在退出 / 卸载前输出攒下的结果，计数不丢失
+#
+# 使用方式:
+#   make test                           # 编译后运行全部测试
+#   ./alin/flows/test_hotswap.sh        # 只运行本组 (需已 make stream runner host)
+
+source "$(dirname "$0")/test_lib.sh"
+
+export ALIN_METRICS_DIR=
+
+run_runner() {
+    "$BIN_DIR/alin_runner" -a "$WORK_DIR/active" -n "$NODES_DIR" -s "$WORK_DIR/state" "$@" 2>>"$WORK_DIR/runner.log"
+}
+
+run_host() {
+    "$BIN_DIR/alin_host" -a "$WORK_DIR/active" -n "$NODES_DIR" -s "$WORK_DIR/state" "$@" 2>>"$WORK_DIR/host.log"
+}
+
+# 逐行写入 n 条日志，每 batch 条停顿 pause 秒 (热替换需要在流动中发生)
+slow_logs() {
+    gen_logs "$1" | awk -v batch="$2" -v pause="$3" '{ print; fflush() } NR % batch == 0 { system("sleep " pause) }'
+}
+
+# 原子地把槽位指向 target (与 alin_link.sh 相同: 新链接改名覆盖旧链接): swap_slot <槽位> <目标>
+swap_slot() {
+    ln -s "$2" "$WORK_DIR/active/.$1.new"
+    mv -T "$WORK_DIR/active/.$1.new" "$WORK_DIR/active/$1"
+}
+
+# ===== 无状态节点 =====
+section "热替换不丢失记录"
+# 同一节点的副本 (新 Inode)，替换前后输出相同，只检查记录的完整与顺序
+cp "$(node_path filter_level)" "$WORK_DIR/filter_level_copy"
+cp "$(node_path filter_level).so" "$WORK_DIR/filter_level_copy.so"
+export ALIN_FILTER_LEVEL=DEBUG
+for mode in runner host; do
+    make_topology "$WORK_DIR/active" 01_parse:parse_json 02_filter:filter_level
+    : > "$WORK_DIR/$mode.log"
+    slow_logs 4000 200 0.05 | run_$mode > "$WORK_DIR/out.jsonl" &
+    pid=$!
+    sleep 0.4
+    swap_slot 02_filter "$WORK_DIR/filter_level_copy"
+    sleep 0.4
+    swap_slot 02_filter "$(node_path filter_level)"
+    wait $pid
+    check_sequence "$mode: 4000 条依次输出" "$WORK_DIR/out.jsonl" 4000
+    check_equal "$mode: 替换了两次" 2 "$(grep -c 'Swapped 02_filter' "$WORK_DIR/$mode.log")"
+done
+
+# ===== 有状态节点 =====
+section "换下的有状态节点输出攒下的结果"
+# agg_group 只在输入结束 (或换下) 时输出: 各次输出的 delta 之和即计入的事件数
+cp "$(node_path agg_group)" "$WORK_DIR/agg_group_copy"
+cp "$(node_path agg_group).so" "$WORK_DIR/agg_group_copy.so"
+export ALIN_GROUP_BY=level ALIN_GROUP_DROP=1 ALIN_GROUP_EMIT_MS=3600000
+for mode in runner host; do
+    make_topology "$WORK_DIR/active" 01_parse:parse_json 02_group:agg_group
+    : > "$WORK_DIR/$mode.log"
+    slow_logs 4000 200 0.05 | run_$mode > "$WORK_DIR/out.jsonl" &
+    pid=$!
+    sleep 0.6
+    swap_slot 02_group "$WORK_DIR/agg_group_copy"
+    wait $pid
+    check_equal "$mode: 替换了一次" 1 "$(grep -c 'Swapped 02_group' "$WORK_DIR/$mode.log")"
+    check_equal "$mode: delta 之和" 4000 \
+        "$(grep -o '"delta":[0-9]*' "$WORK_DIR/out.jsonl" | awk -F: '{ sum += $2 } END { print sum + 0 }')"
+done
+unset ALIN_GROUP_BY ALIN_GROUP_DROP ALIN_GROUP_EMIT_MS
+
+finish
@@ -0,0 +1,130 @@
+#!/bin/bash
+# =========================================
+# ALIN 流程测试公共函数 (Flow Test Helpers)
+# =========================================
+#
+# 由 alin/flows/test_*.sh 引用 (source)，不单独运行:
+# - 每个测试脚本一个临时工作目录 (退出时删除)，拓扑、状态与输出都放在其中，不触碰 alin/active
+# - 节点取 alin/nodes 下最近编译的 <名称>_<hash> (先 make stream runner)
+# - check_same / check_equal 记录结果，finish 汇总并以失败数决定退出码
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$(dirname "$SCRIPT_DIR")")"
+NODES_DIR="$PROJECT_DIR/alin/nodes"
+BIN_DIR="$PROJECT_DIR/alin/bin"
+
+# 颜色输出
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+NC='\033[0m'
+
+WORK_DIR=$(mktemp -d /tmp/alin-test.XXXXXX)
+trap 'rm -rf "$WORK_DIR"' EXIT
+TESTS_PASSED=0
+TESTS_FAILED=0
+
+section() {
+    echo -e "${YELLOW}▶ $1${NC}"
+}
+
+pass() {
+    echo -e "  ${GREEN}✅ $1${NC}"
+    TESTS_PASSED=$((TESTS_PASSED + 1))
+}
+
+fail() {
+    echo -e "  ${RED}❌ $1${NC}"
+    TESTS_FAILED=$((TESTS_FAILED + 1))
+}
+
+# 最近编译的节点的绝对路径
+node_path() {
+    local name=$(ls -1t "$NODES_DIR" 2>/dev/null | grep -E "^$1_[0-9a-f]{8}$" | head -1)
+    if [ -z "$name" ]; then
+        echo -e "${RED}❌ 未找到节点: $1 (先运行 make stream runner)${NC}" >&2
+        exit 1
+    fi
+    echo "$NODES_DIR/$name"
+}
+
+# 在 dir 下建立拓扑: make_topology <dir> <槽位>:<节点> ...
+make_topology() {
+    local dir="$1"
+    shift
+    rm -rf "$dir"
+    mkdir -p "$dir"
+    for spec in "$@"; do
+        mkdir -p "$(dirname "$dir/${spec%%:*}")"
+        ln -s "$(node_path "${spec#*:}")" "$dir/${spec%%:*}"
+    done
+}
+
+# 生成 n 条日志 (消息为 "event <i>"，时间戳递增): gen_logs <n> [起始时间]
+gen_logs() {
+    awk -v n="$1" -v t0="${2:-1700000000}" 'BEGIN {
+        split("DEBUG INFO INFO INFO WARN ERROR", levels, " ")
+        split("api auth db cache", services, " ")
+        srand(42)
+        for (i = 0; i < n; i++) {
+            printf "{\"level\":\"%s\",\"service\":\"%s\",\"msg\":\"event %d\",\"timestamp\":%d,\"latency_ms\":%d}\n",
+                levels[int(rand() * 6) + 1], services[int(rand() * 4) + 1], i, t0 + i, int(rand() * 3000)
+        }
+    }'
+}
+
+# 逐行经过节点链 (单次模式，与 alin_stream.sh 的逐行路径相同): per_line <输入> <节点路径>...
+per_line() {
+    local input="$1"
+    shift
+    while IFS= read -r line || [ -n "$line" ]; do
+        [ -z "$line" ] && continue
+        local result="$line"
+        for node in "$@"; do
+            [ -n "$result" ] && result=$(echo "$result" | ALIN_STREAM=0 "$node" 2>/dev/null || echo "")
+        done
+        [ -n "$result" ] && echo "$result"
+    done < "$input"
+}
+
+# 两个文件内容相同: check_same <说明> <期望文件> <实际文件>
+check_same() {
+    if cmp -s "$2" "$3"; then
+        pass "$1"
+    else
+        fail "$1"
+        diff "$2" "$3" | head -10 | sed 's/^/      /'
+    fi
+}
+
+# 两个值相等: check_equal <说明> <期望> <实际>
+check_equal() {
+    if [ "$2" == "$3" ]; then
+        pass "$1"
+    else
+        fail "$1 (期望 $2, 实际 $3)"
+    fi
+}
+
+# 输出中的消息 "event <i>" 按 i = 0..n-1 依次出现 (不丢失、不重复、不乱序):
+# check_sequence <说明> <文件> <n>
+check_sequence() {
+    local bad=$(grep -o '"message":"event [0-9]*' "$2" | grep -o '[0-9]*$' | awk -v n="$3" '
+        $1 != NR - 1 { print "record " NR " has seq " $1; exit }
+        END { if (NR != n) print NR " records, expected " n }')
+    if [ -z "$bad" ]; then
+        pass "$1"
+    else
+        fail "$1: $bad"
+    fi
+}
+
+finish() {
+    echo ""
+    if [ "$TESTS_FAILED" -eq 0 ]; then
+        echo -e "${GREEN}$(basename "$0"): $TESTS_PASSED passed${NC}"
+    else
+        echo -e "${RED}$(basename "$0"): $TESTS_FAILED failed, $TESTS_PASSED passed${NC}"
+    fi
+    [ "$TESTS_FAILED" -eq 0 ]
+}
@@ -0,0 +1,231 @@
+#!/bin/bash
+# =========================================
+# ALIN 节点测试 (Node Flow Tests)
+# =========================================
+#
+# 每个流处理节点以流模式处理一组固定的输入，输出与期望逐行比对
+# (聚合节点的结果在输入结束时的最后一次空闲回调中输出)
+#
+# 使用方式:
+#   make test                       # 编译后运行全部测试
+#   ./alin/flows/test_nodes.sh      # 只运行本组 (需已 make stream)
+
+source "$(dirname "$0")/test_lib.sh"
+
+export ALIN_METRICS_DIR=
+
+# 节点处理 EVENTS 的输出 (经 sed 脚本 NORMALIZE 去掉不确定的部分) 与 stdin 中的期望相同:
+# expect_node <说明> <节点> [参数]...
+expect_node() {
+    local desc="$1" node="$2"
+    shift 2
+    cat > "$WORK_DIR/expected.jsonl"
+    "$(node_path "$node")" "$@" --stream < "$EVENTS" 2>>"$WORK_DIR/node.log" \
+        | sed -e "${NORMALIZE:-}" > "$WORK_DIR/out.jsonl"
+    check_same "$desc" "$WORK_DIR/expected.jsonl" "$WORK_DIR/out.jsonl"
+}
+
+section "parse_json"
+EVENTS="$WORK_DIR/raw.jsonl"
+cat > "$EVENTS" <<'EOF'
+{"level":"error","msg":"disk \"sda\" full","ts":1700000000,"host":"web-1"}
+{"level":"warn","message":"slow","timestamp":1700000005}
+EOF
+export ALIN_SPOOL_DIR="$WORK_DIR/spool"
+mkdir -p "$ALIN_SPOOL_DIR"
+expect_node "inline: 原文转义后内嵌" parse_json <<'EOF'
+{"_type":"log","level":"ERROR","message":"disk \"sda\" full","timestamp":1700000000,"_raw":"{\"level\":\"error\",\"msg\":\"disk \\\"sda\\\" full\",\"ts\":1700000000,\"host\":\"web-1\"}"}
+{"_type":"log","level":"WARN","message":"slow","timestamp":1700000005,"_raw":"{\"level\":\"warn\",\"message\":\"slow\",\"timestamp\":1700000005}"}
+EOF
+check_equal "inline: 放得下时不创建暂存区" 0 "$(ls "$ALIN_SPOOL_DIR" | wc -l)"
+
+ALIN_RAW=off expect_node "off: 不带原文" parse_json <<'EOF'
+{"_type":"log","level":"ERROR","message":"disk \"sda\" full","timestamp":1700000000}
+{"_type":"log","level":"WARN","message":"slow","timestamp":1700000005}
+EOF
+
+ALIN_RAW=ref NORMALIZE='s/"spool":"parse_json\.[0-9]*"/"spool":"parse_json"/' \
+expect_node "ref: 原文写入暂存区，事件只带引用" parse_json <<'EOF'
+{"_type":"log","level":"ERROR","message":"disk \"sda\" full","timestamp":1700000000,"_raw_ref":{"spool":"parse_json","pos":0,"len":74}}
+{"_type":"log","level":"WARN","message":"slow","timestamp":1700000005,"_raw_ref":{"spool":"parse_json","pos":74,"len":56}}
+EOF
+ALIN_RAW=ref "$(node_path parse_json)" --stream < "$EVENTS" 2>>"$WORK_DIR/node.log" | head -1 \
+    | ALIN_ALERT_RAW=1 "$(node_path alert_console)" --stream 2>"$WORK_DIR/alert.log" > /dev/null
+check_equal "ref: 下游从暂存区取回原文" 1 "$(grep -c 'Raw:     {"level":"error","msg":"disk' "$WORK_DIR/alert.log")"
+
+# 转义后超出输出上限的记录: inline 模式此时才打开暂存区，改用引用
+rm -f "$ALIN_SPOOL_DIR"/*
+awk 'BEGIN { printf "{\"level\":\"warn\",\"timestamp\":7,\"msg\":\""; for (i = 0; i < 3000000; i++) printf "\\\\"; print "\"}" }' \
+    > "$WORK_DIR/big.jsonl"
+"$(node_path parse_json)" --stream < "$WORK_DIR/big.jsonl" 2>>"$WORK_DIR/node.log" > "$WORK_DIR/out.jsonl"
+check_equal "inline: 超长记录改用引用" 1 "$(grep -c '"_raw_ref":{"spool":"parse_json\.[0-9]*","pos":0,"len":6000039}}$' "$WORK_DIR/out.jsonl")"
+check_equal "inline: 超长记录时创建暂存区" 1 "$(ls "$ALIN_SPOOL_DIR" | wc -l)"
+unset ALIN_SPOOL_DIR
+"$(node_path parse_json)" --stream < "$WORK_DIR/big.jsonl" 2>>"$WORK_DIR/node.log" > "$WORK_DIR/out.jsonl"
+check_equal "inline: 无暂存区时截断" 1 "$(grep -c '"_raw_truncated":true}$' "$WORK_DIR/out.jsonl")"
+
+# 标准化事件 (parse_json 之后各节点的输入)
+EVENTS="$WORK_DIR/events.jsonl"
+cat > "$EVENTS" <<'EOF'
+{"_type":"log","level":"INFO","service":"api","message":"request ok","timestamp":100,"latency_ms":12,"user_id":"u1"}
+{"_type":"log","level":"ERROR","service":"db","message":"connection refused","timestamp":101,"latency_ms":812,"user_id":"u2"}
+{"_type":"log","level":"WARN","service":"db","message":"slow query","timestamp":103,"latency_ms":640,"user_id":"u1"}
+{"_type":"log","level":"ERROR","service":"db","message":"connection refused","timestamp":104,"latency_ms":900,"user_id":"u3"}
+{"_type":"log","level":"DEBUG","service":"api","message":"cache miss","timestamp":105,"latency_ms":3,"user_id":"u2"}
+{"_type":"log","level":"ERROR","service":"api","message":"upstream timeout","timestamp":108,"latency_ms":5000,"user_id":"u4"}
+{"_type":"log","level":"INFO","service":"api","message":"request ok","timestamp":109,"latency_ms":20,"user_id":"u1"}
+{"_type":"log","level":"ERROR","service":"db","message":"connection refused","timestamp":112,"latency_ms":700,"user_id":"u2"}
+{"_type":"log","level":"INFO","service":"auth","message":"login","timestamp":113,"latency_ms":45,"user_id":"u5"}
+{"_type":"log","level":"WARN","service":"api","message":"retry","timestamp":121,"latency_ms":250,"user_id":"u4"}
+EOF
+
+section "filter_expr"
+ALIN_FILTER_EXPR='level>=WARN && service=="db" && latency_ms>650 || message~"timeout"' \
+expect_node "比较、组合与包含" filter_expr <<'EOF'
+{"_type":"log","level":"ERROR","service":"db","message":"connection refused","timestamp":101,"latency_ms":812,"user_id":"u2"}
+{"_type":"log","level":"ERROR","service":"db","message":"connection refused","timestamp":104,"latency_ms":900,"user_id":"u3"}
+{"_type":"log","level":"ERROR","service":"api","message":"upstream timeout","timestamp":108,"latency_ms":5000,"user_id":"u4"}
+{"_type":"log","level":"ERROR","service":"db","message":"connection refused","timestamp":112,"latency_ms":700,"user_id":"u2"}
+EOF
+
+section "match_keywords"
+printf 'refused\n# 注释\nTIMEOUT\nok\n' > "$WORK_DIR/patterns.txt"
+ALIN_MATCH_PATTERNS="$WORK_DIR/patterns.txt" ALIN_MATCH_NOCASE=1 ALIN_MATCH_DROP=1 \
+expect_node "不区分大小写，丢弃未命中" match_keywords <<'EOF'
+{"_type":"log","level":"INFO","service":"api","message":"request ok","timestamp":100,"latency_ms":12,"user_id":"u1","_match":[3]}
+{"_type":"log","level":"ERROR","service":"db","message":"connection refused","timestamp":101,"latency_ms":812,"user_id":"u2","_match":[1]}
+{"_type":"log","level":"ERROR","service":"db","message":"connection refused","timestamp":104,"latency_ms":900,"user_id":"u3","_match":[1]}
+{"_type":"log","level":"ERROR","service":"api","message":"upstream timeout","timestamp":108,"latency_ms":5000,"user_id":"u4","_match":[2]}
+{"_type":"log","level":"INFO","service":"api","message":"request ok","timestamp":109,"latency_ms":20,"user_id":"u1","_match":[3]}
+{"_type":"log","level":"ERROR","service":"db","message":"connection refused","timestamp":112,"latency_ms":700,"user_id":"u2","_match":[1]}
+EOF
+
+section "sampler"
+ALIN_SAMPLE_KEY=service ALIN_SAMPLE_KEYS=api=0 \
+expect_node "丢弃的事件计入同级别下一条的 _weight" sampler <<'EOF'
+{"_type":"log","level":"ERROR","service":"db","message":"connection refused","timestamp":101,"latency_ms":812,"user_id":"u2"}
+{"_type":"log","level":"WARN","service":"db","message":"slow query","timestamp":103,"latency_ms":640,"user_id":"u1"}
+{"_type":"log","level":"ERROR","service":"db","message":"connection refused","timestamp":104,"latency_ms":900,"user_id":"u3"}
+{"_type":"log","level":"ERROR","service":"db","message":"connection refused","timestamp":112,"latency_ms":700,"user_id":"u2","_weight":2}
+{"_type":"log","level":"INFO","service":"auth","message":"login","timestamp":113,"latency_ms":45,"user_id":"u5","_weight":3}
+{"_type":"log","level":"DEBUG","_weight":1,"_sample_flush":"final"}
+{"_type":"log","level":"WARN","_weight":1,"_sample_flush":"final"}
+EOF
+# 上游带来的 _weight 计入待补权重，保留的事件就地改写 _weight，不重复追加
+awk 'BEGIN {
+    for (i = 0; i < 200; i++) printf "{\"_type\":\"log\",\"level\":\"DEBUG\",\"message\":\"event %d\",\"_weight\":4}\n", i
+    print "{\"_type\":\"log\",\"level\":\"DEBUG\",\"message\":\"event 200\"}"
+}' > "$WORK_DIR/weighted.jsonl"
+ALIN_SAMPLE_LEVELS=DEBUG=0.5 ALIN_SAMPLE_SEED=7 "$(node_path sampler)" --stream < "$WORK_DIR/weighted.jsonl" \
+    2>>"$WORK_DIR/node.log" > "$WORK_DIR/sampled.jsonl"
+check_equal "没有重复的 _weight" 0 "$(grep -c '_weight.*_weight' "$WORK_DIR/sampled.jsonl")"
+ALIN_STATE_FILE= "$(node_path agg_count)" --stream < "$WORK_DIR/sampled.jsonl" 2>>"$WORK_DIR/node.log" \
+    > "$WORK_DIR/out.jsonl"
+check_equal "带权输入经 agg_count 的总数" '"total":801' "$(tail -1 "$WORK_DIR/out.jsonl" | grep -o '"total":[0-9]*')"
+# dedup 的 _dup 与补记记录经 sampler 后计数仍与去重前一致
+gen_logs 3000 | ALIN_DEDUP_FIELDS=service "$(node_path dedup)" --stream 2>>"$WORK_DIR/node.log" \
+    | ALIN_SAMPLE_LEVELS=DEBUG=0.1,INFO=0.3,WARN=0.5 ALIN_SAMPLE_SEED=7 "$(node_path sampler)" --stream 2>>"$WORK_DIR/node.log" \
+    | ALIN_STATE_FILE= "$(node_path agg_count)" --stream 2>>"$WORK_DIR/node.log" > "$WORK_DIR/out.jsonl"
+check_equal "dedup → sampler → agg_count 的总数" '"total":3000' "$(tail -1 "$WORK_DIR/out.jsonl" | grep -o '"total":[0-9]*')"
+
+section "dedup"
+ALIN_DEDUP_FIELDS=service,message \
+expect_node "窗口内的重复被抑制，输入结束时补记" dedup <<'EOF'
+{"_type":"log","level":"INFO","service":"api","message":"request ok","timestamp":100,"latency_ms":12,"user_id":"u1"}
+{"_type":"log","level":"ERROR","service":"db","message":"connection refused","timestamp":101,"latency_ms":812,"user_id":"u2"}
+{"_type":"log","level":"WARN","service":"db","message":"slow query","timestamp":103,"latency_ms":640,"user_id":"u1"}
+{"_type":"log","level":"DEBUG","service":"api","message":"cache miss","timestamp":105,"latency_ms":3,"user_id":"u2"}
+{"_type":"log","level":"ERROR","service":"api","message":"upstream timeout","timestamp":108,"latency_ms":5000,"user_id":"u4"}
+{"_type":"log","level":"INFO","service":"auth","message":"login","timestamp":113,"latency_ms":45,"user_id":"u5"}
+{"_type":"log","level":"WARN","service":"api","message":"retry","timestamp":121,"latency_ms":250,"user_id":"u4"}
+{"_type":"log","level":"ERROR","timestamp":104,"service":"db","message":"connection refused","_weight":2,"_dup_flush":"final"}
+{"_type":"log","level":"INFO","timestamp":109,"service":"api","message":"request ok","_weight":1,"_dup_flush":"final"}
+EOF
+# 补记后经 agg_count 的总数与抑制前一致
+gen_logs 3000 | "$(node_path dedup)" --stream 2>>"$WORK_DIR/node.log" \
+    | ALIN_STATE_FILE= "$(node_path agg_count)" --stream 2>>"$WORK_DIR/node.log" > "$WORK_DIR/out.jsonl"
+check_equal "agg_count 计数与去重前一致" '"total":3000' "$(tail -1 "$WORK_DIR/out.jsonl" | grep -o '"total":[0-9]*')"
+
+section "agg_group"
+ALIN_GROUP_BY=service,level ALIN_GROUP_DROP=1 \
+expect_node "按 service,level 分组计数" agg_group <<'EOF'
+{"_type":"agg","group":{"service":"api","level":"INFO"},"count":2,"delta":2}
+{"_type":"agg","group":{"service":"db","level":"ERROR"},"count":3,"delta":3}
+{"_type":"agg","group":{"service":"db","level":"WARN"},"count":1,"delta":1}
+{"_type":"agg","group":{"service":"api","level":"DEBUG"},"count":1,"delta":1}
+{"_type":"agg","group":{"service":"api","level":"ERROR"},"count":1,"delta":1}
+{"_type":"agg","group":{"service":"auth","level":"INFO"},"count":1,"delta":1}
+{"_type":"agg","group":{"service":"api","level":"WARN"},"count":1,"delta":1}
+EOF
+
+section "agg_window"
+ALIN_WINDOW_SIZE=10 ALIN_WINDOW_SLIDE=5 ALIN_WINDOW_LATENESS=2 ALIN_WINDOW_DROP=1 \
+expect_node "10 秒窗口每 5 秒滑动" agg_window <<'EOF'
+{"_type":"window","start":95,"end":105,"count":4,"rate":0.40,"by_level":{"INFO":1,"ERROR":2,"WARN":1},"late":0}
+{"_type":"window","start":100,"end":110,"count":7,"rate":0.70,"by_level":{"INFO":2,"ERROR":3,"WARN":1,"DEBUG":1},"late":0}
+{"_type":"window","start":105,"end":115,"count":5,"rate":0.50,"by_level":{"INFO":2,"ERROR":2,"DEBUG":1},"late":0}
+{"_type":"window","start":110,"end":120,"count":2,"rate":0.20,"by_level":{"INFO":1,"ERROR":1},"late":0}
+{"_type":"window","start":115,"end":125,"count":1,"rate":0.10,"by_level":{"WARN":1},"late":0}
+{"_type":"window","start":120,"end":130,"count":1,"rate":0.10,"by_level":{"WARN":1},"late":0}
+EOF
+
+# 迟到事件不计入已关闭的窗口，在下一条结果中报告; 其余窗口在输入结束时输出
+printf '%s\n' '{"level":"INFO","timestamp":100}' '{"level":"WARN","timestamp":120}' '{"level":"ERROR","timestamp":101}' \
+    '{"level":"INFO","timestamp":119}' '{"level":"INFO","timestamp":125}' > "$WORK_DIR/late.jsonl"
+EVENTS="$WORK_DIR/late.jsonl" ALIN_WINDOW_SIZE=10 ALIN_WINDOW_SLIDE=5 ALIN_WINDOW_LATENESS=2 ALIN_WINDOW_DROP=1 \
+expect_node "迟到事件与输入结束时的输出" agg_window <<'EOF'
+{"_type":"window","start":95,"end":105,"count":1,"rate":0.10,"by_level":{"INFO":1},"late":0}
+{"_type":"window","start":100,"end":110,"count":1,"rate":0.10,"by_level":{"INFO":1},"late":0}
+{"_type":"window","start":110,"end":120,"count":1,"rate":0.10,"by_level":{"INFO":1},"late":1}
+{"_type":"window","start":115,"end":125,"count":2,"rate":0.20,"by_level":{"INFO":1,"WARN":1},"late":0}
+{"_type":"window","start":120,"end":130,"count":2,"rate":0.20,"by_level":{"INFO":1,"WARN":1},"late":0}
+{"_type":"window","start":125,"end":135,"count":1,"rate":0.10,"by_level":{"INFO":1},"late":0}
+EOF
+
+# alert_console 按窗口的 count / rate 判断阈值
+ALIN_WINDOW_SIZE=10 ALIN_WINDOW_SLIDE=5 ALIN_WINDOW_LATENESS=2 ALIN_WINDOW_DROP=1 \
+    "$(node_path agg_window)" --stream < "$EVENTS" 2>>"$WORK_DIR/node.log" \
+    | TZ=UTC ALIN_ALERT_FORMAT=json ALIN_ALERT_THRESHOLD=5 "$(node_path alert_console)" --stream \
+    2>>"$WORK_DIR/node.log" > "$WORK_DIR/out.jsonl"
+cat > "$WORK_DIR/expected.jsonl" <<'EOF'
+{"alert":true,"time":"1970-01-01 00:01:50","level":"INFO","message":"window 100-110","total":7,"rate":0.70}
+{"alert":true,"time":"1970-01-01 00:01:55","level":"INFO","message":"window 105-115","total":5,"rate":0.50}
+EOF
+grep '"alert"' "$WORK_DIR/out.jsonl" > "$WORK_DIR/alerts.jsonl"    # 未达阈值的记录原样放行
+check_same "alert_console: 窗口计数阈值" "$WORK_DIR/expected.jsonl" "$WORK_DIR/alerts.jsonl"
+ALIN_WINDOW_SIZE=10 ALIN_WINDOW_SLIDE=5 ALIN_WINDOW_LATENESS=2 ALIN_WINDOW_DROP=1 \
+    "$(node_path agg_window)" --stream < "$EVENTS" 2>>"$WORK_DIR/node.log" \
+    | TZ=UTC ALIN_ALERT_FORMAT=json ALIN_ALERT_THRESHOLD=1 ALIN_ALERT_RATE=0.6 "$(node_path alert_console)" --stream \
+    2>>"$WORK_DIR/node.log" > "$WORK_DIR/out.jsonl"
+check_equal "alert_console: 窗口速率阈值" '"message":"window 100-110"' "$(grep '"alert"' "$WORK_DIR/out.jsonl" | grep -o '"message":"[^"]*"')"
+
+# 事件时间向前跳跃: 中间没有事件的窗口不逐个关闭 (每秒滑动时原先要循环约 1e12 次)
+printf '%s\n' '{"level":"ERROR","timestamp":1000}' '{"level":"INFO","timestamp":1000000000000}' > "$WORK_DIR/jump.jsonl"
+ALIN_WINDOW_SIZE=10 ALIN_WINDOW_SLIDE=1 ALIN_WINDOW_DROP=1 timeout 10 "$(node_path agg_window)" --stream \
+    < "$WORK_DIR/jump.jsonl" > "$WORK_DIR/out.jsonl" 2>>"$WORK_DIR/node.log"
+check_equal "时间跳跃后及时结束" 0 "$?"
+check_equal "跳跃前后各 10 个窗口" "10 10" \
+    "$(grep -c '"end":10[0-9][0-9],' "$WORK_DIR/out.jsonl") $(grep -c '"end":10000000000[0-9][0-9],' "$WORK_DIR/out.jsonl")"
+
+section "agg_sketch"
+ALIN_SKETCH_STATE= ALIN_SKETCH_DROP=1 NORMALIZE='s/,"_agg":{"sketch":"[^"]*"}//' \
+expect_node "去重计数与分位数" agg_sketch <<'EOF'
+{"_type":"sketch","group":{"service":"api"},"count":5,"distinct":3,"value":{"count":5,"min":3,"max":5000,"mean":1057,"p50":20.25,"p90":250,"p99":250,"p999":250}}
+{"_type":"sketch","group":{"service":"db"},"count":4,"distinct":3,"value":{"count":4,"min":640,"max":900,"mean":763,"p50":696,"p90":808,"p99":808,"p999":808}}
+{"_type":"sketch","group":{"service":"auth"},"count":1,"distinct":1,"value":{"count":1,"min":45,"max":45,"mean":45,"p50":45,"p90":45,"p99":45,"p999":45}}
+EOF
+# 两个实例的增量概要汇入第三个实例，与一个实例处理全部输入相同
+gen_logs 4000 > "$WORK_DIR/logs.jsonl"
+export ALIN_SKETCH_STATE= ALIN_SKETCH_DROP=1 ALIN_SKETCH_EMIT_MS=1
+SKETCH=$(node_path agg_sketch)
+"$SKETCH" --stream < "$WORK_DIR/logs.jsonl" 2>>"$WORK_DIR/node.log" | tail -4 \
+    | sed 's/,"_agg":{"sketch":"[^"]*"}//' | sort > "$WORK_DIR/expected.jsonl"
+{ head -1500 "$WORK_DIR/logs.jsonl" | "$SKETCH" --stream; tail -n +1501 "$WORK_DIR/logs.jsonl" | "$SKETCH" --stream; } 2>>"$WORK_DIR/node.log" \
+    | "$SKETCH" --stream 2>>"$WORK_DIR/node.log" | sed 's/,"_agg":{"sketch":"[^"]*"}//' \
+    | awk -F',"count":' '{ last[$1] = $0 } END { for (g in last) print last[g] }' \
+    | sort > "$WORK_DIR/out.jsonl"
+check_equal "单实例每个 service 一组" 4 "$(wc -l < "$WORK_DIR/expected.jsonl")"
+check_same "增量合并与单实例相同" "$WORK_DIR/expected.jsonl" "$WORK_DIR/out.jsonl"
+unset ALIN_SKETCH_STATE ALIN_SKETCH_DROP ALIN_SKETCH_EMIT_MS
+
+finish
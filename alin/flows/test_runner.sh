@@ -0,0 +1,81 @@
+#!/bin/bash
+# =========================================
+# ALIN 运行器测试 (Runner Flow Tests)
+# =========================================
+#
+# - 常驻运行器的输出与逐行 fork 的旧路径一致 (JSON 行 / 帧格式 / 环形缓冲)
+# - 有状态的末级 (agg_count) 计入全部事件
+# - 并行副本不改变记录顺序
+# - 分叉槽位把每条记录交给每条分支，输出在分叉之后汇合 (与宿主一致)
+#
+# 使用方式:
+#   make test                          # 编译后运行全部测试
+#   ./alin/flows/test_runner.sh        # 只运行本组 (需已 make stream runner host)
+
+source "$(dirname "$0")/test_lib.sh"
+
+RUNNER="$BIN_DIR/alin_runner"
+export ALIN_FILTER_LEVEL=WARN
+export ALIN_METRICS_DIR=
+
+run_runner() {
+    "$RUNNER" -a "$WORK_DIR/active" -n "$NODES_DIR" -s "$WORK_DIR/state" "$@" 2>>"$WORK_DIR/runner.log"
+}
+
+run_host() {
+    "$BIN_DIR/alin_host" -a "$WORK_DIR/active" -n "$NODES_DIR" -s "$WORK_DIR/state" "$@" 2>>"$WORK_DIR/host.log"
+}
+
+# ===== 与逐行路径一致 =====
+section "运行器与逐行路径的输出一致"
+printf 'timeout\nrefused\n# 注释\nevent 1\n' > "$WORK_DIR/patterns.txt"
+export ALIN_MATCH_PATTERNS="$WORK_DIR/patterns.txt"
+gen_logs 300 > "$WORK_DIR/logs.jsonl"
+make_topology "$WORK_DIR/active" 01_parse:parse_json 02_filter:filter_level 03_match:match_keywords
+per_line "$WORK_DIR/logs.jsonl" "$WORK_DIR/active/01_parse" "$WORK_DIR/active/02_filter" "$WORK_DIR/active/03_match" \
+    > "$WORK_DIR/expected.jsonl"
+check_equal "逐行路径有输出" 1 "$([ -s "$WORK_DIR/expected.jsonl" ] && echo 1 || echo 0)"
+
+ALIN_FRAMED=0 ALIN_RING=0 run_runner "$WORK_DIR/logs.jsonl" > "$WORK_DIR/out.jsonl"
+check_same "运行器 (JSON 行)" "$WORK_DIR/expected.jsonl" "$WORK_DIR/out.jsonl"
+ALIN_FRAMED=0 ALIN_RING=0 run_runner < "$WORK_DIR/logs.jsonl" > "$WORK_DIR/out.jsonl"
+check_same "运行器 (stdin 输入)" "$WORK_DIR/expected.jsonl" "$WORK_DIR/out.jsonl"
+ALIN_RING=0 run_runner "$WORK_DIR/logs.jsonl" > "$WORK_DIR/out.jsonl"
+check_same "运行器 (帧格式 + 管道)" "$WORK_DIR/expected.jsonl" "$WORK_DIR/out.jsonl"
+run_runner "$WORK_DIR/logs.jsonl" > "$WORK_DIR/out.jsonl"
+check_same "运行器 (帧格式 + 环形缓冲)" "$WORK_DIR/expected.jsonl" "$WORK_DIR/out.jsonl"
+
+# ===== 有状态的末级 =====
+section "agg_count 在运行器中计入全部事件"
+make_topology "$WORK_DIR/active" 01_parse:parse_json 02_agg:agg_count
+gen_logs 5000 > "$WORK_DIR/logs.jsonl"
+rm -rf "$WORK_DIR/state"
+mkdir -p "$WORK_DIR/state"
+ALIN_STATE_FILE="$WORK_DIR/state/agg_count.state" run_runner "$WORK_DIR/logs.jsonl" > "$WORK_DIR/out.jsonl"
+check_equal "输出条数" 5000 "$(wc -l < "$WORK_DIR/out.jsonl")"
+check_equal "最后一条的累计数" '"total":5000' "$(tail -1 "$WORK_DIR/out.jsonl" | grep -o '"total":[0-9]*')"
+check_equal "ERROR 计数" "\"ERROR\":$(grep -c '"level":"ERROR"' "$WORK_DIR/logs.jsonl")" \
+    "$(tail -1 "$WORK_DIR/out.jsonl" | grep -o '"ERROR":[0-9]*')"
+
+# ===== 并行副本 =====
+section "并行副本保持记录顺序"
+make_topology "$WORK_DIR/active" 01_parse:parse_json 02_filter:filter_level 03_match:match_keywords
+gen_logs 50000 > "$WORK_DIR/logs.jsonl"
+run_runner "$WORK_DIR/logs.jsonl" > "$WORK_DIR/expected.jsonl"
+run_runner -r 01_parse=4 -r 02_filter=3 -r 03_match=2 "$WORK_DIR/logs.jsonl" > "$WORK_DIR/out.jsonl"
+check_same "副本 4/3/2 与单实例一致" "$WORK_DIR/expected.jsonl" "$WORK_DIR/out.jsonl"
+ALIN_RING=0 run_runner -r 01_parse=4 "$WORK_DIR/logs.jsonl" > "$WORK_DIR/out.jsonl"
+check_same "副本 (管道) 与单实例一致" "$WORK_DIR/expected.jsonl" "$WORK_DIR/out.jsonl"
+
+# ===== 分叉槽位 =====
+section "分叉槽位扇出与汇合"
+make_topology "$WORK_DIR/active" 01_parse:parse_json 02_fork/a/01_filter:filter_level 02_fork/b/01_match:match_keywords
+gen_logs 1000 > "$WORK_DIR/logs.jsonl"
+run_runner "$WORK_DIR/logs.jsonl" > "$WORK_DIR/out.jsonl"
+run_host "$WORK_DIR/logs.jsonl" > "$WORK_DIR/host.jsonl"
+check_same "运行器与宿主一致" "$WORK_DIR/host.jsonl" "$WORK_DIR/out.jsonl"
+expected=$(( $(grep -c '"level":"\(WARN\|ERROR\)"' "$WORK_DIR/logs.jsonl") + 1000 ))
+check_equal "两条分支的输出都在" "$expected" "$(wc -l < "$WORK_DIR/out.jsonl")"
+check_equal "b 分支标注了命中" 1 "$(grep -c '"message":"event 1",.*"_match":\[3\]' "$WORK_DIR/out.jsonl")"
+
+finish
@@ -0,0 +1,99 @@
+#!/bin/bash
+# =========================================
+# ALIN 状态持久化测试 (State Flow Tests)
+# =========================================
+#
+# - agg_count 映射状态: 重启后接着累计，kill -9 不丢失已计入的事件，--dump-state 可读
+# - agg_count WAL + 快照: kill -9 后重放恢复，末尾残缺的记录被截去，其前的记录照常恢复
+# - agg_sketch 状态文件: 分开处理再 --merge-state 合并，与一个实例处理全部输入相同
+#
+# 使用方式:
+#   make test                       # 编译后运行全部测试
+#   ./alin/flows/test_state.sh      # 只运行本组 (需已 make stream)
+
+source "$(dirname "$0")/test_lib.sh"
+
+AGG=$(node_path agg_count)
+SKETCH=$(node_path agg_sketch)
+export ALIN_METRICS_DIR=
+
+# 从 FIFO 读入 n 条事件，等节点空闲 (提交) 后 kill -9: crash_after <n> <命令>...
+crash_after() {
+    local n="$1"
+    shift
+    rm -f "$WORK_DIR/in.fifo"
+    mkfifo "$WORK_DIR/in.fifo"
+    "$@" --stream < "$WORK_DIR/in.fifo" > /dev/null 2>>"$WORK_DIR/node.log" &
+    local pid=$!
+    exec 3>"$WORK_DIR/in.fifo"
+    gen_logs "$n" >&3
+    sleep 0.5
+    kill -9 $pid
+    wait $pid 2>/dev/null
+    exec 3>&-
+}
+
+dump_total() {
+    "$AGG" --dump-state "$1" 2>/dev/null | grep '^total=' | cut -d= -f2
+}
+
+# ===== 映射状态 =====
+section "agg_count 映射状态"
+export ALIN_STATE_FILE="$WORK_DIR/mmap.state"
+gen_logs 1000 > "$WORK_DIR/logs.jsonl"
+"$AGG" --stream < "$WORK_DIR/logs.jsonl" > /dev/null 2>>"$WORK_DIR/node.log"
+check_equal "首次运行" 1000 "$(dump_total "$ALIN_STATE_FILE")"
+"$AGG" --stream < "$WORK_DIR/logs.jsonl" > "$WORK_DIR/out.jsonl" 2>>"$WORK_DIR/node.log"
+check_equal "重启后接着累计" '"total":2000' "$(tail -1 "$WORK_DIR/out.jsonl" | grep -o '"total":[0-9]*')"
+crash_after 700 "$AGG"
+check_equal "kill -9 后不丢失" 2700 "$(dump_total "$ALIN_STATE_FILE")"
+check_equal "按级别的计数" "level_ERROR=$(( $(grep -c '"ERROR"' "$WORK_DIR/logs.jsonl") * 2 + $(gen_logs 700 | grep -c '"ERROR"') ))" \
+    "$("$AGG" --dump-state "$ALIN_STATE_FILE" | grep '^level_ERROR=')"
+
+# ===== WAL + 快照 =====
+section "agg_count WAL 恢复"
+export ALIN_STATE_MODE=wal
+export ALIN_STATE_FILE="$WORK_DIR/wal/agg"
+mkdir -p "$WORK_DIR/wal"
+"$AGG" --stream < "$WORK_DIR/logs.jsonl" > /dev/null 2>>"$WORK_DIR/node.log"
+check_equal "输入结束时写入快照" 1000 "$(dump_total "$ALIN_STATE_FILE")"
+wal_header=$(stat -c %s "$ALIN_STATE_FILE.wal")
+check_equal "快照后 WAL 只剩头部" 1 "$(( wal_header > 0 && wal_header <= 64 ))"
+
+crash_after 600 "$AGG"
+check_equal "kill -9 前已提交的增量在 WAL 中" 1 "$(( $(stat -c %s "$ALIN_STATE_FILE.wal") > wal_header ))"
+check_equal "快照 + WAL 重放" 1600 "$(dump_total "$ALIN_STATE_FILE")"
+
+# 写了一半的记录: 长度与 CRC 齐全但数据不完整
+printf '\x20\x00\x00\x00\x12\x34\x56\x78\x01\x02\x03' >> "$ALIN_STATE_FILE.wal"
+check_equal "残缺末尾不影响读取" 1600 "$(dump_total "$ALIN_STATE_FILE")"
+: > "$WORK_DIR/node.log"
+gen_logs 400 | "$AGG" --stream > "$WORK_DIR/out.jsonl" 2>>"$WORK_DIR/node.log"
+check_equal "截去残缺末尾后恢复" 1 "$(grep -c 'torn tail dropped' "$WORK_DIR/node.log")"
+check_equal "恢复后接着累计" '"total":2000' "$(tail -1 "$WORK_DIR/out.jsonl" | grep -o '"total":[0-9]*')"
+check_equal "重启后的状态" 2000 "$(dump_total "$ALIN_STATE_FILE")"
+unset ALIN_STATE_MODE ALIN_STATE_FILE
+
+# ===== agg_sketch =====
+section "agg_sketch 状态合并"
+export ALIN_SKETCH_DROP=1
+gen_logs 6000 > "$WORK_DIR/logs.jsonl"
+head -2500 "$WORK_DIR/logs.jsonl" > "$WORK_DIR/part1.jsonl"
+tail -n +2501 "$WORK_DIR/logs.jsonl" > "$WORK_DIR/part2.jsonl"
+ALIN_SKETCH_STATE="$WORK_DIR/all.sketch" "$SKETCH" --stream < "$WORK_DIR/logs.jsonl" > /dev/null 2>>"$WORK_DIR/node.log"
+ALIN_SKETCH_STATE="$WORK_DIR/p1.sketch" "$SKETCH" --stream < "$WORK_DIR/part1.jsonl" > /dev/null 2>>"$WORK_DIR/node.log"
+ALIN_SKETCH_STATE="$WORK_DIR/p2.sketch" "$SKETCH" --stream < "$WORK_DIR/part2.jsonl" > /dev/null 2>>"$WORK_DIR/node.log"
+"$SKETCH" --merge-state "$WORK_DIR/merged.sketch" "$WORK_DIR/p1.sketch" "$WORK_DIR/p2.sketch" >>"$WORK_DIR/node.log" 2>&1
+"$SKETCH" --dump-state "$WORK_DIR/all.sketch" > "$WORK_DIR/expected.jsonl"
+"$SKETCH" --dump-state "$WORK_DIR/merged.sketch" > "$WORK_DIR/out.jsonl"
+check_equal "每个 service 一组" 4 "$(wc -l < "$WORK_DIR/expected.jsonl")"
+check_same "合并两个实例的状态与单实例相同" "$WORK_DIR/expected.jsonl" "$WORK_DIR/out.jsonl"
+
+# 分两次运行同一个状态文件 (重启接着累计)
+ALIN_SKETCH_STATE="$WORK_DIR/restart.sketch" "$SKETCH" --stream < "$WORK_DIR/part1.jsonl" > /dev/null 2>>"$WORK_DIR/node.log"
+ALIN_SKETCH_STATE="$WORK_DIR/restart.sketch" "$SKETCH" --stream < "$WORK_DIR/part2.jsonl" > /dev/null 2>>"$WORK_DIR/node.log"
+"$SKETCH" --dump-state "$WORK_DIR/restart.sketch" > "$WORK_DIR/out.jsonl"
+check_same "重启后接着累计与单实例相同" "$WORK_DIR/expected.jsonl" "$WORK_DIR/out.jsonl"
+unset ALIN_SKETCH_DROP
+
+finish
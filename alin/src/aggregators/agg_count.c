@@ -5,208 +5,306 @@
  * 输入: 标准化 ALIN 事件
  * 输出: 事件 + 累积计数信息 {"...原事件...", "_count": N, "_count_by_level": {...}}
  * 
- * 状态: 使用文件持久化计数 (ALIN_STATE_FILE 环境变量)
+ * 状态: 计数保存在 ALIN_STATE_FILE 指向的二进制状态文件 (alin_state)，首条记录前映射一次，
+ *       之后原地更新，按 ALIN_STATE_SYNC_MS 定期同步; 旧的文本格式在首次打开时自动迁移
+ *       ALIN_STATE_MODE=wal 时改用预写日志 + 快照 (alin_wal，文件为 <路径>.wal 与 <路径>.snap):
+ *       计数保存在内存中，每条事件的增量 (级别、权重) 组提交到 WAL，启动时在快照上重放
+ *       输入结束时 (两种模式) 立即同步: WAL 模式写快照，映射模式做检查点
+ *       查看: agg_count --dump-state [路径] 以文本形式打印 (运行中也可读取)
  * 
  * 统计维度:
  * - 总事件数
  * - 按 level 分组计数
+ *
+ * 权重: 事件带 _weight (sampler 采样后追加) 时按权重计数，带 _dup (dedup 抑制的重复数) 时
+ *       一并计入，还原采样与去重前的数量
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stddef.h>
 #include <time.h>
 
-#define MAX_INPUT_SIZE 65536
+#include "alin_node.h"
+#include "alin_json.h"
+#include "alin_state.h"
+#include "alin_wal.h"
+
 #define MAX_LEVELS 16
 #define MAX_PATH 1024
+#define AGG_STATE_VERSION 1
 
+// 状态文件的状态体 (只在末尾追加字段，追加时 AGG_STATE_VERSION 加一)
 typedef struct {
     char level[64];
-    long count;
+    alin_state_counter_t count;
 } LevelCount;
 
 typedef struct {
-    long total_count;
-    long session_start;
-    int level_count;
+    alin_state_counter_t total_count;
+    int64_t session_start;
+    _Atomic int32_t level_count;     // 名称写好后再发布 (release)，外部读者不会看到半写的名称
+    int32_t reserved;
     LevelCount levels[MAX_LEVELS];
 } AggState;
 
-// 全局状态
-AggState state = {0};
-char state_file[MAX_PATH] = "";
+// WAL 模式下每条事件的增量: 权重、事件时间 (首个增量确定 session_start)、级别名 (不含 '\0')
+typedef struct {
+    int64_t weight;
+    int64_t time;
+    char level[64];
+} AggDelta;
 
-void load_state() {
-    if (state_file[0] == '\0') return;
-    
-    FILE* f = fopen(state_file, "r");
-    if (!f) {
-        state.session_start = (long)time(NULL);
-        return;
+// 全局状态: 未设置 ALIN_STATE_FILE 或打开失败时只保存在内存中
+static AggState memory_state = {0};
+static AggState* state = &memory_state;
+static alin_state_t store = {0};
+static alin_wal_t wal = {0};
+static int wal_mode = 0;
+
+static int find_or_create_level(AggState* s, const char* level);
+
+/**
+ * 把一条增量作用到状态上 (WAL 模式的更新与重放共用)
+ */
+static void apply_delta(void* target, const void* delta, size_t len) {
+    AggState* s = target;
+    AggDelta d = {0};
+    if (len < offsetof(AggDelta, level)) return;
+    memcpy(&d, delta, len < sizeof(d) - 1 ? len : sizeof(d) - 1);
+    if (s->session_start == 0) s->session_start = d.time;
+    alin_state_add(&s->total_count, d.weight);
+    int level_idx = find_or_create_level(s, d.level);
+    if (level_idx >= 0) {
+        alin_state_add(&s->levels[level_idx].count, d.weight);
     }
-    
+}
+
+/**
+ * 空闲回调: 等待输入前提交 WAL 中攒下的一组; 输入结束时 (final) WAL 模式写一次快照，
+ * 映射模式立即做检查点，返回时已计入的全部事件都已同步到磁盘。
+ * 之后 atexit 中的 close_state 没有新的更新，不会再次提交或同步
+ */
+static void commit_state(int final) {
+    if (wal_mode) {
+        if (final) alin_wal_snapshot(&wal);
+        else alin_wal_commit(&wal);
+    } else if (final && store.dirty > 0) {
+        alin_state_checkpoint(&store);
+    }
+}
+
+static void close_state() {
+    if (wal_mode) alin_wal_close(&wal);
+    else alin_state_close(&store);
+}
+
+static int wal_mode_enabled() {
+    const char* mode = getenv("ALIN_STATE_MODE");
+    return mode && strcmp(mode, "wal") == 0;
+}
+
+/**
+ * 读入旧版本的文本状态文件 (total=/session_start=/level_X= 每行一项) 到 memory_state
+ * @return 0 成功, -1 无法读取
+ */
+static int import_text_state(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+
+    int level_count = 0;
     char line[256];
     while (fgets(line, sizeof(line), f)) {
         char key[64], value[64];
         if (sscanf(line, "%63[^=]=%63s", key, value) == 2) {
             if (strcmp(key, "total") == 0) {
-                state.total_count = atol(value);
+                memory_state.total_count = atol(value);
             } else if (strcmp(key, "session_start") == 0) {
-                state.session_start = atol(value);
-            } else if (strncmp(key, "level_", 6) == 0 && state.level_count < MAX_LEVELS) {
-                strncpy(state.levels[state.level_count].level, key + 6, 63);
-                state.levels[state.level_count].count = atol(value);
-                state.level_count++;
+                memory_state.session_start = atol(value);
+            } else if (strncmp(key, "level_", 6) == 0 && level_count < MAX_LEVELS) {
+                strncpy(memory_state.levels[level_count].level, key + 6, 63);
+                memory_state.levels[level_count].count = atol(value);
+                level_count++;
             }
         }
     }
     fclose(f);
-    
-    if (state.session_start == 0) {
-        state.session_start = (long)time(NULL);
-    }
+    memory_state.level_count = level_count;
+    return 0;
 }
 
-void save_state() {
-    if (state_file[0] == '\0') return;
-    
-    FILE* f = fopen(state_file, "w");
-    if (!f) return;
-    
-    fprintf(f, "total=%ld\n", state.total_count);
-    fprintf(f, "session_start=%ld\n", state.session_start);
-    for (int i = 0; i < state.level_count; i++) {
-        fprintf(f, "level_%s=%ld\n", state.levels[i].level, state.levels[i].count);
+/**
+ * 映射状态文件 (首条记录前一次); 旧的文本格式先读入，原文件改名为 <路径>.txt 后重建为二进制格式
+ */
+static void open_state() {
+    const char* path = getenv("ALIN_STATE_FILE");
+    if (!path || path[0] == '\0') return;
+
+    if (wal_mode_enabled()) {
+        if (alin_wal_open(&wal, path, "agg_count", AGG_STATE_VERSION, &memory_state, sizeof(AggState), apply_delta) < 0) {
+            fprintf(stderr, "[AGG] Cannot use write-ahead log %s.wal, counting in memory only\n", path);
+            memset(&memory_state, 0, sizeof(memory_state));
+            memory_state.session_start = (int64_t)time(NULL);
+            return;
+        }
+        wal_mode = 1;
+        alin_set_idle_hook(commit_state);
+        atexit(close_state);
+        return;
     }
-    fclose(f);
-}
 
-int find_or_create_level(const char* level) {
-    for (int i = 0; i < state.level_count; i++) {
-        if (strcasecmp(state.levels[i].level, level) == 0) {
-            return i;
+    AggState* mapped = alin_state_open(&store, path, "agg_count", AGG_STATE_VERSION, sizeof(AggState));
+    if (!mapped && store.error == ALIN_STATE_FOREIGN && import_text_state(path) == 0) {
+        char backup[MAX_PATH + 8];
+        snprintf(backup, sizeof(backup), "%s.txt", path);
+        if (rename(path, backup) == 0) {
+            mapped = alin_state_open(&store, path, "agg_count", AGG_STATE_VERSION, sizeof(AggState));
+            if (mapped) {
+                memcpy(mapped, &memory_state, sizeof(AggState));
+                fprintf(stderr, "[AGG] Migrated text state (total=%ld) to binary, old file kept as %s\n",
+                    (long)memory_state.total_count, backup);
+            }
         }
     }
-    if (state.level_count < MAX_LEVELS) {
-        strncpy(state.levels[state.level_count].level, level, 63);
-        state.levels[state.level_count].count = 0;
-        return state.level_count++;
+    if (!mapped) {
+        fprintf(stderr, "[AGG] Cannot use state file %s%s, counting in memory only\n", path,
+            store.error == ALIN_STATE_MISMATCH ? " (belongs to another node)" : "");
+        memory_state.session_start = (int64_t)time(NULL);
+        return;
     }
-    return -1;
+
+    state = mapped;
+    if (state->session_start == 0) state->session_start = (int64_t)time(NULL);
+    alin_set_idle_hook(commit_state);
+    atexit(close_state);
 }
 
-int extract_string_field(const char* json, const char* field, char* value, size_t max_size) {
-    char pattern[256];
-    snprintf(pattern, sizeof(pattern), "\"%s\"", field);
-    
-    const char* pos = strstr(json, pattern);
-    if (!pos) return 0;
-    
-    pos += strlen(pattern);
-    while (*pos && (*pos == ':' || *pos == ' ' || *pos == '\t')) pos++;
-    
-    if (*pos == '"') {
-        pos++;
-        size_t i = 0;
-        while (*pos && *pos != '"' && i < max_size - 1) {
-            if (*pos == '\\' && *(pos + 1)) pos++;
-            value[i++] = *pos++;
+/**
+ * 以旧的文本格式打印状态文件 (agg_count --dump-state [路径])，运行中也可读取
+ */
+static int dump_state(const char* path) {
+    if (!path || path[0] == '\0') {
+        fprintf(stderr, "Usage: agg_count --dump-state <state file> (or set ALIN_STATE_FILE)\n");
+        return 1;
+    }
+    AggState snapshot;
+    if (wal_mode_enabled()) {
+        if (alin_wal_read(path, "agg_count", &snapshot, sizeof(snapshot), apply_delta) < 0) {
+            fprintf(stderr, "[AGG] No agg_count snapshot or write-ahead log at %s\n", path);
+            return 1;
         }
-        value[i] = '\0';
+    } else if (alin_state_read(path, "agg_count", &snapshot, sizeof(snapshot), NULL) != ALIN_STATE_OK) {
+        fprintf(stderr, "[AGG] %s is not an agg_count state file\n", path);
         return 1;
     }
+    int level_count = snapshot.level_count;
+    if (level_count > MAX_LEVELS) level_count = MAX_LEVELS;
+    printf("total=%ld\n", (long)snapshot.total_count);
+    printf("session_start=%ld\n", (long)snapshot.session_start);
+    for (int i = 0; i < level_count; i++) {
+        printf("level_%.63s=%ld\n", snapshot.levels[i].level, (long)snapshot.levels[i].count);
+    }
     return 0;
 }
 
-int read_stdin(char* buffer, size_t max_size) {
-    size_t total = 0;
-    int c;
-    while ((c = getchar()) != EOF && total < max_size - 1) {
-        buffer[total++] = (char)c;
+static int find_or_create_level(AggState* s, const char* level) {
+    int level_count = atomic_load_explicit(&s->level_count, memory_order_relaxed);
+    for (int i = 0; i < level_count; i++) {
+        if (strcasecmp(s->levels[i].level, level) == 0) {
+            return i;
+        }
     }
-    buffer[total] = '\0';
-    return (int)total;
-}
-
-void trim(char* str) {
-    char* start = str;
-    while (*start == ' ' || *start == '\n' || *start == '\r' || *start == '\t') start++;
-    if (*start == '\0') { str[0] = '\0'; return; }
-    char* end = start + strlen(start) - 1;
-    while (end > start && (*end == ' ' || *end == '\n' || *end == '\r' || *end == '\t')) end--;
-    size_t len = end - start + 1;
-    memmove(str, start, len);
-    str[len] = '\0';
+    if (level_count < MAX_LEVELS) {
+        strncpy(s->levels[level_count].level, level, 63);
+        atomic_store_explicit(&s->levels[level_count].count, 0, memory_order_relaxed);
+        atomic_store_explicit(&s->level_count, level_count + 1, memory_order_release);
+        return level_count;
+    }
+    return -1;
 }
 
-int main(int argc, char* argv[]) {
-    char input[MAX_INPUT_SIZE];
-    char output[MAX_INPUT_SIZE * 2];
+int process(const char* input, char* output, size_t output_size) {
+    static int loaded = 0;
     char level[64] = "UNKNOWN";
     
-    // 获取状态文件路径
-    const char* state_path = getenv("ALIN_STATE_FILE");
-    if (state_path && state_path[0] != '\0') {
-        strncpy(state_file, state_path, MAX_PATH - 1);
+    // 首条记录前映射一次状态文件，之后原地更新
+    if (!loaded) {
+        open_state();
+        loaded = 1;
     }
     
-    // 加载现有状态
-    load_state();
-    
-    if (read_stdin(input, MAX_INPUT_SIZE) <= 0) {
-        return 0;
-    }
-    
-    trim(input);
-    
-    if (input[0] == '\0') {
-        return 0;
+    // 提取 level (帧头已带级别时不扫描负载) 与权重
+    alin_json_t doc;
+    alin_input_index(&doc, input);
+    const char* known = alin_level_name(alin_input_meta()->level);
+    if (known) {
+        snprintf(level, sizeof(level), "%s", known);
+    } else {
+        alin_json_string(&doc, "level", level, sizeof(level));
     }
+    long weight = alin_json_long(&doc, "_weight");
+    if (weight < 1) weight = 1;
+    weight += alin_json_long(&doc, "_dup");
     
-    // 提取 level
-    extract_string_field(input, "level", level, sizeof(level));
-    
-    // 更新计数
-    state.total_count++;
-    int level_idx = find_or_create_level(level);
-    if (level_idx >= 0) {
-        state.levels[level_idx].count++;
+    // 更新计数: 直接写入映射 (按检查点策略同步)，WAL 模式下作用增量并追加到组缓冲
+    if (wal_mode) {
+        AggDelta d = { weight, (int64_t)time(NULL), "" };
+        size_t n = strnlen(level, sizeof(d.level) - 1);
+        memcpy(d.level, level, n);
+        alin_wal_update(&wal, &d, offsetof(AggDelta, level) + n);
+    } else {
+        alin_state_add(&state->total_count, weight);
+        int level_idx = find_or_create_level(state, level);
+        if (level_idx >= 0) {
+            alin_state_add(&state->levels[level_idx].count, weight);
+        }
+        alin_state_touch(&store);
     }
     
-    // 保存状态
-    save_state();
-    
     // 构建输出: 在原 JSON 基础上添加统计信息
     // 找到最后一个 }
     size_t len = strlen(input);
     if (len > 0 && input[len - 1] == '}') {
-        input[len - 1] = '\0';
-        
         // 构建 level 统计 JSON
         char level_stats[4096] = "{";
-        for (int i = 0; i < state.level_count; i++) {
+        int level_count = atomic_load_explicit(&state->level_count, memory_order_relaxed);
+        for (int i = 0; i < level_count; i++) {
             char entry[128];
             snprintf(entry, sizeof(entry), "%s\"%s\":%ld",
                 i > 0 ? "," : "",
-                state.levels[i].level,
-                state.levels[i].count);
+                state->levels[i].level,
+                (long)alin_state_load(&state->levels[i].count));
             strcat(level_stats, entry);
         }
         strcat(level_stats, "}");
         
-        long duration = (long)time(NULL) - state.session_start;
-        double rate = duration > 0 ? (double)state.total_count / duration : 0;
+        long total = (long)alin_state_load(&state->total_count);
+        long duration = (long)time(NULL) - (long)state->session_start;
+        double rate = duration > 0 ? (double)total / duration : 0;
+        
+        int n = snprintf(output, output_size,
+            "%.*s,\"_agg\":{\"total\":%ld,\"rate\":%.2f,\"by_level\":%s}}",
+            (int)(len - 1), input, total, rate, level_stats);
         
-        snprintf(output, sizeof(output),
-            "%s,\"_agg\":{\"total\":%ld,\"rate\":%.2f,\"by_level\":%s}}",
-            input, state.total_count, rate, level_stats);
+        // 输入带字段表时沿用其中的位置 (前缀不变)，只编入追加的 _agg
+        const alin_fields_t* fields = alin_input_meta()->fields;
+        alin_json_t out_doc;
+        if (fields && (size_t)n < output_size && alin_json_unpack(&out_doc, output, len - 1, fields) >= 0) {
+            alin_json_resume(&out_doc, output + len - 1);
+            alin_set_output_fields(&out_doc);
+        }
     } else {
-        strcpy(output, input);
+        snprintf(output, output_size, "%s", input);
     }
     
-    printf("%s\n", output);
-    
     return 0;
 }
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--dump-state") == 0) {
+        return dump_state(argc > 2 ? argv[2] : getenv("ALIN_STATE_FILE"));
+    }
+    return alin_node_main(argc, argv, process, 0);
+}
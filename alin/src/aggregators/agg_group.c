@@ -0,0 +1,507 @@
+/**
+ * ALIN 流处理节点: agg_group (多字段分组计数)
+ *
+ * 功能: 按 ALIN_GROUP_BY 列出的字段 (如 service,host) 分组累计事件数，分组可达数万个，内存有上限
+ * 输入: 标准化 ALIN 事件 {"_type":"log","service":"api","host":"web-3",...}
+ * 输出: 事件原样放行 (ALIN_GROUP_DROP=1 时丢弃)，另外追加分组结果记录 (alin_emit_extra):
+ *   {"_type":"agg","group":{"service":"api","host":"web-3"},"count":1234,"delta":56}
+ *   count 为累计数，delta 为上次输出以来的增量; 被淘汰的分组最后输出一次并带 "evicted":true
+ *
+ * 增量输出: 计数有变化的分组按变化先后排队; 距上一轮输出满 ALIN_GROUP_EMIT_MS (默认 1000) 后
+ *   开始新一轮，每条输入记录之后至多输出 ALIN_GROUP_EMIT_MAX 条 (默认 256，分摊到后续记录上)，
+ *   输入暂停时输出本轮其余的分组，输入结束时全部输出
+ *
+ * 分组表: 键为各字段原文拼成的 JSON 片段 ("service":"api","host":"web-3")，写入键池一次;
+ *   开放寻址 (线性探测) 的索引只存分组编号，先比较 64 位哈希再比较键，删除时后移后续项 (无墓碑)
+ * 内存上限: 分组至多 ALIN_GROUP_MAX 个 (默认 65536)，键池按每组 ALIN_GROUP_KEY_BYTES 字节
+ *   (默认 64) 计，启动时一次分配; 分组数或键池满时淘汰一个分组 (ALIN_GROUP_EVICT):
+ *   - lru (默认): 最久没有出现的分组 (双向链表，O(1))
+ *   - lfu: 随机抽样 8 个分组，淘汰其中计数最小的 (近似最不常见)
+ *   键池不够时先淘汰到可回收的空间达到键池的 1/16，再整体压缩回收
+ *
+ * 权重: 同 agg_count，事件带 _weight / _dup 时按权重计数
+ * 统计: 结束时输出事件数、分组数、淘汰数与键池压缩次数 ([GROUP])
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "alin_node.h"
+#include "alin_json.h"
+
+#define MAX_KEY_FIELDS 8
+#define MAX_FIELD_PATH 128
+#define MAX_KEY_LEN 1024         // 键的上限 (超出的事件不分组)
+#define LFU_SAMPLES 8
+#define NIL UINT32_MAX
+
+typedef struct {
+    uint64_t hash;
+    uint32_t key_off;            // 键在键池中的位置
+    uint32_t key_len;            // 0 表示空闲
+    int64_t count;               // 累计数 (按权重)
+    int64_t reported;            // 上次输出时的累计数
+    uint32_t lru_prev, lru_next; // LRU 链表 (空闲项经 lru_next 串成空闲链)
+    uint32_t dirty_prev, dirty_next;
+    int dirty;                   // 在待输出队列中
+} Group;
+
+// 配置
+static char key_fields[MAX_KEY_FIELDS][MAX_FIELD_PATH];
+static int key_field_count = 0;
+static uint32_t max_groups = 65536;
+static int evict_lfu = 0;
+static int64_t emit_interval_ns = 1000000000;
+static long emit_max = 256;
+static int drop_events = 0;
+
+// 分组表
+static Group* groups = NULL;
+static uint32_t group_count = 0;        // 使用中的分组数
+static uint32_t group_used = 0;         // groups[0..group_used) 分配过 (其中可能有空闲项)
+static uint32_t free_head = NIL;
+static uint32_t* slots = NULL;          // 索引: 分组编号 + 1，0 表示空
+static uint64_t slot_mask = 0;
+static char* key_pool = NULL;
+static size_t pool_size = 0;
+static size_t pool_used = 0;
+static size_t pool_dead = 0;            // 已淘汰分组留在键池中的字节
+static uint32_t lru_head = NIL, lru_tail = NIL;        // 头部为最近出现
+static uint32_t dirty_head = NIL, dirty_tail = NIL;
+static uint32_t dirty_count = 0;
+static uint64_t sample_state = 0x9e3779b97f4a7c15ull;
+
+// 增量输出
+static int64_t last_round_ns = 0;
+static uint32_t round_left = 0;         // 本轮还要输出的分组数 (0 表示不在一轮中)
+static char record_buf[MAX_KEY_LEN + 256];
+
+// 统计
+static long events = 0;
+static long evicted = 0;
+static long compactions = 0;
+static long oversized = 0;
+static long results = 0;
+static int configured = 0;
+
+// ===== 哈希 =====
+
+static inline uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * 按 8 字节一组累积 (不逐字节)，末尾不足 8 字节的部分补零
+ */
+static uint64_t hash_bytes(uint64_t h, const char* data, size_t len) {
+    const uint64_t k = 0x9fb21c651e98df25ull;
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, data, 8);
+        h = (h ^ w) * k;
+        h ^= h >> 29;
+        data += 8;
+        len -= 8;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data, len);
+    h = (h ^ tail ^ ((uint64_t)len << 56)) * k;
+    return h ^ (h >> 29);
+}
+
+static int64_t monotonic_ns() {
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// ===== 链表 =====
+
+static void lru_unlink(uint32_t id) {
+    Group* g = &groups[id];
+    if (g->lru_prev != NIL) groups[g->lru_prev].lru_next = g->lru_next;
+    else lru_head = g->lru_next;
+    if (g->lru_next != NIL) groups[g->lru_next].lru_prev = g->lru_prev;
+    else lru_tail = g->lru_prev;
+}
+
+static void lru_push_front(uint32_t id) {
+    Group* g = &groups[id];
+    g->lru_prev = NIL;
+    g->lru_next = lru_head;
+    if (lru_head != NIL) groups[lru_head].lru_prev = id;
+    else lru_tail = id;
+    lru_head = id;
+}
+
+static void dirty_unlink(uint32_t id) {
+    Group* g = &groups[id];
+    if (!g->dirty) return;
+    if (g->dirty_prev != NIL) groups[g->dirty_prev].dirty_next = g->dirty_next;
+    else dirty_head = g->dirty_next;
+    if (g->dirty_next != NIL) groups[g->dirty_next].dirty_prev = g->dirty_prev;
+    else dirty_tail = g->dirty_prev;
+    g->dirty = 0;
+    dirty_count--;
+}
+
+static void dirty_push_back(uint32_t id) {
+    Group* g = &groups[id];
+    if (g->dirty) return;
+    g->dirty = 1;
+    g->dirty_next = NIL;
+    g->dirty_prev = dirty_tail;
+    if (dirty_tail != NIL) groups[dirty_tail].dirty_next = id;
+    else dirty_head = id;
+    dirty_tail = id;
+    dirty_count++;
+}
+
+// ===== 输出 =====
+
+/**
+ * 追加一条分组结果记录，并移出待输出队列
+ */
+static void emit_group(uint32_t id, int is_evicted) {
+    Group* g = &groups[id];
+    int n = snprintf(record_buf, sizeof(record_buf),
+        "{\"_type\":\"agg\",\"group\":{%.*s},\"count\":%lld,\"delta\":%lld%s}",
+        (int)g->key_len, key_pool + g->key_off, (long long)g->count, (long long)(g->count - g->reported),
+        is_evicted ? ",\"evicted\":true" : "");
+    if (n > 0 && (size_t)n < sizeof(record_buf) && alin_emit_extra(record_buf, (size_t)n) == 0) results++;
+    g->reported = g->count;
+    dirty_unlink(id);
+    if (round_left > 0) round_left--;
+}
+
+/**
+ * 按输出节奏写出待输出的分组
+ * @param limit 本次至多输出的条数 (0 表示不限，输出本轮其余的分组)
+ */
+static void emit_due(long limit) {
+    if (round_left == 0) {
+        if (dirty_head == NIL || monotonic_ns() - last_round_ns < emit_interval_ns) return;
+        round_left = dirty_count;    // 本轮只输出此刻已有变化的分组，之后变化的留到下一轮
+    }
+    for (long n = 0; dirty_head != NIL && round_left > 0 && (limit == 0 || n < limit); n++) {
+        emit_group(dirty_head, 0);
+    }
+    if (round_left == 0 || dirty_head == NIL) {
+        round_left = 0;
+        last_round_ns = monotonic_ns();
+    }
+}
+
+/**
+ * 空闲回调: 输入暂停时输出本轮其余的分组，输入结束时输出全部有变化的分组
+ */
+static void on_idle(int final) {
+    if (configured <= 0) return;
+    if (final) {
+        while (dirty_head != NIL) emit_group(dirty_head, 0);
+        round_left = 0;
+        return;
+    }
+    emit_due(0);
+}
+
+// ===== 配置 =====
+
+static void report() {
+    if (events <= 1) return;    // 单次模式不汇总
+    fprintf(stderr, "[GROUP] events %ld, groups %u, evicted %ld, results %ld, compactions %ld, oversized keys %ld\n",
+        events, group_count, evicted, results, compactions, oversized);
+}
+
+/**
+ * 读取配置并一次分配分组表、索引与键池
+ * @return 0 成功, -1 失败
+ */
+static int configure() {
+    const char* fields = getenv("ALIN_GROUP_BY");
+    if (!fields || !fields[0]) fields = "service";
+    for (const char* p = fields; *p; ) {
+        const char* comma = strchr(p, ',');
+        size_t len = comma ? (size_t)(comma - p) : strlen(p);
+        if (len > 0) {
+            if (key_field_count >= MAX_KEY_FIELDS || len >= MAX_FIELD_PATH) {
+                fprintf(stderr, "[GROUP] Too many or too long group fields (at most %d of %d bytes)\n",
+                    MAX_KEY_FIELDS, MAX_FIELD_PATH - 1);
+                return -1;
+            }
+            if (memchr(p, '"', len) || memchr(p, '\\', len)) {
+                fprintf(stderr, "[GROUP] Invalid group field: %.*s\n", (int)len, p);
+                return -1;
+            }
+            memcpy(key_fields[key_field_count], p, len);
+            key_fields[key_field_count++][len] = '\0';
+        }
+        p += len + (comma ? 1 : 0);
+    }
+    if (key_field_count == 0) {
+        fprintf(stderr, "[GROUP] ALIN_GROUP_BY lists no fields\n");
+        return -1;
+    }
+
+    const char* env = getenv("ALIN_GROUP_MAX");
+    if (env && atol(env) > 0) max_groups = (uint32_t)atol(env);
+    env = getenv("ALIN_GROUP_EVICT");
+    evict_lfu = env && strcmp(env, "lfu") == 0;
+    env = getenv("ALIN_GROUP_EMIT_MS");
+    if (env && env[0]) emit_interval_ns = (int64_t)atol(env) * 1000000;
+    env = getenv("ALIN_GROUP_EMIT_MAX");
+    if (env && atol(env) > 0) emit_max = atol(env);
+    env = getenv("ALIN_GROUP_DROP");
+    drop_events = env && env[0] && strcmp(env, "0") != 0;
+    env = getenv("ALIN_GROUP_KEY_BYTES");
+    size_t key_bytes = env && atol(env) > 0 ? (size_t)atol(env) : 64;
+
+    // 索引至少为分组数的 2 倍 (装载率不超过 50%)
+    uint64_t slot_count = 16;
+    while (slot_count < (uint64_t)max_groups * 2) slot_count <<= 1;
+    pool_size = (size_t)max_groups * key_bytes;
+    if (pool_size < MAX_KEY_LEN) pool_size = MAX_KEY_LEN;
+    groups = malloc(sizeof(Group) * max_groups);
+    slots = calloc(slot_count, sizeof(uint32_t));
+    key_pool = malloc(pool_size);
+    if (!groups || !slots || !key_pool) {
+        fprintf(stderr, "[GROUP] Cannot allocate %u groups\n", max_groups);
+        return -1;
+    }
+    slot_mask = slot_count - 1;
+    last_round_ns = monotonic_ns();
+    // 宿主进程中不经过 main，回调在这里注册
+    alin_set_idle_hook(on_idle);
+    atexit(report);
+
+    size_t total = sizeof(Group) * max_groups + slot_count * sizeof(uint32_t) + pool_size;
+    fprintf(stderr, "[GROUP] Up to %u groups by %s (%s), %zu KB\n",
+        max_groups, fields, evict_lfu ? "lfu" : "lru", total / 1024);
+    return 0;
+}
+
+// ===== 分组表 =====
+
+/**
+ * 查找键
+ * @param pos 找到时为所在的索引位置，找不到时为可插入的空位
+ * @return 分组编号, NIL 表示不存在
+ */
+static uint32_t lookup(uint64_t hash, const char* key, uint32_t len, uint64_t* pos) {
+    uint64_t i = hash & slot_mask;
+    while (slots[i] != 0) {
+        uint32_t id = slots[i] - 1;
+        const Group* g = &groups[id];
+        if (g->hash == hash && g->key_len == len && memcmp(key_pool + g->key_off, key, len) == 0) {
+            *pos = i;
+            return id;
+        }
+        i = (i + 1) & slot_mask;
+    }
+    *pos = i;
+    return NIL;
+}
+
+/**
+ * 从索引中删除分组: 其后同一探测段中的项前移补位 (不留墓碑)
+ */
+static void index_remove(uint32_t id) {
+    uint64_t i = groups[id].hash & slot_mask;
+    while (slots[i] != id + 1) i = (i + 1) & slot_mask;
+    for (;;) {
+        slots[i] = 0;
+        uint64_t j = i;
+        for (;;) {
+            j = (j + 1) & slot_mask;
+            if (slots[j] == 0) return;
+            uint64_t home = groups[slots[j] - 1].hash & slot_mask;
+            // home 不在 (i, j] 之间 (按环形计) 时，该项可以移到空位 i
+            int between = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+            if (!between) break;
+        }
+        slots[i] = slots[j];
+        i = j;
+    }
+}
+
+static uint32_t pick_victim() {
+    if (!evict_lfu) return lru_tail;
+    uint32_t victim = NIL;
+    for (int tries = 0, found = 0; found < LFU_SAMPLES && tries < LFU_SAMPLES * 4; tries++) {
+        sample_state = mix64(sample_state);
+        uint32_t id = (uint32_t)(sample_state % group_used);
+        if (groups[id].key_len == 0) continue;
+        found++;
+        if (victim == NIL || groups[id].count < groups[victim].count) victim = id;
+    }
+    return victim != NIL ? victim : lru_tail;
+}
+
+/**
+ * 淘汰一个分组: 尚未输出的增量先作为最后一条结果写出
+ */
+static void evict_one() {
+    uint32_t id = pick_victim();
+    if (id == NIL) return;
+    Group* g = &groups[id];
+    if (g->count != g->reported) emit_group(id, 1);
+    else dirty_unlink(id);
+    index_remove(id);
+    lru_unlink(id);
+    pool_dead += g->key_len;
+    g->key_len = 0;
+    g->lru_next = free_head;
+    free_head = id;
+    group_count--;
+    evicted++;
+}
+
+static int compare_key_off(const void* a, const void* b) {
+    uint32_t x = groups[*(const uint32_t*)a].key_off;
+    uint32_t y = groups[*(const uint32_t*)b].key_off;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * 压缩键池: 按位置顺序把仍在使用的键前移，回收被淘汰分组留下的空间
+ */
+static void compact_pool() {
+    uint32_t* order = malloc(sizeof(uint32_t) * (group_count ? group_count : 1));
+    if (!order) return;
+    uint32_t n = 0;
+    for (uint32_t id = 0; id < group_used; id++) {
+        if (groups[id].key_len != 0) order[n++] = id;
+    }
+    qsort(order, n, sizeof(uint32_t), compare_key_off);
+    size_t used = 0;
+    for (uint32_t k = 0; k < n; k++) {
+        Group* g = &groups[order[k]];
+        if (g->key_off != used) memmove(key_pool + used, key_pool + g->key_off, g->key_len);
+        g->key_off = (uint32_t)used;
+        used += g->key_len;
+    }
+    free(order);
+    pool_used = used;
+    pool_dead = 0;
+    compactions++;
+}
+
+/**
+ * 插入新分组 (分组数或键池满时先淘汰)
+ * @return 分组编号
+ */
+static uint32_t insert(uint64_t hash, const char* key, uint32_t len) {
+    if (group_count >= max_groups) evict_one();
+    // 键池满: 先淘汰到可回收的空间至少为键池的 1/16 再压缩，使压缩的代价分摊到后续的插入上
+    while (pool_used + len > pool_size) {
+        if (pool_dead < pool_size / 16 && group_count > 0) evict_one();
+        else compact_pool();
+    }
+
+    uint32_t id;
+    if (free_head != NIL) {
+        id = free_head;
+        free_head = groups[id].lru_next;
+    } else {
+        id = group_used++;
+    }
+    Group* g = &groups[id];
+    memset(g, 0, sizeof(*g));
+    g->hash = hash;
+    g->key_off = (uint32_t)pool_used;
+    g->key_len = len;
+    memcpy(key_pool + pool_used, key, len);
+    pool_used += len;
+
+    // 淘汰可能移动了索引中的项，插入位置重新探测
+    uint64_t pos;
+    lookup(hash, key, len, &pos);
+    slots[pos] = id + 1;
+    lru_push_front(id);
+    group_count++;
+    return id;
+}
+
+// ===== 处理 =====
+
+/**
+ * 各分组字段的原文拼成键: "service":"api","host":"web-3" (缺失的字段为 null)
+ * @return 键长, -1 表示超过 MAX_KEY_LEN
+ */
+static int build_key(const alin_json_t* doc, char* key) {
+    size_t len = 0;
+    for (int i = 0; i < key_field_count; i++) {
+        const alin_json_field_t* f = alin_json_find(doc, key_fields[i]);
+        const char* value = f ? f->value : "null";
+        size_t value_len = f ? f->value_len : 4;
+        int quoted = f && f->type == ALIN_JSON_STRING;
+        size_t name_len = strlen(key_fields[i]);
+        if (len + name_len + value_len + 6 > MAX_KEY_LEN) return -1;
+        if (i > 0) key[len++] = ',';
+        key[len++] = '"';
+        memcpy(key + len, key_fields[i], name_len);
+        len += name_len;
+        key[len++] = '"';
+        key[len++] = ':';
+        if (quoted) key[len++] = '"';
+        memcpy(key + len, value, value_len);
+        len += value_len;
+        if (quoted) key[len++] = '"';
+    }
+    return (int)len;
+}
+
+int process(const char* input, char* output, size_t output_size) {
+    if (configured == 0) configured = configure() == 0 ? 1 : -1;
+    if (configured < 0) return -1;
+
+    alin_json_t doc;
+    alin_input_index(&doc, input);
+    char* key = alin_arena_alloc(alin_record_arena(), MAX_KEY_LEN);
+    int len = key ? build_key(&doc, key) : -1;
+    events++;
+    if (len < 0) {
+        oversized++;
+    } else {
+        long weight = alin_json_long(&doc, "_weight");
+        if (weight < 1) weight = 1;
+        weight += alin_json_long(&doc, "_dup");
+
+        uint64_t hash = mix64(hash_bytes(0x243f6a8885a308d3ull, key, (size_t)len));
+        uint64_t pos;
+        uint32_t id = lookup(hash, key, (uint32_t)len, &pos);
+        if (id == NIL) {
+            id = insert(hash, key, (uint32_t)len);
+        } else if (id != lru_head) {
+            lru_unlink(id);
+            lru_push_front(id);
+        }
+        groups[id].count += weight;
+        dirty_push_back(id);
+    }
+    emit_due(emit_max);
+
+    if (drop_events) {
+        output[0] = '\0';
+        return 0;
+    }
+    return ALIN_PASS;
+}
+
+int main(int argc, char* argv[]) {
+    configured = configure() == 0 ? 1 : -1;
+    if (configured < 0) return 1;
+    return alin_node_main(argc, argv, process, 0);
+}
@@ -0,0 +1,897 @@
+/**
+ * ALIN 流处理节点: agg_sketch (去重计数与分位数概要)
+ *
+ * 功能: 按 ALIN_SKETCH_BY 列出的字段分组 (默认 service)，每组维护
+ *   - HyperLogLog: ALIN_SKETCH_DISTINCT 字段 (默认 user_id) 的不同取值数，2^12 个寄存器，标准误差约 1.6%
+ *   - DDSketch: ALIN_SKETCH_VALUE 数值字段 (默认 latency_ms) 的分位数，相对误差不超过 1/64
+ *   每组占用固定内存，与事件数和取值的基数无关
+ * 输入: 标准化 ALIN 事件 {"_type":"log","service":"api","user_id":"u42","latency_ms":12.5,...}
+ * 输出: 事件原样放行 (ALIN_SKETCH_DROP=1 时丢弃); 每隔 ALIN_SKETCH_EMIT_MS (默认 1000) 及输入结束时，
+ *   有变化的分组追加一条结果记录 (alin_emit_extra):
+ *   {"_type":"sketch","group":{"service":"api"},"count":1200,"distinct":87,
+ *    "value":{"count":1150,"min":0.4,"max":930,"mean":41.2,"p50":20.1,"p90":88,"p99":402,"p999":870},
+ *    "_agg":{"sketch":"<base64>"}}
+ *   count / distinct / value 为累计值; _agg.sketch 为上次输出以来的增量概要 (HLL 为全部寄存器)
+ *
+ * 合并: 输入中的 "_type":"sketch" 记录不计为事件，其 _agg.sketch 并入同名分组
+ *   (HLL 逐寄存器取最大值，DDSketch 各桶相加)，多个实例的输出汇入下游的一个 agg_sketch 即得到全局概要;
+ *   因为输出的是增量，同一概要不会被重复计入
+ * 状态: 各组概要保存在映射的状态文件中 (alin_state，ALIN_SKETCH_STATE，默认为 ALIN_STATE_FILE
+ *   所在目录下的 agg_sketch.state)，重启后接着累计，尚未输出的增量在下次输出;
+ *   agg_sketch --merge-state <目标> <来源>... 把多个实例的状态文件合并为一个,
+ *   agg_sketch --dump-state [路径] 以结果记录的形式打印各组 (运行中也可读取)
+ *
+ * DDSketch 的桶: 值的浮点指数与尾数高 5 位拼成桶号 (每个 2 倍区间 32 个桶，取桶中点，相对误差 ≤ 1/64)，
+ *   每组 1024 个桶覆盖 32 个 2 倍区间; 超出时合并最低的桶 (保住高分位数)，值 ≤ 0 单独计数
+ * 分组: 至多 ALIN_SKETCH_GROUPS 个 (默认 256)，之后的新分组计入 {"_other":true}
+ * 权重: 同 agg_count，事件带 _weight / _dup 时按权重计数
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include <time.h>
+
+#include "alin_node.h"
+#include "alin_json.h"
+#include "alin_state.h"
+
+#define SKETCH_STATE_VERSION 1
+#define HLL_BITS 12
+#define HLL_REGISTERS (1 << HLL_BITS)
+#define DD_SUB_BITS 5
+#define DD_BINS 1024
+#define MAX_KEY_FIELDS 8
+#define MAX_FIELD_PATH 128
+#define MAX_GROUP_KEY 128
+#define OTHER_KEY "\"_other\":true"
+#define SKETCH_MAGIC 0x314b5341u          // "ASK1"
+#define MAX_SKETCH_BYTES (64 + HLL_REGISTERS + 8 + DD_BINS * 10)
+
+// 一个分组的概要 (状态文件中的布局，只在末尾追加字段)
+typedef struct {
+    char key[MAX_GROUP_KEY];     // 分组键 ("service":"api")
+    uint32_t key_len;
+    int32_t dd_offset;           // bins[0] 对应的桶号
+    int32_t dd_used;             // 桶窗口已确定 (有过正值)
+    int32_t reserved;
+    int64_t count;               // 事件数 (按权重)
+    int64_t value_count;         // 带数值的事件数 (含 zero_count)
+    int64_t zero_count;          // 值 ≤ 0 的事件数
+    double value_sum;
+    double value_min;
+    double value_max;
+    // 上次输出时的累计值 (输出增量用)
+    int64_t reported_count;
+    int64_t reported_value_count;
+    int64_t reported_zero;
+    double reported_sum;
+    uint8_t hll[HLL_REGISTERS];
+    int64_t bins[DD_BINS];
+    int64_t reported_bins[DD_BINS];
+} SketchGroup;
+
+typedef struct {
+    uint32_t hll_bits;           // 概要参数，与本程序不同的状态文件拒绝使用
+    uint32_t dd_sub_bits;
+    uint32_t dd_bins;
+    int32_t group_count;
+    int64_t reserved[2];
+    SketchGroup groups[];
+} SketchState;
+
+// 配置
+static char key_fields[MAX_KEY_FIELDS][MAX_FIELD_PATH];
+static int key_field_count = 0;
+static char distinct_field[MAX_FIELD_PATH] = "user_id";
+static char value_field[MAX_FIELD_PATH] = "latency_ms";
+static int32_t group_capacity = 256;
+static int64_t emit_interval_ns = 1000000000;
+static int drop_events = 0;
+
+// 状态
+static alin_state_t store;
+static SketchState* state = NULL;
+static uint32_t* slots = NULL;          // 分组索引: 编号 + 1，0 表示空
+static uint32_t slot_mask = 0;
+static int64_t last_emit_ns = 0;
+
+// 统计
+static long events = 0;
+static long merged = 0;
+static long results = 0;
+static long rejected = 0;
+static int configured = 0;
+
+static char record_buf[ALIN_MAX_RECORD];
+static uint8_t sketch_buf[MAX_SKETCH_BYTES];
+
+// ===== 数值工具 =====
+
+static inline uint64_t double_bits(double v) {
+    uint64_t bits;
+    memcpy(&bits, &v, 8);
+    return bits;
+}
+
+static inline double bits_double(uint64_t bits) {
+    double v;
+    memcpy(&v, &bits, 8);
+    return v;
+}
+
+static inline uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * 按 8 字节一组累积 (不逐字节)，末尾不足 8 字节的部分补零
+ */
+static uint64_t hash_bytes(uint64_t h, const char* data, size_t len) {
+    const uint64_t k = 0x9fb21c651e98df25ull;
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, data, 8);
+        h = (h ^ w) * k;
+        h ^= h >> 29;
+        data += 8;
+        len -= 8;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data, len);
+    h = (h ^ tail ^ ((uint64_t)len << 56)) * k;
+    return h ^ (h >> 29);
+}
+
+static int64_t monotonic_ns() {
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// ===== HyperLogLog =====
+
+static void hll_add(SketchGroup* g, const char* value, size_t len) {
+    uint64_t h = mix64(hash_bytes(0x452821e638d01377ull, value, len));
+    uint32_t index = (uint32_t)(h >> (64 - HLL_BITS));
+    uint64_t rest = (h << HLL_BITS) | (1ull << (HLL_BITS - 1));    // 保证 rank 不超过 64 - HLL_BITS + 1
+    uint8_t rank = (uint8_t)(__builtin_clzll(rest) + 1);
+    if (rank > g->hll[index]) g->hll[index] = rank;
+}
+
+/**
+ * 基数估计: 调和平均 α·m²/Σ2^-M，估计值较小且有空寄存器时改用线性计数 m·ln(m/V)
+ */
+static double hll_estimate(const SketchGroup* g) {
+    double sum = 0;
+    int zeros = 0;
+    for (int i = 0; i < HLL_REGISTERS; i++) {
+        sum += bits_double((uint64_t)(1023 - g->hll[i]) << 52);      // 2^-M
+        if (g->hll[i] == 0) zeros++;
+    }
+    double m = HLL_REGISTERS;
+    double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    if (estimate <= 2.5 * m && zeros > 0) estimate = m * log(m / zeros);
+    return estimate;
+}
+
+// ===== DDSketch =====
+
+static inline int32_t dd_index(double v) {
+    return (int32_t)(double_bits(v) >> (52 - DD_SUB_BITS));
+}
+
+/**
+ * 桶的代表值: 桶上下界的中点
+ */
+static inline double dd_value(int32_t index) {
+    double lower = bits_double((uint64_t)index << (52 - DD_SUB_BITS));
+    double upper = bits_double((uint64_t)(index + 1) << (52 - DD_SUB_BITS));
+    return (lower + upper) / 2;
+}
+
+/**
+ * 桶窗口上移 shift 格: 移出窗口的低位桶合并到新的最低桶 (bins 与 reported_bins 同样处理)
+ */
+static void dd_shift_up(SketchGroup* g, int32_t shift) {
+    int64_t* arrays[2] = { g->bins, g->reported_bins };
+    for (int a = 0; a < 2; a++) {
+        int64_t* bins = arrays[a];
+        int64_t low = 0;
+        int32_t moved = shift < DD_BINS ? shift : DD_BINS;
+        for (int32_t i = 0; i < moved; i++) low += bins[i];
+        if (shift < DD_BINS) {
+            memmove(bins, bins + shift, sizeof(int64_t) * (size_t)(DD_BINS - shift));
+            memset(bins + DD_BINS - shift, 0, sizeof(int64_t) * (size_t)shift);
+        } else {
+            memset(bins, 0, sizeof(int64_t) * DD_BINS);
+        }
+        bins[0] += low;
+    }
+    g->dd_offset += shift;
+}
+
+/**
+ * 把 weight 计入桶号 index (超出窗口时移动窗口或合并到最低桶)
+ */
+static void dd_add(SketchGroup* g, int32_t index, int64_t weight) {
+    if (!g->dd_used) {
+        // 第一个正值: 窗口以该桶为中心
+        g->dd_offset = index - DD_BINS / 2;
+        g->dd_used = 1;
+    }
+    if (index >= g->dd_offset + DD_BINS) {
+        dd_shift_up(g, index - (g->dd_offset + DD_BINS - 1));
+    } else if (index < g->dd_offset) {
+        int32_t top = DD_BINS - 1;
+        while (top > 0 && g->bins[top] == 0 && g->reported_bins[top] == 0) top--;
+        int32_t shift = g->dd_offset - index;
+        if (top + shift < DD_BINS) {
+            // 高位有空余: 窗口下移
+            memmove(g->bins + shift, g->bins, sizeof(int64_t) * (size_t)(DD_BINS - shift));
+            memset(g->bins, 0, sizeof(int64_t) * (size_t)shift);
+            memmove(g->reported_bins + shift, g->reported_bins, sizeof(int64_t) * (size_t)(DD_BINS - shift));
+            memset(g->reported_bins, 0, sizeof(int64_t) * (size_t)shift);
+            g->dd_offset = index;
+        } else {
+            index = g->dd_offset;
+        }
+    }
+    g->bins[index - g->dd_offset] += weight;
+}
+
+static void add_value(SketchGroup* g, double v, int64_t weight) {
+    if (g->value_count == 0 || v < g->value_min) g->value_min = v;
+    if (g->value_count == 0 || v > g->value_max) g->value_max = v;
+    if (v > 0) dd_add(g, dd_index(v), weight);
+    else g->zero_count += weight;
+    g->value_count += weight;
+    g->value_sum += v * weight;
+}
+
+static double dd_quantile(const SketchGroup* g, double q) {
+    if (g->value_count == 0) return 0;
+    int64_t rank = (int64_t)(q * (double)(g->value_count - 1));
+    double v = g->value_max;
+    if (rank < g->zero_count) {
+        v = g->value_min < 0 ? g->value_min : 0;
+    } else {
+        int64_t seen = g->zero_count;
+        for (int32_t i = 0; i < DD_BINS; i++) {
+            seen += g->bins[i];
+            if (seen > rank) {
+                v = dd_value(g->dd_offset + i);
+                break;
+            }
+        }
+    }
+    if (v < g->value_min) v = g->value_min;
+    if (v > g->value_max) v = g->value_max;
+    return v;
+}
+
+// ===== 序列化 =====
+
+static const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static size_t base64_encode(const uint8_t* in, size_t len, char* out) {
+    size_t n = 0;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)in[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)in[i + 1] << 8;
+        if (i + 2 < len) v |= in[i + 2];
+        out[n++] = base64_chars[(v >> 18) & 63];
+        out[n++] = base64_chars[(v >> 12) & 63];
+        out[n++] = i + 1 < len ? base64_chars[(v >> 6) & 63] : '=';
+        out[n++] = i + 2 < len ? base64_chars[v & 63] : '=';
+    }
+    return n;
+}
+
+/**
+ * 解码 (跳过 JSON 转义的反斜杠)
+ * @return 字节数, -1 表示格式错误或超过 cap
+ */
+static long base64_decode(const char* in, size_t len, uint8_t* out, size_t cap) {
+    uint32_t v = 0;
+    int bits = 0;
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = in[i];
+        int d;
+        if (c >= 'A' && c <= 'Z') d = c - 'A';
+        else if (c >= 'a' && c <= 'z') d = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') d = c - '0' + 52;
+        else if (c == '+') d = 62;
+        else if (c == '/') d = 63;
+        else if (c == '=' || c == '\\') continue;
+        else return -1;
+        v = (v << 6) | (uint32_t)d;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            if (n >= cap) return -1;
+            out[n++] = (uint8_t)(v >> bits);
+        }
+    }
+    return (long)n;
+}
+
+static inline size_t put_varint(uint8_t* out, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+static inline int get_varint(const uint8_t** p, const uint8_t* end, uint64_t* v) {
+    *v = 0;
+    for (int shift = 0; *p < end && shift < 64; shift += 7) {
+        uint8_t b = *(*p)++;
+        *v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return 0;
+    }
+    return -1;
+}
+
+/**
+ * 增量概要的二进制形式 (小端):
+ *   [magic u32][hll_bits u8][dd_sub_bits u8][hll 编码 u8][保留 u8]
+ *   [count i64][value_count i64][zero_count i64][sum f64][min f64][max f64]
+ *   HLL: 稀疏时 [n u16] + n × [寄存器号 u16][值 u8]，否则 4096 个寄存器原样
+ *   DDSketch: [首个桶号 i32][桶数 u16] + 各桶计数 (varint)
+ * @return 字节数
+ */
+static size_t encode_delta(const SketchGroup* g, uint8_t* out) {
+    size_t n = 0;
+    int nonzero = 0;
+    for (int i = 0; i < HLL_REGISTERS; i++) nonzero += g->hll[i] != 0;
+    int sparse = nonzero * 3 < HLL_REGISTERS;
+
+    uint32_t magic = SKETCH_MAGIC;
+    memcpy(out, &magic, 4);
+    out[4] = HLL_BITS;
+    out[5] = DD_SUB_BITS;
+    out[6] = (uint8_t)sparse;
+    out[7] = 0;
+    n = 8;
+    int64_t ints[3] = { g->count - g->reported_count, g->value_count - g->reported_value_count,
+                        g->zero_count - g->reported_zero };
+    double reals[3] = { g->value_sum - g->reported_sum, g->value_min, g->value_max };
+    memcpy(out + n, ints, sizeof(ints));
+    n += sizeof(ints);
+    memcpy(out + n, reals, sizeof(reals));
+    n += sizeof(reals);
+
+    if (sparse) {
+        uint16_t count = (uint16_t)nonzero;
+        memcpy(out + n, &count, 2);
+        n += 2;
+        for (uint16_t i = 0; i < HLL_REGISTERS; i++) {
+            if (g->hll[i] == 0) continue;
+            memcpy(out + n, &i, 2);
+            out[n + 2] = g->hll[i];
+            n += 3;
+        }
+    } else {
+        memcpy(out + n, g->hll, HLL_REGISTERS);
+        n += HLL_REGISTERS;
+    }
+
+    int32_t lo = 0, hi = -1;
+    for (int32_t i = 0; i < DD_BINS; i++) {
+        if (g->bins[i] == g->reported_bins[i]) continue;
+        if (hi < 0) lo = i;
+        hi = i;
+    }
+    int32_t first = g->dd_offset + lo;
+    uint16_t span = (uint16_t)(hi - lo + 1);
+    memcpy(out + n, &first, 4);
+    memcpy(out + n + 4, &span, 2);
+    n += 6;
+    for (int32_t i = lo; i <= hi; i++) n += put_varint(out + n, (uint64_t)(g->bins[i] - g->reported_bins[i]));
+    return n;
+}
+
+/**
+ * 把二进制增量概要并入分组
+ * @return 0 成功, -1 格式错误或参数不符
+ */
+static int merge_delta(SketchGroup* g, const uint8_t* data, size_t len) {
+    const uint8_t* end = data + len;
+    uint32_t magic;
+    if (len < 8 + 48 + 2) return -1;
+    memcpy(&magic, data, 4);
+    if (magic != SKETCH_MAGIC || data[4] != HLL_BITS || data[5] != DD_SUB_BITS) return -1;
+    int sparse = data[6];
+    int64_t ints[3];
+    double reals[3];
+    memcpy(ints, data + 8, sizeof(ints));
+    memcpy(reals, data + 32, sizeof(reals));
+    const uint8_t* p = data + 56;
+
+    uint8_t hll[HLL_REGISTERS];
+    if (sparse) {
+        uint16_t count;
+        memcpy(&count, p, 2);
+        p += 2;
+        if ((size_t)(end - p) < (size_t)count * 3) return -1;
+        memset(hll, 0, sizeof(hll));
+        for (uint16_t k = 0; k < count; k++, p += 3) {
+            uint16_t i;
+            memcpy(&i, p, 2);
+            if (i >= HLL_REGISTERS) return -1;
+            hll[i] = p[2];
+        }
+    } else {
+        if ((size_t)(end - p) < HLL_REGISTERS) return -1;
+        memcpy(hll, p, HLL_REGISTERS);
+        p += HLL_REGISTERS;
+    }
+    int32_t first;
+    uint16_t span;
+    if (end - p < 6) return -1;
+    memcpy(&first, p, 4);
+    memcpy(&span, p + 4, 2);
+    p += 6;
+    // 先完整校验，再修改分组
+    const uint8_t* bins_start = p;
+    for (uint16_t k = 0; k < span; k++) {
+        uint64_t v;
+        if (get_varint(&p, end, &v) < 0) return -1;
+    }
+
+    for (int i = 0; i < HLL_REGISTERS; i++) {
+        if (hll[i] > g->hll[i]) g->hll[i] = hll[i];
+    }
+    p = bins_start;
+    for (uint16_t k = 0; k < span; k++) {
+        uint64_t v;
+        get_varint(&p, end, &v);
+        if (v != 0) dd_add(g, first + k, (int64_t)v);
+    }
+    if (ints[1] > 0) {
+        if (g->value_count == 0 || reals[1] < g->value_min) g->value_min = reals[1];
+        if (g->value_count == 0 || reals[2] > g->value_max) g->value_max = reals[2];
+    }
+    g->count += ints[0];
+    g->value_count += ints[1];
+    g->zero_count += ints[2];
+    g->value_sum += reals[0];
+    return 0;
+}
+
+// ===== 分组 =====
+
+static void configure_fields() {
+    const char* fields = getenv("ALIN_SKETCH_BY");
+    if (!fields) fields = "service";
+    for (const char* p = fields; *p; ) {
+        const char* comma = strchr(p, ',');
+        size_t len = comma ? (size_t)(comma - p) : strlen(p);
+        if (len > 0 && len < MAX_FIELD_PATH && key_field_count < MAX_KEY_FIELDS &&
+            !memchr(p, '"', len) && !memchr(p, '\\', len)) {
+            memcpy(key_fields[key_field_count], p, len);
+            key_fields[key_field_count++][len] = '\0';
+        } else if (len > 0) {
+            fprintf(stderr, "[SKETCH] Ignoring group field: %.*s\n", (int)len, p);
+        }
+        p += len + (comma ? 1 : 0);
+    }
+    const char* env = getenv("ALIN_SKETCH_DISTINCT");
+    if (env) snprintf(distinct_field, sizeof(distinct_field), "%s", env);
+    env = getenv("ALIN_SKETCH_VALUE");
+    if (env) snprintf(value_field, sizeof(value_field), "%s", env);
+}
+
+static size_t state_size(int32_t capacity) {
+    return offsetof(SketchState, groups) + (size_t)capacity * sizeof(SketchGroup);
+}
+
+static int32_t state_capacity(size_t body_size) {
+    if (body_size < offsetof(SketchState, groups)) return 0;
+    return (int32_t)((body_size - offsetof(SketchState, groups)) / sizeof(SketchGroup));
+}
+
+static int state_compatible(const SketchState* s) {
+    return s->hll_bits == HLL_BITS && s->dd_sub_bits == DD_SUB_BITS && s->dd_bins == DD_BINS;
+}
+
+static uint64_t key_hash(const char* key, size_t len) {
+    return mix64(hash_bytes(0x243f6a8885a308d3ull, key, len));
+}
+
+/**
+ * 为 state 中已有的分组建立索引
+ * @return 0 成功, -1 内存不足
+ */
+static int build_index() {
+    uint32_t slot_count = 16;
+    while (slot_count < (uint32_t)group_capacity * 2) slot_count <<= 1;
+    free(slots);
+    slots = calloc(slot_count, sizeof(uint32_t));
+    if (!slots) return -1;
+    slot_mask = slot_count - 1;
+    for (int32_t id = 0; id < state->group_count; id++) {
+        const SketchGroup* g = &state->groups[id];
+        uint32_t i = (uint32_t)key_hash(g->key, g->key_len) & slot_mask;
+        while (slots[i] != 0) i = (i + 1) & slot_mask;
+        slots[i] = (uint32_t)id + 1;
+    }
+    return 0;
+}
+
+/**
+ * 查找或创建分组; 分组数已满 (留出最后一个给 _other) 或键过长时计入 _other
+ */
+static SketchGroup* find_group(const char* key, size_t len) {
+    if (len >= MAX_GROUP_KEY) {
+        key = OTHER_KEY;
+        len = strlen(OTHER_KEY);
+    }
+    for (;;) {
+        uint32_t i = (uint32_t)key_hash(key, len) & slot_mask;
+        while (slots[i] != 0) {
+            SketchGroup* g = &state->groups[slots[i] - 1];
+            if (g->key_len == len && memcmp(g->key, key, len) == 0) return g;
+            i = (i + 1) & slot_mask;
+        }
+        int is_other = len == strlen(OTHER_KEY) && memcmp(key, OTHER_KEY, len) == 0;
+        if (state->group_count < group_capacity - 1 || (is_other && state->group_count < group_capacity)) {
+            SketchGroup* g = &state->groups[state->group_count];
+            memset(g, 0, sizeof(*g));
+            memcpy(g->key, key, len);
+            g->key_len = (uint32_t)len;
+            slots[i] = (uint32_t)state->group_count + 1;
+            state->group_count++;
+            return g;
+        }
+        key = OTHER_KEY;
+        len = strlen(OTHER_KEY);
+    }
+}
+
+/**
+ * 各分组字段的原文拼成键: "service":"api","host":"web-3" (缺失的字段为 null)
+ * @return 键长, -1 表示过长
+ */
+static int build_key(const alin_json_t* doc, char* key) {
+    size_t len = 0;
+    for (int i = 0; i < key_field_count; i++) {
+        const alin_json_field_t* f = alin_json_find(doc, key_fields[i]);
+        const char* value = f ? f->value : "null";
+        size_t value_len = f ? f->value_len : 4;
+        int quoted = f && f->type == ALIN_JSON_STRING;
+        size_t name_len = strlen(key_fields[i]);
+        if (len + name_len + value_len + 6 >= MAX_GROUP_KEY) return -1;
+        if (i > 0) key[len++] = ',';
+        key[len++] = '"';
+        memcpy(key + len, key_fields[i], name_len);
+        len += name_len;
+        key[len++] = '"';
+        key[len++] = ':';
+        if (quoted) key[len++] = '"';
+        memcpy(key + len, value, value_len);
+        len += value_len;
+        if (quoted) key[len++] = '"';
+    }
+    return (int)len;
+}
+
+// ===== 输出 =====
+
+/**
+ * 分组的结果记录 (with_delta 时附带 _agg.sketch)
+ * @return 记录长度, -1 表示放不下
+ */
+static int format_group(const SketchGroup* g, int with_delta, char* out, size_t size) {
+    double mean = g->value_count > 0 ? g->value_sum / g->value_count : 0;
+    int n = snprintf(out, size,
+        "{\"_type\":\"sketch\",\"group\":{%.*s},\"count\":%lld,\"distinct\":%.0f,"
+        "\"value\":{\"count\":%lld,\"min\":%.6g,\"max\":%.6g,\"mean\":%.6g,"
+        "\"p50\":%.6g,\"p90\":%.6g,\"p99\":%.6g,\"p999\":%.6g}",
+        (int)g->key_len, g->key, (long long)g->count, hll_estimate(g),
+        (long long)g->value_count, g->value_min, g->value_max, mean,
+        dd_quantile(g, 0.5), dd_quantile(g, 0.9), dd_quantile(g, 0.99), dd_quantile(g, 0.999));
+    if (n < 0 || (size_t)n >= size) return -1;
+    if (with_delta) {
+        size_t bytes = encode_delta(g, sketch_buf);
+        if ((size_t)n + (bytes + 2) / 3 * 4 + 24 >= size) return -1;
+        n += snprintf(out + n, size - n, ",\"_agg\":{\"sketch\":\"");
+        n += (int)base64_encode(sketch_buf, bytes, out + n);
+        n += snprintf(out + n, size - n, "\"}");
+    }
+    if ((size_t)n + 2 > size) return -1;
+    out[n++] = '}';
+    out[n] = '\0';
+    return n;
+}
+
+/**
+ * 输出有变化的分组，并把当前累计值记为已输出
+ */
+static void emit_changed() {
+    for (int32_t id = 0; id < state->group_count; id++) {
+        SketchGroup* g = &state->groups[id];
+        if (g->count == g->reported_count && g->value_count == g->reported_value_count) continue;
+        int n = format_group(g, 1, record_buf, sizeof(record_buf));
+        if (n > 0 && alin_emit_extra(record_buf, (size_t)n) == 0) results++;
+        g->reported_count = g->count;
+        g->reported_value_count = g->value_count;
+        g->reported_zero = g->zero_count;
+        g->reported_sum = g->value_sum;
+        memcpy(g->reported_bins, g->bins, sizeof(g->bins));
+    }
+    if (store.header) alin_state_touch(&store);
+    last_emit_ns = monotonic_ns();
+}
+
+static void on_idle(int final) {
+    if (configured <= 0) return;
+    if (final || monotonic_ns() - last_emit_ns >= emit_interval_ns) emit_changed();
+}
+
+static void close_state() {
+    if (events + merged > 1) {    // 单次模式不汇总
+        fprintf(stderr, "[SKETCH] events %ld, merged sketches %ld, rejected %ld, results %ld, groups %d\n",
+            events, merged, rejected, results, state->group_count);
+    }
+    if (store.header) alin_state_close(&store);
+}
+
+// ===== 配置与状态文件 =====
+
+/**
+ * 状态文件路径: ALIN_SKETCH_STATE，否则为 ALIN_STATE_FILE 所在目录下的 agg_sketch.state
+ * @return 0 有路径, -1 只在内存中累计
+ */
+static int state_path(char* path, size_t size) {
+    const char* env = getenv("ALIN_SKETCH_STATE");
+    if (env) {
+        snprintf(path, size, "%s", env);
+        return env[0] ? 0 : -1;
+    }
+    env = getenv("ALIN_STATE_FILE");
+    if (!env || !env[0]) return -1;
+    const char* slash = strrchr(env, '/');
+    if (slash) snprintf(path, size, "%.*s/agg_sketch.state", (int)(slash - env), env);
+    else snprintf(path, size, "agg_sketch.state");
+    return 0;
+}
+
+/**
+ * 读取配置，映射 (或在内存中分配) 各组概要
+ * @return 0 成功, -1 失败
+ */
+static int configure() {
+    configure_fields();
+    const char* env = getenv("ALIN_SKETCH_GROUPS");
+    if (env && atol(env) > 1) group_capacity = (int32_t)atol(env);
+    env = getenv("ALIN_SKETCH_EMIT_MS");
+    if (env && env[0]) emit_interval_ns = (int64_t)atol(env) * 1000000;
+    env = getenv("ALIN_SKETCH_DROP");
+    drop_events = env && env[0] && strcmp(env, "0") != 0;
+
+    char path[1024];
+    if (state_path(path, sizeof(path)) == 0) {
+        state = alin_state_open(&store, path, "agg_sketch", SKETCH_STATE_VERSION, state_size(group_capacity));
+        if (state && store.version != 0 && !state_compatible(state)) {
+            fprintf(stderr, "[SKETCH] %s was written with other sketch parameters\n", path);
+            alin_state_close(&store);
+            state = NULL;
+        }
+        if (!state) {
+            fprintf(stderr, "[SKETCH] Cannot use state file %s, keeping sketches in memory only\n", path);
+            memset(&store, 0, sizeof(store));
+        } else {
+            // 已有文件可能比本次配置的容量大 (映射整个文件)
+            int32_t capacity = state_capacity(store.header->body_size);
+            if (capacity > group_capacity) group_capacity = capacity;
+        }
+    }
+    if (!state) {
+        state = calloc(1, state_size(group_capacity));
+        if (!state) {
+            fprintf(stderr, "[SKETCH] Cannot allocate %d groups\n", group_capacity);
+            return -1;
+        }
+    }
+    state->hll_bits = HLL_BITS;
+    state->dd_sub_bits = DD_SUB_BITS;
+    state->dd_bins = DD_BINS;
+    if (state->group_count > group_capacity) state->group_count = group_capacity;
+    if (build_index() < 0) return -1;
+    last_emit_ns = monotonic_ns();
+
+    // 宿主进程中不经过 main，回调在这里注册
+    alin_set_idle_hook(on_idle);
+    atexit(close_state);
+    fprintf(stderr, "[SKETCH] distinct %s, quantiles of %s, up to %d groups (%zu KB each)%s\n",
+        distinct_field, value_field, group_capacity, sizeof(SketchGroup) / 1024,
+        state->group_count > 0 ? ", resumed from state file" : "");
+    return 0;
+}
+
+/**
+ * 读取整个状态文件 (调用方释放)
+ */
+static SketchState* read_state(const char* path) {
+    SketchState head;
+    alin_state_header_t header;
+    if (alin_state_read(path, "agg_sketch", &head, sizeof(head), &header) != ALIN_STATE_OK) {
+        fprintf(stderr, "[SKETCH] %s is not an agg_sketch state file\n", path);
+        return NULL;
+    }
+    SketchState* s = malloc(header.body_size);
+    if (!s || alin_state_read(path, "agg_sketch", s, header.body_size, NULL) != ALIN_STATE_OK ||
+        !state_compatible(s)) {
+        fprintf(stderr, "[SKETCH] Cannot read %s\n", path);
+        free(s);
+        return NULL;
+    }
+    int32_t capacity = state_capacity(header.body_size);
+    if (s->group_count > capacity) s->group_count = capacity;
+    return s;
+}
+
+/**
+ * 打印各组的结果记录 (agg_sketch --dump-state [路径])
+ */
+static int dump_state(const char* path) {
+    char default_path[1024];
+    if (!path && state_path(default_path, sizeof(default_path)) == 0) path = default_path;
+    if (!path || !path[0]) {
+        fprintf(stderr, "Usage: agg_sketch --dump-state <state file> (or set ALIN_SKETCH_STATE)\n");
+        return 1;
+    }
+    SketchState* s = read_state(path);
+    if (!s) return 1;
+    for (int32_t id = 0; id < s->group_count; id++) {
+        if (format_group(&s->groups[id], 0, record_buf, sizeof(record_buf)) > 0) printf("%s\n", record_buf);
+    }
+    free(s);
+    return 0;
+}
+
+/**
+ * 合并多个实例的状态文件 (agg_sketch --merge-state <目标> <来源>...):
+ * 来源的累计值与已输出部分分别并入目标，尚未输出的增量在目标的节点下次输出
+ */
+static int merge_states(const char* target, char** sources, int count) {
+    if (!target || count <= 0) {
+        fprintf(stderr, "Usage: agg_sketch --merge-state <target> <source>...\n");
+        return 1;
+    }
+    state = alin_state_open(&store, target, "agg_sketch", SKETCH_STATE_VERSION, state_size(group_capacity));
+    if (!state || (store.version != 0 && !state_compatible(state))) {
+        fprintf(stderr, "[SKETCH] Cannot open %s\n", target);
+        return 1;
+    }
+    group_capacity = state_capacity(store.header->body_size);
+    state->hll_bits = HLL_BITS;
+    state->dd_sub_bits = DD_SUB_BITS;
+    state->dd_bins = DD_BINS;
+    if (build_index() < 0) return 1;
+
+    int failed = 0;
+    for (int i = 0; i < count; i++) {
+        SketchState* s = read_state(sources[i]);
+        if (!s) {
+            failed = 1;
+            continue;
+        }
+        for (int32_t id = 0; id < s->group_count; id++) {
+            SketchGroup* from = &s->groups[id];
+            SketchGroup* to = find_group(from->key, from->key_len);
+            if (from->value_count > 0) {
+                if (to->value_count == 0 || from->value_min < to->value_min) to->value_min = from->value_min;
+                if (to->value_count == 0 || from->value_max > to->value_max) to->value_max = from->value_max;
+            }
+            for (int r = 0; r < HLL_REGISTERS; r++) {
+                if (from->hll[r] > to->hll[r]) to->hll[r] = from->hll[r];
+            }
+            // 桶按桶号逐个并入 (累计计数不小于已输出计数，空桶没有已输出部分)，
+            // 已输出部分放入同一个桶 (该桶已被合并到最低桶时同样放入最低桶)
+            for (int32_t b = 0; from->dd_used && b < DD_BINS; b++) {
+                if (from->bins[b] == 0) continue;
+                int32_t index = from->dd_offset + b;
+                dd_add(to, index, from->bins[b]);
+                if (index < to->dd_offset) index = to->dd_offset;
+                to->reported_bins[index - to->dd_offset] += from->reported_bins[b];
+            }
+            to->count += from->count;
+            to->value_count += from->value_count;
+            to->zero_count += from->zero_count;
+            to->value_sum += from->value_sum;
+            to->reported_count += from->reported_count;
+            to->reported_value_count += from->reported_value_count;
+            to->reported_zero += from->reported_zero;
+            to->reported_sum += from->reported_sum;
+        }
+        printf("merged %s (%d groups)\n", sources[i], s->group_count);
+        free(s);
+    }
+    alin_state_close(&store);
+    return failed;
+}
+
+// ===== 处理 =====
+
+int process(const char* input, char* output, size_t output_size) {
+    if (configured == 0) configured = configure() == 0 ? 1 : -1;
+    if (configured < 0) return -1;
+
+    alin_json_t doc;
+    alin_input_index(&doc, input);
+    char* key = alin_arena_alloc(alin_record_arena(), MAX_GROUP_KEY);
+    if (!key) return ALIN_PASS;
+
+    const alin_json_field_t* type = alin_json_find(&doc, "_type");
+    if (type && type->value_len == 6 && memcmp(type->value, "sketch", 6) == 0) {
+        // 上游实例的增量概要: 并入同名分组，不再向下游转发
+        const alin_json_field_t* group = alin_json_find(&doc, "group");
+        const alin_json_field_t* sketch = alin_json_find(&doc, "_agg.sketch");
+        long bytes = -1;
+        if (group && group->type == ALIN_JSON_OBJECT && group->value_len >= 2 && sketch) {
+            bytes = base64_decode(sketch->value, sketch->value_len, sketch_buf, sizeof(sketch_buf));
+        }
+        if (bytes > 0 && merge_delta(find_group(group->value + 1, group->value_len - 2), sketch_buf, (size_t)bytes) == 0) {
+            merged++;
+        } else {
+            rejected++;
+        }
+    } else {
+        events++;
+        int len = build_key(&doc, key);
+        SketchGroup* g = len >= 0 ? find_group(key, (size_t)len) : find_group(OTHER_KEY, strlen(OTHER_KEY));
+
+        long weight = alin_json_long(&doc, "_weight");
+        if (weight < 1) weight = 1;
+        weight += alin_json_long(&doc, "_dup");
+        g->count += weight;
+
+        const alin_json_field_t* f = alin_json_find(&doc, distinct_field);
+        if (f && f->type != ALIN_JSON_NULL) hll_add(g, f->value, f->value_len);
+        f = alin_json_find(&doc, value_field);
+        if (f && f->type == ALIN_JSON_NUMBER) add_value(g, alin_json_double(&doc, value_field), weight);
+    }
+
+    if (store.header) alin_state_touch(&store);
+    if (monotonic_ns() - last_emit_ns >= emit_interval_ns) emit_changed();
+
+    if (drop_events || (type && type->value_len == 6 && memcmp(type->value, "sketch", 6) == 0)) {
+        output[0] = '\0';
+        return 0;
+    }
+    return ALIN_PASS;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--dump-state") == 0) {
+        configure_fields();
+        return dump_state(argc > 2 ? argv[2] : NULL);
+    }
+    if (argc > 1 && strcmp(argv[1], "--merge-state") == 0) {
+        const char* env = getenv("ALIN_SKETCH_GROUPS");
+        if (env && atol(env) > 1) group_capacity = (int32_t)atol(env);
+        return merge_states(argc > 2 ? argv[2] : NULL, argv + 3, argc - 3);
+    }
+    configured = configure() == 0 ? 1 : -1;
+    if (configured < 0) return 1;
+    return alin_node_main(argc, argv, process, 0);
+}
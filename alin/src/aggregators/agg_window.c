@@ -0,0 +1,271 @@
+/**
+ * ALIN 流处理节点: agg_window (事件时间窗口计数)
+ *
+ * 功能: 按事件自带的 timestamp 把事件计入时间窗口，窗口关闭后输出该窗口的计数与速率，
+ *   告警可以按每个窗口的真实速率判断 (agg_count 的 rate 是整个会话的平均值，看不出突发)
+ * 输入: 标准化 ALIN 事件 {"_type":"log","level":"ERROR","timestamp":1234567890,...}
+ * 输出: 事件原样放行 (ALIN_WINDOW_DROP=1 时丢弃)，窗口关闭时追加一条结果记录 (alin_emit_extra):
+ *   {"_type":"window","start":1234567880,"end":1234567890,"count":57,"rate":5.70,"by_level":{"ERROR":3,"INFO":54},"late":0}
+ *
+ * 窗口: 长 ALIN_WINDOW_SIZE 秒 (默认 10)，每隔 ALIN_WINDOW_SLIDE 秒 (默认等于窗口长，即滚动窗口)
+ *   开始一个，边界对齐到 slide 的整数倍; 如 SIZE=10 SLIDE=1 为每秒输出一次最近 10 秒的计数
+ * 分桶: 时间轴按 size 与 slide 的最大公约数分桶，桶放在环形数组中 (桶编号取模定位)，
+ *   窗口的计数为其覆盖的各桶之和; 内存只与 (窗口长 + 滑动步长 + 允许的迟到) / 桶宽有关，与事件数无关
+ * 水位线: 已见到的最大事件时间减去 ALIN_WINDOW_LATENESS 秒 (默认 5)，结束时间不晚于水位线的窗口
+ *   即关闭并输出; 属于已关闭窗口的事件不再计入 (按迟到计数，在下一条结果的 late 中报告)。
+ *   没有事件的窗口不输出，输入结束时输出其余所有窗口
+ *
+ * 权重: 同 agg_count，事件带 _weight / _dup 时按权重计数
+ * 统计: 结束时输出事件数、窗口数、迟到与缺少时间的事件数 ([WINDOW])
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <strings.h>
+
+#include "alin_node.h"
+#include "alin_json.h"
+
+#define MAX_LEVELS 16
+#define MAX_LEVEL_NAME 16
+#define NO_BUCKET INT64_MIN
+
+typedef struct {
+    int64_t id;                  // 桶编号 (起始时间 / 桶宽)，NO_BUCKET 表示空
+    int64_t count;
+    int64_t levels[MAX_LEVELS];
+} Bucket;
+
+// 配置 (秒)
+static int64_t window_size = 10;
+static int64_t window_slide = 10;
+static int64_t lateness = 5;
+static int64_t bucket_width = 10;
+static int drop_events = 0;
+
+// 环形分桶
+static Bucket* ring = NULL;
+static int64_t ring_size = 0;
+static char level_names[MAX_LEVELS][MAX_LEVEL_NAME];
+static int level_count = 0;
+
+// 事件时间
+static int started = 0;
+static int64_t max_time = 0;            // 已见到的最大事件时间
+static int64_t closed_end = 0;          // 结束时间不晚于此的窗口已关闭
+static int64_t data_end = INT64_MIN;    // 计入过事件的桶的最晚结束时间
+
+// 统计
+static long events = 0;
+static long windows = 0;
+static long late_events = 0;
+static long late_pending = 0;           // 上一条结果之后的迟到事件数
+static long untimed = 0;
+static int configured = 0;
+
+static char record_buf[1024];
+
+static inline int64_t floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+static inline int64_t align_down(int64_t t, int64_t step) {
+    return floor_div(t, step) * step;
+}
+
+static int64_t gcd(int64_t a, int64_t b) {
+    while (b != 0) {
+        int64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static inline Bucket* bucket_at(int64_t id) {
+    int64_t slot = id % ring_size;
+    return &ring[slot < 0 ? slot + ring_size : slot];
+}
+
+static void report() {
+    if (events <= 1) return;    // 单次模式不汇总
+    fprintf(stderr, "[WINDOW] events %ld, windows %ld, late %ld, untimed %ld\n",
+        events, windows, late_events, untimed);
+}
+
+static void on_idle(int final);
+
+/**
+ * 读取配置并分配环形分桶
+ * @return 0 成功, -1 失败
+ */
+static int configure() {
+    const char* env = getenv("ALIN_WINDOW_SIZE");
+    if (env && atol(env) > 0) window_size = atol(env);
+    window_slide = window_size;
+    env = getenv("ALIN_WINDOW_SLIDE");
+    if (env && atol(env) > 0) window_slide = atol(env);
+    env = getenv("ALIN_WINDOW_LATENESS");
+    if (env && env[0] && atol(env) >= 0) lateness = atol(env);
+    env = getenv("ALIN_WINDOW_DROP");
+    drop_events = env && env[0] && strcmp(env, "0") != 0;
+
+    if (window_slide > window_size) {
+        fprintf(stderr, "[WINDOW] Slide %lds is longer than the %lds window, using %lds\n",
+            (long)window_slide, (long)window_size, (long)window_size);
+        window_slide = window_size;
+    }
+    bucket_width = gcd(window_size, window_slide);
+    // 需要保留的桶: 最早未关闭窗口的起点 (不早于水位线 - slide - size) 到最大事件时间
+    ring_size = (window_size + window_slide + lateness) / bucket_width + 2;
+    ring = malloc(sizeof(Bucket) * (size_t)ring_size);
+    if (!ring) {
+        fprintf(stderr, "[WINDOW] Cannot allocate %ld buckets\n", (long)ring_size);
+        return -1;
+    }
+    for (int64_t i = 0; i < ring_size; i++) ring[i].id = NO_BUCKET;
+
+    // 宿主进程中不经过 main，回调在这里注册
+    alin_set_idle_hook(on_idle);
+    atexit(report);
+    fprintf(stderr, "[WINDOW] %lds windows every %lds, lateness %lds, %ld buckets of %lds\n",
+        (long)window_size, (long)window_slide, (long)lateness, (long)ring_size, (long)bucket_width);
+    return 0;
+}
+
+static int find_or_create_level(const char* level) {
+    for (int i = 0; i < level_count; i++) {
+        if (strcasecmp(level_names[i], level) == 0) return i;
+    }
+    if (level_count >= MAX_LEVELS) return -1;
+    snprintf(level_names[level_count], MAX_LEVEL_NAME, "%s", level);
+    return level_count++;
+}
+
+/**
+ * 输出结束于 end 的窗口 (没有事件时不输出)
+ */
+static void emit_window(int64_t end) {
+    int64_t count = 0;
+    int64_t levels[MAX_LEVELS] = {0};
+    for (int64_t id = floor_div(end - window_size, bucket_width); id < floor_div(end, bucket_width); id++) {
+        const Bucket* b = bucket_at(id);
+        if (b->id != id) continue;
+        count += b->count;
+        for (int i = 0; i < level_count; i++) levels[i] += b->levels[i];
+    }
+    if (count == 0) return;
+
+    char by_level[MAX_LEVELS * (MAX_LEVEL_NAME + 24) + 4];
+    size_t pos = 0;
+    by_level[pos++] = '{';
+    for (int i = 0; i < level_count; i++) {
+        if (levels[i] == 0) continue;
+        pos += snprintf(by_level + pos, sizeof(by_level) - pos, "%s\"%s\":%lld",
+            pos > 1 ? "," : "", level_names[i], (long long)levels[i]);
+    }
+    by_level[pos++] = '}';
+    by_level[pos] = '\0';
+
+    int n = snprintf(record_buf, sizeof(record_buf),
+        "{\"_type\":\"window\",\"start\":%lld,\"end\":%lld,\"count\":%lld,\"rate\":%.2f,\"by_level\":%s,\"late\":%ld}",
+        (long long)(end - window_size), (long long)end, (long long)count,
+        (double)count / window_size, by_level, late_pending);
+    if (n > 0 && (size_t)n < sizeof(record_buf) && alin_emit_extra(record_buf, (size_t)n) == 0) windows++;
+    late_pending = 0;
+}
+
+/**
+ * 关闭结束时间不晚于 target 的窗口
+ * 只逐个关闭可能含有事件的窗口 (至多约 ring_size 个): 事件时间向前跳跃时，
+ * 之后的窗口都从最后一个有事件的桶之后开始，closed_end 直接移到 target
+ */
+static void close_windows(int64_t target) {
+    while (closed_end < target) {
+        int64_t end = closed_end + window_slide;
+        if (end - window_size >= data_end) {
+            closed_end = target;
+            break;
+        }
+        emit_window(end);
+        closed_end = end;
+    }
+}
+
+/**
+ * 空闲回调: 输入结束时关闭其余所有窗口 (窗口只随事件时间推进，等待输入时不关闭)
+ */
+static void on_idle(int final) {
+    if (!final || configured <= 0 || !started) return;
+    close_windows(align_down(max_time, window_slide) + window_size + window_slide);
+}
+
+static void add_event(int64_t ts, int level, int64_t weight) {
+    if (!started) {
+        started = 1;
+        max_time = ts;
+        closed_end = align_down(ts - lateness, window_slide);
+    } else if (ts > max_time) {
+        max_time = ts;
+        close_windows(align_down(max_time - lateness, window_slide));
+    }
+
+    // 包含该事件的最后一个窗口也已关闭
+    int64_t id = floor_div(ts, bucket_width);
+    if (align_down(id * bucket_width + window_size, window_slide) <= closed_end) {
+        late_events++;
+        late_pending++;
+        return;
+    }
+
+    Bucket* b = bucket_at(id);
+    if (b->id != id) {
+        memset(b, 0, sizeof(*b));
+        b->id = id;
+    }
+    b->count += weight;
+    if (level >= 0) b->levels[level] += weight;
+    if ((id + 1) * bucket_width > data_end) data_end = (id + 1) * bucket_width;
+}
+
+int process(const char* input, char* output, size_t output_size) {
+    if (configured == 0) configured = configure() == 0 ? 1 : -1;
+    if (configured < 0) return -1;
+
+    alin_json_t doc;
+    alin_input_index(&doc, input);
+    events++;
+
+    // 时间与级别: 帧头已带时直接使用
+    const alin_meta_t* meta = alin_input_meta();
+    int64_t ts = meta->timestamp != 0 ? meta->timestamp : alin_json_long(&doc, "timestamp");
+    if (ts == 0) {
+        untimed++;
+    } else {
+        char level[64];
+        const char* known = alin_level_name(meta->level);
+        int slot = -1;
+        if (known) slot = find_or_create_level(known);
+        else if (alin_json_string(&doc, "level", level, sizeof(level))) slot = find_or_create_level(level);
+
+        long weight = alin_json_long(&doc, "_weight");
+        if (weight < 1) weight = 1;
+        weight += alin_json_long(&doc, "_dup");
+        add_event(ts, slot, weight);
+    }
+
+    if (drop_events) {
+        output[0] = '\0';
+        return 0;
+    }
+    return ALIN_PASS;
+}
+
+int main(int argc, char* argv[]) {
+    configured = configure() == 0 ? 1 : -1;
+    if (configured < 0) return 1;
+    return alin_node_main(argc, argv, process, 0);
+}
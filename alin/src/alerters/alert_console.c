@@ -6,8 +6,16 @@
  * 输出: 格式化的告警文本
  * 
  * 配置: 
- * - ALIN_ALERT_THRESHOLD: 触发告警的阈值 (默认: 0 = 每条都告警)
+ * - ALIN_ALERT_THRESHOLD: 触发告警的计数阈值 (默认: 0 = 每条都告警)
+ * - ALIN_ALERT_RATE: 触发告警的速率阈值 (条/秒，默认: 0 = 不限)
  * - ALIN_ALERT_FORMAT: 输出格式 (text/json, 默认: text)
+ * - ALIN_ALERT_RAW: 为 1 时文本告警附上原始日志行 (内嵌的 _raw 或从暂存区取回 _raw_ref，见 alin_spool.h)
+ *
+ * 计数与速率: 事件取 agg_count 追加的 _agg.total / _agg.rate; agg_window 的窗口结果记录
+ * ({"_type":"window",...}) 取该窗口的 count / rate，告警时间为窗口结束时间，阈值按窗口判断
+ *
+ * 事件带有 match_keywords 追加的 _match 时，告警中列出命中的模式编号;
+ * 带有 dedup 追加的 _dup 时，列出此前被抑制的重复条数; dedup 的补记记录 (_dup_flush) 不告警
  */
 
 #include <stdio.h>
@@ -15,83 +23,9 @@
 #include <string.h>
 #include <time.h>
 
-#define MAX_INPUT_SIZE 65536
-
-int extract_string_field(const char* json, const char* field, char* value, size_t max_size) {
-    char pattern[256];
-    snprintf(pattern, sizeof(pattern), "\"%s\"", field);
-    
-    const char* pos = strstr(json, pattern);
-    if (!pos) return 0;
-    
-    pos += strlen(pattern);
-    while (*pos && (*pos == ':' || *pos == ' ' || *pos == '\t')) pos++;
-    
-    if (*pos == '"') {
-        pos++;
-        size_t i = 0;
-        while (*pos && *pos != '"' && i < max_size - 1) {
-            if (*pos == '\\' && *(pos + 1)) pos++;
-            value[i++] = *pos++;
-        }
-        value[i] = '\0';
-        return 1;
-    }
-    return 0;
-}
-
-long extract_number_field(const char* json, const char* field) {
-    char pattern[256];
-    snprintf(pattern, sizeof(pattern), "\"%s\"", field);
-    
-    const char* pos = strstr(json, pattern);
-    if (!pos) return 0;
-    
-    pos += strlen(pattern);
-    while (*pos && (*pos == ':' || *pos == ' ' || *pos == '\t')) pos++;
-    
-    if (*pos == '-' || (*pos >= '0' && *pos <= '9')) {
-        return strtol(pos, NULL, 10);
-    }
-    return 0;
-}
-
-double extract_double_field(const char* json, const char* field) {
-    char pattern[256];
-    snprintf(pattern, sizeof(pattern), "\"%s\"", field);
-    
-    const char* pos = strstr(json, pattern);
-    if (!pos) return 0;
-    
-    pos += strlen(pattern);
-    while (*pos && (*pos == ':' || *pos == ' ' || *pos == '\t')) pos++;
-    
-    if (*pos == '-' || *pos == '.' || (*pos >= '0' && *pos <= '9')) {
-        return strtod(pos, NULL);
-    }
-    return 0;
-}
-
-int read_stdin(char* buffer, size_t max_size) {
-    size_t total = 0;
-    int c;
-    while ((c = getchar()) != EOF && total < max_size - 1) {
-        buffer[total++] = (char)c;
-    }
-    buffer[total] = '\0';
-    return (int)total;
-}
-
-void trim(char* str) {
-    char* start = str;
-    while (*start == ' ' || *start == '\n' || *start == '\r' || *start == '\t') start++;
-    if (*start == '\0') { str[0] = '\0'; return; }
-    char* end = start + strlen(start) - 1;
-    while (end > start && (*end == ' ' || *end == '\n' || *end == '\r' || *end == '\t')) end--;
-    size_t len = end - start + 1;
-    memmove(str, start, len);
-    str[len] = '\0';
-}
+#include "alin_node.h"
+#include "alin_json.h"
+#include "alin_spool.h"
 
 const char* get_level_color(const char* level) {
     if (strcasecmp(level, "ERROR") == 0 || strcasecmp(level, "FATAL") == 0) return "\033[0;31m";  // Red
@@ -110,41 +44,58 @@ const char* get_level_icon(const char* level) {
     return "⚪";
 }
 
-int main(int argc, char* argv[]) {
-    char input[MAX_INPUT_SIZE];
+int process(const char* input, char* output, size_t output_size) {
+    static int configured = 0;
+    static long threshold = 0;
+    static double rate_threshold = 0;
+    static int json_format = 0;
+    static int show_raw = 0;
     char level[64] = "INFO";
     char message[4096] = "";
     
-    // 获取配置
-    const char* threshold_str = getenv("ALIN_ALERT_THRESHOLD");
-    long threshold = threshold_str ? atol(threshold_str) : 0;
-    
-    const char* format = getenv("ALIN_ALERT_FORMAT");
-    int json_format = (format && strcasecmp(format, "json") == 0);
-    
-    if (read_stdin(input, MAX_INPUT_SIZE) <= 0) {
-        return 0;
+    // 获取配置 (常驻时只读取一次)
+    if (!configured) {
+        const char* threshold_str = getenv("ALIN_ALERT_THRESHOLD");
+        threshold = threshold_str ? atol(threshold_str) : 0;
+        const char* rate_str = getenv("ALIN_ALERT_RATE");
+        rate_threshold = rate_str ? atof(rate_str) : 0;
+        
+        const char* format = getenv("ALIN_ALERT_FORMAT");
+        json_format = (format && strcasecmp(format, "json") == 0);
+        
+        const char* raw = getenv("ALIN_ALERT_RAW");
+        show_raw = raw && strcmp(raw, "1") == 0;
+        configured = 1;
     }
     
-    trim(input);
-    
-    if (input[0] == '\0') {
-        return 0;
+    // 提取字段 (计数与速率在 agg_count 追加的 _agg 对象中，窗口结果记录在顶层)
+    alin_json_t doc;
+    alin_input_index(&doc, input);
+    alin_json_string(&doc, "level", level, sizeof(level));
+    alin_json_string(&doc, "message", message, sizeof(message));
+    char type[16] = "";
+    alin_json_string(&doc, "_type", type, sizeof(type));
+    int window = strcmp(type, "window") == 0;
+    
+    long total = alin_json_long(&doc, window ? "count" : "_agg.total");
+    double rate = alin_json_double(&doc, window ? "rate" : "_agg.rate");
+    long timestamp = alin_json_long(&doc, window ? "end" : "timestamp");
+    if (window && message[0] == '\0') {
+        snprintf(message, sizeof(message), "window %ld-%ld", alin_json_long(&doc, "start"), timestamp);
     }
     
-    // 提取字段
-    extract_string_field(input, "level", level, sizeof(level));
-    extract_string_field(input, "message", message, sizeof(message));
+    // 命中的模式编号 (数组原文，如 [1,7])
+    const alin_json_field_t* match = alin_json_find(&doc, "_match");
+    if (match && match->type != ALIN_JSON_ARRAY) match = NULL;
+    long dup = alin_json_long(&doc, "_dup");
     
-    long total = extract_number_field(input, "total");
-    double rate = extract_double_field(input, "rate");
-    long timestamp = extract_number_field(input, "timestamp");
+    // dedup 的补记记录 (被抑制的重复，首条已告警) 只放行给下游计数
+    if (alin_json_find(&doc, "_dup_flush")) return ALIN_PASS;
     
     // 检查阈值
-    if (threshold > 0 && total < threshold) {
+    if ((threshold > 0 && total < threshold) || (rate_threshold > 0 && rate < rate_threshold)) {
         // 未达阈值，静默
-        printf("%s\n", input);
-        return 0;
+        return ALIN_PASS;
     }
     
     // 格式化时间
@@ -154,8 +105,16 @@ int main(int argc, char* argv[]) {
     
     if (json_format) {
         // JSON 格式输出
-        printf("{\"alert\":true,\"time\":\"%s\",\"level\":\"%s\",\"message\":\"%s\",\"total\":%ld,\"rate\":%.2f}\n",
+        int n = snprintf(output, output_size,
+            "{\"alert\":true,\"time\":\"%s\",\"level\":\"%s\",\"message\":\"%s\",\"total\":%ld,\"rate\":%.2f",
             time_str, level, message, total, rate);
+        if (match && n > 0 && (size_t)n < output_size) {
+            n += snprintf(output + n, output_size - n, ",\"match\":%.*s", (int)match->value_len, match->value);
+        }
+        if (dup > 0 && n > 0 && (size_t)n < output_size) {
+            n += snprintf(output + n, output_size - n, ",\"suppressed\":%ld", dup);
+        }
+        if (n > 0 && (size_t)n < output_size) snprintf(output + n, output_size - n, "}");
     } else {
         // 人类可读格式
         const char* color = get_level_color(level);
@@ -169,12 +128,28 @@ int main(int argc, char* argv[]) {
         fprintf(stderr, "║ 🕐 Time:    %-46s ║\n", time_str);
         fprintf(stderr, "║ 📝 Message: %-46.46s ║\n", message[0] ? message : "(no message)");
         fprintf(stderr, "║ 📊 Count:   %-6ld  Rate: %-6.2f events/sec            ║\n", total, rate);
+        if (match) {
+            fprintf(stderr, "║ 🔎 Match:   %-46.*s ║\n", match->value_len < 46 ? (int)match->value_len : 46, match->value);
+        }
+        if (dup > 0) {
+            fprintf(stderr, "║ 🔁 Repeats: %-6ld  suppressed since last alert        ║\n", dup);
+        }
+        if (show_raw) {
+            // 原文只在这里才取回 (引用模式下事件本身不携带)
+            char raw[4096];
+            if (alin_spool_raw(&doc, raw, sizeof(raw)) < 0) snprintf(raw, sizeof(raw), "(unavailable)");
+            fprintf(stderr, "║ 📄 Raw:     %-46.46s ║\n", raw);
+        }
         fprintf(stderr, "╚══════════════════════════════════════════════════════════╝%s\n", reset);
         fprintf(stderr, "\n");
         
         // 同时输出原始 JSON 到 stdout (保持管道链)
-        printf("%s\n", input);
+        return ALIN_PASS;
     }
     
     return 0;
 }
+
+int main(int argc, char* argv[]) {
+    return alin_node_main(argc, argv, process, 0);
+}
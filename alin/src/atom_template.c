@@ -5,93 +5,37 @@
  * 1. 输入/输出通过 stdin/stdout 流式传输
  * 2. 使用 JSON 格式进行数据交换
  * 3. 每个节点是无状态的纯函数
+ * 4. 只实现 process()，读取/循环/输出由节点运行时 (runtime/alin_node.h) 负责
+ * 5. 读取 JSON 字段用 runtime/alin_json.h (流模式下用 alin_input_index，上游附带字段表时不必扫描)
  * 
  * 编译: make <node_name>
  * 运行: echo '[1,2,3]' | ./alin/nodes/<node_name>_<hash>
+ * 流模式: cat records.jsonl | ./alin/nodes/<node_name>_<hash> --stream
+ *         (或 ALIN_STREAM=1，每行一条记录，进程常驻)
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define MAX_INPUT_SIZE 65536
+#include "alin_node.h"
 
 /**
  * 主处理函数 - 子类需要实现
- * @param input  输入的 JSON 字符串
- * @param output 输出缓冲区
+ * 单次模式下对整个输入调用一次，流模式下对每条记录调用一次
+ * @param input  输入的 JSON 字符串 (已去除首尾空白)
+ * @param output 输出缓冲区 (置为空串表示丢弃该记录)
  * @param output_size 输出缓冲区大小
- * @return 0 成功, -1 失败
+ * @return 0 成功, ALIN_PASS 原样输出 input, -1 失败
  */
-int process(const char* input, char* output, size_t output_size);
-
-/**
- * 从 stdin 读取全部输入
- */
-int read_stdin(char* buffer, size_t max_size) {
-    size_t total = 0;
-    int c;
-    while ((c = getchar()) != EOF && total < max_size - 1) {
-        buffer[total++] = (char)c;
-    }
-    buffer[total] = '\0';
-    return (int)total;
-}
-
-/**
- * 去除字符串首尾空白
- */
-void trim(char* str) {
-    char* start = str;
-    char* end;
-    
-    // 去除开头空白
-    while (*start == ' ' || *start == '\n' || *start == '\r' || *start == '\t') {
-        start++;
-    }
-    
-    // 如果全是空白
-    if (*start == '\0') {
-        str[0] = '\0';
-        return;
-    }
-    
-    // 找到结尾
-    end = start + strlen(start) - 1;
-    while (end > start && (*end == ' ' || *end == '\n' || *end == '\r' || *end == '\t')) {
-        end--;
-    }
-    
-    // 移动内容
-    size_t len = end - start + 1;
-    memmove(str, start, len);
-    str[len] = '\0';
+int process(const char* input, char* output, size_t output_size) {
+    snprintf(output, output_size, "%s", input);
+    return 0;
 }
 
 /**
  * 主入口函数
  */
 int main(int argc, char* argv[]) {
-    char input[MAX_INPUT_SIZE];
-    char output[MAX_INPUT_SIZE];
-    
-    // 读取输入
-    if (read_stdin(input, MAX_INPUT_SIZE) <= 0) {
-        fprintf(stderr, "Error: No input received\n");
-        return 1;
-    }
-    
-    // 去除空白
-    trim(input);
-    
-    // 处理数据
-    if (process(input, output, MAX_INPUT_SIZE) != 0) {
-        fprintf(stderr, "Error: Processing failed\n");
-        return 1;
-    }
-    
-    // 输出结果
-    printf("%s\n", output);
-    
-    return 0;
+    return alin_node_main(argc, argv, process, ALIN_NODE_REQUIRE_INPUT);
 }
@@ -0,0 +1,291 @@
+/**
+ * ALIN 输入层基准 (Input Benchmark)
+ *
+ * 比较节点读取 stdin 的方式 (输入为临时文件，页缓存已预热):
+ * - getchar: 原先各节点的 read_stdin，逐字节 getc 到调用方的缓冲区
+ * - read:    alin_input 块读取 (每次 read(2) 一大块，memchr 切分，记录原地交出)
+ * - mmap:    alin_input 整体读入普通文件时的映射
+ * 日志路径: 按行切分 (与 bench_json 同形态的记录)，分别从文件与管道读取 (管道即运行器中的情形)
+ * 图像路径: 整体读入一个接近 10MB 的文档 (图像节点的 MAX_INPUT_SIZE) 并扫描一遍
+ * 每种方式的记录数与校验和都与同一来源的 getchar 比对，加速比也相对于它
+ *
+ * 使用方式:
+ *   make bench-input
+ *   alin/bin/alin_bench_input [records] [rounds]    # 默认 500000 条 x 5 轮
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "alin_input.h"
+
+#define LINE_SIZE 65536
+#define IMAGE_SIZE 10485760
+
+typedef struct {
+    long records;
+    long checksum;
+} Result;
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * 每条记录计入校验和 (长度与首尾字节，保证记录确实被读到)
+ */
+static inline void account(Result* res, const char* record, size_t len) {
+    res->records++;
+    res->checksum += (long)len + (len ? record[0] + record[len - 1] : 0);
+}
+
+/**
+ * 文档整体扫描一遍 (如同节点建立字段索引)，计入引号数
+ */
+static void scan_doc(Result* res, const char* doc, size_t len) {
+    const char* end = doc + len;
+    for (const char* p = doc; (p = memchr(p, '"', (size_t)(end - p))) != NULL; p++) res->checksum++;
+    account(res, doc, len);
+}
+
+// ===== 原先的读取方式 (各节点的 read_stdin) =====
+
+Result lines_getchar(int fd) {
+    static char line[LINE_SIZE];
+    Result res = { 0, 0 };
+    FILE* f = fdopen(fd, "r");
+    size_t len = 0;
+    int c;
+    while ((c = getc(f)) != EOF) {
+        if (c == '\n') {
+            line[len] = '\0';
+            account(&res, line, len);
+            len = 0;
+        } else if (len < LINE_SIZE - 1) {
+            line[len++] = (char)c;
+        }
+    }
+    if (len > 0) {
+        line[len] = '\0';
+        account(&res, line, len);
+    }
+    fclose(f);
+    return res;
+}
+
+Result doc_getchar(int fd) {
+    Result res = { 0, 0 };
+    char* buffer = malloc(IMAGE_SIZE);
+    FILE* f = fdopen(fd, "r");
+    size_t total = 0;
+    int c;
+    while ((c = getc(f)) != EOF && total < IMAGE_SIZE - 1) buffer[total++] = (char)c;
+    buffer[total] = '\0';
+    scan_doc(&res, buffer, total);
+    fclose(f);
+    free(buffer);
+    return res;
+}
+
+// ===== alin_input =====
+
+Result lines_input(int fd) {
+    Result res = { 0, 0 };
+    alin_input_t in;
+    alin_input_open(&in, fd, LINE_SIZE);
+    size_t len;
+    char* line;
+    while ((line = alin_input_line(&in, LINE_SIZE - 1, &len)) != NULL) account(&res, line, len);
+    alin_input_close(&in);
+    close(fd);
+    return res;
+}
+
+Result doc_input(int fd) {
+    Result res = { 0, 0 };
+    alin_input_t in;
+    alin_input_open(&in, fd, IMAGE_SIZE);
+    size_t len;
+    char* doc = alin_input_all(&in, &len);
+    scan_doc(&res, doc, len);
+    alin_input_close(&in);
+    close(fd);
+    return res;
+}
+
+/**
+ * 打开输入: 文件直接打开，管道由子进程把文件写入
+ */
+int open_source(const char* path, int piped, pid_t* writer) {
+    *writer = -1;
+    if (!piped) return open(path, O_RDONLY);
+
+    int fds[2];
+    if (pipe(fds) < 0) return -1;
+    *writer = fork();
+    if (*writer == 0) {
+        close(fds[0]);
+        int src = open(path, O_RDONLY);
+        static char buf[1 << 16];
+        ssize_t n;
+        while ((n = read(src, buf, sizeof(buf))) > 0) {
+            if (write(fds[1], buf, (size_t)n) != n) break;
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+    return fds[0];
+}
+
+double run(Result (*reader)(int), const char* path, int piped, int rounds, Result* res) {
+    double best = 0;
+    for (int r = 0; r < rounds; r++) {
+        pid_t writer;
+        int fd = open_source(path, piped, &writer);
+        if (fd < 0) return -1;
+        double start = now_seconds();
+        *res = reader(fd);
+        double elapsed = now_seconds() - start;
+        if (writer > 0) waitpid(writer, NULL, 0);
+        if (r == 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+/**
+ * 生成 count 条日志 (字段顺序与长度轮换)
+ * @return 文件大小
+ */
+long generate_log(const char* path, int count) {
+    static const char* levels[] = { "DEBUG", "INFO", "INFO", "INFO", "WARN", "ERROR" };
+    static const char* services[] = { "api", "auth", "database", "cache", "queue", "worker" };
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+    srand(42);
+    for (int i = 0; i < count; i++) {
+        const char* level = levels[rand() % 6];
+        const char* service = services[rand() % 6];
+        if (i % 2) {
+            fprintf(f, "{\"level\":\"%s\",\"service\":\"%s\",\"msg\":\"event %d\",\"ts\":%d,"
+                "\"request_id\":\"%08x\",\"latency_ms\":%d}\n", level, service, i, 1700000000 + i,
+                rand(), rand() % 3000);
+        } else {
+            fprintf(f, "{\"timestamp\":%d,\"service\":\"%s\",\"request_id\":\"%08x\","
+                "\"latency_ms\":%d,\"message\":\"user \\\"u%d\\\" done\",\"level\":\"%s\"}\n",
+                1700000000 + i, service, rand(), rand() % 3000, i, level);
+        }
+    }
+    long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+/**
+ * 生成一个图像文档: base64 字符填满 ppm 字段，总长 IMAGE_SIZE - 1
+ */
+long generate_image(const char* path) {
+    static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+    const char* head = "{\"_type\":\"image\",\"width\":1536,\"height\":1536,\"format\":\"ppm\",\"ppm\":\"";
+    fputs(head, f);
+    long body = IMAGE_SIZE - 1 - (long)strlen(head) - 3;
+    for (long i = 0; i < body; i++) fputc(b64[(i * 7 + i / 64) & 63], f);
+    fputs("\"}\n", f);
+    long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+typedef struct {
+    const char* name;
+    Result (*reader)(int);
+    const char* mmap;       // ALIN_MMAP
+    int piped;
+} Variant;
+
+/**
+ * @return 0 成功, 1 记录数或校验和不一致
+ */
+int bench_path(const char* title, const char* path, long size, const Variant* variants, int n, int rounds) {
+    printf("%s: %.1f MB, rounds: %d (best of)\n", title, size / 1e6, rounds);
+    printf("%-10s %-6s %10s %12s %12s %9s\n", "reader", "source", "records", "MB/s", "ns/record", "speedup");
+
+    // 基准为同一来源的 getchar (每种来源的第一行)
+    Result base[2] = { { 0, 0 }, { 0, 0 } };
+    double base_time[2] = { 0, 0 };
+    int failed = 0;
+    for (int i = 0; i < n; i++) {
+        int piped = variants[i].piped;
+        setenv("ALIN_MMAP", variants[i].mmap, 1);
+        Result res;
+        double best = run(variants[i].reader, path, piped, rounds, &res);
+        if (best < 0) return 1;
+        if (base_time[piped] == 0) {
+            base[piped] = res;
+            base_time[piped] = best;
+        } else if (res.records != base[piped].records || res.checksum != base[piped].checksum) {
+            fprintf(stderr, "Mismatch: %s/%s read %ld records (checksum %ld), expected %ld (%ld)\n",
+                variants[i].name, piped ? "pipe" : "file",
+                res.records, res.checksum, base[piped].records, base[piped].checksum);
+            failed = 1;
+        }
+        printf("%-10s %-6s %10ld %12.0f %12.1f %8.2fx\n", variants[i].name, piped ? "pipe" : "file",
+            res.records, size / best / 1e6, best * 1e9 / res.records, base_time[piped] / best);
+    }
+    printf("\n");
+    return failed;
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 500000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 5;
+    if (count <= 0 || rounds <= 0) {
+        fprintf(stderr, "Usage: %s [records] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    char log_path[] = "/tmp/alin_bench_input_XXXXXX";
+    char image_path[] = "/tmp/alin_bench_image_XXXXXX";
+    int log_fd = mkstemp(log_path);
+    int image_fd = mkstemp(image_path);
+    if (log_fd < 0 || image_fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(log_fd);
+    close(image_fd);
+
+    long log_size = generate_log(log_path, count);
+    long image_size = generate_image(image_path);
+    int failed = log_size <= 0 || image_size <= 0;
+
+    if (!failed) {
+        static const Variant lines[] = {
+            { "getchar", lines_getchar, "0", 0 },
+            { "read", lines_input, "0", 0 },
+            { "getchar", lines_getchar, "0", 1 },
+            { "read", lines_input, "0", 1 }
+        };
+        static const Variant docs[] = {
+            { "getchar", doc_getchar, "0", 0 },
+            { "read", doc_input, "0", 0 },
+            { "mmap", doc_input, "1", 0 },
+            { "getchar", doc_getchar, "0", 1 },
+            { "read", doc_input, "0", 1 }
+        };
+        failed |= bench_path("log path", log_path, log_size, lines, 4, rounds);
+        failed |= bench_path("image path", image_path, image_size, docs, 5, rounds);
+    }
+
+    unlink(log_path);
+    unlink(image_path);
+    return failed;
+}
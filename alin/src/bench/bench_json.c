@@ -0,0 +1,262 @@
+/**
+ * ALIN JSON 字段提取基准 (JSON Extraction Benchmark)
+ *
+ * 比较 parse_json 每条记录的字段提取开销:
+ * - strstr: 原先各节点复制的 extract_string_field / extract_number_field，
+ *           每次查找都从头 strstr 整条记录 (parse_json 一条记录最多 7 次)
+ * - index:  alin_json_index 扫描一次建立字段索引，之后的查找只比较键
+ * 两种方式的提取结果逐条比对; 另以 "键出现在字符串值中" 的记录验证索引只匹配真正的键
+ *
+ * 另对每种可用的 alin_scan 实现 (avx2/sse4.2/scalar) 测量长字符串的扫描吞吐 (GB/s)，
+ * 并与逐字节转义比对 alin_scan_escape 的结果
+ *
+ * 使用方式:
+ *   make bench-json
+ *   alin/bin/alin_bench_json [records] [rounds]     # 默认 200000 条 x 5 轮
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#include "alin_json.h"
+#include "alin_scan.h"
+
+#define FIELD_SIZE 4096
+#define SCAN_SIZE (64 << 20)
+
+typedef struct {
+    char level[FIELD_SIZE];
+    char message[FIELD_SIZE];
+    long timestamp;
+} Extracted;
+
+// ===== 原先的提取函数 (parse_json.c 中的版本) =====
+
+int extract_string_field(const char* json, const char* field, char* value, size_t max_size) {
+    char pattern[256];
+    snprintf(pattern, sizeof(pattern), "\"%s\"", field);
+
+    const char* pos = strstr(json, pattern);
+    if (!pos) return 0;
+
+    pos += strlen(pattern);
+    while (*pos && (*pos == ':' || *pos == ' ' || *pos == '\t')) pos++;
+
+    if (*pos == '"') {
+        pos++;
+        size_t i = 0;
+        while (*pos && *pos != '"' && i < max_size - 1) {
+            if (*pos == '\\' && *(pos + 1)) {
+                pos++;
+                switch (*pos) {
+                    case 'n': value[i++] = '\n'; break;
+                    case 't': value[i++] = '\t'; break;
+                    case 'r': value[i++] = '\r'; break;
+                    case '"': value[i++] = '"'; break;
+                    case '\\': value[i++] = '\\'; break;
+                    default: value[i++] = *pos;
+                }
+            } else {
+                value[i++] = *pos;
+            }
+            pos++;
+        }
+        value[i] = '\0';
+        return 1;
+    }
+    return 0;
+}
+
+long extract_number_field(const char* json, const char* field) {
+    char pattern[256];
+    snprintf(pattern, sizeof(pattern), "\"%s\"", field);
+
+    const char* pos = strstr(json, pattern);
+    if (!pos) return 0;
+
+    pos += strlen(pattern);
+    while (*pos && (*pos == ':' || *pos == ' ' || *pos == '\t')) pos++;
+
+    if (*pos == '-' || isdigit(*pos)) {
+        return strtol(pos, NULL, 10);
+    }
+    return 0;
+}
+
+// ===== parse_json 的提取步骤 =====
+
+void extract_strstr(const char* input, Extracted* e) {
+    strcpy(e->level, "INFO");
+    e->message[0] = '\0';
+    extract_string_field(input, "level", e->level, FIELD_SIZE);
+    if (!extract_string_field(input, "message", e->message, FIELD_SIZE)) {
+        if (!extract_string_field(input, "msg", e->message, FIELD_SIZE)) {
+            extract_string_field(input, "error", e->message, FIELD_SIZE);
+        }
+    }
+    e->timestamp = extract_number_field(input, "timestamp");
+    if (e->timestamp == 0) e->timestamp = extract_number_field(input, "ts");
+    if (e->timestamp == 0) e->timestamp = extract_number_field(input, "time");
+}
+
+void extract_index(const char* input, Extracted* e) {
+    alin_json_t doc;
+    strcpy(e->level, "INFO");
+    e->message[0] = '\0';
+    alin_json_index(&doc, input);
+    alin_json_string(&doc, "level", e->level, FIELD_SIZE);
+    if (!alin_json_string(&doc, "message", e->message, FIELD_SIZE)) {
+        if (!alin_json_string(&doc, "msg", e->message, FIELD_SIZE)) {
+            alin_json_string(&doc, "error", e->message, FIELD_SIZE);
+        }
+    }
+    e->timestamp = alin_json_long(&doc, "timestamp");
+    if (e->timestamp == 0) e->timestamp = alin_json_long(&doc, "ts");
+    if (e->timestamp == 0) e->timestamp = alin_json_long(&doc, "time");
+}
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * 生成与 scripts/bench_replicas.sh 相同形态的日志 (字段顺序轮换，时间戳字段名轮换)
+ */
+char** generate(int count) {
+    static const char* levels[] = { "DEBUG", "INFO", "INFO", "INFO", "WARN", "ERROR" };
+    static const char* services[] = { "api", "auth", "database", "cache", "queue", "worker" };
+    static const char* ts_keys[] = { "timestamp", "ts", "time" };
+    char** records = malloc(sizeof(char*) * count);
+    srand(42);
+    for (int i = 0; i < count && records; i++) {
+        char buf[512];
+        const char* level = levels[rand() % 6];
+        const char* service = services[rand() % 6];
+        const char* ts_key = ts_keys[i % 3];
+        if (i % 2) {
+            snprintf(buf, sizeof(buf), "{\"level\":\"%s\",\"service\":\"%s\",\"msg\":\"event %d\",\"%s\":%d,"
+                "\"request_id\":\"%08x\",\"latency_ms\":%d}", level, service, i, ts_key, 1700000000 + i,
+                rand(), rand() % 3000);
+        } else {
+            snprintf(buf, sizeof(buf), "{\"%s\":%d,\"service\":\"%s\",\"request_id\":\"%08x\","
+                "\"latency_ms\":%d,\"message\":\"user \\\"u%d\\\" done\",\"level\":\"%s\"}", ts_key,
+                1700000000 + i, service, rand(), rand() % 3000, i, level);
+        }
+        records[i] = strdup(buf);
+    }
+    return records;
+}
+
+double run(void (*extract)(const char*, Extracted*), char** records, int count, int rounds, long* checksum) {
+    Extracted e;
+    double best = 0;
+    for (int r = 0; r < rounds; r++) {
+        long sum = 0;
+        double start = now_seconds();
+        for (int i = 0; i < count; i++) {
+            extract(records[i], &e);
+            sum += e.timestamp + e.level[0] + e.message[0];
+        }
+        double elapsed = now_seconds() - start;
+        if (r == 0 || elapsed < best) best = elapsed;
+        *checksum = sum;
+    }
+    return best * 1e9 / count;
+}
+
+/**
+ * 逐字节查找第一个需转义的字符 (比对基准)
+ */
+const char* escape_reference(const char* p) {
+    while (*p && *p != '"' && *p != '\\' && *p != '\n' && *p != '\r' && *p != '\t') p++;
+    return p;
+}
+
+/**
+ * 各实现的长字符串扫描吞吐: 64MB 无引号文本，每 1MB 放一个引号/换行
+ * @return 0 成功, 1 结果与逐字节扫描不一致
+ */
+int bench_scan(int rounds) {
+    static const char* isas[] = { "avx2", "sse4.2", "scalar" };
+    char* buf = malloc(SCAN_SIZE + 1);
+    if (!buf) return 1;
+    for (size_t i = 0; i < SCAN_SIZE; i++) buf[i] = 'a' + (char)(i % 26);
+    for (size_t i = (1 << 20) - 1; i < SCAN_SIZE; i += 1 << 20) buf[i] = (i >> 20) % 2 ? '"' : '\n';
+    buf[SCAN_SIZE] = '\0';
+
+    printf("\n%-10s %14s %14s\n", "scan isa", "string GB/s", "escape GB/s");
+    int failed = 0;
+    for (int k = 0; k < 3; k++) {
+        if (alin_scan_use(isas[k]) != 0) {
+            printf("%-10s %14s %14s\n", isas[k], "-", "-");
+            continue;
+        }
+        // 结果一致性: 每个起点都与逐字节扫描比对 (含跨页与 '\0' 结尾)
+        for (size_t i = SCAN_SIZE - 8192; i < SCAN_SIZE; i++) {
+            if (alin_scan_escape(buf + i) != escape_reference(buf + i)) failed = 1;
+        }
+        double best_string = 0, best_escape = 0;
+        for (int r = 0; r < rounds; r++) {
+            double start = now_seconds();
+            for (const char* p = buf; *p; p++) p = alin_scan_string(p);
+            double mid = now_seconds();
+            for (const char* p = buf; *p; p++) p = alin_scan_escape(p);
+            double end = now_seconds();
+            if (r == 0 || mid - start < best_string) best_string = mid - start;
+            if (r == 0 || end - mid < best_escape) best_escape = end - mid;
+        }
+        printf("%-10s %14.2f %14.2f\n", isas[k], SCAN_SIZE / best_string / 1e9, SCAN_SIZE / best_escape / 1e9);
+    }
+    free(buf);
+    if (failed) fprintf(stderr, "alin_scan_escape mismatch\n");
+    return failed;
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 200000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 5;
+    if (count <= 0 || rounds <= 0) {
+        fprintf(stderr, "Usage: %s [records] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    char** records = generate(count);
+    if (!records) return 1;
+
+    // 结果一致性
+    Extracted a, b;
+    for (int i = 0; i < count; i++) {
+        extract_strstr(records[i], &a);
+        extract_index(records[i], &b);
+        if (strcmp(a.level, b.level) != 0 || strcmp(a.message, b.message) != 0 || a.timestamp != b.timestamp) {
+            fprintf(stderr, "Mismatch on record %d: %s\n", i, records[i]);
+            return 1;
+        }
+    }
+
+    // 键出现在字符串值中: strstr 会误匹配，索引只认真正的键
+    const char* trap = "{\"msg\":\"bad \\\"level\\\":\\\"FATAL\\\" text\",\"note\":\"level\",\"level\":\"info\"}";
+    extract_strstr(trap, &a);
+    extract_index(trap, &b);
+
+    long sum_strstr = 0, sum_index = 0;
+    double ns_strstr = run(extract_strstr, records, count, rounds, &sum_strstr);
+    double ns_index = run(extract_index, records, count, rounds, &sum_index);
+
+    printf("records: %d, rounds: %d (best of)\n\n", count, rounds);
+    printf("%-10s %14s %14s\n", "extractor", "ns/record", "records/sec");
+    printf("%-10s %14.1f %14.0f\n", "strstr", ns_strstr, 1e9 / ns_strstr);
+    printf("%-10s %14.1f %14.0f\n", "index", ns_index, 1e9 / ns_index);
+    printf("\nspeedup: %.2fx (checksum %s)\n", ns_strstr / ns_index, sum_strstr == sum_index ? "ok" : "MISMATCH");
+    printf("key inside a value: strstr level=\"%s\", index level=\"%s\"\n", a.level, b.level);
+
+    for (int i = 0; i < count; i++) free(records[i]);
+    free(records);
+    if (bench_scan(rounds) != 0) return 1;
+    return sum_strstr == sum_index ? 0 : 1;
+}
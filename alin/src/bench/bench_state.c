@@ -0,0 +1,277 @@
+/**
+ * ALIN 状态持久化基准 (State Durability Benchmark)
+ *
+ * 以 agg_count 形态的状态 (总数 + 按级别计数，5 个级别轮流出现) 比较每条事件的持久化方式:
+ * - save_state: 原先的 agg_count，每条事件 fopen("w") 重写整个文本文件
+ * - mmap:       alin_state 映射二进制状态文件原地更新，每秒 msync 一次 (默认策略)
+ * - wal:        alin_wal 组提交 (每组 256 条 write + fdatasync)，WAL 满 4MB 时做快照
+ * - wal-sync1:  alin_wal 每条事件提交一次 (每条都 fdatasync，最严格)
+ * - wal-nosync: alin_wal 组提交但不同步 (只防进程崩溃，与 save_state 的保证相当)
+ * 每种方式至多运行 events 条或 3 秒，按实际条数计吞吐; 结束时校验状态中的计数
+ *
+ * 恢复时间: 模拟崩溃 (不关闭、不做最后的快照) 后重新打开并恢复状态所需的时间;
+ * WAL 另测一次全部靠重放的情形 (禁用快照，恢复时重放全部 events 条增量)
+ *
+ * 使用方式:
+ *   make bench-state
+ *   alin/bin/alin_bench_state [events] [dir]    # 默认 200000 条，文件放在 alin/state 下的临时目录
+ * fdatasync 的代价取决于 dir 所在的文件系统 (tmpfs 上同步是空操作)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "alin_state.h"
+#include "alin_wal.h"
+
+#define MAX_LEVELS 16
+#define TIME_LIMIT 3.0
+
+static const char* level_names[] = { "ERROR", "WARN", "INFO", "DEBUG", "FATAL" };
+#define LEVEL_NAMES 5
+
+typedef struct {
+    char level[64];
+    alin_state_counter_t count;
+} LevelCount;
+
+typedef struct {
+    alin_state_counter_t total_count;
+    int64_t session_start;
+    _Atomic int32_t level_count;
+    int32_t reserved;
+    LevelCount levels[MAX_LEVELS];
+} State;
+
+typedef struct {
+    int64_t weight;
+    char level[64];
+} Delta;
+
+typedef struct {
+    const char* name;
+    long events;
+    double seconds;
+    double recover_seconds;
+    int64_t recovered_total;
+} Result;
+
+char work_dir[1024];
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int find_or_create_level(State* s, const char* level) {
+    int n = s->level_count;
+    for (int i = 0; i < n; i++) {
+        if (strcasecmp(s->levels[i].level, level) == 0) return i;
+    }
+    if (n >= MAX_LEVELS) return -1;
+    snprintf(s->levels[n].level, sizeof(s->levels[n].level), "%s", level);
+    s->level_count = n + 1;
+    return n;
+}
+
+static inline void count_event(State* s, const char* level, int64_t weight) {
+    alin_state_add(&s->total_count, weight);
+    int idx = find_or_create_level(s, level);
+    if (idx >= 0) alin_state_add(&s->levels[idx].count, weight);
+}
+
+void apply_delta(void* target, const void* delta, size_t len) {
+    Delta d = {0};
+    memcpy(&d, delta, len < sizeof(d) - 1 ? len : sizeof(d) - 1);
+    count_event(target, d.level, d.weight);
+}
+
+void path_of(char* out, size_t size, const char* name) {
+    snprintf(out, size, "%s/%s", work_dir, name);
+}
+
+// ===== save_state: 原先 agg_count 的文本文件 =====
+
+void save_text(const char* path, State* s) {
+    FILE* f = fopen(path, "w");
+    if (!f) return;
+    fprintf(f, "total=%ld\n", (long)s->total_count);
+    fprintf(f, "session_start=%ld\n", (long)s->session_start);
+    for (int i = 0; i < s->level_count; i++) {
+        fprintf(f, "level_%s=%ld\n", s->levels[i].level, (long)s->levels[i].count);
+    }
+    fclose(f);
+}
+
+void load_text(const char* path, State* s) {
+    FILE* f = fopen(path, "r");
+    if (!f) return;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char key[64], value[64];
+        if (sscanf(line, "%63[^=]=%63s", key, value) != 2) continue;
+        if (strcmp(key, "total") == 0) s->total_count = atol(value);
+        else if (strcmp(key, "session_start") == 0) s->session_start = atol(value);
+        else if (strncmp(key, "level_", 6) == 0) {
+            int idx = find_or_create_level(s, key + 6);
+            if (idx >= 0) s->levels[idx].count = atol(value);
+        }
+    }
+    fclose(f);
+}
+
+Result run_text(long events) {
+    Result res = { "save_state", 0, 0, 0, 0 };
+    char path[1100];
+    path_of(path, sizeof(path), "text.state");
+    static State s;
+    memset(&s, 0, sizeof(s));
+    s.session_start = (int64_t)time(NULL);
+
+    double start = now_seconds();
+    while (res.events < events) {
+        count_event(&s, level_names[res.events % LEVEL_NAMES], 1);
+        save_text(path, &s);
+        res.events++;
+        if ((res.events & 63) == 0 && now_seconds() - start > TIME_LIMIT) break;
+    }
+    res.seconds = now_seconds() - start;
+
+    static State r;
+    memset(&r, 0, sizeof(r));
+    start = now_seconds();
+    load_text(path, &r);
+    res.recover_seconds = now_seconds() - start;
+    res.recovered_total = r.total_count;
+    return res;
+}
+
+// ===== mmap: alin_state =====
+
+Result run_mmap(long events) {
+    Result res = { "mmap", 0, 0, 0, 0 };
+    char path[1100];
+    path_of(path, sizeof(path), "mmap.state");
+    alin_state_t st;
+    State* s = alin_state_open(&st, path, "bench", 1, sizeof(State));
+    if (!s) return res;
+
+    double start = now_seconds();
+    while (res.events < events) {
+        count_event(s, level_names[res.events % LEVEL_NAMES], 1);
+        alin_state_touch(&st);
+        res.events++;
+        if ((res.events & 63) == 0 && now_seconds() - start > TIME_LIMIT) break;
+    }
+    res.seconds = now_seconds() - start;
+    // 崩溃: 不做最后的检查点 (映射中的内容仍在页缓存中)
+    munmap(st.header, st.map_size);
+
+    start = now_seconds();
+    s = alin_state_open(&st, path, "bench", 1, sizeof(State));
+    res.recover_seconds = now_seconds() - start;
+    if (s) {
+        res.recovered_total = s->total_count;
+        alin_state_close(&st);
+    }
+    return res;
+}
+
+// ===== wal: alin_wal =====
+
+Result run_wal(const char* name, const char* file, long events, const char* group, const char* sync, int snapshots) {
+    Result res = { name, 0, 0, 0, 0 };
+    char path[1100];
+    path_of(path, sizeof(path), file);
+    setenv("ALIN_WAL_GROUP", group, 1);
+    setenv("ALIN_WAL_SYNC", sync, 1);
+    setenv("ALIN_WAL_COMMIT_MS", "10", 1);
+
+    static State s;
+    memset(&s, 0, sizeof(s));
+    alin_wal_t w;
+    if (alin_wal_open(&w, path, "bench", 1, &s, sizeof(s), apply_delta) < 0) return res;
+    if (!snapshots) w.snapshot_size = UINT64_MAX;
+
+    double start = now_seconds();
+    while (res.events < events) {
+        Delta d = { 1, "" };
+        const char* level = level_names[res.events % LEVEL_NAMES];
+        size_t n = strlen(level);
+        memcpy(d.level, level, n);
+        alin_wal_update(&w, &d, offsetof(Delta, level) + n);
+        res.events++;
+        if ((res.events & 63) == 0 && now_seconds() - start > TIME_LIMIT) break;
+    }
+    alin_wal_commit(&w);
+    res.seconds = now_seconds() - start;
+    // 崩溃: 不做最后的快照
+    close(w.fd);
+    free(w.buf);
+
+    static State r;
+    memset(&r, 0, sizeof(r));
+    start = now_seconds();
+    if (alin_wal_open(&w, path, "bench", 1, &r, sizeof(r), apply_delta) == 0) {
+        res.recover_seconds = now_seconds() - start;
+        res.recovered_total = r.total_count;
+        alin_wal_close(&w);
+    }
+    return res;
+}
+
+void print_result(const Result* r, double base) {
+    double rate = r->seconds > 0 ? r->events / r->seconds : 0;
+    printf("%-24s %9ld %12.0f %10.2f %9.1fx %12.3f %10s\n", r->name, r->events, rate,
+        r->events ? r->seconds * 1e6 / r->events : 0, base > 0 ? rate / base : 0,
+        r->recover_seconds * 1e3, r->recovered_total == r->events ? "ok" : "LOST");
+}
+
+int main(int argc, char* argv[]) {
+    long events = argc > 1 ? atol(argv[1]) : 200000;
+    const char* dir = argc > 2 ? argv[2] : "alin/state";
+    if (events <= 0) {
+        fprintf(stderr, "Usage: %s [events] [dir]\n", argv[0]);
+        return 1;
+    }
+    mkdir(dir, 0755);
+    snprintf(work_dir, sizeof(work_dir), "%s/bench_state.XXXXXX", dir);
+    if (!mkdtemp(work_dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    printf("State durability: %ld events (at most %.0fs each), files in %s\n\n", events, TIME_LIMIT, work_dir);
+    printf("%-24s %9s %12s %10s %10s %12s %10s\n", "mode", "events", "events/s", "us/event", "speedup",
+        "recover ms", "recovered");
+
+    Result results[6];
+    results[0] = run_text(events);
+    results[1] = run_mmap(events);
+    results[2] = run_wal("wal", "wal", events, "256", "1", 1);
+    results[3] = run_wal("wal-sync1", "wal_sync1", events, "1", "1", 1);
+    results[4] = run_wal("wal-nosync", "wal_nosync", events, "256", "0", 1);
+    results[5] = run_wal("wal (replay only)", "wal_replay", events, "256", "1", 0);
+
+    double base = results[0].seconds > 0 ? results[0].events / results[0].seconds : 0;
+    int failed = 0;
+    for (int i = 0; i < 6; i++) {
+        print_result(&results[i], base);
+        if (results[i].recovered_total != results[i].events) failed = 1;
+    }
+    printf("\n");
+
+    char cmd[1200];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", work_dir);
+    if (system(cmd) != 0) fprintf(stderr, "Cannot remove %s\n", work_dir);
+    return failed;
+}
@@ -0,0 +1,410 @@
+/**
+ * ALIN 流处理节点: dedup (重复事件抑制)
+ *
+ * 功能: 时间窗口内键相同的事件只放行第一条，其余抑制并计数
+ * 输入: 标准化 ALIN 事件 {"_type":"log","level":"ERROR","message":"Connection refused",...}
+ * 输出: 放行的事件 (原样输出，或追加 _dup) 或空 (被抑制)
+ *
+ * 键: ALIN_DEDUP_FIELDS 列出的字段 (默认 level,message) 的原文连同字段序号一起哈希为 64 位
+ *
+ * 过滤器: 定长的 cuckoo 过滤器，每个桶 4 个槽，槽中保存 32 位指纹、首次放行时间、已抑制数
+ * 与待补记录的编号; 一个键只可能位于两个候选桶之一，查找至多比较 8 个槽。内存在启动时按
+ * ALIN_DEDUP_SLOTS 一次分配 (每槽 16 字节)，与输入中键的数量无关
+ * - 窗口内再次出现: 抑制，计入该槽的抑制数 (带 _weight 的事件按权重计入)
+ * - 窗口过后再次出现: 放行并追加 "_dup":N (N 为上次放行以来抑制的条数)，窗口重新开始;
+ *   agg_count 把 _dup 计入权重，计数与抑制前一致
+ * - 新键: 写入空槽或已过期的槽; 两个桶都满时按 cuckoo 方式迁移已有的槽，
+ *   迁移失败时挤出一个槽 (该键之后再出现时当作新键放行)，事件总是放行
+ * - 补记: 抑制数没有放行事件可以携带时 (槽过期后键未再出现、槽被挤出、输入结束)，
+ *   追加一条带 "_weight":N 的补记记录 (alin_emit_extra):
+ *   {"_type":"log","level":"ERROR","message":"Connection refused","_weight":3,"_dup_flush":"expired"}
+ *   其中是首条被抑制事件的 level、timestamp 与组成键的顶层字段 (至多 PENDING_RECORD_MAX 字节，
+ *   只在键有抑制时保存); 过期的槽在空闲时每秒检查一次，输入结束时补记其余所有槽。
+ *   下游的计数因此与抑制前一致，alert_console 对补记记录不再告警
+ * 不同的键指纹碰撞的概率约为 8 / 2^32，碰撞时后者在窗口内被误当作重复
+ *
+ * 配置:
+ * - ALIN_DEDUP_FIELDS: 组成键的字段，逗号分隔 (支持点分路径)
+ * - ALIN_DEDUP_WINDOW: 窗口长度 (秒，默认 10，按处理时间计)
+ * - ALIN_DEDUP_SLOTS: 槽数 (默认 65536，向上取整为 4 的 2 的幂倍)
+ *
+ * 统计: 结束时输出放行、抑制、挤出的条数，补记的记录数，以及未能补记的抑制数
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "alin_node.h"
+#include "alin_json.h"
+
+#define MAX_KEY_FIELDS 8
+#define MAX_FIELD_PATH 128
+#define BUCKET_SLOTS 4
+#define MAX_KICKS 128            // cuckoo 迁移的最大步数
+#define PENDING_RECORD_MAX 1024  // 补记记录中保存的字段 (不含 _weight 等尾部)
+
+typedef struct {
+    uint32_t fingerprint;        // 0 表示空槽
+    uint32_t first_seen;         // 本窗口首次放行的时间 (秒，相对启动时间)
+    uint32_t suppressed;         // 本窗口已抑制的条数 (按权重)
+    uint32_t pending;            // 补记记录的编号 (0 表示没有)
+} Slot;
+
+typedef struct {
+    Slot slots[BUCKET_SLOTS];
+} Bucket;
+
+// 配置
+static char key_fields[MAX_KEY_FIELDS][MAX_FIELD_PATH];
+static int key_field_count = 0;
+static uint32_t window = 10;
+
+// 过滤器
+static Bucket* buckets = NULL;
+static uint64_t bucket_mask = 0;
+static int64_t started_ns = 0;
+static uint64_t kick_state = 0x9e3779b97f4a7c15ull;
+
+// 补记记录: 编号 1..slot_count，空闲编号放在栈中
+static char** pending_records = NULL;
+static uint32_t* free_ids = NULL;
+static uint32_t free_count = 0;
+static uint32_t last_sweep = 0;
+
+// 统计
+static long passed = 0;
+static long suppressed_total = 0;
+static long evicted = 0;                // 窗口未过就被挤出的槽
+static long flushed = 0;                // 补记的记录数
+static long unreported = 0;             // 未能补记的抑制数 (内存不足)
+static int configured = 0;
+
+static char flush_buf[PENDING_RECORD_MAX + 64];
+
+// ===== 哈希 =====
+
+static inline uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * 按 8 字节一组累积 (不逐字节)，末尾不足 8 字节的部分补零
+ */
+static uint64_t hash_bytes(uint64_t h, const char* data, size_t len) {
+    const uint64_t k = 0x9fb21c651e98df25ull;
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, data, 8);
+        h = (h ^ w) * k;
+        h ^= h >> 29;
+        data += 8;
+        len -= 8;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data, len);
+    h = (h ^ tail ^ ((uint64_t)len << 56)) * k;
+    return h ^ (h >> 29);
+}
+
+// ===== 配置 =====
+
+static void on_idle(int final);
+static void report();
+
+/**
+ * 读取配置并分配过滤器
+ * @return 0 成功, -1 失败
+ */
+static int configure() {
+    const char* fields = getenv("ALIN_DEDUP_FIELDS");
+    if (!fields || !fields[0]) fields = "level,message";
+    for (const char* p = fields; *p; ) {
+        const char* comma = strchr(p, ',');
+        size_t len = comma ? (size_t)(comma - p) : strlen(p);
+        if (len > 0) {
+            if (key_field_count >= MAX_KEY_FIELDS || len >= MAX_FIELD_PATH) {
+                fprintf(stderr, "[DEDUP] Too many or too long key fields (at most %d of %d bytes)\n",
+                    MAX_KEY_FIELDS, MAX_FIELD_PATH - 1);
+                return -1;
+            }
+            memcpy(key_fields[key_field_count], p, len);
+            key_fields[key_field_count++][len] = '\0';
+        }
+        p += len + (comma ? 1 : 0);
+    }
+    if (key_field_count == 0) {
+        fprintf(stderr, "[DEDUP] ALIN_DEDUP_FIELDS lists no fields\n");
+        return -1;
+    }
+
+    const char* window_str = getenv("ALIN_DEDUP_WINDOW");
+    if (window_str && atol(window_str) > 0) window = (uint32_t)atol(window_str);
+
+    const char* slots_str = getenv("ALIN_DEDUP_SLOTS");
+    uint64_t slots = slots_str && atoll(slots_str) > 0 ? (uint64_t)atoll(slots_str) : 65536;
+    uint64_t count = 2;          // 桶数至少为 2 (两个候选桶)
+    while (count * BUCKET_SLOTS < slots) count <<= 1;
+    buckets = calloc(count, sizeof(Bucket));
+    if (!buckets) {
+        fprintf(stderr, "[DEDUP] Cannot allocate %llu slots\n", (unsigned long long)(count * BUCKET_SLOTS));
+        return -1;
+    }
+    bucket_mask = count - 1;
+
+    uint64_t slot_count = count * BUCKET_SLOTS;
+    pending_records = calloc(slot_count + 1, sizeof(char*));
+    free_ids = malloc(slot_count * sizeof(uint32_t));
+    if (!pending_records || !free_ids) {
+        fprintf(stderr, "[DEDUP] Cannot allocate %llu slots\n", (unsigned long long)slot_count);
+        return -1;
+    }
+    for (uint64_t id = slot_count; id >= 1; id--) free_ids[free_count++] = (uint32_t)id;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    started_ns = (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    // 宿主进程中不经过 main，回调在这里注册
+    alin_set_idle_hook(on_idle);
+    atexit(report);
+    fprintf(stderr, "[DEDUP] %llu slots (%llu KB), window %us, key %s\n",
+        (unsigned long long)slot_count, (unsigned long long)(count * sizeof(Bucket) / 1024),
+        window, fields);
+    return 0;
+}
+
+static uint32_t now_seconds() {
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (uint32_t)(((int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec - started_ns) / 1000000000);
+}
+
+static void report() {
+    if (passed + suppressed_total <= 1) return;    // 单次模式不汇总
+    fprintf(stderr, "[DEDUP] passed %ld, suppressed %ld, evicted %ld, flushed %ld, unreported %ld\n",
+        passed, suppressed_total, evicted, flushed, unreported);
+}
+
+// ===== 过滤器 =====
+
+static inline uint64_t alternate(uint64_t index, uint32_t fingerprint) {
+    return (index ^ mix64(fingerprint)) & bucket_mask;
+}
+
+static inline int live(const Slot* s, uint32_t now) {
+    return s->fingerprint != 0 && now - s->first_seen < window;
+}
+
+/**
+ * 在两个候选桶中查找指纹
+ * @return 槽, NULL 表示不存在
+ */
+static Slot* find_slot(uint64_t i1, uint64_t i2, uint32_t fingerprint) {
+    for (int k = 0; k < BUCKET_SLOTS; k++) {
+        if (buckets[i1].slots[k].fingerprint == fingerprint) return &buckets[i1].slots[k];
+        if (buckets[i2].slots[k].fingerprint == fingerprint) return &buckets[i2].slots[k];
+    }
+    return NULL;
+}
+
+// ===== 补记 =====
+
+/**
+ * 追加一个成员的原文 ("key":value)，放不下时不追加
+ */
+static size_t append_member(char* buf, size_t pos, const alin_json_field_t* f) {
+    const char* quote = f->type == ALIN_JSON_STRING ? "\"" : "";
+    int n = snprintf(buf + pos, PENDING_RECORD_MAX - pos, ",\"%.*s\":%s%.*s%s",
+        (int)f->key_len, f->key, quote, (int)f->value_len, f->value, quote);
+    return n > 0 && (size_t)n < PENDING_RECORD_MAX - pos ? pos + (size_t)n : pos;
+}
+
+/**
+ * 键第一次被抑制时保存补记记录的字段: level、timestamp 与组成键的字段所在的顶层成员
+ */
+static void save_pending(Slot* s, const alin_json_t* doc) {
+    if (s->pending != 0 || free_count == 0) return;
+    char buf[PENDING_RECORD_MAX];
+    size_t pos = (size_t)snprintf(buf, sizeof(buf), "{\"_type\":\"log\"");
+
+    const char* members[MAX_KEY_FIELDS + 2];      // 已写入成员的键 (在记录中的位置)
+    int member_count = 0;
+    const char* paths[MAX_KEY_FIELDS + 2] = { "level", "timestamp" };
+    for (int i = 0; i < key_field_count; i++) paths[i + 2] = key_fields[i];
+    for (int i = 0; i < key_field_count + 2; i++) {
+        const alin_json_field_t* f = alin_json_find(doc, paths[i]);
+        // 宽记录中扫描找到的嵌套字段没有所在对象的索引项，不知道顶层成员
+        if (!f || (f->parent < 0 && strchr(paths[i], '.'))) continue;
+        while (f->parent >= 0) f = &doc->fields[f->parent];
+        int seen = 0;
+        for (int j = 0; j < member_count && !seen; j++) seen = members[j] == f->key;
+        if (seen || (f->key_len == 5 && memcmp(f->key, "_type", 5) == 0)) continue;
+        members[member_count++] = f->key;
+        pos = append_member(buf, pos, f);
+    }
+
+    char* record = malloc(pos + 1);
+    if (!record) return;
+    memcpy(record, buf, pos);
+    record[pos] = '\0';
+    s->pending = free_ids[--free_count];
+    pending_records[s->pending] = record;
+}
+
+static void release_pending(Slot* s) {
+    if (s->pending == 0) return;
+    free(pending_records[s->pending]);
+    pending_records[s->pending] = NULL;
+    free_ids[free_count++] = s->pending;
+    s->pending = 0;
+}
+
+/**
+ * 槽中的抑制数不会再随放行事件带出 (过期、挤出或输入结束): 追加补记记录
+ */
+static void flush_slot(Slot* s, const char* reason) {
+    if (s->suppressed > 0) {
+        const char* fields = s->pending ? pending_records[s->pending] : "{\"_type\":\"log\"";
+        int n = snprintf(flush_buf, sizeof(flush_buf), "%s,\"_weight\":%u,\"_dup_flush\":\"%s\"}",
+            fields, s->suppressed, reason);
+        if (n > 0 && (size_t)n < sizeof(flush_buf) && alin_emit_extra(flush_buf, (size_t)n) == 0) flushed++;
+        else unreported += s->suppressed;
+        s->suppressed = 0;
+    }
+    release_pending(s);
+}
+
+/**
+ * 空闲回调: 每秒至多一次补记已过期的槽 (槽仍保留，键再次出现时照常放行);
+ * 输入结束时补记所有槽
+ */
+static void on_idle(int final) {
+    if (configured <= 0) return;
+    uint32_t now = now_seconds();
+    if (!final && now == last_sweep) return;
+    last_sweep = now;
+    for (uint64_t i = 0; i <= bucket_mask; i++) {
+        for (int k = 0; k < BUCKET_SLOTS; k++) {
+            Slot* s = &buckets[i].slots[k];
+            if (s->suppressed > 0 && (final || !live(s, now))) flush_slot(s, final ? "final" : "expired");
+        }
+    }
+}
+
+static Slot* free_slot(uint64_t index, uint32_t now) {
+    for (int k = 0; k < BUCKET_SLOTS; k++) {
+        Slot* s = &buckets[index].slots[k];
+        if (!live(s, now)) {
+            if (s->fingerprint != 0) flush_slot(s, "expired");
+            return s;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * 写入新键: 先找空槽或过期槽，都满时沿 cuckoo 路径迁移
+ */
+static void insert(uint64_t i1, uint64_t i2, uint32_t fingerprint, uint32_t now) {
+    Slot* s = free_slot(i1, now);
+    if (!s) s = free_slot(i2, now);
+    if (s) {
+        s->fingerprint = fingerprint;
+        s->first_seen = now;
+        s->suppressed = 0;
+        s->pending = 0;
+        return;
+    }
+
+    Slot carry = { fingerprint, now, 0, 0 };
+    uint64_t index = (kick_state & 1) ? i1 : i2;
+    for (int kick = 0; kick < MAX_KICKS; kick++) {
+        kick_state = mix64(kick_state);
+        Slot* victim = &buckets[index].slots[kick_state % BUCKET_SLOTS];
+        Slot moved = *victim;
+        *victim = carry;
+        carry = moved;
+        index = alternate(index, carry.fingerprint);
+        if ((s = free_slot(index, now)) != NULL) {
+            *s = carry;
+            return;
+        }
+    }
+    evicted++;    // 路径过长: 放弃最后被挤出的槽
+    flush_slot(&carry, "evicted");
+}
+
+int process(const char* input, char* output, size_t output_size) {
+    if (configured == 0) configured = configure() == 0 ? 1 : -1;
+    if (configured < 0) return -1;
+
+    alin_json_t doc;
+    alin_input_index(&doc, input);
+    uint64_t h = 0x243f6a8885a308d3ull;
+    for (int i = 0; i < key_field_count; i++) {
+        const alin_json_field_t* f = alin_json_find(&doc, key_fields[i]);
+        h = hash_bytes(h ^ (uint64_t)(i + 1), f ? f->value : "", f ? f->value_len : 0);
+    }
+    h = mix64(h);
+
+    uint32_t fingerprint = (uint32_t)(h >> 32);
+    if (fingerprint == 0) fingerprint = 1;
+    uint64_t i1 = h & bucket_mask;
+    uint64_t i2 = alternate(i1, fingerprint);
+    uint32_t now = now_seconds();
+
+    Slot* s = find_slot(i1, i2, fingerprint);
+    if (s && live(s, now)) {
+        long weight = alin_json_long(&doc, "_weight");
+        if (weight < 1) weight = 1;
+        s->suppressed += (uint32_t)weight;
+        suppressed_total++;
+        save_pending(s, &doc);
+        output[0] = '\0';
+        return 0;
+    }
+
+    passed++;
+    if (!s) {
+        insert(i1, i2, fingerprint, now);
+        return ALIN_PASS;
+    }
+
+    // 窗口已过: 放行并带上上个窗口抑制的条数
+    uint32_t dup = s->suppressed;
+    s->first_seen = now;
+    s->suppressed = 0;
+    release_pending(s);
+    size_t len = strlen(input);
+    if (dup == 0 || len == 0 || input[len - 1] != '}') return ALIN_PASS;
+
+    // 在原 JSON 末尾追加 _dup
+    int n = snprintf(output, output_size, "%.*s%s\"_dup\":%u}",
+        (int)(len - 1), input, len > 2 ? "," : "", dup);
+
+    // 输入带字段表时沿用其中的位置 (前缀不变)，只编入追加的 _dup
+    const alin_fields_t* fields = alin_input_meta()->fields;
+    alin_json_t out_doc;
+    if (fields && (size_t)n < output_size && alin_json_unpack(&out_doc, output, len - 1, fields) >= 0) {
+        alin_json_resume(&out_doc, output + len - 1);
+        alin_set_output_fields(&out_doc);
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    configured = configure() == 0 ? 1 : -1;
+    if (configured < 0) return 1;
+    return alin_node_main(argc, argv, process, 0);
+}
@@ -0,0 +1,649 @@
+/**
+ * ALIN 流处理节点: filter_expr (表达式过滤器)
+ *
+ * 功能: 按字段表达式过滤事件，满足规则的事件原样输出，其余丢弃
+ * 输入: 标准化 ALIN 事件 {"_type":"log","level":"ERROR","service":"db","latency_ms":812,...}
+ * 输出: 满足规则的事件 (原样输出) 或空 (被过滤)
+ *
+ * 规则: level>=WARN && service=="db" && latency_ms>500
+ * - 比较: == != < <= > >= 以及 ~ (字符串包含); 只写字段名表示字段存在且不为 false/null
+ * - 组合: && || ! 与括号; 字段可用点分路径 (如 _agg.total)
+ * - 字面量: 数字、"字符串"、true/false/null; level 与级别名比较时按优先级
+ *   (DEBUG < INFO < WARN < ERROR < FATAL，同 filter_level，RAW 当作 INFO)
+ * - 记录缺少该字段或类型不符时，比较不成立 (!= 也不成立)
+ *
+ * 编译: 启动时解析一次规则，&& / || 的操作数按代价重排 (帧头中已有的 level/_type/timestamp
+ *       最先，其次数值与字符串比较，包含最后)，再编成分支程序: 每条指令是一次字段比较，
+ *       带成立/不成立两个跳转目标 (下一条指令、通过或丢弃)，求值沿跳转走到结果为止
+ * 求值: 不分配内存; 只用到帧头字段时不扫描负载，用到其他字段时才建立一次字段索引
+ *
+ * 规则来源 (依次):
+ * - 命令行参数给出的规则文件: 以 "#!<filter_expr 节点的绝对路径>" 开头的可执行规则文件
+ *   放在 alin/nodes 下即可像节点一样链接到槽位，热切换规则就是切换链接
+ *   (alin_host 按 .so 加载插件，其中改用环境变量)
+ * - 环境变量 ALIN_FILTER_EXPR_FILE (规则文件路径)
+ * - 环境变量 ALIN_FILTER_EXPR (规则文本)
+ * 规则中 # 至行尾为注释
+ *
+ * 并行: 无跨记录状态，可用 alin_runner -r <slot>=N 运行多个副本
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#include "alin_node.h"
+#include "alin_json.h"
+
+#define MAX_RULE 8192          // 规则文本的上限
+#define MAX_POOL 8192          // 字段路径与字符串字面量
+#define MAX_NODES 256          // 语法树节点
+#define MAX_TESTS 128          // 比较指令 (语法树的叶子)
+#define MAX_TERMS 64           // 一组 && 或 || 的操作数
+#define TEXT_BUF 4096          // 求值时反转义字符串字段的缓冲 (更长的按转义形式比较)
+
+// 跳转目标: 非负为下一条指令
+#define RESULT_DROP -1
+#define RESULT_PASS -2
+
+enum { OP_EXISTS, OP_EQ, OP_NE, OP_LT, OP_LE, OP_GT, OP_GE, OP_CONTAINS };
+
+// 字段来源: 帧头中已有的先取帧头，没有时退回字段索引
+enum { FIELD_PATH, FIELD_LEVEL, FIELD_TYPE, FIELD_TIMESTAMP };
+
+enum { LIT_NONE, LIT_NUMBER, LIT_STRING, LIT_LEVEL, LIT_TRUE, LIT_FALSE, LIT_NULL };
+
+// 一条比较指令
+typedef struct {
+    uint8_t field;              // FIELD_*
+    uint8_t op;                 // OP_*
+    uint8_t lit;                // LIT_*
+    int level;                  // LIT_LEVEL: 级别优先级
+    double number;              // LIT_NUMBER
+    const char* str;            // LIT_STRING: 反转义后的值
+    size_t str_len;
+    const char* esc;            // LIT_STRING: JSON 转义形式 (与未反转义的长字段比较)
+    size_t esc_len;
+    const char* path;           // 字段路径
+    int next[2];                // [0] 不成立 / [1] 成立: 下一条指令或 RESULT_*
+} Test;
+
+// 语法树 (只在编译时使用)
+enum { NODE_TEST, NODE_NOT, NODE_AND, NODE_OR };
+
+typedef struct {
+    int kind;
+    Test test;                  // NODE_TEST
+    int child;                  // 第一个操作数 (NOT 的唯一操作数)
+    int sibling;                // 同组的下一个操作数 (-1 表示没有)
+    int cost;                   // 估计的求值代价，同组操作数按此排序
+} Node;
+
+typedef struct {
+    const char* src;
+    const char* p;
+    const char* error;          // 第一个错误 (NULL 表示没有)
+    const char* error_at;
+} Parser;
+
+static Node nodes[MAX_NODES];
+static int node_count = 0;
+static int test_count = 0;
+static char pool[MAX_POOL];
+static size_t pool_len = 0;
+
+static Test program[MAX_TESTS];
+static int program_len = 0;
+static int program_entry = RESULT_DROP;
+static int rule_state = 0;             // 0 未加载, 1 已编译, -1 加载失败
+
+// ===== 级别 =====
+
+typedef struct {
+    const char* name;
+    int priority;
+} LevelName;
+
+static const LevelName level_names[] = {
+    { "DEBUG", 0 }, { "TRACE", 0 }, { "INFO", 1 }, { "WARN", 2 }, { "WARNING", 2 },
+    { "ERROR", 3 }, { "ERR", 3 }, { "FATAL", 4 }, { "CRITICAL", 4 }, { "RAW", 1 }
+};
+
+// 帧头级别编码 (ALIN_LEVEL_*) → 优先级
+static const int level_code_priority[] = { -1, 0, 1, 2, 3, 4, 1 };
+
+/**
+ * 级别名 (不区分大小写) → 优先级
+ * @return 优先级, -1 表示未知级别
+ */
+static int level_priority(const char* name, size_t len) {
+    for (size_t i = 0; i < sizeof(level_names) / sizeof(level_names[0]); i++) {
+        if (strlen(level_names[i].name) == len && strncasecmp(name, level_names[i].name, len) == 0) {
+            return level_names[i].priority;
+        }
+    }
+    return -1;
+}
+
+// ===== 解析 =====
+
+static void parse_error(Parser* ps, const char* message) {
+    if (ps->error) return;
+    ps->error = message;
+    ps->error_at = ps->p;
+}
+
+static void skip_space(Parser* ps) {
+    for (;;) {
+        while (isspace((unsigned char)*ps->p)) ps->p++;
+        if (*ps->p != '#') return;
+        while (*ps->p && *ps->p != '\n') ps->p++;
+    }
+}
+
+static int accept_token(Parser* ps, const char* token) {
+    skip_space(ps);
+    size_t n = strlen(token);
+    if (strncmp(ps->p, token, n) != 0) return 0;
+    ps->p += n;
+    return 1;
+}
+
+/**
+ * 复制到字符串池 (以 '\0' 结尾)
+ */
+static const char* pool_add(Parser* ps, const char* s, size_t len) {
+    if (pool_len + len + 1 > MAX_POOL) {
+        parse_error(ps, "rule too large");
+        return "";
+    }
+    char* dst = pool + pool_len;
+    memcpy(dst, s, len);
+    dst[len] = '\0';
+    pool_len += len + 1;
+    return dst;
+}
+
+static int new_node(Parser* ps, int kind) {
+    if (node_count >= MAX_NODES) {
+        parse_error(ps, "too many terms");
+        return 0;
+    }
+    Node* n = &nodes[node_count];
+    memset(n, 0, sizeof(*n));
+    n->kind = kind;
+    n->child = -1;
+    n->sibling = -1;
+    return node_count++;
+}
+
+/**
+ * 字符串字面量: 反转义后的值与 JSON 转义形式都放入字符串池
+ */
+static void parse_string(Parser* ps, Test* t) {
+    char value[MAX_RULE];
+    char escaped[MAX_RULE];
+    size_t n = 0, e = 0;
+    ps->p++;
+    while (*ps->p && *ps->p != '"') {
+        char c = *ps->p++;
+        if (c == '\\') {
+            switch (*ps->p++) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case '"': c = '"'; break;
+                case '\\': c = '\\'; break;
+                default: parse_error(ps, "unsupported escape in string"); return;
+            }
+        }
+        value[n++] = c;
+        // 与 parse_json 写出的转义形式一致
+        switch (c) {
+            case '"': escaped[e++] = '\\'; escaped[e++] = '"'; break;
+            case '\\': escaped[e++] = '\\'; escaped[e++] = '\\'; break;
+            case '\n': escaped[e++] = '\\'; escaped[e++] = 'n'; break;
+            case '\r': escaped[e++] = '\\'; escaped[e++] = 'r'; break;
+            case '\t': escaped[e++] = '\\'; escaped[e++] = 't'; break;
+            default: escaped[e++] = c;
+        }
+    }
+    if (*ps->p != '"') {
+        parse_error(ps, "unterminated string");
+        return;
+    }
+    ps->p++;
+    t->lit = LIT_STRING;
+    t->str = pool_add(ps, value, n);
+    t->str_len = n;
+    t->esc = pool_add(ps, escaped, e);
+    t->esc_len = e;
+}
+
+/**
+ * 比较右侧的字面量
+ */
+static void parse_literal(Parser* ps, Test* t) {
+    skip_space(ps);
+    const char* p = ps->p;
+    if (*p == '"') {
+        parse_string(ps, t);
+    } else if (isdigit((unsigned char)*p) || *p == '-' || *p == '.') {
+        char* end;
+        t->number = strtod(p, &end);
+        if (end == p) {
+            parse_error(ps, "expected number");
+            return;
+        }
+        t->lit = LIT_NUMBER;
+        ps->p = end;
+    } else if (isalpha((unsigned char)*p)) {
+        while (isalnum((unsigned char)*ps->p) || *ps->p == '_') ps->p++;
+        size_t len = (size_t)(ps->p - p);
+        if (len == 4 && strncmp(p, "true", 4) == 0) t->lit = LIT_TRUE;
+        else if (len == 5 && strncmp(p, "false", 5) == 0) t->lit = LIT_FALSE;
+        else if (len == 4 && strncmp(p, "null", 4) == 0) t->lit = LIT_NULL;
+        else if ((t->level = level_priority(p, len)) >= 0) t->lit = LIT_LEVEL;
+        else {
+            ps->p = p;
+            parse_error(ps, "unknown identifier (strings need quotes)");
+        }
+    } else {
+        parse_error(ps, "expected literal");
+    }
+}
+
+/**
+ * 检查比较是否有意义，并按字段把字面量转成求值时的形式
+ */
+static void check_test(Parser* ps, Test* t, const char* at) {
+    const char* error = NULL;
+    if (t->op == OP_EXISTS) return;
+
+    if (t->field == FIELD_LEVEL) {
+        // level 只与级别名比较 (写成字符串也可以)
+        if (t->lit == LIT_STRING && (t->level = level_priority(t->str, t->str_len)) >= 0) t->lit = LIT_LEVEL;
+        if (t->lit != LIT_LEVEL) error = "level compares with a level name (DEBUG/INFO/WARN/ERROR/FATAL)";
+        else if (t->op == OP_CONTAINS) error = "~ needs a string";
+    } else if (t->lit == LIT_LEVEL) {
+        error = "unknown identifier (strings need quotes)";
+    } else if (t->op == OP_CONTAINS && t->lit != LIT_STRING) {
+        error = "~ needs a string";
+    } else if ((t->lit == LIT_TRUE || t->lit == LIT_FALSE || t->lit == LIT_NULL) &&
+               t->op != OP_EQ && t->op != OP_NE) {
+        error = "true/false/null only compare with == or !=";
+    } else if (t->field == FIELD_TIMESTAMP && t->lit != LIT_NUMBER) {
+        error = "timestamp compares with a number";
+    }
+    if (error) {
+        ps->p = at;
+        parse_error(ps, error);
+    }
+}
+
+/**
+ * 一次比较: 字段 [运算符 字面量]
+ */
+static int parse_comparison(Parser* ps) {
+    skip_space(ps);
+    const char* start = ps->p;
+    while (isalnum((unsigned char)*ps->p) || *ps->p == '_' || *ps->p == '.') ps->p++;
+    if (ps->p == start) {
+        parse_error(ps, "expected field name");
+        return 0;
+    }
+
+    int n = new_node(ps, NODE_TEST);
+    Test* t = &nodes[n].test;
+    size_t len = (size_t)(ps->p - start);
+    t->path = pool_add(ps, start, len);
+    if (strcmp(t->path, "level") == 0) t->field = FIELD_LEVEL;
+    else if (strcmp(t->path, "_type") == 0) t->field = FIELD_TYPE;
+    else if (strcmp(t->path, "timestamp") == 0) t->field = FIELD_TIMESTAMP;
+    else t->field = FIELD_PATH;
+
+    // 两字符的运算符先于其前缀匹配
+    static const struct { const char* token; int op; } ops[] = {
+        { "==", OP_EQ }, { "!=", OP_NE }, { "<=", OP_LE }, { ">=", OP_GE },
+        { "<", OP_LT }, { ">", OP_GT }, { "~", OP_CONTAINS }
+    };
+    t->op = OP_EXISTS;
+    for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        if (accept_token(ps, ops[i].token)) {
+            t->op = (uint8_t)ops[i].op;
+            break;
+        }
+    }
+    if (t->op != OP_EXISTS) parse_literal(ps, t);
+    check_test(ps, t, start);
+
+    // 帧头字段最便宜; 字符串比较按长度、包含按扫描计
+    if (t->field != FIELD_PATH) nodes[n].cost = 1;
+    else if (t->lit == LIT_STRING) nodes[n].cost = t->op == OP_CONTAINS ? 16 : 6;
+    else nodes[n].cost = 4;
+    test_count++;
+    return n;
+}
+
+static int parse_or(Parser* ps);
+
+static int parse_unary(Parser* ps) {
+    if (accept_token(ps, "!")) {
+        int n = new_node(ps, NODE_NOT);
+        int child = parse_unary(ps);
+        if (ps->error) return n;
+        nodes[n].child = child;
+        nodes[n].cost = nodes[child].cost;
+        return n;
+    }
+    if (accept_token(ps, "(")) {
+        int n = parse_or(ps);
+        if (!accept_token(ps, ")")) parse_error(ps, "expected )");
+        return n;
+    }
+    return parse_comparison(ps);
+}
+
+/**
+ * 把 child 并入 group 的操作数 (同类的组展开，重排时可以跨越括号)
+ */
+static void add_term(Node* group, int* tail, int child) {
+    int first = nodes[child].kind == group->kind ? nodes[child].child : child;
+    if (*tail < 0) group->child = first;
+    else nodes[*tail].sibling = first;
+    for (int c = first; c >= 0; c = nodes[c].sibling) {
+        *tail = c;
+        group->cost += nodes[c].cost;
+    }
+}
+
+/**
+ * 一组以 token 连接的操作数
+ */
+static int parse_group(Parser* ps, int kind, const char* token, int (*operand)(Parser*)) {
+    int first = operand(ps);
+    if (ps->error) return first;
+    skip_space(ps);
+    if (strncmp(ps->p, token, 2) != 0) return first;
+
+    int n = new_node(ps, kind);
+    int tail = -1;
+    add_term(&nodes[n], &tail, first);
+    while (!ps->error && accept_token(ps, token)) {
+        int next = operand(ps);
+        if (ps->error) break;   // 出错时 next 可能不是新节点，不能再挂入链表
+        add_term(&nodes[n], &tail, next);
+    }
+    return n;
+}
+
+static int parse_and(Parser* ps) {
+    return parse_group(ps, NODE_AND, "&&", parse_unary);
+}
+
+static int parse_or(Parser* ps) {
+    return parse_group(ps, NODE_OR, "||", parse_and);
+}
+
+// ===== 编译 =====
+
+/**
+ * 组内操作数按代价升序 (稳定)，便宜的先求值、先短路
+ */
+static int sorted_terms(const Node* group, int* terms) {
+    int k = 0;
+    for (int c = group->child; c >= 0 && k < MAX_TERMS; c = nodes[c].sibling) {
+        int i = k++;
+        while (i > 0 && nodes[terms[i - 1]].cost > nodes[c].cost) {
+            terms[i] = terms[i - 1];
+            i--;
+        }
+        terms[i] = c;
+    }
+    return k;
+}
+
+/**
+ * 编出节点 n: 成立时跳到 on_true，不成立时跳到 on_false
+ * @return 入口指令 (或直接是结果)
+ */
+static int emit(int n, int on_true, int on_false) {
+    Node* node = &nodes[n];
+    if (node->kind == NODE_TEST) {
+        Test* t = &program[program_len];
+        *t = node->test;
+        t->next[1] = on_true;
+        t->next[0] = on_false;
+        return program_len++;
+    }
+    if (node->kind == NODE_NOT) return emit(node->child, on_false, on_true);
+
+    // 从最后一个操作数往前编，前一个操作数的后继即后一个的入口
+    int terms[MAX_TERMS];
+    int k = sorted_terms(node, terms);
+    int target = node->kind == NODE_AND ? on_true : on_false;
+    for (int i = k - 1; i >= 0; i--) {
+        target = node->kind == NODE_AND ? emit(terms[i], target, on_false)
+                                        : emit(terms[i], on_true, target);
+    }
+    return target;
+}
+
+/**
+ * 解析并编译规则
+ * @return 0 成功, -1 规则有误 (已输出错误位置)
+ */
+static int compile_rule(const char* rule) {
+    Parser ps = { rule, rule, NULL, NULL };
+    node_count = 0;
+    test_count = 0;
+    pool_len = 0;
+    program_len = 0;
+
+    int root = parse_or(&ps);
+    skip_space(&ps);
+    if (!ps.error && *ps.p) parse_error(&ps, "unexpected input");
+    if (!ps.error && test_count > MAX_TESTS) parse_error(&ps, "too many comparisons");
+    for (int i = 0; !ps.error && i < node_count; i++) {
+        int k = 0;
+        for (int c = nodes[i].kind >= NODE_AND ? nodes[i].child : -1; c >= 0; c = nodes[c].sibling) k++;
+        if (k > MAX_TERMS) parse_error(&ps, "too many terms in one group");
+    }
+    if (ps.error) {
+        int line = 1, column = 1;
+        for (const char* p = rule; p < ps.error_at; p++) {
+            if (*p == '\n') { line++; column = 1; } else column++;
+        }
+        fprintf(stderr, "[FILTER] Rule error at %d:%d: %s\n", line, column, ps.error);
+        return -1;
+    }
+
+    program_entry = emit(root, RESULT_PASS, RESULT_DROP);
+    return 0;
+}
+
+/**
+ * 读取规则: 参数中的规则文件、ALIN_FILTER_EXPR_FILE、ALIN_FILTER_EXPR 依次
+ * @return 0 成功, -1 没有规则或规则有误
+ */
+static int load_rule(int argc, char* argv[]) {
+    static char text[MAX_RULE];
+    const char* path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            path = argv[i];
+            break;
+        }
+    }
+    if (!path) path = getenv("ALIN_FILTER_EXPR_FILE");
+
+    const char* rule = NULL;
+    if (path && path[0]) {
+        FILE* f = fopen(path, "r");
+        if (!f) {
+            fprintf(stderr, "[FILTER] Cannot open rule file %s\n", path);
+            return -1;
+        }
+        size_t n = fread(text, 1, sizeof(text), f);
+        fclose(f);
+        if (n == sizeof(text)) {
+            fprintf(stderr, "[FILTER] Rule file %s exceeds %d bytes\n", path, MAX_RULE - 1);
+            return -1;
+        }
+        text[n] = '\0';
+        rule = text;    // 首行的 #! 按注释跳过
+    } else {
+        rule = getenv("ALIN_FILTER_EXPR");
+    }
+    if (!rule || !rule[0]) {
+        fprintf(stderr, "[FILTER] No rule: pass a rule file or set ALIN_FILTER_EXPR / ALIN_FILTER_EXPR_FILE\n");
+        return -1;
+    }
+    return compile_rule(rule);
+}
+
+// ===== 求值 =====
+
+// 当前记录: 字段索引在第一次用到负载字段时才建立
+typedef struct {
+    const char* input;
+    int indexed;
+    alin_json_t doc;
+} Record;
+
+static const alin_json_t* record_index(Record* rec) {
+    if (!rec->indexed) {
+        alin_input_index(&rec->doc, rec->input);
+        rec->indexed = 1;
+    }
+    return &rec->doc;
+}
+
+static inline int compare(int op, int cmp) {
+    switch (op) {
+        case OP_EQ: return cmp == 0;
+        case OP_NE: return cmp != 0;
+        case OP_LT: return cmp < 0;
+        case OP_LE: return cmp <= 0;
+        case OP_GT: return cmp > 0;
+        case OP_GE: return cmp >= 0;
+    }
+    return 0;
+}
+
+static inline int compare_number(int op, double a, double b) {
+    return compare(op, (a > b) - (a < b));
+}
+
+/**
+ * 字符串与字面量比较 (text 与 lit 同为反转义后或同为转义形式)
+ */
+static int match_text(int op, const char* text, size_t len, const char* lit, size_t lit_len) {
+    if (op == OP_CONTAINS) return lit_len == 0 || memmem(text, len, lit, lit_len) != NULL;
+    int cmp = memcmp(text, lit, len < lit_len ? len : lit_len);
+    if (cmp == 0) cmp = (len > lit_len) - (len < lit_len);
+    return compare(op, cmp);
+}
+
+/**
+ * 数值字段 (或内容是数字的字符串字段)
+ * @return 1 取到数值, 0 不是数字
+ */
+static int field_number(const alin_json_field_t* f, double* value) {
+    if (f->type != ALIN_JSON_NUMBER && f->type != ALIN_JSON_STRING) return 0;
+    if (f->value_len == 0) return 0;
+    char* end;
+    *value = strtod(f->value, &end);
+    if (f->type == ALIN_JSON_STRING) return end == f->value + f->value_len;
+    return end != f->value;
+}
+
+static int eval_string(const Test* t, const alin_json_t* doc, const alin_json_field_t* f) {
+    if (f->type != ALIN_JSON_STRING && f->type != ALIN_JSON_NUMBER) return 0;
+    if (f->type != ALIN_JSON_STRING || !f->escaped) {
+        return match_text(t->op, f->value, f->value_len, t->str, t->str_len);
+    }
+    // 含转义: 较短的反转义到栈上比较，过长的直接与字面量的转义形式比较
+    if (f->value_len < TEXT_BUF) {
+        char text[TEXT_BUF];
+        alin_json_string(doc, t->path, text, sizeof(text));
+        return match_text(t->op, text, strlen(text), t->str, t->str_len);
+    }
+    return match_text(t->op, f->value, f->value_len, t->esc, t->esc_len);
+}
+
+static int eval_test(const Test* t, Record* rec) {
+    const alin_meta_t* meta = alin_input_meta();
+    switch (t->field) {
+        case FIELD_LEVEL:
+            if (meta->level != ALIN_LEVEL_NONE && meta->level <= ALIN_LEVEL_RAW) {
+                return t->op == OP_EXISTS || compare(t->op, level_code_priority[meta->level] - t->level);
+            }
+            break;
+        case FIELD_TYPE:
+            if (meta->type == ALIN_TYPE_LOG) {
+                return t->op == OP_EXISTS || (t->lit == LIT_STRING && match_text(t->op, "log", 3, t->str, t->str_len));
+            }
+            break;
+        case FIELD_TIMESTAMP:
+            if (meta->timestamp != 0) {
+                return t->op == OP_EXISTS || compare_number(t->op, (double)meta->timestamp, t->number);
+            }
+            break;
+    }
+
+    const alin_json_t* doc = record_index(rec);
+    const alin_json_field_t* f = alin_json_find(doc, t->path);
+    if (!f) return 0;
+
+    double number;
+    switch (t->lit) {
+        case LIT_NONE:
+            return f->type != ALIN_JSON_FALSE && f->type != ALIN_JSON_NULL;
+        case LIT_LEVEL: {
+            if (f->type != ALIN_JSON_STRING) return 0;
+            int priority = level_priority(f->value, f->value_len);
+            return compare(t->op, (priority < 0 ? 1 : priority) - t->level);    // 未知级别当作 INFO
+        }
+        case LIT_NUMBER:
+            return field_number(f, &number) && compare_number(t->op, number, t->number);
+        case LIT_STRING:
+            return eval_string(t, doc, f);
+        case LIT_TRUE:
+            return (f->type == ALIN_JSON_TRUE) == (t->op == OP_EQ);
+        case LIT_FALSE:
+            return (f->type == ALIN_JSON_FALSE) == (t->op == OP_EQ);
+        case LIT_NULL:
+            return (f->type == ALIN_JSON_NULL) == (t->op == OP_EQ);
+    }
+    return 0;
+}
+
+int process(const char* input, char* output, size_t output_size) {
+    // 以插件加载时不经过 main，首条记录时读取规则
+    if (rule_state == 0) rule_state = load_rule(0, NULL) == 0 ? 1 : -1;
+    if (rule_state < 0) return -1;
+
+    Record rec;
+    rec.input = input;
+    rec.indexed = 0;
+    int pc = program_entry;
+    while (pc >= 0) pc = program[pc].next[eval_test(&program[pc], &rec)];
+
+    if (pc == RESULT_PASS) return ALIN_PASS;
+    output[0] = '\0';
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // 规则有误时启动即失败，而不是逐条记录报错
+    rule_state = load_rule(argc, argv) == 0 ? 1 : -1;
+    if (rule_state < 0) return 1;
+    return alin_node_main(argc, argv, process, ALIN_NODE_STATELESS);
+}
@@ -4,10 +4,13 @@
  * 功能: 按日志级别过滤事件，只保留指定级别及以上的日志
  * 输入: 标准化 ALIN 事件 {"_type":"log","level":"ERROR",...}
  * 输出: 通过过滤的事件 (原样输出) 或空 (被过滤)
+ *       以帧格式输入时直接读取帧头中的级别，不扫描负载
  * 
  * 配置: 通过环境变量 ALIN_FILTER_LEVEL 设置 (默认: ERROR)
  *       级别优先级: DEBUG < INFO < WARN < ERROR < FATAL
  * 
+ * 并行: 无跨记录状态，可用 alin_runner -r <slot>=N 运行多个副本
+ * 
  * 热切换: 创建不同配置的版本 (filter_level_error, filter_level_warn 等)
  */
 
@@ -16,7 +19,8 @@
 #include <string.h>
 #include <ctype.h>
 
-#define MAX_INPUT_SIZE 65536
+#include "alin_node.h"
+#include "alin_json.h"
 
 // 日志级别优先级
 int get_level_priority(const char* level) {
@@ -29,81 +33,30 @@ int get_level_priority(const char* level) {
     return 1; // 默认 INFO 级别
 }
 
-int extract_string_field(const char* json, const char* field, char* value, size_t max_size) {
-    char pattern[256];
-    snprintf(pattern, sizeof(pattern), "\"%s\"", field);
-    
-    const char* pos = strstr(json, pattern);
-    if (!pos) return 0;
-    
-    pos += strlen(pattern);
-    while (*pos && (*pos == ':' || *pos == ' ' || *pos == '\t')) pos++;
-    
-    if (*pos == '"') {
-        pos++;
-        size_t i = 0;
-        while (*pos && *pos != '"' && i < max_size - 1) {
-            if (*pos == '\\' && *(pos + 1)) {
-                pos++;
-            }
-            value[i++] = *pos++;
-        }
-        value[i] = '\0';
-        return 1;
-    }
-    return 0;
-}
-
-int read_stdin(char* buffer, size_t max_size) {
-    size_t total = 0;
-    int c;
-    while ((c = getchar()) != EOF && total < max_size - 1) {
-        buffer[total++] = (char)c;
-    }
-    buffer[total] = '\0';
-    return (int)total;
-}
-
-void trim(char* str) {
-    char* start = str;
-    char* end;
-    while (*start == ' ' || *start == '\n' || *start == '\r' || *start == '\t') start++;
-    if (*start == '\0') { str[0] = '\0'; return; }
-    end = start + strlen(start) - 1;
-    while (end > start && (*end == ' ' || *end == '\n' || *end == '\r' || *end == '\t')) end--;
-    size_t len = end - start + 1;
-    memmove(str, start, len);
-    str[len] = '\0';
-}
-
-int main(int argc, char* argv[]) {
-    char input[MAX_INPUT_SIZE];
+int process(const char* input, char* output, size_t output_size) {
+    static int min_priority = -1;
     char level[256] = "";
     
-    // 获取过滤级别配置 (默认 ERROR)
-    const char* filter_level_str = getenv("ALIN_FILTER_LEVEL");
-    if (!filter_level_str || filter_level_str[0] == '\0') {
-        filter_level_str = "ERROR";
-    }
-    int min_priority = get_level_priority(filter_level_str);
-    
-    if (read_stdin(input, MAX_INPUT_SIZE) <= 0) {
-        // 无输入，静默退出
-        return 0;
-    }
-    
-    trim(input);
-    
-    // 空输入
-    if (input[0] == '\0') {
-        return 0;
+    // 获取过滤级别配置 (默认 ERROR)，常驻时只解析一次
+    if (min_priority < 0) {
+        const char* filter_level_str = getenv("ALIN_FILTER_LEVEL");
+        if (!filter_level_str || filter_level_str[0] == '\0') {
+            filter_level_str = "ERROR";
+        }
+        min_priority = get_level_priority(filter_level_str);
     }
     
-    // 提取日志级别
-    if (!extract_string_field(input, "level", level, sizeof(level))) {
-        // 无 level 字段，透传
-        printf("%s\n", input);
-        return 0;
+    // 帧头已带级别时直接判断，无需扫描负载
+    const char* known = alin_level_name(alin_input_meta()->level);
+    if (known) {
+        snprintf(level, sizeof(level), "%s", known);
+    } else {
+        alin_json_t doc;
+        alin_input_index(&doc, input);
+        if (!alin_json_string(&doc, "level", level, sizeof(level))) {
+            // 无 level 字段，透传
+            return ALIN_PASS;
+        }
     }
     
     // 比较级别
@@ -111,9 +64,14 @@ int main(int argc, char* argv[]) {
     
     if (event_priority >= min_priority) {
         // 通过过滤，原样输出
-        printf("%s\n", input);
+        return ALIN_PASS;
     }
-    // 否则静默丢弃
     
+    // 否则静默丢弃
+    output[0] = '\0';
     return 0;
 }
+
+int main(int argc, char* argv[]) {
+    return alin_node_main(argc, argv, process, ALIN_NODE_STATELESS);
+}
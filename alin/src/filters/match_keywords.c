@@ -0,0 +1,363 @@
+/**
+ * ALIN 流处理节点: match_keywords (多关键字匹配)
+ *
+ * 功能: 在消息字段中一次扫描匹配全部关键字，为命中的事件标注模式编号
+ * 输入: 标准化 ALIN 事件 {"_type":"log","level":"ERROR","message":"Connection pool exhausted",...}
+ * 输出: 命中时追加 _match {"...原事件...","_match":[1,7]}，未命中时原样输出 (或丢弃)
+ *
+ * 模式文件: 每行一个子串，编号为其在文件中的序号 (从 1 起，跳过空行与 # 开头的注释行)
+ *
+ * 匹配: 启动时由全部模式构建 Aho-Corasick 自动机并展开为确定状态转移表
+ * (字节先映射到字符类，只有模式中出现过的字节各占一类)，每条记录沿转移表走一遍消息，
+ * 耗时与消息长度成正比而与模式数量无关; 匹配时不分配内存 (含转义的消息反转义到记录 arena)
+ *
+ * 配置:
+ * - 命令行参数或 ALIN_MATCH_PATTERNS: 模式文件路径
+ * - ALIN_MATCH_FIELD: 匹配的字段 (默认 message)
+ * - ALIN_MATCH_NOCASE: 为 1 时不区分 ASCII 大小写
+ * - ALIN_MATCH_DROP: 为 1 时丢弃未命中的事件 (作为过滤器使用)
+ *
+ * 并行: 无跨记录状态，可用 alin_runner -r <slot>=N 运行多个副本
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#include "alin_node.h"
+#include "alin_json.h"
+
+#define MAX_PATTERN 4096        // 单个模式的长度上限
+#define MAX_MATCHES 64          // 每条记录标注的模式编号上限
+
+// 自动机 (构建后只读)
+typedef struct {
+    uint8_t byte_class[256];    // 字节 → 字符类 (0 为模式中未出现的字节)
+    int classes;
+    int states;
+    int32_t* next;              // [state * classes + class] → 状态 (已展开失败转移)
+    int32_t* output;            // 在该状态结束的第一个模式 (-1 表示没有)
+    int32_t* output_link;       // 后缀链上下一个有输出的状态 (-1 表示没有)
+    int32_t* pattern_next;      // 在同一状态结束的下一个模式 (重复的模式)
+    int patterns;
+} Automaton;
+
+static Automaton ac = {0};
+static char field_path[128] = "message";
+static int nocase = 0;
+static int drop_unmatched = 0;
+static int ready = 0;                  // 0 未加载, 1 已构建, -1 加载失败
+
+// 每条记录已命中的模式 (按记录序号标记，不必逐条清空)
+static uint32_t* seen_stamp = NULL;
+static uint32_t record_stamp = 0;
+
+// ===== 构建 =====
+
+// 构建期间的字典树: 子节点以 (状态, 字节) 链表保存，展开转移表后释放
+typedef struct {
+    int32_t first_child;
+    int32_t sibling;
+    int32_t fail;
+    uint8_t byte;
+} TrieNode;
+
+static TrieNode* trie = NULL;
+static int trie_capacity = 0;
+static int pattern_capacity = 0;
+
+static int trie_child(int state, uint8_t byte) {
+    for (int c = trie[state].first_child; c >= 0; c = trie[c].sibling) {
+        if (trie[c].byte == byte) return c;
+    }
+    return -1;
+}
+
+static int trie_add(int state, uint8_t byte) {
+    if (ac.states == trie_capacity) {
+        int capacity = trie_capacity ? trie_capacity * 2 : 1024;
+        TrieNode* grown = realloc(trie, (size_t)capacity * sizeof(TrieNode));
+        int32_t* out = realloc(ac.output, (size_t)capacity * sizeof(int32_t));
+        if (out) ac.output = out;
+        if (!grown || !out) {
+            if (grown) trie = grown;
+            return -1;
+        }
+        trie = grown;
+        trie_capacity = capacity;
+    }
+    int s = ac.states++;
+    trie[s].first_child = -1;
+    trie[s].sibling = state >= 0 ? trie[state].first_child : -1;
+    trie[s].fail = 0;
+    trie[s].byte = byte;
+    ac.output[s] = -1;
+    if (state >= 0) trie[state].first_child = s;
+    return s;
+}
+
+static inline uint8_t fold(uint8_t c) {
+    return nocase ? (uint8_t)tolower(c) : c;
+}
+
+/**
+ * 编入一个模式 (id 从 0 起)
+ * @return 0 成功, -1 内存不足
+ */
+static int add_pattern(const char* pattern, size_t len, int id) {
+    int s = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = fold((uint8_t)pattern[i]);
+        int child = trie_child(s, c);
+        if (child < 0 && (child = trie_add(s, c)) < 0) return -1;
+        s = child;
+    }
+    // 同一模式出现多次时挂在同一状态上
+    if (id == pattern_capacity) {
+        pattern_capacity = pattern_capacity ? pattern_capacity * 2 : 256;
+        int32_t* grown = realloc(ac.pattern_next, (size_t)pattern_capacity * sizeof(int32_t));
+        if (!grown) return -1;
+        ac.pattern_next = grown;
+    }
+    ac.pattern_next[id] = -1;
+    if (ac.output[s] < 0) {
+        ac.output[s] = id;
+    } else {
+        int p = ac.output[s];
+        while (ac.pattern_next[p] >= 0) p = ac.pattern_next[p];
+        ac.pattern_next[p] = id;
+    }
+    return 0;
+}
+
+/**
+ * 按层 (BFS) 计算失败转移，展开为完整的转移表
+ * @return 0 成功, -1 内存不足
+ */
+static int build_automaton() {
+    // 字符类: 模式中出现过的字节各占一类
+    int classes = 1;
+    memset(ac.byte_class, 0, sizeof(ac.byte_class));
+    for (int s = 1; s < ac.states; s++) {
+        uint8_t b = trie[s].byte;
+        if (ac.byte_class[b] == 0) ac.byte_class[b] = (uint8_t)classes++;
+    }
+    if (nocase) {
+        for (int c = 'a'; c <= 'z'; c++) ac.byte_class[toupper(c)] = ac.byte_class[c];
+    }
+    ac.classes = classes;
+
+    size_t states = (size_t)ac.states;
+    ac.next = malloc(states * (size_t)classes * sizeof(int32_t));
+    ac.output_link = malloc(states * sizeof(int32_t));
+    int32_t* queue = malloc(states * sizeof(int32_t));
+    if (!ac.next || !ac.output_link || !queue) {
+        free(queue);
+        return -1;
+    }
+
+    // 根: 没有子节点的字符类回到根
+    int32_t* root = ac.next;
+    for (int k = 0; k < classes; k++) root[k] = 0;
+    int head = 0, tail = 0;
+    for (int c = trie[0].first_child; c >= 0; c = trie[c].sibling) {
+        root[ac.byte_class[trie[c].byte]] = c;
+        trie[c].fail = 0;
+        queue[tail++] = c;
+    }
+    ac.output_link[0] = -1;
+
+    // 父节点先于子节点出队: 失败状态所在层更浅，其转移行已经填好，整行复制后只改写自己的子节点
+    while (head < tail) {
+        int s = queue[head++];
+        int fail = trie[s].fail;
+        int32_t* row = ac.next + (size_t)s * classes;
+        memcpy(row, ac.next + (size_t)fail * classes, (size_t)classes * sizeof(int32_t));
+        ac.output_link[s] = ac.output[fail] >= 0 ? fail : ac.output_link[fail];
+        for (int c = trie[s].first_child; c >= 0; c = trie[c].sibling) {
+            int k = ac.byte_class[trie[c].byte];
+            trie[c].fail = ac.next[(size_t)fail * classes + k];
+            row[k] = c;
+            queue[tail++] = c;
+        }
+    }
+
+    free(queue);
+    free(trie);
+    trie = NULL;
+    return 0;
+}
+
+/**
+ * 读取模式文件并构建自动机
+ * @return 0 成功, -1 失败 (已输出原因)
+ */
+static int load_patterns(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "[MATCH] Cannot open pattern file %s\n", path);
+        return -1;
+    }
+
+    ac.states = 0;
+    ac.patterns = 0;
+    int rc = trie_add(-1, 0);
+    char line[MAX_PATTERN + 2];
+    int line_no = 0;
+    while (rc >= 0 && fgets(line, sizeof(line), f)) {
+        line_no++;
+        size_t len = strlen(line);
+        if (len > 0 && line[len - 1] == '\n') line[--len] = '\0';
+        else if (!feof(f)) {
+            fprintf(stderr, "[MATCH] %s:%d: pattern exceeds %d bytes\n", path, line_no, MAX_PATTERN);
+            rc = -1;
+            break;
+        }
+        if (len > 0 && line[len - 1] == '\r') line[--len] = '\0';
+        if (len == 0 || line[0] == '#') continue;
+        if ((rc = add_pattern(line, len, ac.patterns++)) < 0) {
+            fprintf(stderr, "[MATCH] Cannot allocate automaton (%d states)\n", ac.states);
+        }
+    }
+    fclose(f);
+    if (rc < 0) return -1;
+
+    if (ac.patterns == 0) {
+        fprintf(stderr, "[MATCH] No patterns in %s\n", path);
+        return -1;
+    }
+    if (build_automaton() < 0 || !(seen_stamp = calloc((size_t)ac.patterns, sizeof(uint32_t)))) {
+        fprintf(stderr, "[MATCH] Cannot allocate automaton (%d states)\n", ac.states);
+        return -1;
+    }
+    fprintf(stderr, "[MATCH] %d patterns, %d states, %d byte classes\n", ac.patterns, ac.states, ac.classes);
+    return 0;
+}
+
+/**
+ * 读取配置与模式文件 (参数中的路径优先于 ALIN_MATCH_PATTERNS)
+ * @return 0 成功, -1 失败
+ */
+static int configure(int argc, char* argv[]) {
+    const char* path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            path = argv[i];
+            break;
+        }
+    }
+    if (!path) path = getenv("ALIN_MATCH_PATTERNS");
+    if (!path || !path[0]) {
+        fprintf(stderr, "[MATCH] No pattern file: pass a path or set ALIN_MATCH_PATTERNS\n");
+        return -1;
+    }
+
+    const char* field = getenv("ALIN_MATCH_FIELD");
+    if (field && field[0]) snprintf(field_path, sizeof(field_path), "%s", field);
+    const char* nocase_env = getenv("ALIN_MATCH_NOCASE");
+    nocase = nocase_env && strcmp(nocase_env, "1") == 0;
+    const char* drop = getenv("ALIN_MATCH_DROP");
+    drop_unmatched = drop && strcmp(drop, "1") == 0;
+
+    return load_patterns(path);
+}
+
+// ===== 匹配 =====
+
+/**
+ * 沿转移表扫描一遍 text，命中的模式编号 (去重) 写入 ids
+ * @return 命中的模式数 (至多 max_ids)
+ */
+static int match_text(const char* text, size_t len, int* ids, int max_ids) {
+    const uint8_t* p = (const uint8_t*)text;
+    const uint8_t* end = p + len;
+    const int32_t* next = ac.next;
+    const int classes = ac.classes;
+    int count = 0;
+
+    if (++record_stamp == 0) {
+        memset(seen_stamp, 0, (size_t)ac.patterns * sizeof(uint32_t));
+        record_stamp = 1;
+    }
+
+    int32_t s = 0;
+    while (p < end) {
+        s = next[(size_t)s * classes + ac.byte_class[*p++]];
+        // 沿输出链列出在此结束的全部模式
+        for (int32_t o = ac.output[s] >= 0 ? s : ac.output_link[s]; o >= 0; o = ac.output_link[o]) {
+            for (int32_t id = ac.output[o]; id >= 0; id = ac.pattern_next[id]) {
+                if (seen_stamp[id] == record_stamp) continue;
+                seen_stamp[id] = record_stamp;
+                if (count < max_ids) ids[count++] = id;
+            }
+        }
+    }
+    return count;
+}
+
+static int compare_ids(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+int process(const char* input, char* output, size_t output_size) {
+    // 以插件加载时不经过 main，首条记录时读取配置
+    if (ready == 0) ready = configure(0, NULL) == 0 ? 1 : -1;
+    if (ready < 0) return -1;
+
+    alin_json_t doc;
+    alin_input_index(&doc, input);
+    const alin_json_field_t* f = alin_json_find(&doc, field_path);
+
+    int ids[MAX_MATCHES];
+    int count = 0;
+    if (f && f->type == ALIN_JSON_STRING) {
+        const char* text = f->value;
+        size_t len = f->value_len;
+        if (f->escaped) {
+            // 反转义后的长度不超过原文
+            char* buf = alin_arena_alloc(alin_record_arena(), len + 1);
+            if (!buf) return -1;
+            alin_json_string(&doc, field_path, buf, len + 1);
+            text = buf;
+            len = strlen(buf);
+        }
+        count = match_text(text, len, ids, MAX_MATCHES);
+    }
+
+    if (count == 0) {
+        if (!drop_unmatched) return ALIN_PASS;
+        output[0] = '\0';
+        return 0;
+    }
+
+    // 在原 JSON 末尾追加 _match (编号从 1 起，升序)
+    size_t len = strlen(input);
+    if (len == 0 || input[len - 1] != '}') return ALIN_PASS;
+    qsort(ids, (size_t)count, sizeof(int), compare_ids);
+
+    memcpy(output, input, len - 1);
+    size_t n = len - 1;
+    n += (size_t)snprintf(output + n, output_size - n, "%s\"_match\":[", len > 2 ? "," : "");
+    for (int i = 0; i < count; i++) {
+        n += (size_t)snprintf(output + n, output_size - n, "%s%d", i ? "," : "", ids[i] + 1);
+    }
+    snprintf(output + n, output_size - n, "]}");
+
+    // 输入带字段表时沿用其中的位置 (前缀不变)，只编入追加的 _match
+    const alin_fields_t* fields = alin_input_meta()->fields;
+    alin_json_t out_doc;
+    if (fields && alin_json_unpack(&out_doc, output, len - 1, fields) >= 0) {
+        alin_json_resume(&out_doc, output + len - 1);
+        alin_set_output_fields(&out_doc);
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // 模式文件有误时启动即失败，而不是逐条记录报错
+    ready = configure(argc, argv) == 0 ? 1 : -1;
+    if (ready < 0) return 1;
+    return alin_node_main(argc, argv, process, ALIN_NODE_STATELESS);
+}
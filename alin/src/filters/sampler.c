@@ -0,0 +1,345 @@
+/**
+ * ALIN 流处理节点: sampler (采样限流器)
+ *
+ * 功能: 事件洪峰时按比例采样并限制总速率，保护下游的 agg_count / alert_console
+ * 输入: 标准化 ALIN 事件 {"_type":"log","level":"DEBUG",...}
+ * 输出: 保留的事件 (原样输出，或追加 _weight) 或空 (被丢弃)
+ *
+ * 采样 (依次):
+ * - 按级别 / 按键的概率采样: 保留概率为级别概率与键概率之积
+ * - 全局令牌桶: 每秒至多保留 ALIN_SAMPLE_RATE 条，允许 ALIN_SAMPLE_BURST 条的突发
+ *
+ * 权重: 每条事件的权重为其 _weight (缺省为 1) 加 _dup (上游 sampler / dedup 已带上)。
+ * 被丢弃的事件按权重计入同级别的待补权重，该级别下一条保留的事件带上
+ * "_weight":N (N = 自身的 _weight 加其前被丢弃的同级别权重，已有 _weight 时就地改写);
+ * 输入结束时仍未带出的待补权重追加补记记录 (alin_emit_extra):
+ *   {"_type":"log","level":"DEBUG","_weight":N,"_sample_flush":"final"}
+ * agg_count 按权重累加计数，总数与各级别计数因此与采样前一致; 没有待补权重时原样输出
+ *
+ * 配置:
+ * - ALIN_SAMPLE_LEVELS: 各级别的保留概率，如 DEBUG=0.01,INFO=0.1 (未列出的级别为 1)
+ * - ALIN_SAMPLE_KEY: 按该字段的值采样 (如 service)
+ * - ALIN_SAMPLE_KEYS: 各键值的保留概率，如 db=1,api=0.05
+ * - ALIN_SAMPLE_DEFAULT: 未列出的键值的保留概率 (默认 1)
+ * - ALIN_SAMPLE_RATE / ALIN_SAMPLE_BURST: 令牌桶的速率 (条/秒，0 关闭) 与容量 (默认等于速率)
+ * - ALIN_SAMPLE_SEED: 随机种子 (默认按进程与时间生成)
+ *
+ * 开销: 帧头带级别、不按键采样且负载中没有 "_weight" / "_dup" 时不解析负载，
+ * 每条记录只做一次查表、至多一次随机数与一次粗粒度时钟读取
+ * 统计: 节点指标中的 emitted / dropped 即保留与丢弃数; 结束时输出按原因与级别的汇总
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "alin_node.h"
+#include "alin_json.h"
+
+#define LEVEL_SLOTS 6           // 级别优先级 0..4 (DEBUG..FATAL) 与 5 (无 level 字段)
+#define NO_LEVEL 5
+#define MAX_KEYS 64
+#define MAX_KEY_SIZE 128
+#define KEEP_ALL UINT64_MAX     // 保留概率为 1 (不抽随机数)
+
+static const char* slot_names[LEVEL_SLOTS] = { "DEBUG", "INFO", "WARN", "ERROR", "FATAL", "-" };
+
+typedef struct {
+    char value[MAX_KEY_SIZE];
+    size_t len;
+    uint64_t threshold;         // 随机数低于此值时保留
+} KeyRule;
+
+typedef struct {
+    long kept;
+    long sampled;               // 概率采样丢弃
+    long limited;               // 令牌桶丢弃
+} SlotStats;
+
+// 配置
+static uint64_t level_threshold[LEVEL_SLOTS];
+static char key_path[MAX_KEY_SIZE] = "";
+static KeyRule key_rules[MAX_KEYS];
+static int key_rule_count = 0;
+static uint64_t key_default = KEEP_ALL;
+static double bucket_rate = 0;
+static double bucket_burst = 0;
+
+// 状态
+static uint64_t rng_state = 0;
+static double tokens = 0;
+static int64_t bucket_time = 0;        // 上次补充令牌的时间 (纳秒)
+static long pending_weight[LEVEL_SLOTS];
+static SlotStats stats[LEVEL_SLOTS];
+static int configured = 0;
+static char flush_buf[256];
+
+// ===== 配置 =====
+
+// 日志级别优先级 (同 filter_level)
+static int level_priority(const char* level) {
+    if (strcasecmp(level, "DEBUG") == 0 || strcasecmp(level, "TRACE") == 0) return 0;
+    if (strcasecmp(level, "INFO") == 0) return 1;
+    if (strcasecmp(level, "WARN") == 0 || strcasecmp(level, "WARNING") == 0) return 2;
+    if (strcasecmp(level, "ERROR") == 0 || strcasecmp(level, "ERR") == 0) return 3;
+    if (strcasecmp(level, "FATAL") == 0 || strcasecmp(level, "CRITICAL") == 0) return 4;
+    return 1; // RAW 与未知级别当作 INFO
+}
+
+/**
+ * 保留概率 → 随机数阈值
+ */
+static uint64_t keep_threshold(double p) {
+    if (p >= 1) return KEEP_ALL;
+    if (p <= 0) return 0;
+    return (uint64_t)(p * 18446744073709551616.0);    // p * 2^64
+}
+
+/**
+ * 解析 "name=p,name=p" 列表，每项回调一次
+ * @return 0 成功, -1 格式有误
+ */
+static int parse_list(const char* env, const char* list, void (*add)(const char* name, size_t len, double p)) {
+    const char* p = list;
+    while (*p) {
+        const char* comma = strchr(p, ',');
+        size_t item_len = comma ? (size_t)(comma - p) : strlen(p);
+        const char* eq = memchr(p, '=', item_len);
+        char* end;
+        double prob = eq ? strtod(eq + 1, &end) : 0;
+        if (!eq || eq == p || end != p + item_len || prob < 0 || prob > 1) {
+            fprintf(stderr, "[SAMPLE] Bad %s entry: %.*s (expected name=probability)\n", env, (int)item_len, p);
+            return -1;
+        }
+        add(p, (size_t)(eq - p), prob);
+        p += item_len + (comma ? 1 : 0);
+    }
+    return 0;
+}
+
+static void add_level(const char* name, size_t len, double p) {
+    char level[32];
+    snprintf(level, sizeof(level), "%.*s", (int)len, name);
+    level_threshold[level_priority(level)] = keep_threshold(p);
+}
+
+static void add_key(const char* name, size_t len, double p) {
+    if (key_rule_count >= MAX_KEYS || len >= MAX_KEY_SIZE) {
+        fprintf(stderr, "[SAMPLE] Ignoring key rule %.*s (at most %d keys of %d bytes)\n",
+            (int)len, name, MAX_KEYS, MAX_KEY_SIZE - 1);
+        return;
+    }
+    KeyRule* rule = &key_rules[key_rule_count++];
+    memcpy(rule->value, name, len);
+    rule->value[len] = '\0';
+    rule->len = len;
+    rule->threshold = keep_threshold(p);
+}
+
+static int64_t now_ns() {
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);    // 按时钟节拍更新，读取只需几纳秒
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void on_idle(int final);
+
+static void report() {
+    long kept = 0, sampled = 0, limited = 0;
+    for (int i = 0; i < LEVEL_SLOTS; i++) {
+        kept += stats[i].kept;
+        sampled += stats[i].sampled;
+        limited += stats[i].limited;
+    }
+    if (kept + sampled + limited <= 1) return;    // 单次模式不汇总
+    fprintf(stderr, "[SAMPLE] kept %ld, dropped %ld (sampled %ld, rate-limited %ld)\n",
+        kept, sampled + limited, sampled, limited);
+    for (int i = 0; i < LEVEL_SLOTS; i++) {
+        if (stats[i].kept + stats[i].sampled + stats[i].limited == 0) continue;
+        fprintf(stderr, "[SAMPLE]   %-6s kept %ld, sampled %ld, rate-limited %ld\n",
+            slot_names[i], stats[i].kept, stats[i].sampled, stats[i].limited);
+    }
+}
+
+/**
+ * 读取配置 (首条记录前一次)
+ * @return 0 成功, -1 配置有误
+ */
+static int configure() {
+    for (int i = 0; i < LEVEL_SLOTS; i++) level_threshold[i] = KEEP_ALL;
+    const char* levels = getenv("ALIN_SAMPLE_LEVELS");
+    if (levels && parse_list("ALIN_SAMPLE_LEVELS", levels, add_level) < 0) return -1;
+
+    const char* key = getenv("ALIN_SAMPLE_KEY");
+    if (key && key[0]) snprintf(key_path, sizeof(key_path), "%s", key);
+    const char* keys = getenv("ALIN_SAMPLE_KEYS");
+    if (keys && parse_list("ALIN_SAMPLE_KEYS", keys, add_key) < 0) return -1;
+    const char* key_default_str = getenv("ALIN_SAMPLE_DEFAULT");
+    if (key_default_str && key_default_str[0]) key_default = keep_threshold(atof(key_default_str));
+
+    const char* rate = getenv("ALIN_SAMPLE_RATE");
+    bucket_rate = rate ? atof(rate) : 0;
+    const char* burst = getenv("ALIN_SAMPLE_BURST");
+    bucket_burst = burst && burst[0] ? atof(burst) : bucket_rate;
+    if (bucket_burst < 1) bucket_burst = 1;
+    tokens = bucket_burst;
+    bucket_time = now_ns();
+
+    const char* seed = getenv("ALIN_SAMPLE_SEED");
+    rng_state = seed && seed[0] ? strtoull(seed, NULL, 10) : (uint64_t)getpid() << 32 ^ (uint64_t)bucket_time;
+    if (rng_state == 0) rng_state = 0x9e3779b97f4a7c15ull;
+    // 宿主进程中不经过 main，回调在这里注册
+    alin_set_idle_hook(on_idle);
+    atexit(report);
+    return 0;
+}
+
+// ===== 采样 =====
+
+// xorshift64*
+static inline uint64_t next_random() {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dull;
+}
+
+static inline int sample(uint64_t threshold) {
+    return threshold == KEEP_ALL || next_random() < threshold;
+}
+
+/**
+ * 取一枚令牌 (按流逝的时间补充，至多补到桶容量)
+ * @return 1 取到, 0 桶已空
+ */
+static int take_token() {
+    int64_t now = now_ns();
+    if (now != bucket_time) {
+        tokens += (double)(now - bucket_time) * 1e-9 * bucket_rate;
+        bucket_time = now;
+        if (tokens > bucket_burst) tokens = bucket_burst;
+    }
+    if (tokens < 1) return 0;
+    tokens -= 1;
+    return 1;
+}
+
+static uint64_t key_threshold(const alin_json_t* doc) {
+    const alin_json_field_t* f = alin_json_find(doc, key_path);
+    if (!f || (f->type != ALIN_JSON_STRING && f->type != ALIN_JSON_NUMBER)) return key_default;
+    for (int i = 0; i < key_rule_count; i++) {
+        if (key_rules[i].len == f->value_len && memcmp(key_rules[i].value, f->value, f->value_len) == 0) {
+            return key_rules[i].threshold;
+        }
+    }
+    return key_default;
+}
+
+/**
+ * 空闲回调: 输入结束时为各级别仍未带出的待补权重追加补记记录
+ */
+static void on_idle(int final) {
+    if (!final || configured <= 0) return;
+    for (int i = 0; i < LEVEL_SLOTS; i++) {
+        if (pending_weight[i] == 0) continue;
+        int n = i == NO_LEVEL
+            ? snprintf(flush_buf, sizeof(flush_buf), "{\"_type\":\"log\",\"_weight\":%ld,\"_sample_flush\":\"final\"}",
+                pending_weight[i])
+            : snprintf(flush_buf, sizeof(flush_buf), "{\"_type\":\"log\",\"level\":\"%s\",\"_weight\":%ld,\"_sample_flush\":\"final\"}",
+                slot_names[i], pending_weight[i]);
+        if (n > 0 && (size_t)n < sizeof(flush_buf) && alin_emit_extra(flush_buf, (size_t)n) == 0) pending_weight[i] = 0;
+    }
+}
+
+int process(const char* input, char* output, size_t output_size) {
+    if (configured == 0) configured = configure() == 0 ? 1 : -1;
+    if (configured < 0) return -1;
+
+    // 级别: 帧头已带级别时不扫描负载
+    alin_json_t doc;
+    int indexed = 0;
+    int slot;
+    const char* known = alin_level_name(alin_input_meta()->level);
+    if (known) {
+        slot = level_priority(known);
+    } else {
+        char level[64];
+        alin_input_index(&doc, input);
+        indexed = 1;
+        slot = alin_json_string(&doc, "level", level, sizeof(level)) ? level_priority(level) : NO_LEVEL;
+    }
+
+    // 自身权重: 负载中出现 _weight / _dup 时才解析
+    const alin_json_field_t* weight_field = NULL;
+    long weight = 1, dup = 0;
+    if (indexed || strstr(input, "\"_weight\"") || strstr(input, "\"_dup\"")) {
+        if (!indexed) alin_input_index(&doc, input);
+        indexed = 1;
+        weight_field = alin_json_find(&doc, "_weight");
+        if (weight_field && weight_field->type != ALIN_JSON_NUMBER) weight_field = NULL;
+        weight = alin_json_long(&doc, "_weight");
+        if (weight < 1) weight = 1;
+        dup = alin_json_long(&doc, "_dup");
+        if (dup < 0) dup = 0;
+    }
+
+    // 概率采样: 级别与键的保留概率相乘，依次抽取即可
+    int keep = sample(level_threshold[slot]);
+    if (keep && key_path[0]) {
+        if (!indexed) alin_input_index(&doc, input);
+        keep = sample(key_threshold(&doc));
+    }
+    if (!keep) stats[slot].sampled++;
+    else if (bucket_rate > 0 && !take_token()) {
+        stats[slot].limited++;
+        keep = 0;
+    }
+
+    if (!keep) {
+        pending_weight[slot] += weight + dup;
+        output[0] = '\0';
+        return 0;
+    }
+
+    stats[slot].kept++;
+    if (pending_weight[slot] == 0) return ALIN_PASS;
+    size_t len = strlen(input);
+    if (len == 0 || input[len - 1] != '}') return ALIN_PASS;
+    weight += pending_weight[slot];    // _dup 原样保留，agg_count 仍会计入
+    pending_weight[slot] = 0;
+
+    if (weight_field) {
+        // 已有 _weight: 就地改写其值 (其后的字段位置随之移动，不沿用字段表)
+        size_t head = (size_t)(weight_field->value - input);
+        size_t tail = head + weight_field->value_len;
+        snprintf(output, output_size, "%.*s%ld%s", (int)head, input, weight, input + tail);
+        return 0;
+    }
+
+    // 在原 JSON 末尾追加 _weight
+    int n = snprintf(output, output_size, "%.*s%s\"_weight\":%ld}",
+        (int)(len - 1), input, len > 2 ? "," : "", weight);
+
+    // 输入带字段表时沿用其中的位置 (前缀不变)，只编入追加的 _weight
+    const alin_fields_t* fields = alin_input_meta()->fields;
+    alin_json_t out_doc;
+    if (fields && (size_t)n < output_size && alin_json_unpack(&out_doc, output, len - 1, fields) >= 0) {
+        alin_json_resume(&out_doc, output + len - 1);
+        alin_set_output_fields(&out_doc);
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    configured = configure() == 0 ? 1 : -1;
+    if (configured < 0) return 1;
+    return alin_node_main(argc, argv, process, 0);
+}
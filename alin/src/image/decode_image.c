@@ -15,6 +15,10 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "alin_arena.h"
+#include "alin_input.h"
+#include "alin_json.h"
+
 #define MAX_INPUT_SIZE 1048576  // 1MB
 #define MAX_PATH 4096
 
@@ -68,36 +72,6 @@ size_t base64_decode(const char* input, unsigned char* output, size_t output_max
     return out_len;
 }
 
-int extract_string_field(const char* json, const char* field, char* value, size_t max_size) {
-    char pattern[256];
-    snprintf(pattern, sizeof(pattern), "\"%s\"", field);
-    const char* pos = strstr(json, pattern);
-    if (!pos) return 0;
-    pos += strlen(pattern);
-    while (*pos && (*pos == ':' || *pos == ' ' || *pos == '\t')) pos++;
-    if (*pos == '"') {
-        pos++;
-        size_t i = 0;
-        while (*pos && *pos != '"' && i < max_size - 1) {
-            if (*pos == '\\' && *(pos + 1)) pos++;
-            value[i++] = *pos++;
-        }
-        value[i] = '\0';
-        return 1;
-    }
-    return 0;
-}
-
-int read_stdin(char* buffer, size_t max_size) {
-    size_t total = 0;
-    int c;
-    while ((c = getchar()) != EOF && total < max_size - 1) {
-        buffer[total++] = (char)c;
-    }
-    buffer[total] = '\0';
-    return (int)total;
-}
-
 void trim(char* str) {
     char* start = str;
     while (*start == ' ' || *start == '\n' || *start == '\r' || *start == '\t') start++;
@@ -151,11 +125,14 @@ int get_ppm_dimensions(const char* ppm_path, int* width, int* height) {
 }
 
 int main(int argc, char* argv[]) {
-    char input[MAX_INPUT_SIZE];
     char path[MAX_PATH] = "";
     char tmp_ppm[MAX_PATH];
     
-    if (read_stdin(input, MAX_INPUT_SIZE) <= 0) {
+    alin_input_t in;
+    alin_input_open(&in, STDIN_FILENO, MAX_INPUT_SIZE);
+    size_t input_len;
+    char* input = alin_input_all(&in, &input_len);
+    if (input_len == 0) {
         fprintf(stderr, "Error: No input received\n");
         return 1;
     }
@@ -163,7 +140,9 @@ int main(int argc, char* argv[]) {
     trim(input);
     
     // 提取路径
-    if (!extract_string_field(input, "path", path, MAX_PATH)) {
+    alin_json_t doc;
+    alin_json_index(&doc, input);
+    if (!alin_json_string(&doc, "path", path, MAX_PATH)) {
         fprintf(stderr, "Error: No 'path' field in input\n");
         return 1;
     }
@@ -198,9 +177,15 @@ int main(int argc, char* argv[]) {
     long ppm_size = ftell(f);
     fseek(f, 0, SEEK_SET);
     
-    unsigned char* ppm_data = malloc(ppm_size);
-    if (!ppm_data) {
+    // PPM 数据与 base64 编码结果共用一个 arena (一次分配)
+    size_t b64_size = (ppm_size + 2) / 3 * 4 + 1;
+    alin_arena_t arena;
+    alin_arena_init(&arena, (size_t)ppm_size + b64_size + 64);
+    unsigned char* ppm_data = alin_arena_alloc(&arena, ppm_size);
+    char* b64_data = alin_arena_alloc(&arena, b64_size);
+    if (!ppm_data || !b64_data) {
         fclose(f);
+        alin_arena_free(&arena);
         return 1;
     }
     
@@ -208,12 +193,6 @@ int main(int argc, char* argv[]) {
     fclose(f);
     
     // Base64 编码
-    size_t b64_size = (ppm_size + 2) / 3 * 4 + 1;
-    char* b64_data = malloc(b64_size);
-    if (!b64_data) {
-        free(ppm_data);
-        return 1;
-    }
     
     base64_encode(ppm_data, ppm_size, b64_data, b64_size);
     
@@ -222,8 +201,7 @@ int main(int argc, char* argv[]) {
         width, height, b64_data);
     
     // 清理
-    free(ppm_data);
-    free(b64_data);
+    alin_arena_free(&arena);
     unlink(tmp_ppm);
     
     return 0;
@@ -13,6 +13,9 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "alin_input.h"
+#include "alin_json.h"
+
 #define MAX_INPUT_SIZE 10485760
 #define MAX_PATH 4096
 
@@ -37,43 +40,13 @@ size_t base64_decode(const char* input, unsigned char* output, size_t output_max
     return out_len;
 }
 
-int extract_string_field(const char* json, const char* field, char* value, size_t max_size) {
-    char pattern[256];
-    snprintf(pattern, sizeof(pattern), "\"%s\"", field);
-    const char* pos = strstr(json, pattern);
-    if (!pos) return 0;
-    pos += strlen(pattern);
-    while (*pos && (*pos == ':' || *pos == ' ')) pos++;
-    if (*pos == '"') {
-        pos++;
-        size_t i = 0;
-        while (*pos && *pos != '"' && i < max_size - 1) {
-            if (*pos == '\\' && *(pos + 1)) pos++;
-            value[i++] = *pos++;
-        }
-        value[i] = '\0';
-        return 1;
-    }
-    return 0;
-}
-
-char* extract_ppm_field(const char* json) {
-    const char* start = strstr(json, "\"ppm\":\"");
-    if (!start) return NULL;
-    start += 7;
-    const char* end = start;
-    while (*end && *end != '"') end++;
-    size_t len = end - start;
-    char* result = malloc(len + 1);
-    if (result) { memcpy(result, start, len); result[len] = '\0'; }
-    return result;
-}
-
-int read_stdin(char* buffer, size_t max_size) {
-    size_t total = 0; int c;
-    while ((c = getchar()) != EOF && total < max_size - 1) buffer[total++] = (char)c;
-    buffer[total] = '\0';
-    return (int)total;
+// 图像数据字段 (base64 PPM): 在输入中原地截出 (结尾的引号改为 '\0')，不复制
+char* extract_ppm_field(const alin_json_t* doc) {
+    const alin_json_field_t* f = alin_json_find(doc, "ppm");
+    if (!f || f->type != ALIN_JSON_STRING) return NULL;
+    char* value = (char*)f->value;
+    value[f->value_len] = '\0';
+    return value;
 }
 
 int convert_ppm_to_png(const char* ppm_path, const char* png_path) {
@@ -89,26 +62,31 @@ int convert_ppm_to_png(const char* ppm_path, const char* png_path) {
 }
 
 int main(int argc, char* argv[]) {
-    char* input = malloc(MAX_INPUT_SIZE);
-    if (!input) return 1;
-    
-    if (read_stdin(input, MAX_INPUT_SIZE) <= 0) {
-        free(input);
+    alin_input_t in;
+    alin_input_open(&in, STDIN_FILENO, MAX_INPUT_SIZE);
+    size_t input_len;
+    char* input = alin_input_all(&in, &input_len);
+    if (input_len == 0) {
+        alin_input_close(&in);
         fprintf(stderr, "Error: No input\n");
         return 1;
     }
     
+    // 提取字段 (索引指向 input，使用期间不能释放)
+    alin_json_t doc;
+    alin_json_index(&doc, input);
+    
     // 提取输出路径
     char output_path[MAX_PATH] = "";
-    if (!extract_string_field(input, "output", output_path, MAX_PATH)) {
+    if (!alin_json_string(&doc, "output", output_path, MAX_PATH)) {
         // 默认输出路径
         snprintf(output_path, MAX_PATH, "/tmp/alin_output_%d.png", getpid());
     }
     
     // 提取 PPM 数据
-    char* ppm_b64 = extract_ppm_field(input);
+    char* ppm_b64 = extract_ppm_field(&doc);
     if (!ppm_b64) {
-        free(input);
+        alin_input_close(&in);
         fprintf(stderr, "Error: No ppm field\n");
         return 1;
     }
@@ -117,7 +95,6 @@ int main(int argc, char* argv[]) {
     size_t ppm_max = strlen(ppm_b64);
     unsigned char* ppm_data = malloc(ppm_max);
     size_t ppm_len = base64_decode(ppm_b64, ppm_data, ppm_max);
-    free(ppm_b64);
     
     // 写入临时 PPM 文件
     char tmp_ppm[MAX_PATH];
@@ -125,7 +102,7 @@ int main(int argc, char* argv[]) {
     
     FILE* f = fopen(tmp_ppm, "wb");
     if (!f) {
-        free(input);
+        alin_input_close(&in);
         free(ppm_data);
         return 1;
     }
@@ -138,7 +115,7 @@ int main(int argc, char* argv[]) {
     
     // 清理
     unlink(tmp_ppm);
-    free(input);
+    alin_input_close(&in);
     
     // 输出结果
     printf("{\"_type\":\"result\",\"success\":%s,\"path\":\"%s\"}\n",
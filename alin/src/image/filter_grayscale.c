@@ -11,6 +11,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+#include "alin_arena.h"
+#include "alin_input.h"
+#include "alin_json.h"
 
 #define MAX_INPUT_SIZE 10485760  // 10MB
 
@@ -54,39 +59,13 @@ size_t base64_decode(const char* input, unsigned char* output, size_t output_max
     return out_len;
 }
 
-long extract_number_field(const char* json, const char* field) {
-    char pattern[256];
-    snprintf(pattern, sizeof(pattern), "\"%s\"", field);
-    const char* pos = strstr(json, pattern);
-    if (!pos) return 0;
-    pos += strlen(pattern);
-    while (*pos && (*pos == ':' || *pos == ' ')) pos++;
-    return strtol(pos, NULL, 10);
-}
-
-char* extract_ppm_field(const char* json) {
-    const char* start = strstr(json, "\"ppm\":\"");
-    if (!start) return NULL;
-    start += 7;
-    const char* end = start;
-    while (*end && *end != '"') end++;
-    size_t len = end - start;
-    char* result = malloc(len + 1);
-    if (result) {
-        memcpy(result, start, len);
-        result[len] = '\0';
-    }
-    return result;
-}
-
-int read_stdin(char* buffer, size_t max_size) {
-    size_t total = 0;
-    int c;
-    while ((c = getchar()) != EOF && total < max_size - 1) {
-        buffer[total++] = (char)c;
-    }
-    buffer[total] = '\0';
-    return (int)total;
+// 图像数据字段 (base64 PPM): 在输入中原地截出 (结尾的引号改为 '\0')，不复制
+char* extract_ppm_field(const alin_json_t* doc) {
+    const alin_json_field_t* f = alin_json_find(doc, "ppm");
+    if (!f || f->type != ALIN_JSON_STRING) return NULL;
+    char* value = (char*)f->value;
+    value[f->value_len] = '\0';
+    return value;
 }
 
 // 应用灰度滤镜到 PPM 数据
@@ -121,47 +100,50 @@ void apply_grayscale(unsigned char* ppm_data, size_t data_len) {
 }
 
 int main(int argc, char* argv[]) {
-    char* input = malloc(MAX_INPUT_SIZE);
-    if (!input) return 1;
-    
-    if (read_stdin(input, MAX_INPUT_SIZE) <= 0) {
-        free(input);
+    alin_input_t in;
+    alin_input_open(&in, STDIN_FILENO, MAX_INPUT_SIZE);
+    size_t input_len;
+    char* input = alin_input_all(&in, &input_len);
+    if (input_len == 0) {
+        alin_input_close(&in);
         fprintf(stderr, "Error: No input\n");
         return 1;
     }
     
     // 提取字段
-    int width = (int)extract_number_field(input, "width");
-    int height = (int)extract_number_field(input, "height");
-    char* ppm_b64 = extract_ppm_field(input);
+    alin_json_t doc;
+    alin_json_index(&doc, input);
+    int width = (int)alin_json_long(&doc, "width");
+    int height = (int)alin_json_long(&doc, "height");
+    char* ppm_b64 = extract_ppm_field(&doc);
     
     if (!ppm_b64) {
-        free(input);
+        alin_input_close(&in);
         fprintf(stderr, "Error: No ppm field\n");
         return 1;
     }
     
-    // 解码 PPM
+    // 解码 PPM (解码结果与重新编码的 base64 共用一个 arena，一次分配)
     size_t ppm_max = strlen(ppm_b64);
-    unsigned char* ppm_data = malloc(ppm_max);
+    alin_arena_t arena;
+    alin_arena_init(&arena, ppm_max * 2 + 64);
+    unsigned char* ppm_data = alin_arena_alloc(&arena, ppm_max);
     if (!ppm_data) {
-        free(input);
-        free(ppm_b64);
+        alin_input_close(&in);
         return 1;
     }
     
     size_t ppm_len = base64_decode(ppm_b64, ppm_data, ppm_max);
-    free(ppm_b64);
     
     // 应用灰度滤镜
     apply_grayscale(ppm_data, ppm_len);
     
     // 重新编码
     size_t b64_size = (ppm_len + 2) / 3 * 4 + 1;
-    char* b64_out = malloc(b64_size);
+    char* b64_out = alin_arena_alloc(&arena, b64_size);
     if (!b64_out) {
-        free(input);
-        free(ppm_data);
+        alin_input_close(&in);
+        alin_arena_free(&arena);
         return 1;
     }
     
@@ -171,9 +153,8 @@ int main(int argc, char* argv[]) {
     printf("{\"_type\":\"image\",\"width\":%d,\"height\":%d,\"format\":\"ppm\",\"filter\":\"grayscale\",\"ppm\":\"%s\"}\n",
         width, height, b64_out);
     
-    free(input);
-    free(ppm_data);
-    free(b64_out);
+    alin_input_close(&in);
+    alin_arena_free(&arena);
     
     return 0;
 }
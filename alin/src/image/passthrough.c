@@ -7,22 +7,20 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
+
+#include "alin_input.h"
 
 #define MAX_INPUT_SIZE 10485760
 
 int main(int argc, char* argv[]) {
-    char* buffer = malloc(MAX_INPUT_SIZE);
-    if (!buffer) return 1;
-    
-    size_t total = 0;
-    int c;
-    while ((c = getchar()) != EOF && total < MAX_INPUT_SIZE - 1) {
-        buffer[total++] = (char)c;
-    }
-    buffer[total] = '\0';
+    alin_input_t in;
+    alin_input_open(&in, STDIN_FILENO, MAX_INPUT_SIZE);
     
-    printf("%s", buffer);
+    size_t len;
+    char* buffer = alin_input_all(&in, &len);
+    fwrite(buffer, 1, len, stdout);
     
-    free(buffer);
+    alin_input_close(&in);
     return 0;
 }
@@ -5,8 +5,20 @@
  * 输入: 原始 JSON 日志行 {"level":"ERROR","msg":"something failed","ts":1234567890}
  * 输出: 标准化的 ALIN 事件格式
  * 
+ * 每行独立解析 (ALIN_NODE_STATELESS)，alin_runner 可按槽位并行运行多个副本
+ * 字符串扫描与 _raw 转义使用 alin_scan 的向量化实现 (AVX2/SSE4.2，运行时按 CPU 选择)
+ * 以帧格式输出时附带字段表 (各字段在输出中的位置)，下游节点不必重新解析
+ * 字段副本与转义结果按记录长度从记录 arena 分配，长记录的消息与原文完整保留
+ * 
  * 标准化输出格式:
- * {"_type":"log","level":"ERROR","message":"...", "timestamp":..., "_raw":{原始数据}}
+ * {"_type":"log","level":"ERROR","message":"...", "timestamp":..., "_raw":"原始数据 (转义)"}
+ *
+ * 原始数据 (ALIN_RAW 环境变量):
+ * - inline (默认): 转义后内嵌为 _raw; 转义后超出输出缓冲时，配置了暂存区则改用引用，
+ *                  否则在转义边界截断并加 "_raw_truncated":true (保证输出仍是合法 JSON)
+ * - ref:    原文追加到本进程的暂存区 (ALIN_SPOOL_DIR，见 alin_spool.h)，事件只带引用
+ *           "_raw_ref":{"spool":"...","pos":N,"len":N}，需要原文的下游再取回; 未配置暂存区时按 inline
+ * - off:    不带原始数据
  */
 
 #include <stdio.h>
@@ -15,165 +27,233 @@
 #include <ctype.h>
 #include <time.h>
 
-#define MAX_INPUT_SIZE 65536
-#define MAX_FIELD_SIZE 4096
+#include "alin_node.h"
+#include "alin_json.h"
+#include "alin_scan.h"
+#include "alin_spool.h"
 
-// 简单的 JSON 字段提取 (不依赖外部库)
-int extract_string_field(const char* json, const char* field, char* value, size_t max_size) {
-    char pattern[256];
-    snprintf(pattern, sizeof(pattern), "\"%s\"", field);
-    
-    const char* pos = strstr(json, pattern);
-    if (!pos) return 0;
-    
-    // 跳过字段名和冒号
-    pos += strlen(pattern);
-    while (*pos && (*pos == ':' || *pos == ' ' || *pos == '\t')) pos++;
-    
-    if (*pos == '"') {
-        pos++;
-        size_t i = 0;
-        while (*pos && *pos != '"' && i < max_size - 1) {
-            if (*pos == '\\' && *(pos + 1)) {
-                pos++;
-                switch (*pos) {
-                    case 'n': value[i++] = '\n'; break;
-                    case 't': value[i++] = '\t'; break;
-                    case 'r': value[i++] = '\r'; break;
-                    case '"': value[i++] = '"'; break;
-                    case '\\': value[i++] = '\\'; break;
-                    default: value[i++] = *pos;
-                }
-            } else {
-                value[i++] = *pos;
-            }
-            pos++;
+// 原始数据的携带方式 (ALIN_RAW)
+enum { RAW_INLINE = 0, RAW_REF, RAW_OFF };
+
+static int raw_mode = -1;
+static alin_spool_t spool;     // ref 模式或 inline 超长时使用 (未打开时 spool.hdr 为 NULL)
+static int spool_tried = 0;    // 已尝试打开 (未配置 ALIN_SPOOL_DIR 时不再重试)
+
+// 转义 JSON 字符串，返回写入的长度
+static size_t json_escape(const char* src, char* dst, size_t max_size) {
+    size_t j = 0;
+    // 向量扫描到下一个需转义的字符，中间的普通字节整段复制
+    while (j < max_size - 2) {
+        const char* stop = alin_scan_escape(src);
+        size_t run = (size_t)(stop - src);
+        if (run > max_size - 2 - j) run = max_size - 2 - j;
+        memcpy(dst + j, src, run);
+        j += run;
+        src += run;
+        if (j >= max_size - 2 || *src == '\0') break;
+        dst[j++] = '\\';
+        switch (*src++) {
+            case '"':  dst[j++] = '"'; break;
+            case '\\': dst[j++] = '\\'; break;
+            case '\n': dst[j++] = 'n'; break;
+            case '\r': dst[j++] = 'r'; break;
+            case '\t': dst[j++] = 't'; break;
         }
-        value[i] = '\0';
-        return 1;
     }
-    return 0;
+    dst[j] = '\0';
+    return j;
 }
 
-long extract_number_field(const char* json, const char* field) {
-    char pattern[256];
-    snprintf(pattern, sizeof(pattern), "\"%s\"", field);
-    
-    const char* pos = strstr(json, pattern);
-    if (!pos) return 0;
-    
-    pos += strlen(pattern);
-    while (*pos && (*pos == ':' || *pos == ' ' || *pos == '\t')) pos++;
-    
-    if (*pos == '-' || isdigit(*pos)) {
-        return strtol(pos, NULL, 10);
-    }
-    return 0;
+/**
+ * 转义到记录 arena 中的新缓冲区 (最坏情况每个字节转义为两个)
+ * @return 转义结果, NULL 表示内存不足
+ */
+static char* escape_alloc(const char* src, size_t src_len, size_t* len) {
+    char* dst = alin_arena_alloc(alin_record_arena(), src_len * 2 + 2);
+    if (dst) *len = json_escape(src, dst, src_len * 2 + 2);
+    return dst;
 }
 
-int read_stdin(char* buffer, size_t max_size) {
-    size_t total = 0;
-    int c;
-    while ((c = getchar()) != EOF && total < max_size - 1) {
-        buffer[total++] = (char)c;
-    }
-    buffer[total] = '\0';
-    return (int)total;
+/**
+ * 字符串字段的副本 (反转义后不会变长，按字段长度从记录 arena 分配)
+ * @return 副本, NULL 表示字段不存在、不是字符串或内存不足
+ */
+static char* string_field(const alin_json_t* doc, const char* key) {
+    const alin_json_field_t* f = alin_json_find(doc, key);
+    if (!f || f->type != ALIN_JSON_STRING) return NULL;
+    char* value = alin_arena_alloc(alin_record_arena(), f->value_len + 1);
+    if (value) alin_json_string(doc, key, value, f->value_len + 1);
+    return value;
 }
 
-void trim(char* str) {
-    char* start = str;
-    char* end;
-    while (*start == ' ' || *start == '\n' || *start == '\r' || *start == '\t') start++;
-    if (*start == '\0') { str[0] = '\0'; return; }
-    end = start + strlen(start) - 1;
-    while (end > start && (*end == ' ' || *end == '\n' || *end == '\r' || *end == '\t')) end--;
-    size_t len = end - start + 1;
-    memmove(str, start, len);
-    str[len] = '\0';
+/**
+ * 编入输出记录中的一个成员: p 指向键的开引号，成员紧凑书写 ("key":value)
+ * @return 下一个成员的开引号位置
+ */
+static const char* add_member(alin_json_t* doc, const char* p, size_t key_len, size_t value_len, int type) {
+    const char* key = p + 1;
+    const char* value = key + key_len + 2;
+    if (type == ALIN_JSON_STRING) value++;
+    alin_json_add(doc, key, key_len, value, value_len, type, -1);
+    return value + value_len + (type == ALIN_JSON_STRING ? 1 : 0) + 1;
 }
 
-// 转义 JSON 字符串
-void json_escape(const char* src, char* dst, size_t max_size) {
-    size_t j = 0;
-    for (size_t i = 0; src[i] && j < max_size - 2; i++) {
-        switch (src[i]) {
-            case '"':  dst[j++] = '\\'; dst[j++] = '"'; break;
-            case '\\': dst[j++] = '\\'; dst[j++] = '\\'; break;
-            case '\n': dst[j++] = '\\'; dst[j++] = 'n'; break;
-            case '\r': dst[j++] = '\\'; dst[j++] = 'r'; break;
-            case '\t': dst[j++] = '\\'; dst[j++] = 't'; break;
-            default:   dst[j++] = src[i];
-        }
+/**
+ * 为标准化输出附上字段表: 各部分长度已知，按输出格式直接算出位置，不扫描输出
+ * raw_len 为 0 表示没有内嵌的 _raw; 其后的短尾 (_raw_ref、_raw_truncated) 扫描编入
+ */
+static void index_output(const char* output, size_t level_len, size_t msg_len, size_t ts_len, size_t raw_len) {
+    alin_json_t doc;
+    doc.json = output;
+    doc.count = 0;
+    doc.overflow = 0;
+    doc.found_next = 0;
+    const char* p = add_member(&doc, output + 1, 5, 3, ALIN_JSON_STRING);
+    p = add_member(&doc, p, 5, level_len, ALIN_JSON_STRING);
+    p = add_member(&doc, p, 7, msg_len, ALIN_JSON_STRING);
+    p = add_member(&doc, p, 9, ts_len, ALIN_JSON_NUMBER);
+    if (raw_len > 0) p = add_member(&doc, p, 4, raw_len, ALIN_JSON_STRING);
+    if (*p) alin_json_resume(&doc, p);
+    alin_set_output_fields(&doc);
+}
+
+/**
+ * 首条记录前读取 ALIN_RAW; ref 模式此时打开本进程的暂存区
+ * (inline 模式等到第一条放不下的记录再打开，多数输入用不到暂存区)
+ */
+static void init_raw_mode() {
+    const char* mode = getenv("ALIN_RAW");
+    raw_mode = RAW_INLINE;
+    if (mode && strcmp(mode, "ref") == 0) raw_mode = RAW_REF;
+    else if (mode && strcmp(mode, "off") == 0) raw_mode = RAW_OFF;
+
+    if (raw_mode == RAW_REF && alin_spool_open(&spool, "parse_json") != 0) {
+        fprintf(stderr, "[PARSE] ALIN_RAW=ref needs ALIN_SPOOL_DIR, embedding _raw instead\n");
+        raw_mode = RAW_INLINE;
+        spool_tried = 1;
     }
-    dst[j] = '\0';
 }
 
-int main(int argc, char* argv[]) {
-    char input[MAX_INPUT_SIZE];
-    char output[MAX_INPUT_SIZE];
-    char level[MAX_FIELD_SIZE] = "INFO";
-    char message[MAX_FIELD_SIZE] = "";
-    char msg[MAX_FIELD_SIZE] = "";
-    char escaped_msg[MAX_FIELD_SIZE * 2] = "";
-    char escaped_raw[MAX_INPUT_SIZE * 2] = "";
-    long timestamp = 0;
-    
-    if (read_stdin(input, MAX_INPUT_SIZE) <= 0) {
-        fprintf(stderr, "Error: No input received\n");
-        return 1;
+/**
+ * 在 out 后追加原始输入的引用 (原文写入暂存区，inline 模式首次用到时才打开暂存区)
+ * @return 追加的字节数, -1 表示放不下或暂存区不可用
+ */
+static int append_raw_ref(const char* input, char* out, size_t room) {
+    if (!spool.hdr) {
+        if (spool_tried) return -1;
+        spool_tried = 1;
+        if (alin_spool_open(&spool, "parse_json") != 0) return -1;
     }
-    
-    trim(input);
+    size_t len = strlen(input);
+    int64_t pos = alin_spool_append(&spool, input, len);
+    if (pos < 0) return -1;
+    int n = snprintf(out, room, ",\"_raw_ref\":{\"spool\":\"%s\",\"pos\":%lld,\"len\":%zu}}",
+                     spool.name, (long long)pos, len);
+    return n >= 0 && (size_t)n < room ? n : -1;
+}
+
+int process(const char* input, char* output, size_t output_size) {
+    char default_level[] = "INFO";
+    char* level = default_level;
+    char* message = "";
+    char ts_str[32];
+    long timestamp = 0;
+    size_t input_len = strlen(input);
+    size_t msg_len;
     
     // 检查是否为 JSON (以 { 开头)
     if (input[0] != '{') {
         // 非 JSON，包装为原始消息
-        json_escape(input, escaped_msg, sizeof(escaped_msg));
-        snprintf(output, MAX_INPUT_SIZE,
-            "{\"_type\":\"log\",\"level\":\"RAW\",\"message\":\"%s\",\"timestamp\":%ld}",
-            escaped_msg, (long)time(NULL));
-        printf("%s\n", output);
+        char* escaped_msg = escape_alloc(input, input_len, &msg_len);
+        if (!escaped_msg) return -1;
+        long now = (long)time(NULL);
+        int ts_len = snprintf(ts_str, sizeof(ts_str), "%ld", now);
+        int n = snprintf(output, output_size,
+            "{\"_type\":\"log\",\"level\":\"RAW\",\"message\":\"%s\",\"timestamp\":%s}",
+            escaped_msg, ts_str);
+        alin_set_output_meta(ALIN_TYPE_LOG, ALIN_LEVEL_RAW, (int64_t)now);
+        if ((size_t)n < output_size) index_output(output, 3, msg_len, (size_t)ts_len, 0);
         return 0;
     }
     
-    // 提取字段
-    extract_string_field(input, "level", level, MAX_FIELD_SIZE);
+    // 扫描一次建立字段索引，之后的查找都不再扫描记录
+    alin_json_t doc;
+    alin_json_index(&doc, input);
+    char* field = string_field(&doc, "level");
+    if (field) level = field;
     
     // 尝试多种消息字段名
-    if (!extract_string_field(input, "message", message, MAX_FIELD_SIZE)) {
-        if (!extract_string_field(input, "msg", message, MAX_FIELD_SIZE)) {
-            extract_string_field(input, "error", message, MAX_FIELD_SIZE);
-        }
+    if ((field = string_field(&doc, "message")) != NULL ||
+        (field = string_field(&doc, "msg")) != NULL ||
+        (field = string_field(&doc, "error")) != NULL) {
+        message = field;
     }
     
     // 尝试多种时间戳字段名
-    timestamp = extract_number_field(input, "timestamp");
+    timestamp = alin_json_long(&doc, "timestamp");
     if (timestamp == 0) {
-        timestamp = extract_number_field(input, "ts");
+        timestamp = alin_json_long(&doc, "ts");
     }
     if (timestamp == 0) {
-        timestamp = extract_number_field(input, "time");
+        timestamp = alin_json_long(&doc, "time");
     }
     if (timestamp == 0) {
         timestamp = (long)time(NULL);
     }
     
-    // 转义消息和原始输入
-    json_escape(message, escaped_msg, sizeof(escaped_msg));
-    json_escape(input, escaped_raw, sizeof(escaped_raw));
+    // 转义消息
+    char* escaped_msg = escape_alloc(message, strlen(message), &msg_len);
+    if (!escaped_msg) return -1;
     
     // 转换 level 为大写
     for (int i = 0; level[i]; i++) {
         level[i] = toupper(level[i]);
     }
     
-    // 生成标准化输出
-    snprintf(output, MAX_INPUT_SIZE,
-        "{\"_type\":\"log\",\"level\":\"%s\",\"message\":\"%s\",\"timestamp\":%ld,\"_raw\":\"%s\"}",
-        level, escaped_msg, timestamp, escaped_raw);
+    // 生成标准化输出 (原始数据部分按 ALIN_RAW 追加)
+    int ts_len = snprintf(ts_str, sizeof(ts_str), "%ld", timestamp);
+    int n = snprintf(output, output_size,
+        "{\"_type\":\"log\",\"level\":\"%s\",\"message\":\"%s\",\"timestamp\":%s",
+        level, escaped_msg, ts_str);
+    if (n < 0 || (size_t)n >= output_size) return -1;
     
-    printf("%s\n", output);
+    if (raw_mode < 0) init_raw_mode();
+    char* tail = output + n;
+    size_t room = output_size - (size_t)n;
+    size_t raw_len = 0;
+    int t = -1;
+    if (raw_mode == RAW_INLINE) {
+        char* escaped_raw = escape_alloc(input, input_len, &raw_len);
+        if (!escaped_raw) return -1;
+        t = snprintf(tail, room, ",\"_raw\":\"%s\"}", escaped_raw);
+        if (t < 0 || (size_t)t >= room) {
+            raw_len = 0;
+            t = append_raw_ref(input, tail, room);
+        }
+        if (t < 0) {
+            // 转义后放不下且无暂存区: 在转义边界截断，保证输出仍是合法 JSON
+            const char* closing = "\",\"_raw_truncated\":true}";
+            size_t reserve = sizeof(",\"_raw\":\"") - 1 + strlen(closing);
+            escaped_raw[0] = '\0';
+            raw_len = room > reserve + 2 ? json_escape(input, escaped_raw, room - reserve) : 0;
+            t = snprintf(tail, room, ",\"_raw\":\"%s%s", escaped_raw, closing);
+        }
+    } else if (raw_mode == RAW_REF) {
+        t = append_raw_ref(input, tail, room);
+    }
+    if (t < 0) t = snprintf(tail, room, "}");
+    n += t;
     
+    // 下游可直接从帧头读取类型、级别与时间戳，从字段表定位其余字段
+    // (level 原样写出，含引号或反斜杠时位置无法直接算出，不附字段表)
+    alin_set_output_meta(ALIN_TYPE_LOG, alin_level_code(level), timestamp);
+    size_t level_len = strlen(level);
+    if ((size_t)n < output_size && *alin_scan_string(level) == '\0') {
+        index_output(output, level_len, msg_len, (size_t)ts_len, raw_len);
+    }
     return 0;
 }
+
+int main(int argc, char* argv[]) {
+    return alin_node_main(argc, argv, process, ALIN_NODE_REQUIRE_INPUT | ALIN_NODE_STATELESS);
+}
@@ -0,0 +1,169 @@
+/**
+ * ALIN 指标导出器 (Metrics Exporter)
+ *
+ * 功能: 定期读取指标目录下各节点的指标段 (alin_metrics.h)，按槽位汇总后写成一份 JSON 快照，
+ *       供 docs/stream_dashboard.html 或其他外部程序轮询; 只读映射，不影响节点的热路径
+ * 输出: 每个槽位的计数、相对上一次快照的速率与延迟分位数 (纳秒)，例如
+ *       {"time":1700000000.000,"stages":[{"name":"01_parse","instances":1,"live":1,
+ *        "processed":300000,"emitted":300000,"dropped":0,"shed":0,"errors":0,"rate":51234.5,
+ *        "latency_ns":{"mean":812,"p50":767,"p99":2047,"p999":8191,"max":40211}}]}
+ *       写入文件时先写临时文件再 rename，读者不会看到写了一半的快照
+ *
+ * 使用方式:
+ *   alin/bin/alin_exporter [-d metrics_dir] [-i seconds] [-o output.json] [-1]
+ *   alin/bin/alin_exporter -o docs/metrics.json     # 配合仪表盘 (python3 -m http.server -d docs)
+ *   alin/bin/alin_exporter -1                       # 输出一次快照到 stdout 后退出
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "alin_metrics.h"
+
+#define MAX_ENTRIES 256
+
+alin_metrics_sum_t current[MAX_ENTRIES];
+alin_metrics_sum_t previous[MAX_ENTRIES];
+int current_count = 0;
+int previous_count = 0;
+volatile sig_atomic_t stopping = 0;
+
+void on_signal(int sig) {
+    (void)sig;
+    stopping = 1;
+}
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * 槽位名原样写入 JSON 字符串 (只需转义引号与反斜杠)
+ */
+void write_name(FILE* out, const char* name) {
+    fputc('"', out);
+    for (const char* p = name; *p; p++) {
+        if (*p == '"' || *p == '\\') fputc('\\', out);
+        fputc(*p, out);
+    }
+    fputc('"', out);
+}
+
+const alin_metrics_sum_t* find_previous(const char* name) {
+    for (int i = 0; i < previous_count; i++) {
+        if (strcmp(previous[i].name, name) == 0) return &previous[i];
+    }
+    return NULL;
+}
+
+void write_snapshot(FILE* out, double elapsed) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    fprintf(out, "{\"time\":%.3f,\"stages\":[", ts.tv_sec + ts.tv_nsec / 1e9);
+    for (int i = 0; i < current_count; i++) {
+        const alin_metrics_sum_t* m = &current[i];
+        const alin_metrics_sum_t* last = find_previous(m->name);
+        double rate = 0;
+        if (last && elapsed > 0 && m->processed >= last->processed) {
+            rate = (m->processed - last->processed) / elapsed;
+        }
+
+        fprintf(out, "%s\n  {\"name\":", i ? "," : "");
+        write_name(out, m->name);
+        fprintf(out, ",\"instances\":%d,\"live\":%d,\"processed\":%lu,\"emitted\":%lu,\"dropped\":%lu,"
+            "\"shed\":%lu,\"errors\":%lu,\"rate\":%.1f,", m->instances, m->live,
+            (unsigned long)m->processed, (unsigned long)m->emitted, (unsigned long)m->dropped,
+            (unsigned long)m->shed, (unsigned long)m->errors, rate);
+        fprintf(out, "\"latency_ns\":{\"mean\":%lu,\"p50\":%lu,\"p99\":%lu,\"p999\":%lu,\"max\":%lu}}",
+            (unsigned long)(m->processed ? m->latency_sum / m->processed : 0),
+            (unsigned long)alin_metrics_percentile(m, 0.50),
+            (unsigned long)alin_metrics_percentile(m, 0.99),
+            (unsigned long)alin_metrics_percentile(m, 0.999),
+            (unsigned long)m->latency_max);
+    }
+    fprintf(out, "%s]}\n", current_count ? "\n" : "");
+}
+
+/**
+ * 写出快照: 文件先写到 <output>.tmp 再原子替换
+ */
+int publish(const char* output, double elapsed) {
+    if (strcmp(output, "-") == 0) {
+        write_snapshot(stdout, elapsed);
+        fflush(stdout);
+        return 0;
+    }
+
+    char tmp[4096];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", output);
+    FILE* out = fopen(tmp, "w");
+    if (!out) {
+        fprintf(stderr, "[EXPORTER] Cannot write %s: %s\n", tmp, strerror(errno));
+        return -1;
+    }
+    write_snapshot(out, elapsed);
+    if (fclose(out) != 0 || rename(tmp, output) != 0) {
+        fprintf(stderr, "[EXPORTER] Cannot publish %s: %s\n", output, strerror(errno));
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-d metrics_dir] [-i seconds] [-o output.json] [-1]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    const char* dir = getenv("ALIN_METRICS_DIR");
+    const char* output = "-";
+    double interval = 1.0;
+    int once = 0;
+    int opt;
+
+    if (!dir || dir[0] == '\0') dir = "alin/state/metrics";
+    while ((opt = getopt(argc, argv, "d:i:o:1h")) != -1) {
+        switch (opt) {
+            case 'd': dir = optarg; break;
+            case 'i': interval = atof(optarg); break;
+            case 'o': output = optarg; break;
+            case '1': once = 1; break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (interval <= 0) {
+        fprintf(stderr, "[EXPORTER] Invalid interval\n");
+        return 1;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    double last = 0;
+    while (!stopping) {
+        double now = now_seconds();
+        current_count = alin_metrics_collect(dir, current, MAX_ENTRIES);
+        if (current_count < 0) {
+            if (once) {
+                fprintf(stderr, "[EXPORTER] Cannot read %s: %s\n", dir, strerror(errno));
+                return 1;
+            }
+            current_count = 0;    // 运行器尚未创建目录，继续等待
+        }
+        publish(output, last > 0 ? now - last : 0);
+        if (once) break;
+
+        memcpy(previous, current, sizeof(current[0]) * current_count);
+        previous_count = current_count;
+        last = now;
+        usleep((useconds_t)(interval * 1e6));
+    }
+    return 0;
+}
@@ -0,0 +1,732 @@
+/**
+ * ALIN 有序并行副本分发器 (Order-Preserving Fan-out)
+ *
+ * 功能: 在管道中代替一个无状态节点，内部启动 N 个副本并行处理，
+ *       各副本的输出按输入顺序重新拼接后再交给下游
+ * 输入: 换行分隔的记录 (stdin)
+ * 输出: 与单个节点完全相同的记录序列 (stdout)
+ *
+ * 分批: 输入按完整行切成不超过 64KB 的批次并编号，每批末尾附一行 ALIN_BATCH_MAGIC;
+ *       节点运行时把该行原样回显，分发器据此把副本的输出归入对应批次
+ * 调度: 每个副本最多 MAX_INFLIGHT 个未完成批次，新批次总交给未完成数最少的副本
+ *       (空闲副本主动领取下一批，慢副本不会积压任务)
+ * 重排: 完成的批次按编号写出，下游看到的记录顺序与输入一致
+ * 无状态: 先启动一个副本，只有它在 HELLO 中声明 ALIN_CTL_CAP_STATELESS 时
+ *       才启动其余副本，否则退化为单副本 (有状态节点始终只看到一条全序的流);
+ *       不使用节点运行时的节点不会回显批次边界，此时直接转发其输出
+ *
+ * 对运行器而言分发器就是一个普通节点: 经 fd 3 接入控制通道 (REDIRECT / MARK / BYE)，
+ * 热替换时整组副本一起排空退出，由指向新节点的分发器接管;
+ * 输出队列满时总是阻塞 (整批写出，不按记录丢弃)，等待时间与占用峰值同样以 STATS 汇报
+ *
+ * 使用方式 (由 alin_runner -r <slot>=N 启动):
+ *   alin/bin/alin_fanout -n replicas node_path
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "alin_ctl.h"
+#include "alin_frame.h"
+
+#define MAX_REPLICAS 64
+#define BATCH_BYTES 65536
+#define MAX_INFLIGHT 2           // 每个副本的未完成批次上限 (一批处理、一批排队)
+#define IO_BLOCK_SIZE 65536
+#define CTL_GRACE 1.0            // 等待首个副本 HELLO 的时间
+#define STATS_INTERVAL 1.0       // 输出队列统计的汇报间隔
+
+#define MARK_LINE ALIN_BATCH_MAGIC "\n"
+#define MARK_LEN (sizeof(MARK_LINE) - 1)
+
+typedef struct Batch {
+    long seq;
+    char* in;                    // 输入记录 + 批次边界行
+    size_t in_len;
+    size_t in_off;               // 已写入副本的字节数
+    char* out;                   // 副本输出 (不含边界行)
+    size_t out_len;
+    size_t out_cap;
+    int done;
+    struct Batch* next;          // 全局顺序 (按编号)
+    struct Batch* next_queued;   // 同一副本内的分发顺序
+} Batch;
+
+typedef struct {
+    pid_t pid;
+    int in_fd;                   // 副本 stdin 写端 (非阻塞)，-1 表示已关闭
+    int out_fd;                  // 副本 stdout 读端，-1 表示已 EOF
+    int ctl_fd;                  // 副本控制通道 (只读取 HELLO，其余丢弃)
+    int caps;
+    int hello;
+    Batch* head;                 // 已分发、输出尚未收齐的批次
+    Batch* tail;
+    Batch* sending;              // 第一个尚未写完的批次
+    int inflight;
+    char rbuf[IO_BLOCK_SIZE];    // 尚未归入批次的输出 (可能以半个边界行结尾)
+    size_t rlen;
+} Replica;
+
+Replica replicas[MAX_REPLICAS];
+int replica_count = 0;
+const char* node_path = NULL;
+
+Batch* order_head = NULL;        // 尚未写出的批次 (按编号)
+Batch* order_tail = NULL;
+long next_seq = 0;
+
+// 输入缓冲: 读入但尚未切成批次的数据
+char* ibuf = NULL;
+size_t ilen = 0;
+size_t icap = 0;
+int input_eof = 0;
+
+int ordered = 1;                 // 副本回显批次边界 (使用节点运行时)
+int ctl_fd = -1;                 // 与运行器之间的控制通道
+long records_in = 0;
+long records_out = 0;            // 写入当前下游的记录数
+long records_mark = -1;
+int failed = 0;
+
+// 输出队列 (通往下游的管道) 统计，经 ALIN_CTL_STATS 汇报
+int out_pipe_size = 0;           // 0 表示 stdout 不是管道
+long stall_us = 0;
+long queue_peak = 0;
+double stats_sent = 0;
+
+void log_fanout(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "\033[0;34m[FANOUT]\033[0m ");
+    vfprintf(stderr, fmt, ap);
+    fprintf(stderr, "\n");
+    va_end(ap);
+}
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int make_pipe(int fds[2]) {
+    if (pipe(fds) != 0) return -1;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return 0;
+}
+
+int write_all(int fd, const char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * 读取输出管道的容量 (启动与切换下游后调用)
+ */
+void probe_output() {
+    out_pipe_size = 0;
+#ifdef F_GETPIPE_SZ
+    int size = fcntl(STDOUT_FILENO, F_GETPIPE_SZ);
+    if (size > 0) out_pipe_size = size;
+#endif
+}
+
+/**
+ * 汇报输出队列统计 (累计值); force 为 0 时至多每秒一次
+ */
+void report_stats(int force) {
+    if (ctl_fd < 0) return;
+    double now = now_seconds();
+    if (!force && now - stats_sent < STATS_INTERVAL) return;
+    stats_sent = now;
+    alin_ctl_msg_t stats = { ALIN_CTL_STATS, 0, stall_us, 0, queue_peak };
+    alin_ctl_send(ctl_fd, &stats, NULL, 0);
+}
+
+/**
+ * 写出到下游; 管道中放不下时写入会阻塞，计入等待时间
+ */
+int write_out(const char* buf, size_t len) {
+    int queued = 0;
+#ifdef FIONREAD
+    if (out_pipe_size > 0 && ioctl(STDOUT_FILENO, FIONREAD, &queued) != 0) queued = 0;
+#endif
+    int full = out_pipe_size > 0 && queued + (long)len > out_pipe_size;
+    long occupied = full ? out_pipe_size : queued + (long)len;
+    if (occupied > queue_peak) queue_peak = occupied;
+
+    double start = full ? now_seconds() : 0;
+    int rc = write_all(STDOUT_FILENO, buf, len);
+    if (full) stall_us += (long)((now_seconds() - start) * 1e6);
+    report_stats(0);
+    return rc;
+}
+
+long count_records(const char* buf, size_t len) {
+    long count = 0;
+    const char* p = buf;
+    const char* end = buf + len;
+    while ((p = memchr(p, '\n', end - p)) != NULL) {
+        count++;
+        p++;
+    }
+    return count;
+}
+
+char* find_last_newline(char* buf, size_t len) {
+    while (len > 0) {
+        if (buf[--len] == '\n') return buf + len;
+    }
+    return NULL;
+}
+
+/**
+ * 启动一个副本: 输入/输出各一条管道，控制通道放在 fd 3
+ */
+int spawn_replica(Replica* r) {
+    int in[2], out[2], ctl[2];
+    if (make_pipe(in) != 0) return -1;
+    if (make_pipe(out) != 0) {
+        close(in[0]);
+        close(in[1]);
+        return -1;
+    }
+    if (socketpair(AF_UNIX, ALIN_CTL_SOCK_TYPE, 0, ctl) != 0) {
+        close(in[0]);
+        close(in[1]);
+        close(out[0]);
+        close(out[1]);
+        return -1;
+    }
+    fcntl(ctl[0], F_SETFD, FD_CLOEXEC);
+    fcntl(ctl[1], F_SETFD, FD_CLOEXEC);
+
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+    if (pid == 0) {
+        dup2(in[0], STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        if (ctl[1] != ALIN_CTL_FD_NUM) {
+            dup2(ctl[1], ALIN_CTL_FD_NUM);
+        } else {
+            fcntl(ctl[1], F_SETFD, 0);
+        }
+        signal(SIGPIPE, SIG_DFL);
+        char* argv[] = { (char*)node_path, NULL };
+        execv(node_path, argv);
+        fprintf(stderr, "[FANOUT] exec failed: %s: %s\n", node_path, strerror(errno));
+        _exit(127);
+    }
+
+    close(in[0]);
+    close(out[1]);
+    close(ctl[1]);
+    memset(r, 0, sizeof(*r));
+    r->pid = pid;
+    r->in_fd = in[1];
+    r->out_fd = out[0];
+    r->ctl_fd = ctl[0];
+    fcntl(r->in_fd, F_SETFL, O_NONBLOCK);
+    return 0;
+}
+
+/**
+ * 读取副本的控制消息 (HELLO 记下能力位，BYE 等一律丢弃)
+ */
+void poll_replica_ctl(Replica* r) {
+    alin_ctl_msg_t msg;
+    int fds[ALIN_CTL_MAX_FDS];
+    int rc;
+
+    while (r->ctl_fd >= 0 && (rc = alin_ctl_recv(r->ctl_fd, &msg, fds, 1)) != -1) {
+        if (rc == 0) {
+            close(r->ctl_fd);
+            r->ctl_fd = -1;
+            break;
+        }
+        for (int j = 0; j < ALIN_CTL_MAX_FDS; j++) {
+            if (fds[j] >= 0) close(fds[j]);
+        }
+        if (msg.type == ALIN_CTL_HELLO) {
+            r->hello = 1;
+            r->caps = (int)msg.b;
+        }
+    }
+}
+
+/**
+ * 启动副本组: 首个副本声明无状态后才并行
+ */
+int start_replicas(int wanted) {
+    if (spawn_replica(&replicas[0]) != 0) return -1;
+    replica_count = 1;
+
+    double deadline = now_seconds() + CTL_GRACE;
+    while (!replicas[0].hello && replicas[0].ctl_fd >= 0) {
+        int wait_ms = (int)((deadline - now_seconds()) * 1000);
+        if (wait_ms <= 0) break;
+        struct pollfd pfd = { replicas[0].ctl_fd, POLLIN, 0 };
+        if (poll(&pfd, 1, wait_ms) < 0 && errno != EINTR) break;
+        poll_replica_ctl(&replicas[0]);
+    }
+
+    if (!replicas[0].hello) {
+        log_fanout("%s does not use the node runtime, forwarding a single instance", node_path);
+        ordered = 0;
+        return 0;
+    }
+    if (wanted > 1 && !(replicas[0].caps & ALIN_CTL_CAP_STATELESS)) {
+        log_fanout("%s is not declared stateless, running a single instance", node_path);
+        return 0;
+    }
+    for (int i = 1; i < wanted; i++) {
+        if (spawn_replica(&replicas[i]) != 0) {
+            log_fanout("Cannot start replica %d: %s", i, strerror(errno));
+            break;
+        }
+        replica_count++;
+    }
+    return 0;
+}
+
+/**
+ * 把副本排队中的批次尽量写入其 stdin (非阻塞)
+ * @return 0 正常, -1 副本已不再读取
+ */
+int feed_replica(Replica* r) {
+    while (r->sending && r->in_fd >= 0) {
+        Batch* b = r->sending;
+        ssize_t n = write(r->in_fd, b->in + b->in_off, b->in_len - b->in_off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            return -1;
+        }
+        b->in_off += (size_t)n;
+        if (b->in_off < b->in_len) continue;
+        r->sending = b->next_queued;
+        if (!ordered) {
+            // 没有批次边界可等: 写完即结束
+            r->head = r->sending;
+            if (!r->head) r->tail = NULL;
+            r->inflight--;
+            free(b->in);
+            free(b);
+        }
+    }
+    return 0;
+}
+
+/**
+ * 选出领取下一批的副本: 未完成批次最少者
+ * @return 副本下标, -1 表示全部满载
+ */
+int pick_replica() {
+    static int start = 0;
+    int best = -1;
+    for (int k = 0; k < replica_count; k++) {
+        int i = (start + k) % replica_count;
+        Replica* r = &replicas[i];
+        if (r->in_fd < 0 || r->inflight >= MAX_INFLIGHT) continue;
+        if (best < 0 || r->inflight < replicas[best].inflight) best = i;
+    }
+    if (best >= 0) start = (best + 1) % replica_count;
+    return best;
+}
+
+/**
+ * 从输入缓冲切出一批完整的行
+ * @return 批次, NULL 表示暂无完整的行
+ */
+Batch* cut_batch() {
+    if (ilen == 0) return NULL;
+
+    size_t limit = ilen < BATCH_BYTES ? ilen : BATCH_BYTES;
+    char* last = find_last_newline(ibuf, limit);
+    if (!last) last = memchr(ibuf, '\n', ilen);    // 超长记录单独成批
+    size_t take = last ? (size_t)(last - ibuf) + 1 : 0;
+    int tail = 0;
+    if (take == 0) {
+        if (!input_eof) return NULL;
+        take = ilen;                                // 最后一行没有换行符
+        tail = 1;
+    }
+
+    size_t mark = ordered ? MARK_LEN : 0;
+    Batch* b = calloc(1, sizeof(Batch));
+    if (!b) return NULL;
+    b->in = malloc(take + tail + mark);
+    if (!b->in) {
+        free(b);
+        return NULL;
+    }
+    memcpy(b->in, ibuf, take);
+    if (tail) b->in[take] = '\n';
+    memcpy(b->in + take + tail, MARK_LINE, mark);
+    b->in_len = take + tail + mark;
+    b->seq = next_seq++;
+    records_in += count_records(b->in, take + tail);
+
+    memmove(ibuf, ibuf + take, ilen - take);
+    ilen -= take;
+
+    if (ordered) {
+        if (order_tail) order_tail->next = b;
+        else order_head = b;
+        order_tail = b;
+    }
+    return b;
+}
+
+/**
+ * 把输入缓冲中的完整行分发给有空闲的副本
+ */
+void dispatch() {
+    for (;;) {
+        int i = pick_replica();
+        if (i < 0) return;
+        Batch* b = cut_batch();
+        if (!b) return;
+
+        Replica* r = &replicas[i];
+        if (r->tail) r->tail->next_queued = b;
+        else r->head = b;
+        r->tail = b;
+        if (!r->sending) r->sending = b;
+        r->inflight++;
+        if (feed_replica(r) != 0) {
+            log_fanout("Replica %d stopped reading input", i);
+            failed = 1;
+        }
+    }
+}
+
+void append_output(Batch* b, const char* data, size_t len) {
+    if (b->out_len + len > b->out_cap) {
+        size_t cap = b->out_cap ? b->out_cap : IO_BLOCK_SIZE;
+        while (cap < b->out_len + len) cap *= 2;
+        char* grown = realloc(b->out, cap);
+        if (!grown) {
+            log_fanout("Out of memory buffering batch %ld", b->seq);
+            exit(1);
+        }
+        b->out = grown;
+        b->out_cap = cap;
+    }
+    memcpy(b->out + b->out_len, data, len);
+    b->out_len += len;
+}
+
+/**
+ * 副本回显了批次边界: 其最早的未完成批次已收齐
+ */
+void complete_batch(Replica* r) {
+    Batch* b = r->head;
+    b->done = 1;
+    free(b->in);
+    b->in = NULL;
+    r->head = b->next_queued;
+    if (!r->head) r->tail = NULL;
+    r->inflight--;
+}
+
+/**
+ * 把副本的输出归入批次: 边界行之前的字节属于该副本最早的未完成批次
+ */
+void collect_output(Replica* r, int index) {
+    if (!ordered) {
+        // 单实例直接转发，只写出完整的行，切换下游时仍处于记录边界
+        char* last = find_last_newline(r->rbuf, r->rlen);
+        size_t whole = last ? (size_t)(last - r->rbuf) + 1 : (r->rlen == sizeof(r->rbuf) ? r->rlen : 0);
+        if (whole > 0 && write_out(r->rbuf, whole) != 0) failed = 1;
+        records_out += count_records(r->rbuf, whole);
+        memmove(r->rbuf, r->rbuf + whole, r->rlen - whole);
+        r->rlen -= whole;
+        return;
+    }
+
+    size_t pos = 0;
+    while (pos < r->rlen) {
+        char* p = memchr(r->rbuf + pos, ALIN_BATCH_MAGIC[0], r->rlen - pos);
+        size_t upto = p ? (size_t)(p - r->rbuf) : r->rlen;
+        if (upto > pos) {
+            if (r->head) append_output(r->head, r->rbuf + pos, upto - pos);
+            else log_fanout("Replica %d wrote output outside any batch", index);
+            pos = upto;
+        }
+        if (!p) break;
+
+        size_t avail = r->rlen - pos;
+        if (avail < MARK_LEN) {
+            // 可能是被拆开的边界行，等待后续数据
+            if (memcmp(r->rbuf + pos, MARK_LINE, avail) == 0) break;
+        } else if (memcmp(r->rbuf + pos, MARK_LINE, MARK_LEN) == 0 && r->head) {
+            complete_batch(r);
+            pos += MARK_LEN;
+            continue;
+        }
+        if (r->head) append_output(r->head, r->rbuf + pos, 1);
+        pos++;
+    }
+    memmove(r->rbuf, r->rbuf + pos, r->rlen - pos);
+    r->rlen -= pos;
+}
+
+/**
+ * 按编号写出已完成的批次
+ */
+int flush_ordered() {
+    while (order_head && order_head->done) {
+        Batch* b = order_head;
+        if (b->out_len > 0) {
+            if (write_out(b->out, b->out_len) != 0) return -1;
+            records_out += count_records(b->out, b->out_len);
+        }
+        order_head = b->next;
+        if (!order_head) order_tail = NULL;
+        free(b->out);
+        free(b);
+    }
+    return 0;
+}
+
+/**
+ * 运行器的控制消息; 输出总是整批同步写出，任何时刻都处于记录边界
+ */
+void handle_ctl() {
+    alin_ctl_msg_t msg;
+    int fds[ALIN_CTL_MAX_FDS];
+    int rc;
+
+    while (ctl_fd >= 0 && (rc = alin_ctl_recv(ctl_fd, &msg, fds, 1)) != -1) {
+        if (rc == 0) {
+            close(ctl_fd);
+            ctl_fd = -1;
+            break;
+        }
+        if (msg.type == ALIN_CTL_REDIRECT && fds[0] >= 0) {
+            dup2(fds[0], STDOUT_FILENO);
+            close(fds[0]);
+            probe_output();
+            alin_ctl_msg_t ack = { ALIN_CTL_ACK, 0, records_out, 0, 0 };
+            alin_ctl_send(ctl_fd, &ack, NULL, 0);
+            records_out = 0;
+            continue;
+        }
+        if (msg.type == ALIN_CTL_MARK) records_mark = records_in;
+        for (int j = 0; j < ALIN_CTL_MAX_FDS; j++) {
+            if (fds[j] >= 0) close(fds[j]);
+        }
+    }
+}
+
+/**
+ * 输入已全部分发且写完: 关闭副本的 stdin，副本处理完后自然退出
+ */
+void close_inputs() {
+    if (!input_eof || ilen > 0) return;
+    for (int i = 0; i < replica_count; i++) {
+        Replica* r = &replicas[i];
+        if (r->in_fd >= 0 && !r->sending) {
+            close(r->in_fd);
+            r->in_fd = -1;
+        }
+    }
+}
+
+int all_outputs_closed() {
+    for (int i = 0; i < replica_count; i++) {
+        if (replicas[i].out_fd >= 0) return 0;
+    }
+    return 1;
+}
+
+/**
+ * 主循环: 读输入、分发、收集副本输出并按序写出
+ */
+void run() {
+    while (!all_outputs_closed()) {
+        struct pollfd pfd[2 + MAX_REPLICAS * 3];
+        int owner[2 + MAX_REPLICAS * 3];
+        int nfds = 0;
+
+        // 背压: 副本满载且缓冲已攒够一批时暂停读取
+        int want_input = !input_eof && (ilen < BATCH_BYTES || !memchr(ibuf, '\n', ilen));
+        if (want_input) {
+            pfd[nfds].fd = STDIN_FILENO; pfd[nfds].events = POLLIN; owner[nfds++] = -1;
+        }
+        if (ctl_fd >= 0) {
+            pfd[nfds].fd = ctl_fd; pfd[nfds].events = POLLIN; owner[nfds++] = -2;
+        }
+        for (int i = 0; i < replica_count; i++) {
+            Replica* r = &replicas[i];
+            if (r->out_fd >= 0) {
+                pfd[nfds].fd = r->out_fd; pfd[nfds].events = POLLIN; owner[nfds++] = i;
+            }
+            if (r->in_fd >= 0 && r->sending) {
+                pfd[nfds].fd = r->in_fd; pfd[nfds].events = POLLOUT; owner[nfds++] = MAX_REPLICAS + i;
+            }
+            if (r->ctl_fd >= 0) {
+                pfd[nfds].fd = r->ctl_fd; pfd[nfds].events = POLLIN; owner[nfds++] = 2 * MAX_REPLICAS + i;
+            }
+        }
+
+        if (poll(pfd, nfds, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int j = 0; j < nfds; j++) {
+            if (!pfd[j].revents) continue;
+            int who = owner[j];
+
+            if (who == -1) {
+                if (ilen == icap) {
+                    size_t cap = icap * 2;
+                    char* grown = realloc(ibuf, cap);
+                    if (!grown) {
+                        log_fanout("Out of memory reading input");
+                        exit(1);
+                    }
+                    ibuf = grown;
+                    icap = cap;
+                }
+                ssize_t n = read(STDIN_FILENO, ibuf + ilen, icap - ilen);
+                if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+                if (n <= 0) input_eof = 1;
+                else ilen += (size_t)n;
+            } else if (who == -2) {
+                handle_ctl();
+            } else if (who < MAX_REPLICAS) {
+                Replica* r = &replicas[who];
+                ssize_t n = read(r->out_fd, r->rbuf + r->rlen, sizeof(r->rbuf) - r->rlen);
+                if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+                if (n <= 0) {
+                    if (!ordered && r->rlen > 0) {
+                        if (write_out(r->rbuf, r->rlen) != 0) failed = 1;
+                        records_out++;
+                        r->rlen = 0;
+                    }
+                    if (r->head || r->rlen > 0) {
+                        log_fanout("Replica %d exited with unfinished batches", who);
+                        failed = 1;
+                        // 保留已收到的部分输出，让后续批次继续按序写出
+                        if (r->rlen > 0 && r->head) append_output(r->head, r->rbuf, r->rlen);
+                        r->rlen = 0;
+                        while (r->head) complete_batch(r);
+                        r->sending = NULL;
+                    }
+                    close(r->out_fd);
+                    r->out_fd = -1;
+                    if (r->in_fd >= 0) {
+                        close(r->in_fd);
+                        r->in_fd = -1;
+                    }
+                    continue;
+                }
+                r->rlen += (size_t)n;
+                collect_output(r, who);
+            } else if (who < 2 * MAX_REPLICAS) {
+                Replica* r = &replicas[who - MAX_REPLICAS];
+                if (feed_replica(r) != 0) {
+                    log_fanout("Replica %d stopped reading input", who - MAX_REPLICAS);
+                    failed = 1;
+                    close(r->in_fd);
+                    r->in_fd = -1;
+                }
+            } else {
+                poll_replica_ctl(&replicas[who - 2 * MAX_REPLICAS]);
+            }
+        }
+
+        dispatch();
+        if (flush_ordered() != 0) {
+            log_fanout("Output closed: %s", strerror(errno));
+            failed = 1;
+            break;
+        }
+        close_inputs();
+    }
+}
+
+void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s -n replicas node_path\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    int wanted = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:h")) != -1) {
+        switch (opt) {
+            case 'n': wanted = atoi(optarg); break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind >= argc || wanted < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (wanted > MAX_REPLICAS) wanted = MAX_REPLICAS;
+    node_path = argv[optind];
+
+    // 副本提前退出时由 write 返回 EPIPE
+    signal(SIGPIPE, SIG_IGN);
+
+    const char* env = getenv("ALIN_CTL_FD");
+    if (env && env[0] != '\0' && fcntl(atoi(env), F_GETFD) >= 0) {
+        ctl_fd = atoi(env);
+        fcntl(ctl_fd, F_SETFD, FD_CLOEXEC);
+        alin_ctl_msg_t hello = { ALIN_CTL_HELLO, 0, (int64_t)getpid(), 0, 0 };
+        if (alin_ctl_send(ctl_fd, &hello, NULL, 0) != 0) ctl_fd = -1;
+    }
+
+    probe_output();
+    icap = 2 * BATCH_BYTES;
+    ibuf = malloc(icap);
+    if (!ibuf || start_replicas(wanted) != 0) {
+        log_fanout("Cannot start %s", node_path);
+        return 1;
+    }
+
+    run();
+
+    for (int i = 0; i < replica_count; i++) {
+        int status;
+        if (replicas[i].in_fd >= 0) close(replicas[i].in_fd);
+        if (waitpid(replicas[i].pid, &status, 0) < 0) continue;
+        if ((WIFEXITED(status) && WEXITSTATUS(status) != 0) || WIFSIGNALED(status)) failed = 1;
+    }
+
+    if (ctl_fd >= 0) {
+        report_stats(1);
+        alin_ctl_msg_t bye = { ALIN_CTL_BYE, 0, records_in, records_mark, records_out };
+        alin_ctl_send(ctl_fd, &bye, NULL, 0);
+    }
+    return failed ? 1 : 0;
+}
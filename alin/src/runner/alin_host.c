@@ -0,0 +1,684 @@
+/**
+ * ALIN 进程内宿主 (In-Process Plugin Host)
+ *
+ * 功能: 将 alin/active 符号链接指向的节点以共享库 (.so) 形式 dlopen 到同一地址空间，
+ *       每条记录依次直接调用各节点导出的 process()，省去进程间管道的拷贝与切换
+ * 输入: 换行分隔的记录 (stdin 或文件)
+ * 输出: 最后一个节点的输出 (stdout)
+ *
+ * 插件解析: 链接目标本身是 .so 时直接加载，否则加载同目录下的 <目标>.so
+ *           (make 会为每个使用节点运行时的节点同时生成可执行文件和 .so);
+ *           同一个 .so 用于多个槽位时，其后的槽位加载一份私有副本，全局状态与 arena 不共享
+ * 热重载: 后台线程通过 inotify 监听 active 与 nodes 目录，有变化时置位标志;
+ *         主循环在两条记录之间检查该标志，重新解析拓扑并加载新 .so，保持"原子路由"语义
+ *         (没有变化时每条记录只多一次原子读; 不支持 inotify 时每隔
+ *          ALIN_HOST_CHECK_MS 毫秒 (默认 100) 重扫)
+ *         被换下的插件在卸载前执行最后一次空闲回调 (final)，攒下的结果沿旧拓扑写出
+ *
+ * DAG: 分叉槽位 (目录，见 alin_topology.h) 把同一条记录依次交给每条分支，
+ *      各分支拿到的是同一块输入缓冲的指针 (按引用共享，不复制、不重新解析);
+ *      分支的输出在汇合点之后继续沿父链流动 (扇入)，同一条输入的输出按分支顺序写出
+ * 指标: 设置 ALIN_METRICS_DIR 时每个插件槽位一个指标段 (名称即槽位路径，如 02_fork/a/01_x)，
+ *       计时每次 process() 调用 (见 alin_metrics.h)
+ * 控制通道: 由 alin_runner 启动时 (ALIN_CTL_FD) 接受 REDIRECT/MARK/QUEUE，汇报输出队列统计，
+ *         退出时汇报 BYE; 运行器以此执行分叉槽位 (alin_host -f <分叉目录>) 并照常热替换其下游
+ *
+ * 使用方式:
+ *   alin/bin/alin_host [-a active_dir] [-n nodes_dir] [-s state_dir] [input_file]
+ *   alin/bin/alin_host -f fork_dir [-n nodes_dir] [input_file]    # 只运行一个分叉槽位
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dlfcn.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "alin_ctl.h"
+#include "alin_node.h"
+#include "alin_metrics.h"
+#include "alin_topology.h"
+
+#define MAX_STAGES ALIN_MAX_SLOTS
+#define MAX_PATH ALIN_MAX_PATH
+
+// 拓扑树的一个槽位: 节点插件或分叉
+typedef struct {
+    alin_slot_t slot;          // 槽位与目标节点 (link 为相对 active 目录的路径)
+    char plugin[MAX_PATH];     // 实际加载的 .so 路径
+    void* handle;              // dlopen 句柄 (分叉为 NULL)
+    alin_process_fn process;   // 节点入口
+    alin_arena_t* arena;       // 插件自己的记录 arena: 输出缓冲从中分配，每次调用前重置
+                               // (各槽位的句柄互不相同，因而各用一个，分支共享的输入不会被兄弟分支覆盖)
+    alin_metrics_t* metrics;   // 指标段 (按槽位名，替换插件时沿用; 未启用时为 NULL)
+    void (*idle)(int);         // 插件运行时的 alin_node_idle (旧版本插件没有时为 NULL)
+    const char* (*next_extra)(size_t*);    // 插件运行时的 alin_next_extra (同上)
+    int next;                  // 链上的下一槽位，分支末尾指向汇合点 (-1 表示写出)
+    int branch_count;          // 分叉: 分支数
+    int branches[ALIN_MAX_BRANCHES];   // 分叉: 各分支的首个槽位 (空分支直接指向汇合点)
+} Plugin;
+
+Plugin plugins[MAX_STAGES];
+int plugin_count = 0;
+int root = -1;                 // 记录进入拓扑的第一个槽位
+const char* fork_root = NULL;  // -f: 整个拓扑是一个分叉槽位
+
+// 控制通道 (由 alin_runner 启动时)
+alin_reader_t reader;
+int ctl_fd = -1;
+long records_in = 0;
+long records_out = 0;          // 写入当前下游的记录数
+long records_mark = -1;
+
+// 监听线程置位、主循环在记录边界消费
+atomic_int topology_dirty = 0;
+int watch_fd = -1;
+
+void log_host(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "\033[0;35m[HOST]\033[0m ");
+    vfprintf(stderr, fmt, ap);
+    fprintf(stderr, "\n");
+    va_end(ap);
+}
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * 由槽位目标推导插件路径: *.so 原样使用，否则取 <目标>.so
+ */
+int resolve_plugin(const alin_slot_t* slot, char* plugin, size_t size) {
+    size_t len = strlen(slot->path);
+    if (len > 3 && strcmp(slot->path + len - 3, ".so") == 0) {
+        snprintf(plugin, size, "%s", slot->path);
+    } else {
+        snprintf(plugin, size, "%s.so", slot->path);
+    }
+    return access(plugin, R_OK);
+}
+
+/**
+ * 句柄是否已被其他槽位使用 (新拓扑中已加载的前 count 个槽位，或当前拓扑)
+ */
+int handle_in_use(void* handle, const Plugin* nodes, int count) {
+    for (int k = 0; k < count; k++) {
+        if (nodes[k].handle == handle) return 1;
+    }
+    for (int j = 0; j < plugin_count; j++) {
+        if (plugins[j].handle == handle) return 1;
+    }
+    return 0;
+}
+
+/**
+ * 把插件复制到临时文件再加载: Inode 不同，dlopen 视为另一个库 (全局状态与运行时各一份);
+ * 加载后即删除文件，已建立的映射不受影响
+ * @return dlopen 句柄, NULL 失败
+ */
+void* dlopen_private(const char* plugin) {
+    const char* tmp_dir = getenv("TMPDIR");
+    char copy[MAX_PATH];
+    snprintf(copy, sizeof(copy), "%s/alin_host.XXXXXX", tmp_dir && tmp_dir[0] ? tmp_dir : "/tmp");
+    int out = mkstemp(copy);
+    if (out < 0) {
+        log_host("Cannot create a private copy of %s: %s", plugin, strerror(errno));
+        return NULL;
+    }
+    int in = open(plugin, O_RDONLY);
+    char buf[65536];
+    ssize_t n = in < 0 ? -1 : 0;
+    while (in >= 0 && (n = read(in, buf, sizeof(buf))) > 0) {
+        if (write(out, buf, (size_t)n) != n) {
+            n = -1;
+            break;
+        }
+    }
+    if (in >= 0) close(in);
+    close(out);
+
+    void* handle = NULL;
+    if (n < 0) log_host("Cannot copy %s: %s", plugin, strerror(errno));
+    else if (!(handle = dlopen(copy, RTLD_NOW | RTLD_LOCAL))) log_host("dlopen failed: %s", dlerror());
+    unlink(copy);
+    return handle;
+}
+
+/**
+ * 加载一个槽位的插件到 p (成功时才覆盖 p); loaded 为新拓扑中已加载的前 count 个槽位
+ */
+int load_plugin(Plugin* p, const alin_slot_t* slot, const Plugin* loaded, int count) {
+    char plugin[MAX_PATH];
+    if (resolve_plugin(slot, plugin, sizeof(plugin)) != 0) {
+        log_host("No plugin for %s (expected %s)", slot->link, plugin);
+        return -1;
+    }
+
+    // RTLD_LOCAL: 每个节点的全局状态与运行时符号互相隔离
+    void* handle = dlopen(plugin, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        log_host("dlopen failed: %s", dlerror());
+        return -1;
+    }
+    // 同一文件再次 dlopen 得到的是同一个句柄 (引用计数加一): 改为加载私有副本
+    if (handle_in_use(handle, loaded, count)) {
+        dlclose(handle);
+        handle = dlopen_private(plugin);
+        if (!handle) return -1;
+        log_host("Loaded a private copy of %s for %s", alin_slot_basename(slot), slot->link);
+    }
+
+    alin_process_fn process = (alin_process_fn)dlsym(handle, "process");
+    if (!process) {
+        log_host("%s does not export process()", plugin);
+        dlclose(handle);
+        return -1;
+    }
+    // 插件带有自己的一份节点运行时，process() 中的 alin_record_arena() 指向这里
+    alin_arena_t* (*record_arena)(void) = (alin_arena_t* (*)(void))dlsym(handle, "alin_record_arena");
+    if (!record_arena) {
+        log_host("%s does not export alin_record_arena() (rebuild with make stream)", plugin);
+        dlclose(handle);
+        return -1;
+    }
+
+    p->slot = *slot;
+    snprintf(p->plugin, sizeof(p->plugin), "%s", plugin);
+    p->handle = handle;
+    p->process = process;
+    p->arena = record_arena();
+    p->idle = (void (*)(int))dlsym(handle, "alin_node_idle");
+    p->next_extra = (const char* (*)(size_t*))dlsym(handle, "alin_next_extra");
+    return 0;
+}
+
+void show_chain(int idx, int join, int depth) {
+    for (; idx >= 0 && idx != join; idx = plugins[idx].next) {
+        Plugin* p = &plugins[idx];
+        if (!p->handle) {
+            log_host("  %*s%s ⑂ %d branches", depth * 2, "", p->slot.link, p->branch_count);
+            for (int b = 0; b < p->branch_count; b++) show_chain(p->branches[b], p->next, depth + 1);
+            continue;
+        }
+        log_host("  %*s%s → %s [Inode: %lu]", depth * 2, "", p->slot.link,
+            alin_slot_basename(&p->slot), (unsigned long)p->slot.inode);
+    }
+}
+
+void show_topology() {
+    log_host("=== In-Process Topology ===");
+    show_chain(root, -1, 0);
+    log_host("===========================");
+}
+
+int build_chain(const char* dir, const char* prefix, int join, Plugin* nodes, int* count);
+
+/**
+ * 追加一个分叉槽位，各分支末尾接到 join
+ * @return 槽位下标, -1 超出上限
+ */
+int build_fork(const alin_slot_t* slot, int join, Plugin* nodes, int* count) {
+    alin_slot_t branches[ALIN_MAX_BRANCHES];
+    int n = alin_topology_branches(slot->path, branches, ALIN_MAX_BRANCHES);
+    if (n < 0 || *count >= MAX_STAGES) return -1;
+
+    int idx = (*count)++;
+    Plugin* f = &nodes[idx];
+    memset(f, 0, sizeof(Plugin));
+    f->slot = *slot;
+    f->next = join;
+    f->branch_count = n;
+    alin_watch_add(watch_fd, slot->path);
+
+    for (int b = 0; b < n; b++) {
+        char prefix[MAX_PATH];
+        snprintf(prefix, sizeof(prefix), "%s/%.*s", slot->link, ALIN_MAX_NAME, branches[b].link);
+        alin_watch_add(watch_fd, branches[b].path);
+        int head = build_chain(branches[b].path, prefix, join, nodes, count);
+        if (head < -1) return -1;
+        nodes[idx].branches[b] = head;
+    }
+    return idx;
+}
+
+/**
+ * 解析 dir 下的一条链 (槽位名前加 prefix)，链尾接到 join
+ * @return 链首下标 (空链即 join), -2 超出上限或目录不存在
+ */
+int build_chain(const char* dir, const char* prefix, int join, Plugin* nodes, int* count) {
+    alin_slot_t slots[MAX_STAGES];
+    int n = alin_topology_scan(dir, slots, MAX_STAGES);
+    if (n < 0) return -2;
+
+    // 从链尾向前构建，每个槽位创建时其后继已确定
+    int next = join;
+    for (int i = n - 1; i >= 0; i--) {
+        if (prefix[0] != '\0') {
+            char link[ALIN_MAX_NAME];
+            snprintf(link, sizeof(link), "%s/%s", prefix, slots[i].link);
+            snprintf(slots[i].link, sizeof(slots[i].link), "%s", link);
+        }
+        if (slots[i].fork) {
+            next = build_fork(&slots[i], next, nodes, count);
+            if (next < 0) return -2;
+            continue;
+        }
+        if (*count >= MAX_STAGES) return -2;
+        Plugin* p = &nodes[(*count)];
+        memset(p, 0, sizeof(Plugin));
+        p->slot = slots[i];
+        p->next = next;
+        next = (*count)++;
+    }
+    return next;
+}
+
+int run_from(int idx, const char* in, size_t len, long* failures);
+
+/**
+ * 重新解析拓扑树并与当前加载的插件比较，仅替换指向发生变化的槽位
+ * 新插件全部加载成功后才切换，失败时保留旧拓扑继续运行
+ */
+int reload_topology(const char* active_dir) {
+    static Plugin next[MAX_STAGES];
+    int n = 0;
+    int head;
+
+    if (fork_root) {
+        alin_slot_t slot;
+        struct stat st;
+        memset(&slot, 0, sizeof(slot));
+        if (!realpath(fork_root, slot.path) || stat(slot.path, &st) != 0) return -1;
+        snprintf(slot.link, sizeof(slot.link), "%s", alin_slot_basename(&slot));
+        slot.inode = st.st_ino;
+        slot.fork = 1;
+        head = build_fork(&slot, -1, next, &n);
+    } else {
+        head = build_chain(active_dir, "", -1, next, &n);
+    }
+    if (head < -1) return -1;
+    if (n == 0) return 0;
+
+    int changed = (n != plugin_count || head != root);
+    for (int i = 0; i < n && !changed; i++) {
+        changed = strcmp(next[i].slot.link, plugins[i].slot.link) != 0 ||
+                  next[i].slot.inode != plugins[i].slot.inode ||
+                  next[i].slot.fork != plugins[i].slot.fork;
+    }
+    if (!changed) return 0;
+
+    int reused[MAX_STAGES] = {0};
+    for (int i = 0; i < n; i++) {
+        if (next[i].slot.fork) continue;
+
+        // 指向未变的槽位沿用已加载的句柄 (保留其进程内状态)
+        int found = -1;
+        for (int j = 0; j < plugin_count; j++) {
+            if (plugins[j].handle && !reused[j] && plugins[j].slot.inode == next[i].slot.inode &&
+                strcmp(plugins[j].slot.path, next[i].slot.path) == 0) {
+                found = j;
+                break;
+            }
+        }
+        alin_slot_t slot = next[i].slot;
+        for (int j = 0; j < plugin_count; j++) {
+            if (plugins[j].handle && strcmp(plugins[j].slot.link, slot.link) == 0) {
+                next[i].metrics = plugins[j].metrics;
+                break;
+            }
+        }
+        if (!next[i].metrics) next[i].metrics = alin_metrics_open(slot.link);
+        if (found >= 0) {
+            snprintf(next[i].plugin, sizeof(next[i].plugin), "%s", plugins[found].plugin);
+            next[i].handle = plugins[found].handle;
+            next[i].process = plugins[found].process;
+            next[i].arena = plugins[found].arena;
+            next[i].idle = plugins[found].idle;
+            next[i].next_extra = plugins[found].next_extra;
+            reused[found] = 1;
+        } else if (load_plugin(&next[i], &slot, next, i) != 0) {
+            for (int k = 0; k <= i; k++) {
+                int kept = 0;
+                for (int j = 0; j < plugin_count; j++) {
+                    if (plugins[j].handle && plugins[j].handle == next[k].handle) kept = 1;
+                }
+                if (!kept && next[k].handle) {
+                    alin_arena_free(next[k].arena);
+                    dlclose(next[k].handle);
+                }
+            }
+            log_host("Swap aborted, keeping current topology");
+            return -1;
+        } else if (plugin_count > 0) {
+            log_host("Swapped %s → %s [Inode: %lu]", slot.link,
+                alin_slot_basename(&slot), (unsigned long)slot.inode);
+        }
+    }
+
+    // 被换下的插件按输入结束收尾: 执行最后一次空闲回调 (输出攒下的聚合结果、补记等)，
+    // 追加的记录沿旧拓扑交给下游; 与 idle_plugins 相同按下标从大到小，即从上游到下游
+    long failures = 0;
+    for (int j = plugin_count - 1; j >= 0; j--) {
+        Plugin* p = &plugins[j];
+        if (!p->handle || reused[j] || !p->idle) continue;
+        p->idle(1);
+        size_t len;
+        const char* extra;
+        while (p->next_extra && (extra = p->next_extra(&len)) != NULL) {
+            run_from(p->next, extra, len, &failures);
+        }
+    }
+    for (int j = 0; j < plugin_count; j++) {
+        if (plugins[j].handle && !reused[j]) {
+            alin_arena_free(plugins[j].arena);
+            dlclose(plugins[j].handle);
+        }
+    }
+    memcpy(plugins, next, sizeof(Plugin) * n);
+    plugin_count = n;
+    root = head;
+    return 1;
+}
+
+uint64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * 写出一条记录 (输出队列已满且为丢弃策略时丢弃，计入最后一个节点的 shed)
+ * @return 写出的记录数
+ */
+int emit_record(const char* record, size_t len, Plugin* last) {
+    int admit = alin_queue_admit(len + 1);
+    if (admit == 0) {
+        if (last && last->metrics) alin_metrics_add(&last->metrics->shed, 1);
+        return 0;
+    }
+    fwrite(record, 1, len, stdout);
+    fputc('\n', stdout);
+    if (admit == 2) alin_queue_drain();
+    records_out++;
+    return 1;
+}
+
+/**
+ * 记录从槽位 idx 开始沿链流动直到写出; 分叉处把同一个输入指针依次交给各分支
+ * @return 写出的记录数
+ */
+int run_from(int idx, const char* in, size_t len, long* failures) {
+    Plugin* last = NULL;
+    while (idx >= 0) {
+        Plugin* p = &plugins[idx];
+        if (!p->handle) {
+            int emitted = 0;
+            for (int b = 0; b < p->branch_count; b++) emitted += run_from(p->branches[b], in, len, failures);
+            return emitted;
+        }
+
+        // 本插件上一条记录的输出已经写出或被下游用完
+        alin_arena_reset(p->arena);
+        size_t out_size = alin_output_size(len);
+        char* out = alin_arena_alloc(p->arena, out_size);
+        if (!out) {
+            (*failures)++;
+            return 0;
+        }
+        out[0] = '\0';
+        uint64_t started = p->metrics ? monotonic_ns() : 0;
+        int rc = p->process(in, out, out_size);
+        if (p->metrics) {
+            int outcome = rc < 0 ? ALIN_OUTCOME_ERROR
+                        : (rc == ALIN_PASS || out[0] != '\0') ? ALIN_OUTCOME_EMITTED : ALIN_OUTCOME_DROPPED;
+            alin_metrics_record(p->metrics, monotonic_ns() - started, outcome);
+        }
+        if (rc < 0) {
+            log_host("Node %s failed", p->slot.link);
+            (*failures)++;
+            return 0;
+        }
+        // 插件追加的记录 (alin_emit_extra) 跟在本条之后交给下一槽位
+        size_t extra_len;
+        const char* extra = p->next_extra ? p->next_extra(&extra_len) : NULL;
+        if (extra) {
+            int emitted = 0;
+            if (rc == ALIN_PASS) emitted += run_from(p->next, in, len, failures);
+            else if (out[0] != '\0') emitted += run_from(p->next, out, strlen(out), failures);
+            do {
+                emitted += run_from(p->next, extra, extra_len, failures);
+            } while ((extra = p->next_extra(&extra_len)) != NULL);
+            return emitted;
+        }
+        if (rc != ALIN_PASS) {    // ALIN_PASS: 原样透传，沿用当前输入
+            if (out[0] == '\0') return 0;
+            in = out;
+            len = strlen(out);
+        }
+        last = p;
+        idx = p->next;
+    }
+
+    return emit_record(in, len, last);
+}
+
+/**
+ * 本进程即将阻塞等待输入 (final 为 1 时输入已结束): 各插件执行自己的空闲回调
+ * (如提交攒下的状态写入)，回调中追加的记录交给链上的下一槽位。
+ * 槽位的后继总是先于它创建 (下标更小)，按下标从大到小即从上游到下游，
+ * 上游在回调中追加的记录能赶上下游自己的回调 (final 时下游据此输出最终结果)
+ */
+void idle_plugins(int final) {
+    long failures = 0;
+    for (int i = plugin_count - 1; i >= 0; i--) {
+        Plugin* p = &plugins[i];
+        if (!p->handle || !p->idle) continue;
+        p->idle(final);
+        size_t len;
+        const char* extra;
+        while (p->next_extra && (extra = p->next_extra(&len)) != NULL) {
+            run_from(p->next, extra, len, &failures);
+        }
+    }
+}
+
+/**
+ * 控制消息处理 (读取器在记录边界回调)
+ */
+void handle_ctl(int fd) {
+    alin_ctl_msg_t msg;
+    int fds[ALIN_CTL_MAX_FDS];
+    int rc;
+
+    while ((rc = alin_ctl_recv(fd, &msg, fds, 1)) > 0) {
+        if (msg.type == ALIN_CTL_REDIRECT && fds[0] >= 0) {
+            // 已写出的记录全部交给旧下游后再切换，dup2 同时关闭旧写端
+            fflush(stdout);
+            dup2(fds[0], STDOUT_FILENO);
+            alin_queue_open(fd);
+            alin_ctl_msg_t ack = { ALIN_CTL_ACK, 0, records_out, 0, 0 };
+            alin_ctl_send(fd, &ack, NULL, 0);
+            records_out = 0;
+        } else if (msg.type == ALIN_CTL_QUEUE) {
+            alin_queue_policy((int)msg.a);
+        } else if (msg.type == ALIN_CTL_MARK) {
+            records_mark = records_in;
+        }
+        for (int i = 0; i < ALIN_CTL_MAX_FDS; i++) {
+            if (fds[i] >= 0) close(fds[i]);
+        }
+    }
+    if (rc == 0) reader.ctl_fd = -1;
+}
+
+/**
+ * 由运行器启动时接入控制通道 (不声明帧/环形缓冲能力，两侧保持文本行)
+ */
+int open_ctl() {
+    const char* env = getenv("ALIN_CTL_FD");
+    if (!env || env[0] == '\0') return -1;
+
+    int fd = atoi(env);
+    if (fd < 0 || fcntl(fd, F_GETFD) < 0) return -1;
+    alin_ctl_msg_t hello = { ALIN_CTL_HELLO, 0, (int64_t)getpid(), 0, 0 };
+    if (alin_ctl_send(fd, &hello, NULL, 0) != 0) return -1;
+    return fd;
+}
+
+/**
+ * 监听线程: 阻塞等待目录变化，防抖后通知主循环
+ */
+void* watch_topology(void* arg) {
+    (void)arg;
+    struct pollfd pfd = { watch_fd, POLLIN, 0 };
+
+    for (;;) {
+        if (poll(&pfd, 1, -1) < 0) continue;
+        // ln -sf 会产生一串事件，稍等片刻合并为一次重载
+        usleep(20000);
+        alin_watch_drain(watch_fd);
+        atomic_store(&topology_dirty, 1);
+    }
+    return NULL;
+}
+
+void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-a active_dir | -f fork_dir] [-n nodes_dir] [-s state_dir] [input_file]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    const char* active_dir = "alin/active";
+    const char* state_dir = "alin/state";
+    char nodes_dir[MAX_PATH] = "";
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a:f:n:s:h")) != -1) {
+        switch (opt) {
+            case 'a': active_dir = optarg; break;
+            case 'f': fork_root = optarg; active_dir = optarg; break;
+            case 'n': snprintf(nodes_dir, sizeof(nodes_dir), "%s", optarg); break;
+            case 's': state_dir = optarg; break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    int src_fd = STDIN_FILENO;
+    if (optind < argc) {
+        src_fd = open(argv[optind], O_RDONLY);
+        if (src_fd < 0) {
+            log_host("Cannot open %s: %s", argv[optind], strerror(errno));
+            return 1;
+        }
+    }
+
+    // 环境约定: 与 alin_runner / alin_stream.sh 保持一致 (由运行器启动时已设置)
+    if (!getenv("ALIN_STATE_FILE") || getenv("ALIN_STATE_FILE")[0] == '\0') {
+        char state_file[MAX_PATH];
+        mkdir(state_dir, 0755);
+        snprintf(state_file, sizeof(state_file), "%s/agg_count.state", state_dir);
+        setenv("ALIN_STATE_FILE", state_file, 1);
+    }
+
+    const char* check_env = getenv("ALIN_HOST_CHECK_MS");
+    double check_interval = (check_env ? atof(check_env) : 100.0) / 1000.0;
+
+    // 先开始监听，解析拓扑时顺带监听嵌套的分叉与分支目录
+    if (nodes_dir[0] == '\0') {
+        char parent[MAX_PATH];
+        snprintf(parent, sizeof(parent), "%s/..", active_dir);
+        alin_default_nodes_dir(fork_root ? parent : active_dir, nodes_dir, sizeof(nodes_dir));
+    }
+    watch_fd = alin_watch_open(active_dir, nodes_dir);
+
+    if (reload_topology(active_dir) <= 0 || plugin_count == 0) {
+        log_host("No loadable plugins in %s", active_dir);
+        return 1;
+    }
+    show_topology();
+
+    pthread_t watcher;
+    if (watch_fd >= 0 && pthread_create(&watcher, NULL, watch_topology, NULL) == 0) {
+        pthread_detach(watcher);
+    } else {
+        watch_fd = -1;
+        log_host("inotify unavailable, rescanning every %.0fms", check_interval * 1000);
+    }
+
+    static char stdout_buf[ALIN_READ_BLOCK];
+    setvbuf(stdout, stdout_buf, _IOFBF, sizeof(stdout_buf));
+    alin_reader_init(&reader, src_fd);
+    reader.ctl_fd = ctl_fd = open_ctl();
+    reader.on_ctl = handle_ctl;
+    alin_queue_open(ctl_fd);
+    alin_set_idle_hook(idle_plugins);
+
+    long emitted = 0, failed = 0, swaps = 0;
+    double start_time = now_seconds();
+    double last_check = start_time;
+    double last_report = start_time;
+
+    char* record;
+    size_t len;
+    while ((record = alin_read_record(&reader, &len)) != NULL) {
+        record = alin_trim_span(record, &len);
+        if (record[0] == '\0') continue;
+
+        // 在两条记录之间检查拓扑，保证每条记录只经过一个版本的节点
+        double now = now_seconds();
+        if (watch_fd >= 0) {
+            if (atomic_load_explicit(&topology_dirty, memory_order_relaxed) &&
+                atomic_exchange(&topology_dirty, 0)) {
+                if (reload_topology(active_dir) > 0) {
+                    swaps++;
+                    log_host("Swap applied in %.2fms", (now_seconds() - now) * 1000);
+                }
+            }
+        } else if (now - last_check >= check_interval) {
+            if (reload_topology(active_dir) > 0) swaps++;
+            last_check = now;
+        }
+
+        records_in++;
+        emitted += run_from(root, record, len, &failed);
+        if ((records_in & 4095) == 0) alin_queue_report(0);
+
+        if (now - last_report >= 1.0) {
+            log_host("Processed: %ld events (%.0f/sec)", records_in, records_in / (now - start_time));
+            last_report = now;
+        }
+    }
+    idle_plugins(1);
+    fflush(stdout);
+    alin_reader_close(&reader);
+
+    if (ctl_fd >= 0) {
+        alin_queue_report(1);
+        alin_ctl_msg_t bye = { ALIN_CTL_BYE, 0, records_in, records_mark, records_out };
+        alin_ctl_send(ctl_fd, &bye, NULL, 0);
+    }
+
+    double duration = now_seconds() - start_time;
+    log_host("=== Stream Complete ===");
+    log_host("Total events: %ld (emitted %ld, failed %ld, swaps %ld)", records_in, emitted, failed, swaps);
+    log_host("Duration: %.3fs", duration);
+    log_host("Avg rate: %.0f events/sec", duration > 0 ? records_in / duration : 0);
+
+    for (int i = 0; i < plugin_count; i++) {
+        if (!plugins[i].handle) continue;
+        alin_arena_free(plugins[i].arena);
+        dlclose(plugins[i].handle);
+    }
+    return 0;
+}
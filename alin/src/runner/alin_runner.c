@@ -0,0 +1,1263 @@
+/**
+ * ALIN 常驻管道运行器 (Native Pipeline Runner)
+ *
+ * 功能: 一次性解析 alin/active 拓扑，每个节点只启动一次并用管道串联，
+ *       让记录持续流经整条管道 (替代 alin_stream.sh 逐行 fork 的方式)
+ * 输入: 换行分隔的记录 (stdin 或文件)
+ * 输出: 最后一个节点的 stdout
+ *
+ * 拓扑: 与 alin_run.sh 相同 —— alin/active 下按名称排序的符号链接即管道顺序;
+ *       分叉槽位 (目录，见 alin_topology.h) 作为一级由 alin_host -f 在进程内执行，
+ *       各分支按引用共享同一条输入，输出汇合后流向下一级 (分支内的替换由 alin_host 完成)
+ * 环境: ALIN_FILTER_LEVEL 等配置原样继承给节点;
+ *       未设置 ALIN_STATE_FILE 时默认指向 <state_dir>/agg_count.state;
+ *       为每个节点设置 ALIN_STREAM=1 (常驻流模式) 与 ALIN_CTL_FD (控制通道)
+ *
+ * 帧协议: 相邻两级都使用节点运行时时，二者之间自动升级为帧格式 (alin_frame.h)，
+ *         管道两端 (输入与最终输出) 保持 JSON 行; ALIN_FRAMED=0 关闭
+ * 环形缓冲: 两级都支持时改用共享内存环形缓冲 (alin_ring.h) 代替管道承载帧，
+ *         ALIN_RING=0 关闭, ALIN_RING_SIZE 指定每段大小 (字节，默认 1MB)
+ *
+ * 并行副本: -r <slot>=N (或 ALIN_REPLICAS="<slot>=N,...") 让该槽位经 alin_fanout 运行
+ *         N 个副本，批次按需分发、输出按原顺序重排; 节点未声明 ALIN_NODE_STATELESS 时
+ *         alin_fanout 只运行一个实例 (agg_count 等有状态节点始终看到全序的流)
+ *
+ * 有界队列: 每条边 (输入泵 → 首级、相邻两级之间) 都是容量确定的队列，
+ *         -q <slot>=[SIZE][:shed|:block] (或 ALIN_QUEUES="<slot>=...,...") 配置进入该槽位的边，
+ *         ALIN_QUEUE_SIZE / ALIN_QUEUE_POLICY 为所有边的默认值; SIZE 可带 K/M 后缀，
+ *         管道边按容量设置管道大小，环形缓冲边作为环的逻辑容量。
+ *         队列满时生产者阻塞 (block，默认) 或丢弃放不下的记录 (shed，由节点运行时执行;
+ *         alin_fanout / alin_host / 不使用运行时的节点始终阻塞)。
+ *         每条边的占用峰值、生产者等待时间与丢弃数每 10 秒及结束时列表输出，
+ *         等待最久的边标出其下游为瓶颈
+ *
+ * 指标: 每个节点把处理/输出/过滤/丢弃/错误计数与 process() 延迟直方图写入
+ *       ALIN_METRICS_DIR (默认 <state_dir>/metrics，设为空关闭) 下的指标段 (alin_metrics.h)，
+ *       以槽位名区分 (ALIN_METRICS_NAME); 结束时按槽位列出 p50/p99/p999,
+ *       运行期间可用 alin/bin/alin_exporter 轮询导出为 JSON
+ *
+ * 暂存区: parse_json 以 ALIN_RAW=ref 运行时把原始行写入 ALIN_SPOOL_DIR
+ *         (默认 <state_dir>/spool，设为空关闭) 下的暂存区 (alin_spool.h)，事件只带引用;
+ *         启动时清理上一次运行留下的暂存区
+ *
+ * 热替换: 通过 inotify 监听 active 与 nodes 目录 (不支持时每 500ms 重扫)，
+ *         某个槽位指向新 Inode 时在不停流的情况下替换该级节点:
+ *   1. 新建管道，通知上游 (或输入泵) 在记录边界把输出切到新管道
+ *   2. 旧节点处理完已进入其输入管道的记录后自然 EOF 退出
+ *   3. 以新管道为输入、原下游为输出启动新节点 (有状态节点不会与旧版本并存)
+ *   记录不丢失、不重复且保持顺序，并汇报切换延迟与排空记录数
+ *
+ * 使用方式:
+ *   alin/bin/alin_runner [-a active_dir] [-n nodes_dir] [-s state_dir] [-r slot=N]... [-q slot=SIZE[:POLICY]]... [input_file]
+ *   cat logs.jsonl | alin/bin/alin_runner
+ *   alin/bin/alin_runner -r 01_parse=4 -r 02_filter=2 logs.jsonl
+ *   alin/bin/alin_runner -q 03_alert=256K:shed logs.jsonl
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "alin_ctl.h"
+#include "alin_metrics.h"
+#include "alin_ring.h"
+#include "alin_spool.h"
+#include "alin_topology.h"
+
+#define MAX_STAGES ALIN_MAX_SLOTS
+#define MAX_PATH ALIN_MAX_PATH
+#define IO_BLOCK_SIZE 65536
+#define SWAP_DEBOUNCE 0.02       // 合并 ln -sf 产生的一串 inotify 事件
+#define RESCAN_FALLBACK 0.5      // 无 inotify 时的重扫间隔
+#define CTL_GRACE 1.0            // 新节点接入控制通道的等待时间
+#define EDGE_REPORT_INTERVAL 10.0    // 边队列统计的输出间隔
+
+typedef struct {
+    alin_slot_t slot;        // 槽位与目标节点
+    pid_t pid;               // 节点进程
+    int ctl_fd;              // 控制通道 (运行器一端)
+    int ctl_ready;           // 已收到 HELLO
+    int caps;                // HELLO 声明的能力位 (ALIN_CTL_CAP_*)
+    int out_framed;          // 已通知本级向下游输出帧格式
+    int out_keep;            // 运行器保留的下游写端 (替换本级时交给新节点)，末级为 -1
+    long fed;                // 已退出的上游写入当前输入管道的记录数
+    int exited;
+    double started;
+    alin_ctl_msg_t bye;      // 节点退出前的汇报 (type 为 0 表示未收到)
+    int replicas;            // 并行副本数 (大于 1 时经 alin_fanout 启动)
+} Stage;
+
+Stage stages[MAX_STAGES];
+int stage_count = 0;
+
+// 有界队列: 通往某一级的边的容量、满时策略与生产者汇报的统计
+typedef struct {
+    size_t capacity;         // 配置的容量 (字节，0 表示介质默认)
+    int shed;                // 满时丢弃 (ALIN_QUEUE_SHED)，否则阻塞
+    const char* medium;      // 当前介质: pipe / frames / ring / stdout
+    size_t size;             // 实际容量 (管道大小或环的逻辑容量，0 未知)
+    int reported;            // 生产者汇报过统计 (不使用节点运行时的节点不汇报)
+    long peak;               // 占用峰值 (字节)
+    long stall_us;           // 当前生产者等待下游的累计时间 (ALIN_CTL_STATS)
+    long shed_count;         // 当前生产者丢弃的记录数
+    long past_stall_us;      // 已退出 (被替换) 的生产者的累计值
+    long past_shed;
+} Edge;
+
+// edges[i] 为第 i 级的输入边 (edges[0] 由输入泵写入)，edges[stage_count] 为末级 → stdout
+Edge edges[MAX_STAGES + 1];
+
+// 输入泵: 独立线程把输入源按记录边界写入管道头部
+typedef struct {
+    int src_fd;
+    int head_fd;
+    int pending_fd;          // 待切换的新头部 (-1 表示无)
+    int wake[2];             // 主循环唤醒输入泵
+    int notify_fd;           // 输入泵通知主循环 (Event)
+    long sent;               // 写入当前头部的记录数
+    long total;
+    double start_time;
+    pthread_mutex_t lock;
+} Source;
+
+typedef struct {
+    int type;                // EV_CUT / EV_DONE
+    long value;
+} Event;
+
+enum { EV_CUT = 1, EV_DONE };
+
+// 进行中的替换 (同一时刻只替换一级)
+enum { SWAP_IDLE = 0, SWAP_WAIT_CUT, SWAP_WAIT_DRAIN };
+
+typedef struct {
+    int state;
+    int stage;
+    alin_slot_t next;
+    int in_fd;               // 新节点的输入 (新管道读端)
+    long sent;               // 切断前写入旧节点的记录数 (-1 未知)
+    double t_event;
+    double t_cut;
+} Swap;
+
+Source source;
+Swap swap_op;
+int sigchld_pipe[2];
+int failed = 0;
+int framing = 1;             // 相邻节点间协商帧协议 (ALIN_FRAMED=0 关闭)
+int ring_bus = 1;            // 相邻节点间协商共享内存环形缓冲 (ALIN_RING=0 关闭)
+size_t ring_size = ALIN_RING_DEFAULT_SIZE;
+char fanout_path[MAX_PATH] = "alin_fanout";
+char host_path[MAX_PATH] = "alin_host";
+const char* state_dir = "alin/state";
+char nodes_dir[MAX_PATH] = "";
+char metrics_dir[MAX_PATH] = "";     // 空表示不采集指标
+
+// 槽位 → 副本数 (-r / ALIN_REPLICAS)
+typedef struct {
+    char link[MAX_PATH];
+    int count;
+} ReplicaSpec;
+
+ReplicaSpec replica_specs[MAX_STAGES];
+int replica_spec_count = 0;
+
+// 槽位 → 输入边的队列配置 (-q / ALIN_QUEUES)
+typedef struct {
+    char link[MAX_PATH];
+    size_t capacity;         // 0 表示沿用默认
+    int policy;              // ALIN_QUEUE_*，-1 表示沿用默认
+} QueueSpec;
+
+QueueSpec queue_specs[MAX_STAGES];
+int queue_spec_count = 0;
+size_t queue_size = 0;       // ALIN_QUEUE_SIZE
+int queue_policy = ALIN_QUEUE_BLOCK;   // ALIN_QUEUE_POLICY
+
+void log_runner(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "\033[0;34m[RUNNER]\033[0m ");
+    vfprintf(stderr, fmt, ap);
+    fprintf(stderr, "\n");
+    va_end(ap);
+}
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * 解析副本配置 "<slot>=N[,<slot>=N...]"
+ * @return 0 成功, -1 格式错误
+ */
+int parse_replicas(const char* spec) {
+    char buf[MAX_PATH * 4];
+    snprintf(buf, sizeof(buf), "%s", spec);
+
+    for (char* item = strtok(buf, ","); item; item = strtok(NULL, ",")) {
+        char* eq = strchr(item, '=');
+        if (!eq || eq == item || atoi(eq + 1) < 1) return -1;
+        if (replica_spec_count >= MAX_STAGES) return -1;
+        *eq = '\0';
+        ReplicaSpec* r = &replica_specs[replica_spec_count++];
+        snprintf(r->link, sizeof(r->link), "%s", item);
+        r->count = atoi(eq + 1);
+    }
+    return 0;
+}
+
+int replicas_for(const char* link) {
+    int count = 1;
+    for (int i = 0; i < replica_spec_count; i++) {
+        if (strcmp(replica_specs[i].link, link) == 0) count = replica_specs[i].count;
+    }
+    return count;
+}
+
+/**
+ * 解析字节数 "65536" / "64K" / "1M"
+ * @return 字节数, 0 表示格式错误
+ */
+size_t parse_size(const char* text) {
+    char* end;
+    unsigned long value = strtoul(text, &end, 10);
+    if (end == text) return 0;
+    if (*end == 'K' || *end == 'k') { value <<= 10; end++; }
+    else if (*end == 'M' || *end == 'm') { value <<= 20; end++; }
+    return *end == '\0' ? (size_t)value : 0;
+}
+
+/**
+ * 解析队列策略 "block" / "shed"
+ * @return ALIN_QUEUE_*, -1 表示无法识别
+ */
+int parse_policy(const char* text) {
+    if (strcmp(text, "block") == 0) return ALIN_QUEUE_BLOCK;
+    if (strcmp(text, "shed") == 0) return ALIN_QUEUE_SHED;
+    return -1;
+}
+
+/**
+ * 解析队列配置 "<slot>=[SIZE][:POLICY][,<slot>=...]"，如 "03_alert=256K:shed"
+ * @return 0 成功, -1 格式错误
+ */
+int parse_queues(const char* spec) {
+    char buf[MAX_PATH * 4];
+    snprintf(buf, sizeof(buf), "%s", spec);
+
+    char* save_item;
+    for (char* item = strtok_r(buf, ",", &save_item); item; item = strtok_r(NULL, ",", &save_item)) {
+        char* eq = strchr(item, '=');
+        if (!eq || eq == item || queue_spec_count >= MAX_STAGES) return -1;
+        *eq = '\0';
+        QueueSpec* q = &queue_specs[queue_spec_count++];
+        snprintf(q->link, sizeof(q->link), "%s", item);
+        q->capacity = 0;
+        q->policy = -1;
+
+        char* save_part;
+        for (char* part = strtok_r(eq + 1, ":", &save_part); part; part = strtok_r(NULL, ":", &save_part)) {
+            int policy = parse_policy(part);
+            if (policy >= 0) {
+                q->policy = policy;
+            } else if ((q->capacity = parse_size(part)) == 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * 按配置初始化通往槽位 link 的边 (link 为 NULL 表示末级 → stdout，始终阻塞)
+ */
+void init_edge(Edge* e, const char* link) {
+    memset(e, 0, sizeof(*e));
+    e->medium = link ? "pipe" : "stdout";
+    if (!link) return;
+
+    e->capacity = queue_size;
+    e->shed = queue_policy == ALIN_QUEUE_SHED;
+    for (int i = 0; i < queue_spec_count; i++) {
+        if (strcmp(queue_specs[i].link, link) != 0) continue;
+        if (queue_specs[i].capacity) e->capacity = queue_specs[i].capacity;
+        if (queue_specs[i].policy >= 0) e->shed = queue_specs[i].policy == ALIN_QUEUE_SHED;
+    }
+}
+
+/**
+ * 按边的容量设置管道大小 (写端或读端均可)，并记下实际容量
+ */
+void size_pipe(Edge* e, int fd) {
+    e->medium = "pipe";
+    e->size = 0;
+#ifdef F_SETPIPE_SZ
+    if (e->capacity && fcntl(fd, F_SETPIPE_SZ, (int)e->capacity) < 0) {
+        log_runner("Cannot resize queue to %zu bytes: %s", e->capacity, strerror(errno));
+    }
+    int size = fcntl(fd, F_GETPIPE_SZ);
+    if (size > 0) e->size = (size_t)size;
+#else
+    (void)fd;
+#endif
+}
+
+/**
+ * 边的生产者已退出 (被替换或结束): 其累计值转入历史，由接替的生产者重新计数
+ */
+void retire_edge(Edge* e) {
+    e->past_stall_us += e->stall_us;
+    e->past_shed += e->shed_count;
+    e->stall_us = 0;
+    e->shed_count = 0;
+}
+
+/**
+ * 输出各条边的队列统计并标出瓶颈: 背压会沿管道向上游传递 (下游慢时上游各边都在等待)，
+ * 因此取等待时间接近最大值 (一半以上) 的边中最靠下游的一条，其下游即瓶颈;
+ * 都没有等待时取丢弃最多的边
+ */
+void report_edges() {
+    Edge snapshot[MAX_STAGES + 1];
+    pthread_mutex_lock(&source.lock);
+    memcpy(snapshot, edges, sizeof(Edge) * (stage_count + 1));
+    pthread_mutex_unlock(&source.lock);
+
+    long max_stall = 0, max_shed = 0;
+    for (int i = 0; i <= stage_count; i++) {
+        long stall = snapshot[i].past_stall_us + snapshot[i].stall_us;
+        long shed = snapshot[i].past_shed + snapshot[i].shed_count;
+        if (stall > max_stall) max_stall = stall;
+        if (shed > max_shed) max_shed = shed;
+    }
+    int worst = -1;
+    for (int i = 0; i <= stage_count; i++) {
+        long stall = snapshot[i].past_stall_us + snapshot[i].stall_us;
+        long shed = snapshot[i].past_shed + snapshot[i].shed_count;
+        if (max_stall > 0 ? stall * 2 >= max_stall : (max_shed > 0 && shed == max_shed)) worst = i;
+    }
+
+    log_runner("=== Edge Queues ===");
+    log_runner("  %-34s %-7s %-6s %8s %5s %10s %10s", "edge", "medium", "policy", "capacity", "hwm", "stall", "shed");
+    for (int i = 0; i <= stage_count; i++) {
+        Edge* e = &snapshot[i];
+        char name[MAX_PATH * 2 + 8], capacity[32] = "-", hwm[16] = "-", stall[32] = "-", shed[32] = "-";
+        snprintf(name, sizeof(name), "%s → %s", i == 0 ? "input" : stages[i - 1].slot.link,
+            i == stage_count ? "stdout" : stages[i].slot.link);
+        if (e->size >= (1u << 20) && e->size % (1u << 20) == 0) snprintf(capacity, sizeof(capacity), "%zuM", e->size >> 20);
+        else if (e->size >= 1024 && e->size % 1024 == 0) snprintf(capacity, sizeof(capacity), "%zuK", e->size >> 10);
+        else if (e->size > 0) snprintf(capacity, sizeof(capacity), "%zu", e->size);
+        if (e->reported) {
+            if (e->size > 0) snprintf(hwm, sizeof(hwm), "%ld%%", (long)(e->peak * 100 / (long)e->size));
+            snprintf(stall, sizeof(stall), "%.3fs", (e->past_stall_us + e->stall_us) / 1e6);
+            snprintf(shed, sizeof(shed), "%ld", e->past_shed + e->shed_count);
+        }
+
+        log_runner("  %-36s %-7s %-6s %8s %5s %10s %10s%s", name, e->medium, e->shed ? "shed" : "block",
+            capacity, hwm, stall, shed, i == worst ? "  ◀ bottleneck" : "");
+    }
+    log_runner("===================");
+}
+
+/**
+ * 输出各槽位的指标汇总 (同一槽位的副本与替换前后的实例合并计算)
+ */
+void report_metrics() {
+    if (metrics_dir[0] == '\0') return;
+    alin_metrics_sum_t* sums = calloc(MAX_STAGES * 4, sizeof(alin_metrics_sum_t));
+    if (!sums) return;
+    int n = alin_metrics_collect(metrics_dir, sums, MAX_STAGES * 4);
+
+    log_runner("=== Stage Metrics ===");
+    log_runner("  %-30s %10s %10s %10s %6s %6s %9s %9s %9s %9s", "stage", "processed", "emitted",
+        "dropped", "shed", "errors", "p50", "p99", "p999", "max");
+    for (int i = 0; i < n; i++) {
+        alin_metrics_sum_t* m = &sums[i];
+        char p50[16], p99[16], p999[16], max[16];
+        log_runner("  %-30s %10lu %10lu %10lu %6lu %6lu %9s %9s %9s %9s", m->name,
+            (unsigned long)m->processed, (unsigned long)m->emitted, (unsigned long)m->dropped,
+            (unsigned long)m->shed, (unsigned long)m->errors,
+            alin_metrics_format(alin_metrics_percentile(m, 0.50), p50, sizeof(p50)),
+            alin_metrics_format(alin_metrics_percentile(m, 0.99), p99, sizeof(p99)),
+            alin_metrics_format(alin_metrics_percentile(m, 0.999), p999, sizeof(p999)),
+            alin_metrics_format(m->latency_max, max, sizeof(max)));
+    }
+    log_runner("=====================");
+    free(sums);
+}
+
+/**
+ * 解析 active 拓扑 (语义与 alin_stream.sh 的 get_pipeline 一致)
+ */
+int load_topology(const char* active_dir) {
+    alin_slot_t slots[MAX_STAGES];
+    int n = alin_topology_scan(active_dir, slots, MAX_STAGES);
+    if (n < 0) {
+        log_runner("Active directory not found: %s", active_dir);
+        return -1;
+    }
+    if (n == 0) {
+        log_runner("No active links found in %s", active_dir);
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        memset(&stages[i], 0, sizeof(Stage));
+        stages[i].slot = slots[i];
+        stages[i].pid = -1;
+        stages[i].ctl_fd = -1;
+        stages[i].out_keep = -1;
+        stages[i].replicas = slots[i].fork ? 1 : replicas_for(slots[i].link);
+        init_edge(&edges[i], slots[i].link);
+    }
+    init_edge(&edges[n], NULL);
+    stage_count = n;
+    return 0;
+}
+
+void show_topology() {
+    log_runner("=== Stream Processing Topology ===");
+    for (int i = 0; i < stage_count; i++) {
+        if (stages[i].slot.fork) {
+            alin_slot_t branches[ALIN_MAX_BRANCHES];
+            int n = alin_topology_branches(stages[i].slot.path, branches, ALIN_MAX_BRANCHES);
+            log_runner("  %s ⑂ %d branches (in-process)", stages[i].slot.link, n < 0 ? 0 : n);
+            continue;
+        }
+        if (stages[i].replicas > 1) {
+            log_runner("  %s → %s [Inode: %lu] ×%d", stages[i].slot.link,
+                alin_slot_basename(&stages[i].slot), (unsigned long)stages[i].slot.inode, stages[i].replicas);
+            continue;
+        }
+        log_runner("  %s → %s [Inode: %lu]", stages[i].slot.link,
+            alin_slot_basename(&stages[i].slot), (unsigned long)stages[i].slot.inode);
+    }
+    log_runner("==================================");
+}
+
+int make_pipe(int fds[2]) {
+    if (pipe(fds) != 0) return -1;
+    // 父进程持有的端点不能泄漏给其他节点，否则下游永远等不到 EOF
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return 0;
+}
+
+/**
+ * 启动一个节点进程: in_fd → stdin, out_fd → stdout, 控制通道 → fd 3
+ */
+pid_t spawn_stage(Stage* s, int in_fd, int out_fd) {
+    int ctl[2];
+    if (socketpair(AF_UNIX, ALIN_CTL_SOCK_TYPE, 0, ctl) != 0) return -1;
+    fcntl(ctl[0], F_SETFD, FD_CLOEXEC);
+    fcntl(ctl[1], F_SETFD, FD_CLOEXEC);
+
+    // 指标段以槽位命名 (副本共用同一名称，由读者汇总; alin_host 按插件槽位自行命名)
+    setenv("ALIN_METRICS_NAME", s->slot.link, 1);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(ctl[0]);
+        close(ctl[1]);
+        return -1;
+    }
+
+    if (pid == 0) {
+        if (in_fd != STDIN_FILENO) dup2(in_fd, STDIN_FILENO);
+        if (out_fd != STDOUT_FILENO) dup2(out_fd, STDOUT_FILENO);
+        if (ctl[1] != ALIN_CTL_FD_NUM) {
+            dup2(ctl[1], ALIN_CTL_FD_NUM);
+        } else {
+            fcntl(ctl[1], F_SETFD, 0);
+        }
+        signal(SIGPIPE, SIG_DFL);
+        if (s->slot.fork) {
+            char* argv[] = { host_path, "-f", s->slot.path, "-n", nodes_dir, "-s", (char*)state_dir, NULL };
+            execvp(host_path, argv);
+            fprintf(stderr, "[RUNNER] exec failed: %s: %s\n", host_path, strerror(errno));
+            _exit(127);
+        }
+        if (s->replicas > 1) {
+            char count[16];
+            snprintf(count, sizeof(count), "%d", s->replicas);
+            char* argv[] = { fanout_path, "-n", count, s->slot.path, NULL };
+            execvp(fanout_path, argv);
+            fprintf(stderr, "[RUNNER] exec failed: %s: %s\n", fanout_path, strerror(errno));
+            _exit(127);
+        }
+        char* argv[] = { s->slot.path, NULL };
+        execv(s->slot.path, argv);
+        fprintf(stderr, "[RUNNER] exec failed: %s: %s\n", s->slot.path, strerror(errno));
+        _exit(127);
+    }
+
+    close(ctl[1]);
+    s->pid = pid;
+    s->ctl_fd = ctl[0];
+    s->ctl_ready = 0;
+    s->caps = 0;
+    s->out_framed = 0;
+    s->exited = 0;
+    s->started = now_seconds();
+    memset(&s->bye, 0, sizeof(s->bye));
+    return pid;
+}
+
+/**
+ * 启动整条管道，返回写入第一个节点的 fd
+ */
+int start_pipeline() {
+    int head[2];
+    if (make_pipe(head) != 0) return -1;
+    size_pipe(&edges[0], head[1]);
+
+    int in_fd = head[0];
+    for (int i = 0; i < stage_count; i++) {
+        int link[2] = { -1, -1 };
+        int out_fd = STDOUT_FILENO;
+
+        if (i < stage_count - 1) {
+            if (make_pipe(link) != 0) return -1;
+            size_pipe(&edges[i + 1], link[1]);
+            out_fd = link[1];
+        }
+
+        if (spawn_stage(&stages[i], in_fd, out_fd) < 0) {
+            log_runner("Failed to start %s", stages[i].slot.link);
+            return -1;
+        }
+
+        // 父进程不再需要读端; 写端保留一份，替换下游节点时交给新的本级节点
+        close(in_fd);
+        stages[i].out_keep = link[1];
+        in_fd = link[0];
+    }
+#ifdef F_GETPIPE_SZ
+    int size = fcntl(STDOUT_FILENO, F_GETPIPE_SZ);
+    if (size > 0) edges[stage_count].size = (size_t)size;
+#endif
+    return head[1];
+}
+
+int write_all(int fd, const char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+long count_records(const char* buf, size_t len) {
+    long count = 0;
+    const char* p = buf;
+    const char* end = buf + len;
+    while ((p = memchr(p, '\n', end - p)) != NULL) {
+        count++;
+        p++;
+    }
+    return count;
+}
+
+char* find_last_newline(char* buf, size_t len) {
+    while (len > 0) {
+        if (buf[--len] == '\n') return buf + len;
+    }
+    return NULL;
+}
+
+void notify_main(int type, long value) {
+    Event ev = { type, value };
+    write_all(source.notify_fd, (const char*)&ev, sizeof(ev));
+}
+
+/**
+ * 首级的输入队列核算 (调用方持有锁): 放得下时原样写入;
+ * 放不下时丢弃策略只写入放得下的完整记录，阻塞策略照常写入并计入等待时间
+ * @return 写入的字节数
+ */
+size_t admit_input(char* buf, size_t whole, long* stall_us) {
+    Edge* e = &edges[0];
+    int queued = 0;
+    *stall_us = -1;
+    if (e->size == 0 || whole == 0) return whole;
+    e->reported = 1;
+#ifdef FIONREAD
+    if (ioctl(source.head_fd, FIONREAD, &queued) != 0) queued = 0;
+#endif
+
+    size_t room = (size_t)queued < e->size ? e->size - (size_t)queued : 0;
+    long occupied = (long)queued + (long)(whole < room ? whole : room);
+    if (occupied > e->peak) e->peak = occupied;
+    if (whole <= room || queued == 0) return whole;
+
+    if (e->shed) {
+        // 只保留开头放得下的整行，其余记录丢弃 (不含换行的超长记录照常写入)
+        if (buf[whole - 1] != '\n') return whole;
+        char* last = find_last_newline(buf, room);
+        size_t keep = last ? (size_t)(last - buf) + 1 : 0;
+        e->shed_count += count_records(buf + keep, whole - keep);
+        return keep;
+    }
+    *stall_us = 0;
+    return whole;
+}
+
+/**
+ * 在记录边界执行挂起的头部切换 (调用方持有锁)
+ */
+void switch_head() {
+    if (source.pending_fd < 0) return;
+    close(source.head_fd);
+    source.head_fd = source.pending_fd;
+    source.pending_fd = -1;
+    notify_main(EV_CUT, source.sent);
+    source.sent = 0;
+}
+
+/**
+ * 输入泵线程: 将输入源持续泵入管道头部，并按秒输出吞吐量
+ * 每次只写出完整的记录，保证头部切换总发生在记录边界
+ */
+void* pump_input(void* arg) {
+    (void)arg;
+    static char buf[IO_BLOCK_SIZE];
+    size_t carry = 0;
+    int partial = 0;         // 已写出一条超长记录的前半部分，不能在此切换
+    double last_report = source.start_time;
+
+    for (;;) {
+        struct pollfd pfd[2] = {
+            { source.src_fd, POLLIN, 0 },
+            { source.wake[0], POLLIN, 0 }
+        };
+        if (poll(pfd, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (pfd[1].revents & POLLIN) {
+            char drain[64];
+            while (read(source.wake[0], drain, sizeof(drain)) > 0) {}
+            pthread_mutex_lock(&source.lock);
+            if (!partial) switch_head();
+            pthread_mutex_unlock(&source.lock);
+        }
+        if (!(pfd[0].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+        ssize_t n = read(source.src_fd, buf + carry, sizeof(buf) - carry);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            log_runner("Read error: %s", strerror(errno));
+            break;
+        }
+        if (n == 0) break;
+
+        size_t len = carry + (size_t)n;
+        char* last = find_last_newline(buf, len);
+        size_t whole = last ? (size_t)(last - buf) + 1 : (len == sizeof(buf) ? len : 0);
+        long records = count_records(buf, whole);
+
+        pthread_mutex_lock(&source.lock);
+        long stall_us;
+        size_t take = admit_input(buf, whole, &stall_us);
+        double t_write = now_seconds();
+        int rc = write_all(source.head_fd, buf, take);
+        if (stall_us >= 0) edges[0].stall_us += (long)((now_seconds() - t_write) * 1e6);
+        source.sent += take == whole ? records : count_records(buf, take);
+        source.total += records;
+        if (whole > 0) partial = last ? 0 : 1;
+        if (rc == 0 && !partial) switch_head();
+        pthread_mutex_unlock(&source.lock);
+
+        if (rc != 0) {
+            log_runner("Pipeline closed early: %s", strerror(errno));
+            break;
+        }
+        carry = len - whole;
+        memmove(buf, buf + whole, carry);
+
+        double now = now_seconds();
+        if (now - last_report >= 1.0) {
+            log_runner("Processed: %ld events (%.0f/sec)", source.total,
+                source.total / (now - source.start_time));
+            last_report = now;
+        }
+    }
+
+    pthread_mutex_lock(&source.lock);
+    // 最后一行没有换行符时同样计为一条记录
+    if (carry > 0 && write_all(source.head_fd, buf, carry) == 0) {
+        source.sent++;
+        source.total++;
+    }
+    switch_head();
+    close(source.head_fd);
+    source.head_fd = -1;
+    pthread_mutex_unlock(&source.lock);
+
+    notify_main(EV_DONE, source.total);
+    return NULL;
+}
+
+void on_sigchld(int sig) {
+    (void)sig;
+    int saved = errno;
+    if (write(sigchld_pipe[1], "c", 1) < 0) {}
+    errno = saved;
+}
+
+/**
+ * 旧节点的输入已被切断: 记录切断前写入的记录数，此后等待旧节点排空
+ */
+void swap_cut(long acked) {
+    swap_op.sent = stages[swap_op.stage].fed + acked;
+    swap_op.t_cut = now_seconds();
+    swap_op.state = SWAP_WAIT_DRAIN;
+}
+
+/**
+ * 为第 i 级与第 i+1 级建立共享内存环形缓冲: 先交给下游 (消费者)，
+ * 再交给上游 (生产者)，上游在管道中宣告后开始写环
+ * @return 0 成功, -1 失败 (退回帧协议)
+ */
+int setup_ring(Stage* up, Stage* down, Edge* e) {
+    // 边的容量超过默认大小时按容量建环，否则作为逻辑容量
+    size_t size = e->capacity > ring_size ? e->capacity : ring_size;
+    size_t limit = e->capacity && e->capacity < size ? e->capacity : 0;
+    int fds[ALIN_RING_FDS];
+    if (alin_ring_create(size, fds) != 0) return -1;
+
+    alin_ctl_msg_t consumer = { ALIN_CTL_RING, 0, ALIN_RING_CONSUMER, (int64_t)size, 0 };
+    alin_ctl_msg_t producer = { ALIN_CTL_RING, 0, ALIN_RING_PRODUCER, (int64_t)size, (int64_t)limit };
+    int rc = -1;
+    if (alin_ctl_send(down->ctl_fd, &consumer, fds, ALIN_RING_FDS) == 0) {
+        rc = alin_ctl_send(up->ctl_fd, &producer, fds, ALIN_RING_FDS) == 0 ? 0 : -1;
+    }
+    for (int j = 0; j < ALIN_RING_FDS; j++) close(fds[j]);
+    if (rc == 0) {
+        e->medium = "ring";
+        e->size = limit ? limit : size;
+    }
+    return rc;
+}
+
+/**
+ * 第 i 级与第 i+1 级都支持帧协议时，通知第 i 级把输出升级为帧
+ * (都支持环形缓冲时改走环形缓冲)
+ * 管道头部 (输入泵) 与末级输出 (stdout) 始终保持文本行
+ */
+void negotiate_wire(int i) {
+    if (!framing || i < 0 || i + 1 >= stage_count) return;
+    Stage* up = &stages[i];
+    Stage* down = &stages[i + 1];
+    if (up->out_framed || up->exited || down->exited) return;
+    if (!up->ctl_ready || !down->ctl_ready) return;
+    if (!(up->caps & ALIN_CTL_CAP_FRAMED) || !(down->caps & ALIN_CTL_CAP_FRAMED)) return;
+    // 替换进行中的一段等新节点接入后再协商
+    if (swap_op.state != SWAP_IDLE && (swap_op.stage == i || swap_op.stage == i + 1)) return;
+
+    if (ring_bus && (up->caps & ALIN_CTL_CAP_RING) && (down->caps & ALIN_CTL_CAP_RING)) {
+        if (setup_ring(up, down, &edges[i + 1]) == 0) {
+            up->out_framed = 1;
+            return;
+        }
+    }
+
+    alin_ctl_msg_t msg = { ALIN_CTL_FRAMED, 0, 0, 0, 0 };
+    if (alin_ctl_send(up->ctl_fd, &msg, NULL, 0) == 0) {
+        up->out_framed = 1;
+        edges[i + 1].medium = "frames";
+    }
+}
+
+/**
+ * 读取节点发来的控制消息
+ */
+void poll_ctl(int i) {
+    Stage* s = &stages[i];
+    alin_ctl_msg_t msg;
+    int fds[ALIN_CTL_MAX_FDS];
+    int rc;
+
+    while (s->ctl_fd >= 0 && (rc = alin_ctl_recv(s->ctl_fd, &msg, fds, 1)) != -1) {
+        if (rc == 0) {
+            close(s->ctl_fd);
+            s->ctl_fd = -1;
+            break;
+        }
+        for (int j = 0; j < ALIN_CTL_MAX_FDS; j++) {
+            if (fds[j] >= 0) close(fds[j]);
+        }
+
+        if (msg.type == ALIN_CTL_HELLO) {
+            s->ctl_ready = 1;
+            s->caps = (int)msg.b;
+            if (edges[i + 1].shed) {
+                alin_ctl_msg_t queue = { ALIN_CTL_QUEUE, 0, ALIN_QUEUE_SHED, 0, 0 };
+                alin_ctl_send(s->ctl_fd, &queue, NULL, 0);
+            }
+            negotiate_wire(i - 1);
+            negotiate_wire(i);
+        } else if (msg.type == ALIN_CTL_ACK) {
+            if (swap_op.state == SWAP_WAIT_CUT && swap_op.stage == i + 1) swap_cut((long)msg.a);
+        } else if (msg.type == ALIN_CTL_BYE) {
+            s->bye = msg;
+        } else if (msg.type == ALIN_CTL_STATS) {
+            Edge* e = &edges[i + 1];
+            e->reported = 1;
+            e->stall_us = (long)msg.a;
+            e->shed_count = (long)msg.b;
+            if ((long)msg.c > e->peak) e->peak = (long)msg.c;
+        }
+    }
+}
+
+/**
+ * 开始替换第 k 级节点
+ * @return 0 已开始, 1 暂时无法切换 (稍后重试), -1 放弃
+ */
+int swap_begin(int k, const alin_slot_t* next, double t_event) {
+    Stage* s = &stages[k];
+    Stage* up = k > 0 ? &stages[k - 1] : NULL;
+    if (s->exited || (up && up->exited)) return -1;
+    if (up && !up->ctl_ready) {
+        if (now_seconds() - up->started < CTL_GRACE) return 1;
+        log_runner("Cannot hot-swap %s: upstream %s has no control channel",
+            s->slot.link, up->slot.link);
+        return -1;
+    }
+
+    int np[2];
+    if (make_pipe(np) != 0) return -1;
+    size_pipe(&edges[k], np[1]);
+
+    // 先让旧节点记下当前消费数，此后消费的即为排空的在途记录
+    if (s->ctl_ready) {
+        alin_ctl_msg_t mark = { ALIN_CTL_MARK, 0, 0, 0, 0 };
+        alin_ctl_send(s->ctl_fd, &mark, NULL, 0);
+    }
+
+    if (!up) {
+        pthread_mutex_lock(&source.lock);
+        int done = source.head_fd < 0;
+        if (!done) source.pending_fd = np[1];
+        pthread_mutex_unlock(&source.lock);
+        if (done) {
+            close(np[0]);
+            close(np[1]);
+            log_runner("Input finished, not swapping %s", s->slot.link);
+            return -1;
+        }
+        if (write(source.wake[1], "w", 1) < 0) {}
+    } else {
+        alin_ctl_msg_t redirect = { ALIN_CTL_REDIRECT, 0, 0, 0, 0 };
+        if (alin_ctl_send(up->ctl_fd, &redirect, &np[1], 1) != 0) {
+            close(np[0]);
+            close(np[1]);
+            return -1;
+        }
+        // 旧管道只剩上游那一份写端，上游切换后旧节点随即看到 EOF
+        close(up->out_keep);
+        up->out_keep = np[1];
+        up->out_framed = 0;    // 上游切换时退回文本行，待新节点接入后重新协商
+    }
+
+    swap_op.state = SWAP_WAIT_CUT;
+    swap_op.stage = k;
+    swap_op.next = *next;
+    swap_op.in_fd = np[0];
+    swap_op.sent = -1;
+    swap_op.t_event = t_event;
+    swap_op.t_cut = 0;
+    log_runner("Swapping %s: %s → %s [Inode: %lu]", s->slot.link, alin_slot_basename(&s->slot),
+        alin_slot_basename(next), (unsigned long)next->inode);
+    return 0;
+}
+
+/**
+ * 旧节点已排空退出: 启动新节点接管输入与下游
+ */
+void swap_finish() {
+    int k = swap_op.stage;
+    Stage* s = &stages[k];
+    double t_drained = now_seconds();
+    if (swap_op.t_cut == 0) swap_op.t_cut = t_drained;
+
+    // 旧节点最后写入下游的记录计入下游的输入
+    if (k + 1 < stage_count) stages[k + 1].fed += (long)s->bye.c;
+    long consumed = s->bye.type ? (long)s->bye.a : -1;
+    long drained = s->bye.type && s->bye.b >= 0 ? (long)(s->bye.a - s->bye.b) : -1;
+
+    if (s->ctl_fd >= 0) close(s->ctl_fd);
+    // 新节点先以文本行写出，待协商后再升级
+    if (s->out_keep >= 0) size_pipe(&edges[k + 1], s->out_keep);
+    s->slot = swap_op.next;
+    s->fed = 0;
+    int out_fd = s->out_keep >= 0 ? s->out_keep : STDOUT_FILENO;
+    if (spawn_stage(s, swap_op.in_fd, out_fd) < 0) {
+        log_runner("Failed to start %s, stage lost", s->slot.link);
+        s->exited = 1;
+        s->ctl_fd = -1;
+        if (s->out_keep >= 0) close(s->out_keep);
+        s->out_keep = -1;
+        failed = 1;
+    }
+    close(swap_op.in_fd);
+    swap_op.state = SWAP_IDLE;
+
+    double t_done = now_seconds();
+    log_runner("Swapped %s → %s [Inode: %lu] in %.1fms (cut %.1fms, drain %.1fms), drained %ld records",
+        s->slot.link, alin_slot_basename(&s->slot), (unsigned long)s->slot.inode,
+        (t_done - swap_op.t_event) * 1000, (swap_op.t_cut - swap_op.t_event) * 1000,
+        (t_drained - swap_op.t_cut) * 1000, drained);
+    if (swap_op.sent >= 0 && consumed >= 0 && consumed != swap_op.sent) {
+        log_runner("Warning: old node consumed %ld of %ld records", consumed, swap_op.sent);
+    }
+}
+
+void report_exit(Stage* s, int status) {
+    if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+        log_runner("Node %s exited with status %d", s->slot.link, WEXITSTATUS(status));
+        failed = 1;
+    } else if (WIFSIGNALED(status)) {
+        log_runner("Node %s killed by signal %d", s->slot.link, WTERMSIG(status));
+        failed = 1;
+    }
+}
+
+/**
+ * 回收退出的节点; 正常退出时释放保留的写端，使 EOF 沿管道继续传递
+ */
+void reap_stages() {
+    pid_t pid;
+    int status;
+
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        for (int i = 0; i < stage_count; i++) {
+            Stage* s = &stages[i];
+            if (s->pid != pid || s->exited) continue;
+
+            // 退出前发出的 ACK/BYE 仍在控制通道中，先读完
+            if (i > 0) poll_ctl(i - 1);
+            poll_ctl(i);
+            report_exit(s, status);
+            retire_edge(&edges[i + 1]);
+
+            if (swap_op.state != SWAP_IDLE && swap_op.stage == i) {
+                swap_finish();
+                break;
+            }
+
+            s->exited = 1;
+            if (s->ctl_fd >= 0) close(s->ctl_fd);
+            s->ctl_fd = -1;
+            if (s->out_keep >= 0) close(s->out_keep);
+            s->out_keep = -1;
+            break;
+        }
+    }
+}
+
+/**
+ * 重新解析拓扑，对指向变化的槽位发起替换
+ * @return 1 需要稍后再检查
+ */
+int check_topology(const char* active_dir, double t_event) {
+    if (swap_op.state != SWAP_IDLE) return 1;
+
+    alin_slot_t slots[MAX_STAGES];
+    int n = alin_topology_scan(active_dir, slots, MAX_STAGES);
+    if (n < 0) return 0;
+
+    int same_shape = (n == stage_count);
+    for (int i = 0; i < n && same_shape; i++) {
+        same_shape = strcmp(slots[i].link, stages[i].slot.link) == 0;
+    }
+    if (!same_shape) {
+        log_runner("Topology shape changed (%d → %d stages), restart the runner to apply", stage_count, n);
+        return 0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (slots[i].inode == stages[i].slot.inode && strcmp(slots[i].path, stages[i].slot.path) == 0) continue;
+        int rc = swap_begin(i, &slots[i], t_event);
+        if (rc >= 0) return 1;
+    }
+    return 0;
+}
+
+int pipeline_done(int source_done) {
+    if (!source_done || swap_op.state != SWAP_IDLE) return 0;
+    for (int i = 0; i < stage_count; i++) {
+        if (!stages[i].exited) return 0;
+    }
+    return 1;
+}
+
+/**
+ * 主循环: 回收节点、处理控制消息与拓扑变化，直到整条管道结束
+ */
+void control_loop(const char* active_dir, int watch_fd, int event_fd) {
+    int source_done = 0;
+    double t_event = 0;
+    double check_at = watch_fd >= 0 ? 0 : now_seconds() + RESCAN_FALLBACK;
+    double report_at = now_seconds() + EDGE_REPORT_INTERVAL;
+
+    while (!pipeline_done(source_done)) {
+        struct pollfd pfd[3 + MAX_STAGES];
+        int owner[3 + MAX_STAGES];
+        int nfds = 0;
+
+        pfd[nfds].fd = sigchld_pipe[0]; pfd[nfds].events = POLLIN; owner[nfds++] = -1;
+        pfd[nfds].fd = event_fd; pfd[nfds].events = POLLIN; owner[nfds++] = -2;
+        if (watch_fd >= 0) {
+            pfd[nfds].fd = watch_fd; pfd[nfds].events = POLLIN; owner[nfds++] = -3;
+        }
+        for (int i = 0; i < stage_count; i++) {
+            if (stages[i].ctl_fd < 0) continue;
+            pfd[nfds].fd = stages[i].ctl_fd; pfd[nfds].events = POLLIN; owner[nfds++] = i;
+        }
+
+        double wake_at = check_at > 0 && check_at < report_at ? check_at : report_at;
+        double wait = wake_at - now_seconds();
+        int timeout = wait > 0 ? (int)(wait * 1000) + 1 : 0;
+
+        int ready = poll(pfd, nfds, timeout);
+        if (ready < 0 && errno != EINTR) break;
+
+        for (int j = 0; ready > 0 && j < nfds; j++) {
+            if (!pfd[j].revents) continue;
+            if (owner[j] == -1) {
+                char drain[64];
+                while (read(sigchld_pipe[0], drain, sizeof(drain)) > 0) {}
+                reap_stages();
+            } else if (owner[j] == -2) {
+                Event ev;
+                if (read(event_fd, &ev, sizeof(ev)) == (ssize_t)sizeof(ev)) {
+                    if (ev.type == EV_CUT && swap_op.state == SWAP_WAIT_CUT && swap_op.stage == 0) {
+                        swap_cut(ev.value);
+                    } else if (ev.type == EV_DONE) {
+                        source_done = 1;
+                    }
+                }
+            } else if (owner[j] == -3) {
+                alin_watch_drain(watch_fd);
+                if (t_event == 0) t_event = now_seconds();
+                check_at = now_seconds() + SWAP_DEBOUNCE;
+            } else {
+                poll_ctl(owner[j]);
+            }
+        }
+
+        if (now_seconds() >= report_at) {
+            report_edges();
+            report_at = now_seconds() + EDGE_REPORT_INTERVAL;
+        }
+
+        if (check_at > 0 && now_seconds() >= check_at) {
+            double t = t_event > 0 ? t_event : now_seconds();
+            int again = check_topology(active_dir, t);
+            if (again) {
+                check_at = now_seconds() + SWAP_DEBOUNCE;
+                if (swap_op.state == SWAP_IDLE) t_event = 0;
+            } else {
+                t_event = 0;
+                check_at = watch_fd >= 0 ? 0 : now_seconds() + RESCAN_FALLBACK;
+            }
+        }
+    }
+}
+
+void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-a active_dir] [-n nodes_dir] [-s state_dir] [-r slot=N]... "
+        "[-q slot=[SIZE][:block|:shed]]... [input_file]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    const char* active_dir = "alin/active";
+    int opt;
+
+    const char* replicas_env = getenv("ALIN_REPLICAS");
+    if (replicas_env && replicas_env[0] != '\0' && parse_replicas(replicas_env) != 0) {
+        log_runner("Invalid ALIN_REPLICAS: %s", replicas_env);
+        return 1;
+    }
+    const char* queue_size_env = getenv("ALIN_QUEUE_SIZE");
+    if (queue_size_env && queue_size_env[0] != '\0' && (queue_size = parse_size(queue_size_env)) == 0) {
+        log_runner("Invalid ALIN_QUEUE_SIZE: %s", queue_size_env);
+        return 1;
+    }
+    const char* queue_policy_env = getenv("ALIN_QUEUE_POLICY");
+    if (queue_policy_env && queue_policy_env[0] != '\0' && (queue_policy = parse_policy(queue_policy_env)) < 0) {
+        log_runner("Invalid ALIN_QUEUE_POLICY: %s (expected block or shed)", queue_policy_env);
+        return 1;
+    }
+    const char* queues_env = getenv("ALIN_QUEUES");
+    if (queues_env && queues_env[0] != '\0' && parse_queues(queues_env) != 0) {
+        log_runner("Invalid ALIN_QUEUES: %s", queues_env);
+        return 1;
+    }
+
+    while ((opt = getopt(argc, argv, "a:n:s:r:q:h")) != -1) {
+        switch (opt) {
+            case 'a': active_dir = optarg; break;
+            case 'n': snprintf(nodes_dir, sizeof(nodes_dir), "%s", optarg); break;
+            case 's': state_dir = optarg; break;
+            case 'r':
+                if (parse_replicas(optarg) != 0) {
+                    log_runner("Invalid replica spec: %s (expected slot=N)", optarg);
+                    return 1;
+                }
+                break;
+            case 'q':
+                if (parse_queues(optarg) != 0) {
+                    log_runner("Invalid queue spec: %s (expected slot=[SIZE][:block|:shed])", optarg);
+                    return 1;
+                }
+                break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    // alin_fanout / alin_host 与运行器安装在同一目录
+    const char* slash = strrchr(argv[0], '/');
+    if (slash) {
+        snprintf(fanout_path, sizeof(fanout_path), "%.*s/alin_fanout", (int)(slash - argv[0]), argv[0]);
+        snprintf(host_path, sizeof(host_path), "%.*s/alin_host", (int)(slash - argv[0]), argv[0]);
+    }
+
+    int src_fd = STDIN_FILENO;
+    if (optind < argc) {
+        src_fd = open(argv[optind], O_RDONLY);
+        if (src_fd < 0) {
+            log_runner("Cannot open %s: %s", argv[optind], strerror(errno));
+            return 1;
+        }
+        fcntl(src_fd, F_SETFD, FD_CLOEXEC);
+        log_runner("Reading from file: %s", argv[optind]);
+    } else {
+        log_runner("Reading from stdin...");
+    }
+
+    if (load_topology(active_dir) != 0) return 1;
+    show_topology();
+
+    // 环境约定: 与 alin_stream.sh 保持一致
+    mkdir(state_dir, 0755);
+    if (!getenv("ALIN_STATE_FILE") || getenv("ALIN_STATE_FILE")[0] == '\0') {
+        char state_file[MAX_PATH];
+        snprintf(state_file, sizeof(state_file), "%s/agg_count.state", state_dir);
+        setenv("ALIN_STATE_FILE", state_file, 1);
+    }
+    setenv("ALIN_STREAM", "1", 1);
+    setenv("ALIN_CTL_FD", "3", 1);
+    const char* metrics_env = getenv("ALIN_METRICS_DIR");
+    if (!metrics_env) {
+        snprintf(metrics_dir, sizeof(metrics_dir), "%s/metrics", state_dir);
+    } else {
+        snprintf(metrics_dir, sizeof(metrics_dir), "%s", metrics_env);
+    }
+    if (metrics_dir[0] != '\0') {
+        // 上一次运行留下的段会被读者汇总进来，先清理
+        mkdir(metrics_dir, 0755);
+        alin_metrics_clear(metrics_dir);
+    }
+    setenv("ALIN_METRICS_DIR", metrics_dir, 1);
+    const char* spool_env = getenv("ALIN_SPOOL_DIR");
+    char spool_dir[MAX_PATH];
+    if (!spool_env) {
+        snprintf(spool_dir, sizeof(spool_dir), "%s/spool", state_dir);
+    } else {
+        snprintf(spool_dir, sizeof(spool_dir), "%s", spool_env);
+    }
+    if (spool_dir[0] != '\0') {
+        mkdir(spool_dir, 0755);
+        alin_spool_clear(spool_dir);
+    }
+    setenv("ALIN_SPOOL_DIR", spool_dir, 1);
+    const char* framed_env = getenv("ALIN_FRAMED");
+    if (framed_env && strcmp(framed_env, "0") == 0) framing = 0;
+    const char* ring_env = getenv("ALIN_RING");
+    if (ring_env && strcmp(ring_env, "0") == 0) ring_bus = 0;
+    const char* ring_size_env = getenv("ALIN_RING_SIZE");
+    if (ring_size_env && atol(ring_size_env) >= (long)ALIN_RING_MIN_SIZE) ring_size = (size_t)atol(ring_size_env);
+
+    // 节点提前退出时由 write 返回 EPIPE，而不是直接杀死运行器
+    signal(SIGPIPE, SIG_IGN);
+
+    int event_pipe[2];
+    if (make_pipe(sigchld_pipe) != 0 || make_pipe(event_pipe) != 0 || make_pipe(source.wake) != 0) {
+        log_runner("Cannot create pipes: %s", strerror(errno));
+        return 1;
+    }
+    fcntl(sigchld_pipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(sigchld_pipe[1], F_SETFL, O_NONBLOCK);
+    fcntl(source.wake[0], F_SETFL, O_NONBLOCK);
+    fcntl(source.wake[1], F_SETFL, O_NONBLOCK);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigchld;
+    sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &sa, NULL);
+
+    if (nodes_dir[0] == '\0') alin_default_nodes_dir(active_dir, nodes_dir, sizeof(nodes_dir));
+    int watch_fd = alin_watch_open(active_dir, nodes_dir);
+    if (watch_fd < 0) {
+        log_runner("inotify unavailable, rescanning every %.0fms", RESCAN_FALLBACK * 1000);
+    }
+
+    double start_time = now_seconds();
+    int head_fd = start_pipeline();
+    if (head_fd < 0) return 1;
+
+    source.src_fd = src_fd;
+    source.head_fd = head_fd;
+    source.pending_fd = -1;
+    source.notify_fd = event_pipe[1];
+    source.start_time = start_time;
+    pthread_mutex_init(&source.lock, NULL);
+
+    pthread_t pump;
+    if (pthread_create(&pump, NULL, pump_input, NULL) != 0) {
+        log_runner("Cannot start input pump");
+        return 1;
+    }
+
+    control_loop(active_dir, watch_fd, event_pipe[0]);
+    pthread_join(pump, NULL);
+    if (src_fd != STDIN_FILENO) close(src_fd);
+    if (watch_fd >= 0) close(watch_fd);
+
+    double duration = now_seconds() - start_time;
+    log_runner("=== Stream Complete ===");
+    log_runner("Total events: %ld", source.total);
+    log_runner("Duration: %.3fs", duration);
+    log_runner("Avg rate: %.0f events/sec", duration > 0 ? source.total / duration : 0);
+    report_edges();
+    report_metrics();
+
+    return failed ? 1 : 0;
+}
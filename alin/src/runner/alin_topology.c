@@ -0,0 +1,128 @@
+/**
+ * ALIN 拓扑解析实现 (见 alin_topology.h)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "alin_topology.h"
+
+// ln -sf 表现为 IN_CREATE/IN_MOVED_TO (新链接) 或 IN_DELETE (旧链接)
+#define ACTIVE_EVENTS (IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM | IN_ATTRIB)
+
+static int skip_hidden(const struct dirent* entry) {
+    return entry->d_name[0] != '.';
+}
+
+int alin_topology_scan(const char* active_dir, alin_slot_t* slots, int max_slots) {
+    struct dirent** entries;
+    int count = 0;
+    int n = scandir(active_dir, &entries, skip_hidden, alphasort);
+    if (n < 0) return -1;
+
+    for (int i = 0; i < n; i++) {
+        char link_path[ALIN_MAX_PATH];
+        struct stat st;
+        snprintf(link_path, sizeof(link_path), "%s/%s", active_dir, entries[i]->d_name);
+
+        if (lstat(link_path, &st) == 0 && (S_ISLNK(st.st_mode) || S_ISDIR(st.st_mode)) &&
+            count < max_slots) {
+            alin_slot_t* s = &slots[count];
+            if (realpath(link_path, s->path) && stat(s->path, &st) == 0 &&
+                (S_ISDIR(st.st_mode) || access(s->path, X_OK) == 0)) {
+                snprintf(s->link, sizeof(s->link), "%s", entries[i]->d_name);
+                s->inode = st.st_ino;
+                s->fork = S_ISDIR(st.st_mode);
+                count++;
+            } else {
+                fprintf(stderr, "[TOPOLOGY] Skipping %s: target not executable\n", entries[i]->d_name);
+            }
+        }
+        free(entries[i]);
+    }
+    free(entries);
+    return count;
+}
+
+int alin_topology_branches(const char* fork_dir, alin_slot_t* branches, int max_branches) {
+    struct dirent** entries;
+    int count = 0;
+    int n = scandir(fork_dir, &entries, skip_hidden, alphasort);
+    if (n < 0) return -1;
+
+    for (int i = 0; i < n; i++) {
+        char branch_path[ALIN_MAX_PATH];
+        struct stat st;
+        snprintf(branch_path, sizeof(branch_path), "%s/%s", fork_dir, entries[i]->d_name);
+
+        alin_slot_t* b = &branches[count];
+        if (count < max_branches && realpath(branch_path, b->path) &&
+            stat(b->path, &st) == 0 && S_ISDIR(st.st_mode)) {
+            snprintf(b->link, sizeof(b->link), "%s", entries[i]->d_name);
+            b->inode = st.st_ino;
+            b->fork = 0;
+            count++;
+        }
+        free(entries[i]);
+    }
+    free(entries);
+    return count;
+}
+
+const char* alin_slot_basename(const alin_slot_t* slot) {
+    const char* base = strrchr(slot->path, '/');
+    return base ? base + 1 : slot->path;
+}
+
+void alin_default_nodes_dir(const char* active_dir, char* out, size_t size) {
+    char resolved[ALIN_MAX_PATH];
+    if (!realpath(active_dir, resolved)) {
+        snprintf(resolved, sizeof(resolved), "%s", active_dir);
+    }
+    snprintf(out, size, "%s/nodes", dirname(resolved));
+}
+
+int alin_watch_open(const char* active_dir, const char* nodes_dir) {
+#ifdef __linux__
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return -1;
+
+    if (inotify_add_watch(fd, active_dir, ACTIVE_EVENTS) < 0) {
+        close(fd);
+        return -1;
+    }
+    // 节点被原地重建时 (新 Inode) 同样需要重新解析
+    if (nodes_dir) {
+        inotify_add_watch(fd, nodes_dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+    }
+    return fd;
+#else
+    (void)active_dir;
+    (void)nodes_dir;
+    return -1;
+#endif
+}
+
+void alin_watch_add(int watch_fd, const char* dir) {
+#ifdef __linux__
+    if (watch_fd >= 0) inotify_add_watch(watch_fd, dir, ACTIVE_EVENTS);
+#else
+    (void)watch_fd;
+    (void)dir;
+#endif
+}
+
+int alin_watch_drain(int watch_fd) {
+    char buf[4096];
+    int batches = 0;
+    while (read(watch_fd, buf, sizeof(buf)) > 0) batches++;
+    return batches;
+}
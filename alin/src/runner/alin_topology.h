@@ -0,0 +1,79 @@
+/**
+ * ALIN 拓扑解析 (Topology Scanner)
+ *
+ * alin/active 下按名称排序的符号链接即管道顺序，
+ * 运行器 (alin_runner) 与进程内宿主 (alin_host) 共用此解析逻辑
+ *
+ * DAG 拓扑: 槽位也可以是目录 (或指向目录的符号链接)，即分叉槽位:
+ *
+ *   alin/active/01_parse -> nodes/parse_json_xxx
+ *   alin/active/02_fork/a_alert/01_filter -> nodes/filter_level_xxx
+ *   alin/active/02_fork/a_alert/02_alert -> nodes/alert_console_xxx
+ *   alin/active/02_fork/b_archive/01_agg -> nodes/agg_count_xxx
+ *   alin/active/03_sink -> ...
+ *
+ * 分叉目录下按名称排序的每个子目录是一条分支 (分支内同样按名称排序，可再嵌套分叉);
+ * 进入分叉的每条记录依次流经所有分支 (扇出)，各分支的输出在分叉之后汇合 (扇入)，
+ * 继续流向下一个槽位
+ */
+
+#ifndef ALIN_TOPOLOGY_H
+#define ALIN_TOPOLOGY_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#define ALIN_MAX_SLOTS 64
+#define ALIN_MAX_PATH 4096
+#define ALIN_MAX_NAME 256
+#define ALIN_MAX_BRANCHES 16
+
+typedef struct {
+    char link[ALIN_MAX_NAME];     // 槽位名 (例如 02_filter)
+    char path[ALIN_MAX_PATH];     // 符号链接解析后的节点路径
+    ino_t inode;                  // 目标 Inode
+    int fork;                     // 分叉槽位 (path 为分叉目录)
+} alin_slot_t;
+
+/**
+ * 扫描 active 目录，按名称排序解析出各级槽位
+ * 接受指向可执行文件的符号链接 (与 alin_stream.sh 的 get_pipeline 一致) 与分叉目录
+ * @return 槽位数量, -1 目录不存在
+ */
+int alin_topology_scan(const char* active_dir, alin_slot_t* slots, int max_slots);
+
+/**
+ * 列出分叉目录下的各分支 (子目录，按名称排序)，branches[i].path 为分支目录
+ * @return 分支数量, -1 目录不存在
+ */
+int alin_topology_branches(const char* fork_dir, alin_slot_t* branches, int max_branches);
+
+/**
+ * 槽位显示名: 目标路径的文件名部分
+ */
+const char* alin_slot_basename(const alin_slot_t* slot);
+
+/**
+ * 默认节点仓库: active 目录的同级 nodes 目录
+ */
+void alin_default_nodes_dir(const char* active_dir, char* out, size_t size);
+
+/**
+ * 监听 active (链接切换) 与 nodes (节点重建) 目录的变化
+ * Linux 下基于 inotify，没有事件时不产生任何开销
+ * @return 可 poll 的非阻塞 fd, -1 表示平台不支持 (调用方退回定时重扫)
+ */
+int alin_watch_open(const char* active_dir, const char* nodes_dir);
+
+/**
+ * 追加监听一个嵌套的分叉/分支目录 (重复添加无副作用)
+ */
+void alin_watch_add(int watch_fd, const char* dir);
+
+/**
+ * 读空已到达的变化事件
+ * @return 事件批次数
+ */
+int alin_watch_drain(int watch_fd);
+
+#endif
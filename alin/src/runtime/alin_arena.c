@@ -0,0 +1,86 @@
+/**
+ * ALIN 记录 arena 实现 (见 alin_arena.h)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "alin_arena.h"
+
+struct alin_arena_block {
+    alin_arena_block_t* next;
+    size_t size;                     // 数据区大小
+    size_t used;
+};
+
+// 数据区紧随块头 (对齐)
+#define BLOCK_HDR ((sizeof(alin_arena_block_t) + ALIN_ARENA_ALIGN - 1) & ~(size_t)(ALIN_ARENA_ALIGN - 1))
+
+static inline char* block_data(alin_arena_block_t* b) {
+    return (char*)b + BLOCK_HDR;
+}
+
+static alin_arena_block_t* new_block(alin_arena_t* arena, size_t size) {
+    alin_arena_block_t* b = malloc(BLOCK_HDR + size);
+    if (!b) {
+        fprintf(stderr, "[ARENA] Cannot allocate %zu bytes\n", size);
+        return NULL;
+    }
+    b->next = NULL;
+    b->size = size;
+    b->used = 0;
+    arena->allocations++;
+    return b;
+}
+
+void alin_arena_init(alin_arena_t* arena, size_t initial) {
+    arena->head = NULL;
+    arena->initial = initial;
+    arena->allocations = 0;
+}
+
+void* alin_arena_alloc(alin_arena_t* arena, size_t size) {
+    size = (size + ALIN_ARENA_ALIGN - 1) & ~(size_t)(ALIN_ARENA_ALIGN - 1);
+    alin_arena_block_t* b = arena->head;
+    if (!b || b->size - b->used < size) {
+        size_t want = b ? b->size * 2 : arena->initial;
+        if (want < size) want = size;
+        alin_arena_block_t* nb = new_block(arena, want);
+        if (!nb) return NULL;
+        nb->next = b;
+        arena->head = b = nb;
+    }
+    void* p = block_data(b) + b->used;
+    b->used += size;
+    return p;
+}
+
+void alin_arena_reset(alin_arena_t* arena) {
+    alin_arena_block_t* b = arena->head;
+    if (!b) return;
+
+    if (!b->next && b->size <= ALIN_ARENA_KEEP) {
+        b->used = 0;
+        return;
+    }
+
+    // 多个块: 合并为一个 (下一轮同等用量只需一块); 超过保留上限时全部释放，按需重新分配
+    size_t total = 0;
+    while (b) {
+        alin_arena_block_t* next = b->next;
+        total += b->size;
+        free(b);
+        b = next;
+    }
+    arena->head = total <= ALIN_ARENA_KEEP ? new_block(arena, total) : NULL;
+}
+
+void alin_arena_free(alin_arena_t* arena) {
+    alin_arena_block_t* b = arena->head;
+    while (b) {
+        alin_arena_block_t* next = b->next;
+        free(b);
+        b = next;
+    }
+    arena->head = NULL;
+}
@@ -0,0 +1,50 @@
+/**
+ * ALIN 记录 arena (Per-Record Arena)
+ *
+ * 处理一条记录所需的临时缓冲区 (输出缓冲区、转义结果、解码后的数据) 从 arena 顺序分配，
+ * 不逐个释放，记录处理完后整体重置:
+ * - 当前块放不下时追加新块 (至少为上一块的两倍)，记录长度不再受固定数组的限制
+ * - 重置时若用到了多个块，合并为一个能容纳本轮全部用量的块;
+ *   此后同等规模的记录不再调用 malloc (流模式稳态下每条记录 0 次分配)
+ * - 超过 ALIN_ARENA_KEEP 的块在重置时释放，偶发的超长记录不会一直占用内存
+ * 节点运行时为每个节点维护一个 (alin_record_arena()，见 alin_node.h)
+ */
+
+#ifndef ALIN_ARENA_H
+#define ALIN_ARENA_H
+
+#include <stddef.h>
+
+#define ALIN_ARENA_ALIGN 16
+#define ALIN_ARENA_KEEP (4u << 20)
+
+typedef struct alin_arena_block alin_arena_block_t;
+
+typedef struct {
+    alin_arena_block_t* head;        // 当前块 (链表，最新的在前; NULL 表示尚未分配)
+    size_t initial;                  // 首块大小
+    long allocations;                // 累计 malloc 次数 (观察稳态是否还在分配)
+} alin_arena_t;
+
+/**
+ * 初始化 (首次分配时才申请 initial 字节的首块)
+ */
+void alin_arena_init(alin_arena_t* arena, size_t initial);
+
+/**
+ * 分配 size 字节 (按 ALIN_ARENA_ALIGN 对齐)，在下一次重置前有效
+ * @return 内存, NULL 表示内存不足
+ */
+void* alin_arena_alloc(alin_arena_t* arena, size_t size);
+
+/**
+ * 重置: 之前分配的内存全部失效，保留 (合并后的) 块供下一轮使用
+ */
+void alin_arena_reset(alin_arena_t* arena);
+
+/**
+ * 释放全部块
+ */
+void alin_arena_free(alin_arena_t* arena);
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * ALIN 控制通道实现 (见 alin_ctl.h)
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "alin_ctl.h"
+
+int alin_ctl_send(int ctl_fd, const alin_ctl_msg_t* msg, const int* fds, int nfds) {
+    struct iovec iov = { (void*)msg, sizeof(*msg) };
+    struct msghdr hdr;
+    char cbuf[CMSG_SPACE(sizeof(int) * ALIN_CTL_MAX_FDS)];
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+
+    if (nfds > 0 && nfds <= ALIN_CTL_MAX_FDS) {
+        memset(cbuf, 0, sizeof(cbuf));
+        hdr.msg_control = cbuf;
+        hdr.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+    }
+
+    // 运行器已退出时返回错误而不是 SIGPIPE (节点的周期汇报不应因此终止节点)
+#ifdef MSG_NOSIGNAL
+    int flags = MSG_NOSIGNAL;
+#else
+    int flags = 0;
+#endif
+    ssize_t n;
+    do {
+        n = sendmsg(ctl_fd, &hdr, flags);
+    } while (n < 0 && errno == EINTR);
+    return n == (ssize_t)sizeof(*msg) ? 0 : -1;
+}
+
+int alin_ctl_recv(int ctl_fd, alin_ctl_msg_t* msg, int fds[ALIN_CTL_MAX_FDS], int nonblock) {
+    struct iovec iov = { msg, sizeof(*msg) };
+    struct msghdr hdr;
+    char cbuf[CMSG_SPACE(sizeof(int) * ALIN_CTL_MAX_FDS)];
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = cbuf;
+    hdr.msg_controllen = sizeof(cbuf);
+    for (int i = 0; i < ALIN_CTL_MAX_FDS; i++) fds[i] = -1;
+
+    ssize_t n;
+    do {
+        n = recvmsg(ctl_fd, &hdr, nonblock ? MSG_DONTWAIT : 0);
+    } while (n < 0 && errno == EINTR);
+    if (n == 0) return 0;
+    if (n != (ssize_t)sizeof(*msg)) return -1;
+
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            if (count > ALIN_CTL_MAX_FDS) count = ALIN_CTL_MAX_FDS;
+            memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * count);
+        }
+    }
+    return 1;
+}
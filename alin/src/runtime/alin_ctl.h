@@ -0,0 +1,83 @@
+/**
+ * ALIN 控制通道 (Control Channel)
+ *
+ * 运行器与常驻节点之间的带外控制消息，走 ALIN_CTL_FD 指定的 unix socket:
+ * - HELLO     节点 → 运行器  节点已接入运行时，可接受控制消息，b = 能力位 (ALIN_CTL_CAP_*)
+ * - REDIRECT  运行器 → 节点  携带新 fd，节点在记录边界把 stdout 切换到该 fd
+ * - ACK       节点 → 运行器  切换完成，a = 切换前写入旧下游的记录数
+ * - MARK      运行器 → 节点  输入即将被切断，节点记下当时已消费的记录数
+ * - BYE       节点 → 运行器  输入 EOF，a = 消费记录总数，b = MARK 时的消费数 (未收到为 -1)，
+ *                            c = 写入当前下游的记录数
+ * - FRAMED    运行器 → 节点  下游也支持帧协议，节点在记录边界把输出升级为帧
+ *                            (REDIRECT 切换下游时自动退回文本行，需重新协商)
+ * - RING      运行器 → 节点  携带共享内存环形缓冲的 fds (alin_ring.h)，a = 角色 (ALIN_RING_*)，
+ *                            b = 大小，c = 逻辑容量 (0 为整个环); 相邻两级都声明 ALIN_CTL_CAP_RING 时代替 FRAMED
+ * - QUEUE     运行器 → 节点  输出队列满时的策略，a = ALIN_QUEUE_*，对此后的每个下游都有效
+ * - STATS     节点 → 运行器  输出队列统计 (累计值)，a = 等待下游腾出空间的时间 (微秒)，
+ *                            b = 按策略丢弃的记录数，c = 占用峰值 (字节); 至多每秒一次，退出前再发一次
+ *
+ * 数据通路上没有任何控制开销: 节点只在输入缓冲耗尽、本来就要阻塞读取时
+ * 才顺带检查控制通道
+ */
+
+#ifndef ALIN_CTL_H
+#define ALIN_CTL_H
+
+#include <stdint.h>
+#include <sys/socket.h>
+
+#define ALIN_CTL_FD_NUM 3    // 运行器约定把控制通道放在子进程的 fd 3
+
+// 保留消息边界且能感知对端关闭; 不支持 SEQPACKET 的平台退回定长消息的字节流
+#ifdef __linux__
+#define ALIN_CTL_SOCK_TYPE SOCK_SEQPACKET
+#else
+#define ALIN_CTL_SOCK_TYPE SOCK_STREAM
+#endif
+
+enum {
+    ALIN_CTL_HELLO = 1,
+    ALIN_CTL_REDIRECT,
+    ALIN_CTL_ACK,
+    ALIN_CTL_MARK,
+    ALIN_CTL_BYE,
+    ALIN_CTL_FRAMED,
+    ALIN_CTL_RING,
+    ALIN_CTL_QUEUE,
+    ALIN_CTL_STATS
+};
+
+// 队列满时生产者的策略 (ALIN_CTL_QUEUE 消息的 a)
+enum {
+    ALIN_QUEUE_BLOCK = 0,    // 阻塞直到下游腾出空间 (默认，不丢记录)
+    ALIN_QUEUE_SHED          // 丢弃放不下的记录，生产者不被拖慢
+};
+
+// HELLO 携带的能力位
+#define ALIN_CTL_CAP_FRAMED 0x1
+#define ALIN_CTL_CAP_RING 0x2
+#define ALIN_CTL_CAP_STATELESS 0x4   // 节点声明 ALIN_NODE_STATELESS，可并行运行多个副本
+
+#define ALIN_CTL_MAX_FDS 4   // 单条消息最多携带的 fd 数
+
+typedef struct {
+    uint32_t type;
+    uint32_t reserved;
+    int64_t a;
+    int64_t b;
+    int64_t c;
+} alin_ctl_msg_t;
+
+/**
+ * 发送控制消息，nfds > 0 时通过 SCM_RIGHTS 一并传递 fds
+ * @return 0 成功, -1 失败
+ */
+int alin_ctl_send(int ctl_fd, const alin_ctl_msg_t* msg, const int* fds, int nfds);
+
+/**
+ * 接收一条控制消息，随消息传来的 fd 依次写入 fds (其余置为 -1)
+ * @return 1 收到消息, 0 对端关闭, -1 暂无消息或出错
+ */
+int alin_ctl_recv(int ctl_fd, alin_ctl_msg_t* msg, int fds[ALIN_CTL_MAX_FDS], int nonblock);
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ * ALIN 帧协议实现 (见 alin_frame.h)
+ */
+
+#include <string.h>
+
+#include "alin_frame.h"
+
+static const char* level_names[] = {
+    NULL, "DEBUG", "INFO", "WARN", "ERROR", "FATAL", "RAW"
+};
+
+int alin_level_code(const char* name) {
+    for (int i = ALIN_LEVEL_DEBUG; i <= ALIN_LEVEL_RAW; i++) {
+        if (strcmp(name, level_names[i]) == 0) return i;
+    }
+    return ALIN_LEVEL_NONE;
+}
+
+const char* alin_level_name(int code) {
+    if (code <= ALIN_LEVEL_NONE || code > ALIN_LEVEL_RAW) return NULL;
+    return level_names[code];
+}
@@ -0,0 +1,100 @@
+/**
+ * ALIN 帧协议 (Framed Wire Protocol)
+ *
+ * 节点之间默认以换行分隔的 JSON 文本通信。两端都使用节点运行时时，
+ * 运行器通过控制通道 (alin_ctl.h) 协商升级为帧格式:
+ *
+ *   [alin_frame_t 16 字节头][length 字节负载]
+ *
+ * 头部携带 _type / level / timestamp，下游无需扫描负载即可判断记录边界
+ * 与路由字段。带 ALIN_FRAME_FIELDS 标志的帧在负载之后附带字段表:
+ *
+ *   [alin_frame_t][负载][uint32_t count][count 个 alin_field_t]
+ *
+ * 字段表是生产者已知的负载索引 (如 parse_json 生成的各字段的位置)，
+ * 下游据此直接定位字段值，不必重新解析 (见 alin_json_unpack)。切换点在数据流内标记:
+ * - 生产者在文本流中写一行 ALIN_FRAME_MAGIC，此后的数据为帧
+ * - 生产者在帧流中写一个带 ALIN_FRAME_LINES 标志的空帧，此后恢复文本
+ * 文本流中的 ALIN_BATCH_MAGIC 行是批次边界，节点运行时原样回显到输出
+ * (alin_fanout 据此把并行副本的输出按批次重新排序)
+ * 管道两端总在同一台机器上，头部按本机字节序编码
+ */
+
+#ifndef ALIN_FRAME_H
+#define ALIN_FRAME_H
+
+#include <stdint.h>
+
+#define ALIN_FRAME_MAGIC "\036ALIN-FRAMED/1"   // 以 RS 控制字符开头，不会与 JSON 行冲突
+#define ALIN_BATCH_MAGIC "\036ALIN-BATCH"
+
+// 帧标志
+#define ALIN_FRAME_LINES 0x1    // 切回文本行 (负载为空)
+#define ALIN_FRAME_WRAP 0x2     // 环形缓冲回绕标记 (见 alin_ring.h)
+#define ALIN_FRAME_FIELDS 0x4   // 负载之后附带字段表
+
+// _type
+enum {
+    ALIN_TYPE_NONE = 0,         // 未知 (需解析负载)
+    ALIN_TYPE_LOG
+};
+
+// level (只收录规范的大写级别名，其余一律 NONE)
+enum {
+    ALIN_LEVEL_NONE = 0,
+    ALIN_LEVEL_DEBUG,
+    ALIN_LEVEL_INFO,
+    ALIN_LEVEL_WARN,
+    ALIN_LEVEL_ERROR,
+    ALIN_LEVEL_FATAL,
+    ALIN_LEVEL_RAW
+};
+
+typedef struct {
+    uint32_t length;            // 负载字节数
+    uint8_t type;               // ALIN_TYPE_*
+    uint8_t level;              // ALIN_LEVEL_*
+    uint16_t flags;             // ALIN_FRAME_*
+    int64_t timestamp;          // 事件时间 (0 未知)
+} alin_frame_t;
+
+// 字段表的一项: 负载中一个对象成员的位置 (偏移相对负载起点)
+#define ALIN_FIELDS_MAX 64
+#define ALIN_FIELD_ESCAPED 0x80         // type 最高位: 字符串值含转义序列
+
+typedef struct {
+    uint32_t key;               // 键 (不含引号)
+    uint32_t value;             // 值: 字符串不含引号; 对象含括号
+    uint32_t value_len;
+    uint16_t key_len;
+    int8_t parent;              // 所在对象的表项 (-1 表示顶层)
+    uint8_t type;               // ALIN_JSON_* | ALIN_FIELD_ESCAPED
+} alin_field_t;
+
+typedef struct {
+    uint32_t count;
+    alin_field_t fields[ALIN_FIELDS_MAX];
+} alin_fields_t;
+
+// 帧中字段表的字节数 (只传前 count 项)
+#define ALIN_FIELDS_SIZE(count) (sizeof(uint32_t) + (size_t)(count) * sizeof(alin_field_t))
+
+// 记录的类型化元数据 (帧头中除长度与标志外的部分，以及可选的字段表)
+typedef struct {
+    uint8_t type;
+    uint8_t level;
+    int64_t timestamp;
+    const alin_fields_t* fields;    // NULL 表示没有字段表
+} alin_meta_t;
+
+/**
+ * 级别名 → 编码，仅精确匹配规范名 (DEBUG/INFO/WARN/ERROR/FATAL/RAW)
+ */
+int alin_level_code(const char* name);
+
+/**
+ * 编码 → 级别名，ALIN_LEVEL_NONE 返回 NULL
+ */
+const char* alin_level_name(int code);
+
+#endif
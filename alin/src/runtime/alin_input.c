@@ -0,0 +1,242 @@
+/**
+ * ALIN 块输入层实现 (见 alin_input.h)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "alin_input.h"
+
+// 缓冲区分配失败时的空输入
+static char empty_input[1];
+
+static int mmap_enabled(void) {
+    const char* env = getenv("ALIN_MMAP");
+    return !env || strcmp(env, "0") != 0;
+}
+
+/**
+ * 整体映射普通文件 (从 fd 的当前偏移开始消费)
+ * 文件之后紧跟一页匿名内存，数据之后总能读到 '\0'
+ * @return 0 成功, -1 不是普通文件、已无剩余内容或映射失败
+ */
+static int map_file(alin_input_t* in) {
+    struct stat st;
+    if (fstat(in->fd, &st) < 0 || !S_ISREG(st.st_mode)) return -1;
+    off_t pos = lseek(in->fd, 0, SEEK_CUR);
+    if (pos < 0 || st.st_size <= pos) return -1;
+
+    size_t size = (size_t)st.st_size;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t span = (size + page - 1) / page * page + page;
+    char* base = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return -1;
+    // 私有映射: 切分时原地写入的 '\0' 不会改动文件
+    if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, in->fd, 0) == MAP_FAILED) {
+        munmap(base, span);
+        return -1;
+    }
+    madvise(base, size, MADV_SEQUENTIAL);
+
+    in->buf = base;
+    in->cap = size;
+    in->map_size = span;
+    in->start = (size_t)pos;
+    in->scan = (size_t)pos;
+    in->end = size;
+    in->eof = 1;
+    in->mapped = 1;
+    return 0;
+}
+
+void alin_input_open(alin_input_t* in, int fd, size_t max_span) {
+    memset(in, 0, sizeof(*in));
+    in->fd = fd;
+    in->max_span = max_span;
+    in->buf = empty_input;
+}
+
+/**
+ * 首次读取时分配缓冲区 (至多一块的记录空间，更长的记录到来时再倍增)
+ * @return 0 成功, -1 内存不足 (此后视为 EOF)
+ */
+static int alloc_buffer(alin_input_t* in) {
+    size_t cap = (in->max_span < ALIN_INPUT_BLOCK ? in->max_span : ALIN_INPUT_BLOCK) + ALIN_INPUT_BLOCK;
+    in->buf = malloc(cap + 1);
+    if (!in->buf) {
+        fprintf(stderr, "[INPUT] Cannot allocate %zu bytes\n", cap + 1);
+        in->buf = empty_input;
+        in->eof = 1;
+        return -1;
+    }
+    in->cap = cap;
+    in->buf[0] = '\0';
+    return 0;
+}
+
+/**
+ * 未消费的数据占满缓冲区: 容量倍增，至多 max_span + ALIN_INPUT_BLOCK
+ * (之前交出的切片随之失效，调用方在下一次调用本层前已不再使用)
+ */
+static void grow_buffer(alin_input_t* in) {
+    size_t limit = in->max_span + ALIN_INPUT_BLOCK;
+    size_t cap = in->cap * 2 < limit ? in->cap * 2 : limit;
+    char* buf = realloc(in->buf, cap + 1);
+    if (!buf) {
+        fprintf(stderr, "[INPUT] Cannot grow buffer to %zu bytes\n", cap + 1);
+        return;
+    }
+    in->buf = buf;
+    in->cap = cap;
+}
+
+/**
+ * 恢复 take 时占用的字节
+ */
+static inline void restore(alin_input_t* in) {
+    if (in->held) {
+        *in->held = in->held_byte;
+        in->held = NULL;
+    }
+}
+
+/**
+ * 再读入一块; 尾部空间不足一块时先把未消费的数据移到开头
+ * @return 1 读到数据, 0 EOF
+ */
+static int fill(alin_input_t* in) {
+    if (in->eof) return 0;
+    if (in->cap == 0 && alloc_buffer(in) < 0) return 0;
+    if (in->cap - in->end < ALIN_INPUT_BLOCK && in->start > 0) {
+        size_t n = in->end - in->start;
+        memmove(in->buf, in->buf + in->start, n);
+        in->scan = in->scan > in->start ? in->scan - in->start : 0;
+        in->start = 0;
+        in->end = n;
+    }
+    if (in->cap - in->end < ALIN_INPUT_BLOCK && in->cap < in->max_span + ALIN_INPUT_BLOCK) grow_buffer(in);
+
+    for (;;) {
+        if (in->before_read && in->before_read(in->ctx) != 0) continue;
+        ssize_t n = in->end < in->cap ? read(in->fd, in->buf + in->end, in->cap - in->end) : 0;
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            in->eof = 1;
+            in->buf[in->end] = '\0';
+            return 0;
+        }
+        in->end += (size_t)n;
+        in->buf[in->end] = '\0';
+        return 1;
+    }
+}
+
+char* alin_input_line(alin_input_t* in, size_t max_len, size_t* len) {
+    restore(in);
+    for (;;) {
+        if (in->scan < in->start) in->scan = in->start;
+        char* line = in->buf + in->start;
+        char* nl = memchr(in->buf + in->scan, '\n', in->end - in->scan);
+
+        if (in->discard) {
+            // 上一行超长: 丢弃到下一个换行
+            if (nl) {
+                in->start = (size_t)(nl - in->buf) + 1;
+                in->discard = 0;
+                continue;
+            }
+            in->start = in->end;
+            if (!fill(in)) return NULL;
+            continue;
+        }
+
+        if (nl && (size_t)(nl - line) <= max_len) {
+            *nl = '\0';
+            *len = (size_t)(nl - line);
+            in->start = (size_t)(nl - in->buf) + 1;
+            return line;
+        }
+
+        if (nl || in->end - in->start > max_len) {
+            // 超长行: 交出前 max_len 字节，其余丢弃 (第 max_len 字节不是换行，可以占用)
+            line[max_len] = '\0';
+            *len = max_len;
+            in->start += max_len + 1;
+            in->discard = 1;
+            return line;
+        }
+
+        in->scan = in->end;
+        if (!fill(in)) {
+            if (in->start == in->end) return NULL;
+            // 最后一行没有换行符 (有效数据之后总有 '\0')
+            line = in->buf + in->start;
+            *len = in->end - in->start;
+            in->start = in->end;
+            return line;
+        }
+    }
+}
+
+char* alin_input_need(alin_input_t* in, size_t n) {
+    restore(in);
+    while (in->end - in->start < n) {
+        if (!fill(in)) return NULL;
+    }
+    return in->buf + in->start;
+}
+
+size_t alin_input_skip(alin_input_t* in, size_t n) {
+    restore(in);
+    size_t done = 0;
+    for (;;) {
+        size_t avail = in->end - in->start;
+        size_t step = n - done < avail ? n - done : avail;
+        in->start += step;
+        done += step;
+        if (done == n || !fill(in)) return done;
+    }
+}
+
+char* alin_input_take(alin_input_t* in, size_t n) {
+    char* p = alin_input_need(in, n);
+    if (!p) return NULL;
+    in->start += n;
+    in->held = p + n;
+    in->held_byte = p[n];
+    p[n] = '\0';
+    return p;
+}
+
+char* alin_input_all(alin_input_t* in, size_t* len) {
+    restore(in);
+    // 尚未读取过: 普通文件直接映射
+    if (in->cap == 0 && !in->eof && mmap_enabled()) map_file(in);
+    size_t limit = in->max_span > 0 ? in->max_span - 1 : 0;
+    while (in->end - in->start < limit && fill(in)) {}
+    size_t n = in->end - in->start < limit ? in->end - in->start : limit;
+    *len = n;
+    return alin_input_take(in, n);
+}
+
+void alin_input_close(alin_input_t* in) {
+    restore(in);
+    if (in->mapped) {
+        lseek(in->fd, (off_t)in->start, SEEK_SET);
+        munmap(in->buf, in->map_size);
+    } else if (in->cap > 0) {
+        free(in->buf);
+    }
+    in->buf = empty_input;
+    in->cap = 0;
+    in->start = 0;
+    in->end = 0;
+    in->scan = 0;
+    in->mapped = 0;
+    in->eof = 1;
+}
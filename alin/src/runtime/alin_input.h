@@ -0,0 +1,82 @@
+/**
+ * ALIN 块输入层 (Block Input)
+ *
+ * 节点读取输入的统一入口 (节点运行时、alin_host、图像节点):
+ * - 记录流 (按行或按帧): 每次 read(2) 一大块 (ALIN_INPUT_BLOCK) 到缓冲区，
+ *   按 '\n' 切分 (memchr，glibc 中为向量化实现)，换行符原地改为 '\0'
+ * - 整体读入 (单次模式、图像节点): 输入是普通文件时直接 mmap，不经过 read(2) 复制
+ * 记录以切片形式原地交出，不复制到调用方的缓冲区; 切片在下一次调用本层之前有效，
+ * 调用方可原地修改 (如去除首尾空白)
+ *
+ * 记录流不映射文件: 原地写入的 '\0' 会让私有映射逐页写时复制，比 read(2) 更慢
+ * (make bench-input); 环境变量 ALIN_MMAP=0 关闭整体读入时的映射 (对比与排查)
+ */
+
+#ifndef ALIN_INPUT_H
+#define ALIN_INPUT_H
+
+#include <stddef.h>
+
+#define ALIN_INPUT_BLOCK 262144
+
+typedef struct {
+    int fd;
+    char* buf;                       // 块缓冲区或文件映射 (有效数据之后总有一个 '\0')
+    size_t cap;                      // 缓冲区容量 (0 表示尚未分配; 映射时为文件长度)
+    size_t max_span;                 // 单次需要连续存放的最大字节数 (缓冲区按需倍增到此)
+    size_t start;                    // 未消费数据的起点
+    size_t end;                      // 有效数据的终点
+    size_t scan;                     // 从此处继续查找换行 (之前的部分已确认没有)
+    int eof;
+    int discard;                     // 正在丢弃超长行的剩余部分
+    int mapped;                      // buf 是文件映射
+    size_t map_size;
+    char* held;                      // take 时临时改为 '\0' 的字节 (下次调用时恢复)
+    char held_byte;
+    int (*before_read)(void* ctx);   // 即将阻塞读取前调用; 返回非 0 表示先不读取、重新调用
+    void* ctx;
+} alin_input_t;
+
+/**
+ * 打开输入 (首次读取时才分配缓冲区: 先容纳一块，遇到更长的记录时倍增，
+ * 至多 max_span + ALIN_INPUT_BLOCK 字节)
+ */
+void alin_input_open(alin_input_t* in, int fd, size_t max_span);
+
+/**
+ * 下一行 (不含换行符)，超过 max_len 的部分截断丢弃; max_len 不得超过 max_span
+ * @return 以 '\0' 结尾的切片, NULL 表示 EOF
+ */
+char* alin_input_line(alin_input_t* in, size_t max_len, size_t* len);
+
+/**
+ * 确保接下来的 n 字节连续可用 (不消费); n 不得超过 max_span
+ * @return 指向这 n 字节, NULL 表示不足 n 字节就到了 EOF
+ */
+char* alin_input_need(alin_input_t* in, size_t n);
+
+/**
+ * 消费 n 字节 (可超出缓冲区，超出部分读出后丢弃)
+ * @return 实际消费的字节数 (小于 n 表示 EOF)
+ */
+size_t alin_input_skip(alin_input_t* in, size_t n);
+
+/**
+ * 消费 n 字节并以 '\0' 结尾交出 (结尾处被占用的字节在下次调用时恢复)
+ * @return 切片, NULL 表示不足 n 字节就到了 EOF
+ */
+char* alin_input_take(alin_input_t* in, size_t n);
+
+/**
+ * 余下的全部输入 (单次模式、图像节点)，超过 max_span - 1 的部分截断;
+ * 尚未读取过且输入是普通文件时映射文件
+ * @return 以 '\0' 结尾的切片 (无输入时为空串)
+ */
+char* alin_input_all(alin_input_t* in, size_t* len);
+
+/**
+ * 释放缓冲区或映射; 映射时把 fd 的偏移移到已消费的位置
+ */
+void alin_input_close(alin_input_t* in);
+
+#endif
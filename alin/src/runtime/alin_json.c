@@ -0,0 +1,448 @@
+/**
+ * ALIN JSON 字段索引实现 (见 alin_json.h)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "alin_json.h"
+#include "alin_scan.h"
+
+// 字符分类: 扫描字符串与标量时每个字节只查一次表
+#define STRING_STOP 0x1     // 字符串内需要停下的字符: 引号、反斜杠、结尾
+#define SCALAR_STOP 0x2     // 数字/true/false/null 的结束: 分隔符、空白、结尾
+
+static const uint8_t char_class[256] = {
+    ['\0'] = STRING_STOP | SCALAR_STOP,
+    ['"'] = STRING_STOP,
+    ['\\'] = STRING_STOP,
+    [','] = SCALAR_STOP,
+    ['}'] = SCALAR_STOP,
+    [']'] = SCALAR_STOP,
+    [' '] = SCALAR_STOP,
+    ['\t'] = SCALAR_STOP,
+    ['\n'] = SCALAR_STOP,
+    ['\r'] = SCALAR_STOP
+};
+
+// 键与短值逐字节查表更快，超过这个长度再交给向量扫描
+#define SHORT_STRING 16
+
+static const char* skip_space(const char* p) {
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+    return p;
+}
+
+/**
+ * 扫描字符串 (p 指向开引号之后)
+ * @return 闭引号位置, NULL 表示字符串未闭合
+ */
+static const char* scan_string(const char* p, uint8_t* escaped) {
+    for (;;) {
+        const char* head = p + SHORT_STRING;
+        while (p < head && !(char_class[(unsigned char)*p] & STRING_STOP)) p++;
+        if (p == head) p = alin_scan_string(p);
+        if (*p == '"') return p;
+        if (*p == '\0' || p[1] == '\0') return NULL;
+        *escaped = 1;
+        p += 2;
+    }
+}
+
+/**
+ * 整体跳过一个数组或不再展开的对象 (p 指向开括号)
+ * @return 闭括号之后的位置, NULL 表示不完整
+ */
+static const char* skip_compound(const char* p) {
+    int depth = 0;
+    uint8_t escaped = 0;
+    for (;;) {
+        char c = *p;
+        if (c == '\0') return NULL;
+        if (c == '"') {
+            p = scan_string(p + 1, &escaped);
+            if (!p) return NULL;
+        } else if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) return p + 1;
+        }
+        p++;
+    }
+}
+
+static const char* skip_scalar(const char* p) {
+    while (!(char_class[(unsigned char)*p] & SCALAR_STOP)) p++;
+    return p;
+}
+
+/**
+ * 从 p 起编入顶层对象的成员，直到顶层对象结束
+ */
+static int index_members(alin_json_t* doc, const char* p) {
+    // parents[depth]: 当前正在展开的对象对应的索引项 (顶层为 -1)
+    int parents[ALIN_JSON_MAX_DEPTH];
+    int depth = 0;
+    parents[0] = -1;
+
+    for (;;) {
+        p = skip_space(p);
+        if (*p == '}') {
+            p++;
+            if (depth == 0) break;
+            alin_json_field_t* obj = &doc->fields[parents[depth--]];
+            obj->value_len = (uint32_t)(p - obj->value);
+            p = skip_space(p);
+            if (*p == ',') p++;
+            continue;
+        }
+        if (*p != '"') break;
+        if (doc->count >= ALIN_JSON_MAX_FIELDS) {
+            doc->overflow = 1;
+            break;
+        }
+
+        alin_json_field_t* f = &doc->fields[doc->count];
+        uint8_t key_escaped = 0;
+        const char* key_end = scan_string(p + 1, &key_escaped);
+        if (!key_end || key_end - (p + 1) > UINT16_MAX) break;
+        f->key = p + 1;
+        f->key_len = (uint16_t)(key_end - f->key);
+        f->parent = (int16_t)parents[depth];
+        f->escaped = 0;
+
+        p = skip_space(key_end + 1);
+        if (*p != ':') break;
+        p = skip_space(p + 1);
+        f->value = p;
+
+        const char* end;
+        if (*p == '"') {
+            f->type = ALIN_JSON_STRING;
+            f->value = p + 1;
+            end = scan_string(p + 1, &f->escaped);
+            if (!end) break;
+            f->value_len = (uint32_t)(end - f->value);
+            end++;
+        } else if (*p == '{' && depth + 1 < ALIN_JSON_MAX_DEPTH) {
+            // 展开嵌套对象: 成员紧随其后编入，value_len 在闭括号处补上
+            f->type = ALIN_JSON_OBJECT;
+            f->value_len = 0;
+            parents[++depth] = doc->count++;
+            p++;
+            continue;
+        } else if (*p == '{' || *p == '[') {
+            f->type = *p == '{' ? ALIN_JSON_OBJECT : ALIN_JSON_ARRAY;
+            end = skip_compound(p);
+            if (!end) break;
+            f->value_len = (uint32_t)(end - p);
+        } else {
+            if (*p == 't') f->type = ALIN_JSON_TRUE;
+            else if (*p == 'f') f->type = ALIN_JSON_FALSE;
+            else if (*p == 'n') f->type = ALIN_JSON_NULL;
+            else if (*p == '-' || (*p >= '0' && *p <= '9')) f->type = ALIN_JSON_NUMBER;
+            else break;
+            end = skip_scalar(p);
+            f->value_len = (uint32_t)(end - p);
+        }
+        doc->count++;
+
+        p = skip_space(end);
+        if (*p == ',') p++;
+        else if (*p != '}') break;
+    }
+
+    // 中途停下 (溢出或不完整) 时仍在展开的对象: 按原文补上长度，不完整的记为 0
+    while (depth > 0) {
+        alin_json_field_t* obj = &doc->fields[parents[depth--]];
+        const char* end = skip_compound(obj->value);
+        obj->value_len = end ? (uint32_t)(end - obj->value) : 0;
+    }
+    return doc->count;
+}
+
+int alin_json_index(alin_json_t* doc, const char* json) {
+    doc->json = json;
+    doc->count = 0;
+    doc->overflow = 0;
+    doc->found_next = 0;
+
+    const char* p = skip_space(json);
+    if (*p != '{') return -1;
+    return index_members(doc, p + 1);
+}
+
+int alin_json_resume(alin_json_t* doc, const char* p) {
+    p = skip_space(p);
+    if (*p == ',') p++;
+    return index_members(doc, p);
+}
+
+int alin_json_pack(const alin_json_t* doc, alin_fields_t* fields) {
+    for (int i = 0; i < doc->count; i++) {
+        const alin_json_field_t* f = &doc->fields[i];
+        alin_field_t* out = &fields->fields[i];
+        out->key = (uint32_t)(f->key - doc->json);
+        out->value = (uint32_t)(f->value - doc->json);
+        out->value_len = f->value_len;
+        out->key_len = f->key_len;
+        out->parent = (int8_t)f->parent;
+        out->type = (uint8_t)(f->type | (f->escaped ? ALIN_FIELD_ESCAPED : 0));
+    }
+    fields->count = (uint32_t)doc->count;
+    return doc->count;
+}
+
+int alin_json_unpack(alin_json_t* doc, const char* json, size_t len, const alin_fields_t* fields) {
+    doc->json = json;
+    doc->count = 0;
+    doc->overflow = 0;
+    doc->found_next = 0;
+    if (fields->count > ALIN_JSON_MAX_FIELDS) return -1;
+
+    for (uint32_t i = 0; i < fields->count; i++) {
+        const alin_field_t* in = &fields->fields[i];
+        // 字段表来自上游，越界 (如负载被截断) 时整体作废，由调用方退回扫描
+        if ((size_t)in->key + in->key_len > len || (size_t)in->value + in->value_len > len ||
+            in->parent >= (int)i) {
+            doc->count = 0;
+            return -1;
+        }
+        alin_json_field_t* f = &doc->fields[i];
+        f->key = json + in->key;
+        f->value = json + in->value;
+        f->value_len = in->value_len;
+        f->key_len = in->key_len;
+        f->parent = in->parent;
+        f->type = in->type & ~ALIN_FIELD_ESCAPED;
+        f->escaped = (in->type & ALIN_FIELD_ESCAPED) != 0;
+    }
+    doc->count = (int)fields->count;
+    // 字段表不带溢出标记: 满表时其后可能还有成员
+    doc->overflow = doc->count == ALIN_JSON_MAX_FIELDS;
+    return doc->count;
+}
+
+int alin_json_add(alin_json_t* doc, const char* key, size_t key_len,
+                  const char* value, size_t value_len, int type, int parent) {
+    if (doc->count >= ALIN_JSON_MAX_FIELDS) {
+        doc->overflow = 1;
+        return -1;
+    }
+    alin_json_field_t* f = &doc->fields[doc->count];
+    f->key = key;
+    f->value = value;
+    f->value_len = (uint32_t)value_len;
+    f->key_len = (uint16_t)key_len;
+    f->parent = (int16_t)parent;
+    f->type = (uint8_t)type;
+    f->escaped = type == ALIN_JSON_STRING && memchr(value, '\\', value_len) != NULL;
+    return doc->count++;
+}
+
+/**
+ * 索引溢出后的查找: 从记录开头按路径逐层扫描成员 (不展开的值整体跳过)
+ * @return 存放在 doc->found 中的字段, NULL 表示不存在
+ */
+static const alin_json_field_t* scan_find(alin_json_t* doc, const char* path) {
+    const char* p = skip_space(doc->json);
+    if (*p != '{') return NULL;
+    p++;
+
+    alin_json_field_t f;
+    for (;;) {
+        size_t len = 0;
+        while (path[len] && path[len] != '.') len++;
+
+        // 在当前对象的成员中找 path 的这一段
+        for (;;) {
+            p = skip_space(p);
+            if (*p == ',') p = skip_space(p + 1);
+            if (*p != '"') return NULL;
+            uint8_t escaped = 0;
+            const char* key_end = scan_string(p + 1, &escaped);
+            if (!key_end) return NULL;
+            f.key = p + 1;
+            f.key_len = (uint16_t)(key_end - f.key);
+            int match = (size_t)(key_end - f.key) == len && memcmp(f.key, path, len) == 0;
+
+            p = skip_space(key_end + 1);
+            if (*p != ':') return NULL;
+            p = skip_space(p + 1);
+            if (match && path[len] == '.') {
+                if (*p != '{') return NULL;
+                p++;
+                break;
+            }
+
+            const char* end;
+            f.escaped = 0;
+            f.value = p;
+            if (*p == '"') {
+                f.type = ALIN_JSON_STRING;
+                f.value = p + 1;
+                end = scan_string(p + 1, &f.escaped);
+                if (!end) return NULL;
+                f.value_len = (uint32_t)(end - f.value);
+                end++;
+            } else if (*p == '{' || *p == '[') {
+                f.type = *p == '{' ? ALIN_JSON_OBJECT : ALIN_JSON_ARRAY;
+                end = skip_compound(p);
+                if (!end) return NULL;
+                f.value_len = (uint32_t)(end - p);
+            } else {
+                if (*p == 't') f.type = ALIN_JSON_TRUE;
+                else if (*p == 'f') f.type = ALIN_JSON_FALSE;
+                else if (*p == 'n') f.type = ALIN_JSON_NULL;
+                else if (*p == '-' || (*p >= '0' && *p <= '9')) f.type = ALIN_JSON_NUMBER;
+                else return NULL;
+                end = skip_scalar(p);
+                f.value_len = (uint32_t)(end - p);
+            }
+            if (match) {
+                // 不在索引中，没有可引用的所在对象项
+                f.parent = -1;
+                alin_json_field_t* out = &doc->found[(unsigned)doc->found_next % ALIN_JSON_MAX_FOUND];
+                doc->found_next = (int)(((unsigned)doc->found_next + 1) % ALIN_JSON_MAX_FOUND);
+                *out = f;
+                return out;
+            }
+            p = end;
+        }
+        path += len + 1;
+    }
+}
+
+const alin_json_field_t* alin_json_find(const alin_json_t* doc, const char* path) {
+    const char* full_path = path;
+    int parent = -1;
+    for (;;) {
+        size_t len = 0;
+        while (path[len] && path[len] != '.') len++;
+        const char* dot = path[len] ? path + len : NULL;
+
+        // 成员总是排在所属对象之后
+        const alin_json_field_t* found = NULL;
+        for (int i = parent + 1; i < doc->count; i++) {
+            const alin_json_field_t* f = &doc->fields[i];
+            if (f->key_len == len && f->parent == parent && f->key[0] == path[0] &&
+                memcmp(f->key, path, len) == 0) {
+                found = f;
+                break;
+            }
+        }
+        if (!found && doc->overflow) {
+            // 扫描结果只存放在 found 中，不改变索引本身
+            return scan_find((alin_json_t*)doc, full_path);
+        }
+        if (!found || !dot) return found;
+        if (found->type != ALIN_JSON_OBJECT) return NULL;
+        parent = (int)(found - doc->fields);
+        path = dot + 1;
+    }
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * \uXXXX → UTF-8 (不合并代理对，码点 0 丢弃)
+ * @return 写入的字节数, -1 表示不是合法的转义
+ */
+static int decode_unicode(const char* hex, char* out, size_t room) {
+    unsigned code = 0;
+    for (int i = 0; i < 4; i++) {
+        int v = hex_value(hex[i]);
+        if (v < 0) return -1;
+        code = (code << 4) | (unsigned)v;
+    }
+    if (code == 0) return 0;
+    if (code < 0x80) {
+        if (room < 1) return 0;
+        out[0] = (char)code;
+        return 1;
+    }
+    if (code < 0x800) {
+        if (room < 2) return 0;
+        out[0] = (char)(0xC0 | (code >> 6));
+        out[1] = (char)(0x80 | (code & 0x3F));
+        return 2;
+    }
+    if (room < 3) return 0;
+    out[0] = (char)(0xE0 | (code >> 12));
+    out[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+    out[2] = (char)(0x80 | (code & 0x3F));
+    return 3;
+}
+
+int alin_json_string(const alin_json_t* doc, const char* path, char* value, size_t max_size) {
+    const alin_json_field_t* f = alin_json_find(doc, path);
+    if (!f || f->type != ALIN_JSON_STRING || max_size == 0) return 0;
+
+    if (!f->escaped) {
+        size_t n = f->value_len < max_size - 1 ? f->value_len : max_size - 1;
+        memcpy(value, f->value, n);
+        value[n] = '\0';
+        return 1;
+    }
+
+    size_t i = 0;
+    const char* p = f->value;
+    const char* end = f->value + f->value_len;
+    while (p < end && i < max_size - 1) {
+        if (*p != '\\' || p + 1 >= end) {
+            value[i++] = *p++;
+            continue;
+        }
+        p++;
+        switch (*p) {
+            case 'n': value[i++] = '\n'; break;
+            case 't': value[i++] = '\t'; break;
+            case 'r': value[i++] = '\r'; break;
+            case 'b': value[i++] = '\b'; break;
+            case 'f': value[i++] = '\f'; break;
+            case 'u':
+                if (end - p >= 5) {
+                    int n = decode_unicode(p + 1, value + i, max_size - 1 - i);
+                    if (n >= 0) {
+                        i += (size_t)n;
+                        p += 5;
+                        continue;
+                    }
+                }
+                value[i++] = *p;
+                break;
+            default: value[i++] = *p;    // \" \\ \/
+        }
+        p++;
+    }
+    value[i] = '\0';
+    return 1;
+}
+
+long alin_json_long(const alin_json_t* doc, const char* path) {
+    const alin_json_field_t* f = alin_json_find(doc, path);
+    if (!f || f->type != ALIN_JSON_NUMBER) return 0;
+
+    // 常见的整数 (时间戳、计数) 直接累加，位数多到可能溢出时交给 strtol
+    const char* p = f->value;
+    int negative = *p == '-';
+    if (negative) p++;
+    long value = 0;
+    int digits = 0;
+    while (*p >= '0' && *p <= '9') {
+        if (++digits > 18) return strtol(f->value, NULL, 10);
+        value = value * 10 + (*p++ - '0');
+    }
+    return negative ? -value : value;
+}
+
+double alin_json_double(const alin_json_t* doc, const char* path) {
+    const alin_json_field_t* f = alin_json_find(doc, path);
+    if (!f || f->type != ALIN_JSON_NUMBER) return 0;
+    return strtod(f->value, NULL);
+}
@@ -0,0 +1,123 @@
+/**
+ * ALIN JSON 字段索引 (Single-Pass JSON Tokenizer)
+ *
+ * 节点共用的记录解析器: 一次扫描记录，把对象成员 (键、值的位置与类型) 记入定长索引，
+ * 之后的字段查找只在索引里比较键，不再对整条记录反复 strstr:
+ * - 只有对象成员的键参与匹配，字符串值中出现的 "level" 等内容不会被误认为键
+ * - 嵌套对象的成员同样编入索引，用点分路径查找 (如 "_agg.total");
+ *   数组整体作为一个值跳过，其中的元素不编入索引
+ * - 值不复制: 索引项指向原记录，字符串取值时才按需反转义
+ * - 同名键取第一个; 记录不完整时，已编入的字段照常可查
+ * - 超过 ALIN_JSON_MAX_FIELDS 个成员时索引记下溢出，之后的成员不再编入;
+ *   查找在索引中找不到时退回按路径扫描记录，宽记录靠后的字段同样可查
+ *
+ *   alin_json_t doc;
+ *   alin_json_index(&doc, input);
+ *   alin_json_string(&doc, "level", level, sizeof(level));
+ *   long total = alin_json_long(&doc, "_agg.total");
+ *
+ * 索引可以随记录传给下游: alin_json_pack 把它转成与地址无关的字段表 (alin_fields_t，
+ * 偏移相对记录起点)，帧格式在负载之后携带 (ALIN_FRAME_FIELDS); 下游用 alin_json_unpack
+ * 直接还原索引，不再扫描记录。生成记录的节点可以用 alin_json_add 边写边编入字段
+ */
+
+#ifndef ALIN_JSON_H
+#define ALIN_JSON_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "alin_frame.h"
+
+#define ALIN_JSON_MAX_FIELDS ALIN_FIELDS_MAX
+#define ALIN_JSON_MAX_FOUND 8           // 溢出后扫描找到的字段轮流存放的项数
+#define ALIN_JSON_MAX_DEPTH 8
+
+// 值类型
+enum {
+    ALIN_JSON_STRING = 1,
+    ALIN_JSON_NUMBER,
+    ALIN_JSON_OBJECT,
+    ALIN_JSON_ARRAY,
+    ALIN_JSON_TRUE,
+    ALIN_JSON_FALSE,
+    ALIN_JSON_NULL
+};
+
+typedef struct {
+    const char* key;            // 键 (不含引号，未反转义)
+    const char* value;          // 值: 字符串不含引号; 对象/数组含括号
+    uint32_t value_len;
+    uint16_t key_len;
+    int16_t parent;             // 所在对象的索引项 (-1 表示顶层)
+    uint8_t type;               // ALIN_JSON_*
+    uint8_t escaped;            // 字符串值含转义序列 (取值时需反转义)
+} alin_json_field_t;
+
+typedef struct {
+    const char* json;
+    int count;
+    int overflow;               // 索引已满，其后还有成员未编入
+    int found_next;             // 下一个存放扫描结果的 found 项
+    alin_json_field_t fields[ALIN_JSON_MAX_FIELDS];
+    alin_json_field_t found[ALIN_JSON_MAX_FOUND];
+} alin_json_t;
+
+/**
+ * 扫描一条记录并建立字段索引 (索引项指向 json，使用期间 json 须保持不变)
+ * @return 编入的字段数, -1 表示不是 JSON 对象
+ */
+int alin_json_index(alin_json_t* doc, const char* json);
+
+/**
+ * 在已编入的前缀之后继续编入顶层成员 (p 指向下一个成员或其前的逗号)
+ * 用于在原记录末尾追加字段的节点: 只扫描追加的部分
+ * @return 编入后的字段总数
+ */
+int alin_json_resume(alin_json_t* doc, const char* p);
+
+/**
+ * 索引 → 字段表 (偏移相对 doc->json)
+ * @return 字段数
+ */
+int alin_json_pack(const alin_json_t* doc, alin_fields_t* fields);
+
+/**
+ * 字段表 → 索引 (json 为字段表所描述的记录，len 为其长度)
+ * @return 字段数, -1 表示字段表与记录不符 (doc 为空，应改用 alin_json_index)
+ */
+int alin_json_unpack(alin_json_t* doc, const char* json, size_t len, const alin_fields_t* fields);
+
+/**
+ * 生成记录时编入一个已写出的成员 (key/value 指向 doc->json 所指的缓冲，
+ * 字符串值不含引号; 对象的成员随后以其序号为 parent 编入)
+ * @return 索引项序号, -1 表示索引已满
+ */
+int alin_json_add(alin_json_t* doc, const char* key, size_t key_len,
+                  const char* value, size_t value_len, int type, int parent);
+
+/**
+ * 按点分路径查找字段 ("level"、"_agg.total")
+ * 索引溢出时，不在索引中的字段扫描记录查找，结果存放在 doc->found 中
+ * (在 doc 上再做 ALIN_JSON_MAX_FOUND 次这样的查找之前有效)
+ * @return 索引项, NULL 表示不存在
+ */
+const alin_json_field_t* alin_json_find(const alin_json_t* doc, const char* path);
+
+/**
+ * 取字符串字段 (反转义后写入 value，超长截断)
+ * @return 1 找到, 0 不存在或不是字符串
+ */
+int alin_json_string(const alin_json_t* doc, const char* path, char* value, size_t max_size);
+
+/**
+ * 取整数字段 (不存在或不是数字时为 0)
+ */
+long alin_json_long(const alin_json_t* doc, const char* path);
+
+/**
+ * 取浮点字段 (不存在或不是数字时为 0)
+ */
+double alin_json_double(const alin_json_t* doc, const char* path);
+
+#endif
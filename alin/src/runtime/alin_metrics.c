@@ -0,0 +1,182 @@
+/**
+ * ALIN 节点指标段实现 (见 alin_metrics.h)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "alin_metrics.h"
+
+alin_metrics_t* alin_metrics_open(const char* name) {
+    const char* dir = getenv("ALIN_METRICS_DIR");
+    if (!dir || !dir[0] || !name || !name[0]) return NULL;
+
+    // 名称中的 '/' (alin_host 插件: 槽位/插件) 写作 "__"，保证段是目录下的一个文件
+    char flat[ALIN_METRICS_NAME_MAX];
+    size_t n = 0;
+    for (const char* p = name; *p && n + 2 < sizeof(flat); p++) {
+        if (*p == '/') { flat[n++] = '_'; flat[n++] = '_'; }
+        else flat[n++] = *p;
+    }
+    flat[n] = '\0';
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s.%d%s", dir, flat, (int)getpid(), ALIN_METRICS_SUFFIX);
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "[METRICS] Cannot create %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof(alin_metrics_t)) < 0) {
+        close(fd);
+        unlink(path);
+        return NULL;
+    }
+    alin_metrics_t* m = mmap(NULL, sizeof(alin_metrics_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) {
+        unlink(path);
+        return NULL;
+    }
+
+    // 新建文件全为 0，计数器无需初始化; magic 最后写入，读者据此跳过尚未就绪的段
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    m->pid = getpid();
+    m->started = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    snprintf(m->name, sizeof(m->name), "%s", name);
+    atomic_thread_fence(memory_order_release);
+    m->magic = ALIN_METRICS_MAGIC;
+    return m;
+}
+
+uint64_t alin_metrics_bucket_value(int index) {
+    if (index < ALIN_METRICS_SUB) return (uint64_t)index;
+    int exp = index / ALIN_METRICS_SUB + ALIN_METRICS_SUB_BITS - 1;
+    uint64_t sub = (uint64_t)(index % ALIN_METRICS_SUB);
+    int shift = exp - ALIN_METRICS_SUB_BITS;
+    return ((ALIN_METRICS_SUB + sub + 1) << shift) - 1;
+}
+
+uint64_t alin_metrics_percentile(const alin_metrics_sum_t* s, double q) {
+    uint64_t total = 0;
+    for (int i = 0; i < ALIN_METRICS_BUCKETS; i++) total += s->buckets[i];
+    if (total == 0) return 0;
+
+    uint64_t rank = (uint64_t)(q * (double)total + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > total) rank = total;
+    uint64_t seen = 0;
+    for (int i = 0; i < ALIN_METRICS_BUCKETS; i++) {
+        seen += s->buckets[i];
+        if (seen >= rank) {
+            uint64_t v = alin_metrics_bucket_value(i);
+            return v < s->latency_max ? v : s->latency_max;
+        }
+    }
+    return s->latency_max;
+}
+
+const char* alin_metrics_format(uint64_t ns, char* buf, size_t size) {
+    if (ns < 1000) snprintf(buf, size, "%luns", (unsigned long)ns);
+    else if (ns < 1000000) snprintf(buf, size, "%.1fus", ns / 1e3);
+    else if (ns < 1000000000) snprintf(buf, size, "%.2fms", ns / 1e6);
+    else snprintf(buf, size, "%.2fs", ns / 1e9);
+    return buf;
+}
+
+static int has_suffix(const char* name, const char* suffix) {
+    size_t n = strlen(name), m = strlen(suffix);
+    return n > m && strcmp(name + n - m, suffix) == 0;
+}
+
+static uint64_t load(alin_counter_t* c) {
+    return atomic_load_explicit(c, memory_order_relaxed);
+}
+
+static int compare_sum(const void* a, const void* b) {
+    return strcmp(((const alin_metrics_sum_t*)a)->name, ((const alin_metrics_sum_t*)b)->name);
+}
+
+static void merge_segment(alin_metrics_sum_t* s, alin_metrics_t* m) {
+    s->instances++;
+    if (m->pid > 0 && kill((pid_t)m->pid, 0) == 0) s->live++;
+    if (s->started == 0 || m->started < s->started) s->started = m->started;
+    s->processed += load(&m->processed);
+    s->emitted += load(&m->emitted);
+    s->dropped += load(&m->dropped);
+    s->shed += load(&m->shed);
+    s->errors += load(&m->errors);
+    s->latency_sum += load(&m->latency_sum);
+    uint64_t max = load(&m->latency_max);
+    if (max > s->latency_max) s->latency_max = max;
+    for (int i = 0; i < ALIN_METRICS_BUCKETS; i++) s->buckets[i] += load(&m->buckets[i]);
+}
+
+int alin_metrics_collect(const char* dir, alin_metrics_sum_t* out, int max) {
+    DIR* d = opendir(dir);
+    if (!d) return -1;
+
+    int count = 0;
+    struct dirent* ent;
+    while ((ent = readdir(d)) != NULL) {
+        if (!has_suffix(ent->d_name, ALIN_METRICS_SUFFIX)) continue;
+
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        struct stat st;
+        if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(alin_metrics_t)) {
+            close(fd);
+            continue;
+        }
+        alin_metrics_t* m = mmap(NULL, sizeof(alin_metrics_t), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (m == MAP_FAILED) continue;
+
+        if (m->magic == ALIN_METRICS_MAGIC) {
+            atomic_thread_fence(memory_order_acquire);
+            char name[ALIN_METRICS_NAME_MAX];
+            snprintf(name, sizeof(name), "%.*s", (int)sizeof(name) - 1, m->name);
+
+            alin_metrics_sum_t* s = NULL;
+            for (int i = 0; i < count; i++) {
+                if (strcmp(out[i].name, name) == 0) { s = &out[i]; break; }
+            }
+            if (!s && count < max) {
+                s = &out[count++];
+                memset(s, 0, sizeof(*s));
+                snprintf(s->name, sizeof(s->name), "%s", name);
+            }
+            if (s) merge_segment(s, m);
+        }
+        munmap(m, sizeof(alin_metrics_t));
+    }
+    closedir(d);
+
+    qsort(out, count, sizeof(out[0]), compare_sum);
+    return count;
+}
+
+void alin_metrics_clear(const char* dir) {
+    DIR* d = opendir(dir);
+    if (!d) return;
+    struct dirent* ent;
+    while ((ent = readdir(d)) != NULL) {
+        if (!has_suffix(ent->d_name, ALIN_METRICS_SUFFIX)) continue;
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        unlink(path);
+    }
+    closedir(d);
+}
@@ -0,0 +1,130 @@
+/**
+ * ALIN 节点指标段 (Per-Node Metrics Segment)
+ *
+ * 每个节点进程 (及 alin_host 中的每个插件) 在 ALIN_METRICS_DIR 下映射一个定长文件
+ * <名称>.<pid>.metrics，持续写入计数器与 process() 的延迟直方图:
+ * - 计数: processed (输入记录) / emitted (有输出) / dropped (无输出，如被过滤) /
+ *         shed (输出队列满时按策略丢弃) / errors (process() 返回负值)
+ * - 延迟: HDR 风格的对数-线性直方图，每个 2 的幂区间再等分 ALIN_METRICS_SUB 份
+ *         (相对误差约 6%)，覆盖 1ns ~ 2^40ns; 另记总和与最大值
+ *
+ * 单写者: 只有所属进程写入，计数器用 relaxed 原子读写 (不加锁、不用原子加法)，
+ * 外部读者 (alin_metrics、运行器) 随时映射读取，看到的每个字段都是完整的值
+ * 段不随进程退出删除 (运行器启动时清理)，读者按名称汇总同一槽位的副本与替换前后的实例
+ * 未设置 ALIN_METRICS_DIR (或为空) 时不创建，热路径上只多一次指针判断
+ */
+
+#ifndef ALIN_METRICS_H
+#define ALIN_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define ALIN_METRICS_MAGIC 0x314d4e494c41ull    // "ALINM1"
+#define ALIN_METRICS_NAME_MAX 128
+#define ALIN_METRICS_SUFFIX ".metrics"
+#define ALIN_METRICS_SUB_BITS 4
+#define ALIN_METRICS_SUB (1 << ALIN_METRICS_SUB_BITS)
+#define ALIN_METRICS_MAX_BITS 40                // 超过 2^40ns (约 18 分钟) 的延迟计入最后一档
+#define ALIN_METRICS_BUCKETS ((ALIN_METRICS_MAX_BITS - ALIN_METRICS_SUB_BITS + 1) * ALIN_METRICS_SUB)
+
+typedef _Atomic uint64_t alin_counter_t;
+
+// 共享段布局 (读写两端按此解析，修改时须更换 ALIN_METRICS_MAGIC)
+typedef struct {
+    uint64_t magic;
+    int64_t pid;
+    int64_t started;                 // 创建时间 (CLOCK_REALTIME 纳秒)
+    char name[ALIN_METRICS_NAME_MAX];
+    alin_counter_t processed;
+    alin_counter_t emitted;
+    alin_counter_t dropped;
+    alin_counter_t shed;
+    alin_counter_t errors;
+    alin_counter_t latency_sum;      // 纳秒
+    alin_counter_t latency_max;
+    alin_counter_t buckets[ALIN_METRICS_BUCKETS];
+} alin_metrics_t;
+
+// process() 一次调用的结果
+enum {
+    ALIN_OUTCOME_EMITTED = 0,
+    ALIN_OUTCOME_DROPPED,
+    ALIN_OUTCOME_ERROR
+};
+
+// 读者按名称汇总后的结果
+typedef struct {
+    char name[ALIN_METRICS_NAME_MAX];
+    int instances;                   // 段的个数 (副本、替换前后的版本)
+    int live;                        // 其中进程仍在运行的个数
+    int64_t started;                 // 最早的创建时间
+    uint64_t processed, emitted, dropped, shed, errors;
+    uint64_t latency_sum, latency_max;
+    uint64_t buckets[ALIN_METRICS_BUCKETS];
+} alin_metrics_sum_t;
+
+/**
+ * 创建并映射本进程的指标段: <ALIN_METRICS_DIR>/<name>.<pid>.metrics (name 中的 '/' 写作 "__")
+ * @return 指标段, NULL 表示未启用或创建失败
+ */
+alin_metrics_t* alin_metrics_open(const char* name);
+
+/**
+ * 延迟 (纳秒) → 直方图下标
+ */
+static inline int alin_metrics_bucket(uint64_t ns) {
+    if (ns < ALIN_METRICS_SUB) return (int)ns;
+    int exp = 63 - __builtin_clzll(ns);
+    if (exp >= ALIN_METRICS_MAX_BITS) return ALIN_METRICS_BUCKETS - 1;
+    int sub = (int)(ns >> (exp - ALIN_METRICS_SUB_BITS)) & (ALIN_METRICS_SUB - 1);
+    return (exp - ALIN_METRICS_SUB_BITS + 1) * ALIN_METRICS_SUB + sub;
+}
+
+static inline void alin_metrics_add(alin_counter_t* c, uint64_t n) {
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+/**
+ * 记录一次 process() 调用 (单写者，热路径上没有锁与原子加法)
+ */
+static inline void alin_metrics_record(alin_metrics_t* m, uint64_t ns, int outcome) {
+    alin_metrics_add(&m->processed, 1);
+    if (outcome == ALIN_OUTCOME_EMITTED) alin_metrics_add(&m->emitted, 1);
+    else if (outcome == ALIN_OUTCOME_DROPPED) alin_metrics_add(&m->dropped, 1);
+    else alin_metrics_add(&m->errors, 1);
+    alin_metrics_add(&m->latency_sum, ns);
+    if (ns > atomic_load_explicit(&m->latency_max, memory_order_relaxed)) {
+        atomic_store_explicit(&m->latency_max, ns, memory_order_relaxed);
+    }
+    alin_metrics_add(&m->buckets[alin_metrics_bucket(ns)], 1);
+}
+
+/**
+ * 直方图下标 → 该档的最大延迟 (纳秒)
+ */
+uint64_t alin_metrics_bucket_value(int index);
+
+/**
+ * 分位数 (q 取 0~1)，返回所在档的最大延迟，无样本时为 0
+ */
+uint64_t alin_metrics_percentile(const alin_metrics_sum_t* s, double q);
+
+/**
+ * 延迟的可读形式 (如 850ns、12.5us、3.20ms)
+ */
+const char* alin_metrics_format(uint64_t ns, char* buf, size_t size);
+
+/**
+ * 读取目录下的全部指标段，按名称汇总 (结果按名称排序)
+ * @return 汇总项数, -1 表示目录不可读
+ */
+int alin_metrics_collect(const char* dir, alin_metrics_sum_t* out, int max);
+
+/**
+ * 删除目录下的全部指标段 (运行器启动时清理上一次运行留下的段)
+ */
+void alin_metrics_clear(const char* dir);
+
+#endif
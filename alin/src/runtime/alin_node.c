@@ -0,0 +1,815 @@
+/**
+ * ALIN 节点运行时实现 (见 alin_node.h)
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "alin_node.h"
+#include "alin_ctl.h"
+#include "alin_ring.h"
+#include "alin_metrics.h"
+
+// 记录 arena: 输出缓冲区与 process() 的临时缓冲区 (首块容纳常见记录的全部用量)
+#define ARENA_INITIAL (ALIN_MAX_OUTPUT * 2)
+static alin_arena_t record_arena;
+static int arena_ready = 0;
+
+// 流模式计数，供控制通道汇报 (切换下游时据此核对零丢失)
+static long records_in = 0;      // 已消费的输入记录
+static long records_out = 0;     // 写入当前下游的输出记录
+static long records_mark = -1;   // 收到 MARK 时的 records_in (-1 表示未收到)
+
+// 当前记录的元数据与输出格式
+static alin_meta_t input_meta;
+static alin_meta_t output_meta;
+static int output_framed = 0;
+static size_t input_len = 0;
+static alin_fields_t output_fields;
+static int fields_enabled = -1;      // ALIN_FIELDS (首次使用时读取)
+
+// 共享内存环形缓冲 (由运行器经控制通道协商)
+static alin_ring_t ring_in;          // 当前输入环
+static alin_ring_t ring_in_next;     // 已接入、等待上游在管道中宣告切换的输入环
+static alin_ring_t ring_out;         // 当前输出环
+static alin_reader_t stream_reader;
+
+// 输出队列 (通往下游的边): 满时的策略与统计，经 ALIN_CTL_STATS 汇报给运行器
+#define STATS_INTERVAL_NS 1000000000ull
+static int queue_shed = 0;           // ALIN_QUEUE_SHED: 放不下的记录直接丢弃
+static long pipe_cap = 0;            // 输出管道容量 (0 表示 stdout 不是管道，不做核算)
+static long pipe_free = 0;           // 估算的管道剩余空间 (写入时扣减，不够时再查询)
+static uint64_t stall_ns = 0;        // 等待下游腾出空间的累计时间 (不含当前输出环)
+static uint64_t queue_peak = 0;      // 占用峰值 (字节，不含当前输出环)
+static long shed_count = 0;
+static int stats_fd = -1;            // 统计经此控制通道汇报
+static void (*idle_hook)(int) = NULL;    // 即将阻塞及输入结束时调用 (alin_set_idle_hook)
+
+// 追加的记录 (alin_emit_extra): [长度][内容]['\0'] 依次存放，写出或取完后清空
+static char* extra_buf = NULL;
+static size_t extra_used = 0;
+static size_t extra_cap = 0;
+static size_t extra_read = 0;
+static uint64_t stats_sent_ns = 0;
+
+// 指标段 (ALIN_METRICS_DIR 未设置时为 NULL)
+static alin_metrics_t* metrics = NULL;
+
+static void handle_ctl(int ctl_fd);
+
+int alin_stream_enabled(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stream") == 0) return 1;
+    }
+    const char* env = getenv("ALIN_STREAM");
+    return env && env[0] != '\0' && strcmp(env, "0") != 0;
+}
+
+void alin_trim(char* str) {
+    char* start = str;
+    while (*start == ' ' || *start == '\n' || *start == '\r' || *start == '\t') start++;
+    if (*start == '\0') { str[0] = '\0'; return; }
+    char* end = start + strlen(start) - 1;
+    while (end > start && (*end == ' ' || *end == '\n' || *end == '\r' || *end == '\t')) end--;
+    size_t len = end - start + 1;
+    memmove(str, start, len);
+    str[len] = '\0';
+}
+
+char* alin_trim_span(char* str, size_t* len) {
+    char* end = str + *len;
+    while (str < end && (*str == ' ' || *str == '\n' || *str == '\r' || *str == '\t')) str++;
+    while (end > str && (end[-1] == ' ' || end[-1] == '\n' || end[-1] == '\r' || end[-1] == '\t')) end--;
+    *end = '\0';
+    *len = (size_t)(end - str);
+    return str;
+}
+
+/**
+ * 同时等待输入与控制通道; 控制消息优先处理，此时所有已完成记录的输出都已刷新
+ * @return 0 输入可读, 1 处理了控制消息 (需重新检查)
+ */
+static int wait_input(alin_reader_t* r) {
+    struct pollfd pfd[2] = {
+        { r->fd, POLLIN, 0 },
+        { r->ctl_fd, POLLIN, 0 }
+    };
+
+    while (poll(pfd, 2, -1) < 0) {
+        if (errno != EINTR) return 0;
+    }
+    if (pfd[1].revents & POLLIN) {
+        if (r->on_ctl) r->on_ctl(r->ctl_fd);
+        return 1;
+    }
+    if (pfd[1].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+        r->ctl_fd = -1;
+    }
+    return 0;
+}
+
+static void flush_output();
+
+/**
+ * 块输入即将阻塞读取: 先把已产生的输出交给下游，有控制通道时同时等待
+ */
+static int before_read(void* ctx) {
+    alin_reader_t* r = ctx;
+    flush_output();
+    return r->ctl_fd >= 0 ? wait_input(r) : 0;
+}
+
+void alin_reader_init(alin_reader_t* r, int fd) {
+    r->fd = fd;
+    r->ctl_fd = -1;
+    r->on_ctl = NULL;
+    // 帧连同字段表须连续存放: 上游的输出至多 ALIN_RECORD_LIMIT 字节 (缓冲区按需增长)
+    alin_input_open(&r->in, fd, sizeof(alin_frame_t) + ALIN_RECORD_LIMIT + ALIN_FIELDS_SIZE(ALIN_FIELDS_MAX));
+    r->in.before_read = before_read;
+    r->in.ctx = r;
+    r->eof = 0;
+    r->framed = 0;
+    memset(&r->frame, 0, sizeof(r->frame));
+    r->len = 0;
+    r->fields = NULL;
+}
+
+void alin_reader_close(alin_reader_t* r) {
+    alin_input_close(&r->in);
+}
+
+static uint64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * 输出管道中尚未被下游读走的字节数，同时更新峰值与剩余空间的估算
+ */
+static long pipe_queued() {
+    int queued = 0;
+#ifdef FIONREAD
+    if (ioctl(STDOUT_FILENO, FIONREAD, &queued) != 0) queued = 0;
+#endif
+    if ((uint64_t)queued > queue_peak) queue_peak = (uint64_t)queued;
+    pipe_free = pipe_cap - queued;
+    return queued;
+}
+
+void alin_queue_open(int ctl_fd) {
+    stats_fd = ctl_fd;
+    pipe_cap = 0;
+#ifdef F_GETPIPE_SZ
+    int size = fcntl(STDOUT_FILENO, F_GETPIPE_SZ);
+    if (size > 0) pipe_cap = size;
+#endif
+    pipe_free = 0;
+}
+
+void alin_queue_policy(int policy) {
+    queue_shed = policy == ALIN_QUEUE_SHED;
+}
+
+void alin_queue_report(int force) {
+    if (stats_fd < 0) return;
+
+    uint64_t now = monotonic_ns();
+    if (!force && now - stats_sent_ns < STATS_INTERVAL_NS) return;
+    stats_sent_ns = now;
+
+    uint64_t stall = stall_ns + ring_out.stall_ns;
+    uint64_t peak = ring_out.peak > queue_peak ? ring_out.peak : queue_peak;
+    alin_ctl_msg_t stats = { ALIN_CTL_STATS, 0, (int64_t)(stall / 1000), shed_count, (int64_t)peak };
+    alin_ctl_send(stats_fd, &stats, NULL, 0);
+}
+
+/**
+ * 本节点即将阻塞: 把已产生的输出交给下游
+ */
+static void drain_extras();
+
+static void flush_output() {
+    if (idle_hook) {
+        idle_hook(0);
+        drain_extras();
+    }
+    fflush(stdout);
+    if (ring_out.ctl) alin_ring_flush(&ring_out);
+    else if (pipe_cap > 0) pipe_queued();
+    alin_queue_report(0);
+}
+
+void alin_set_idle_hook(void (*hook)(int final)) {
+    idle_hook = hook;
+}
+
+void alin_node_idle(int final) {
+    if (idle_hook) idle_hook(final);
+}
+
+int alin_emit_extra(const char* record, size_t len) {
+    size_t need = sizeof(size_t) + len + 1;
+    if (extra_used + need > extra_cap) {
+        size_t cap = extra_cap ? extra_cap : 65536;
+        while (extra_used + need > cap) cap *= 2;
+        char* buf = realloc(extra_buf, cap);
+        if (!buf) return -1;
+        extra_buf = buf;
+        extra_cap = cap;
+    }
+    memcpy(extra_buf + extra_used, &len, sizeof(len));
+    memcpy(extra_buf + extra_used + sizeof(len), record, len);
+    extra_buf[extra_used + sizeof(len) + len] = '\0';
+    extra_used += need;
+    return 0;
+}
+
+const char* alin_next_extra(size_t* len) {
+    if (extra_read >= extra_used) {
+        extra_read = extra_used = 0;
+        return NULL;
+    }
+    memcpy(len, extra_buf + extra_read, sizeof(*len));
+    const char* record = extra_buf + extra_read + sizeof(*len);
+    extra_read += sizeof(*len) + *len + 1;
+    return record;
+}
+
+int alin_queue_admit(size_t need) {
+    if (pipe_cap == 0) return 1;
+    if ((long)need > pipe_free) {
+        // 缓冲中的输出都已计入核算，刷新不会阻塞
+        fflush(stdout);
+        if (pipe_queued() > 0 && (long)need > pipe_free) {
+            if (queue_shed) {
+                shed_count++;
+                if (metrics) alin_metrics_add(&metrics->shed, 1);
+                return 0;
+            }
+            return 2;
+        }
+    }
+    pipe_free -= (long)need;
+    return 1;
+}
+
+void alin_queue_drain(void) {
+    uint64_t start = monotonic_ns();
+    fflush(stdout);
+    stall_ns += monotonic_ns() - start;
+    queue_peak = (uint64_t)pipe_cap;
+    pipe_queued();
+}
+
+/**
+ * 输入已结束: 处理可能与 EOF 同时到达的控制消息 (只一次)
+ */
+static void reached_eof(alin_reader_t* r) {
+    if (r->eof) return;
+    r->eof = 1;
+    if (r->ctl_fd >= 0 && r->on_ctl) r->on_ctl(r->ctl_fd);
+}
+
+/**
+ * 读取一帧: 帧头、负载与字段表在缓冲区中连续存放，负载原地交出
+ * @return 1 读到记录, 0 EOF, 2 切回文本行
+ */
+static int read_frame(alin_reader_t* r, char** record) {
+    const size_t hdr_size = sizeof(alin_frame_t);
+    char* p = alin_input_need(&r->in, hdr_size);
+    if (!p) return 0;
+    alin_frame_t hdr;
+    memcpy(&hdr, p, hdr_size);
+    if (hdr.flags & ALIN_FRAME_LINES) {
+        alin_input_skip(&r->in, hdr_size);
+        r->framed = 0;
+        return 2;
+    }
+
+    size_t total = hdr_size + hdr.length;
+    uint32_t count = 0;
+    int oversized = total + sizeof(count) > r->in.max_span;
+    if (oversized) alin_input_skip(&r->in, total);
+    if (hdr.flags & ALIN_FRAME_FIELDS) {
+        p = alin_input_need(&r->in, oversized ? sizeof(count) : total + sizeof(count));
+        if (!p) return 0;
+        memcpy(&count, oversized ? p : p + total, sizeof(count));
+        size_t size = sizeof(count) + (size_t)count * sizeof(alin_field_t);
+        if (oversized) alin_input_skip(&r->in, size);
+        total += size;
+    }
+
+    r->fields = NULL;
+    if (oversized || total > r->in.max_span) {
+        // 上游不会写出这么长的帧: 整帧丢弃，交出空记录
+        static char empty_record[1];
+        if (!oversized) alin_input_skip(&r->in, total);
+        empty_record[0] = '\0';
+        r->frame = hdr;
+        r->len = 0;
+        *record = empty_record;
+        return 1;
+    }
+
+    p = alin_input_take(&r->in, total);
+    if (!p) return 0;
+    char* payload = p + hdr_size;
+    size_t len = hdr.length < ALIN_RECORD_LIMIT - 1 ? hdr.length : ALIN_RECORD_LIMIT - 1;
+
+    // 负载之后的字段表 (负载被截断或表项过多时丢弃)
+    if ((hdr.flags & ALIN_FRAME_FIELDS) && count <= ALIN_FIELDS_MAX && len == hdr.length) {
+        memcpy(r->fields_buf.fields, payload + hdr.length + sizeof(count), (size_t)count * sizeof(alin_field_t));
+        r->fields_buf.count = count;
+        r->fields = &r->fields_buf;
+    }
+    // 负载之后的字节已经消费 (字段表或截断部分)，或已被 take 临时占用
+    payload[len] = '\0';
+    r->frame = hdr;
+    r->len = len;
+    *record = payload;
+    return 1;
+}
+
+/**
+ * 读取一行文本
+ * @return 1 读到记录, 0 EOF
+ */
+static int read_text(alin_reader_t* r, char** record) {
+    size_t len;
+    char* line = alin_input_line(&r->in, ALIN_RECORD_LIMIT - 1, &len);
+    if (!line) return 0;
+    memset(&r->frame, 0, sizeof(r->frame));
+    r->frame.length = (uint32_t)len;
+    r->len = len;
+    r->fields = NULL;
+    *record = line;
+    return 1;
+}
+
+char* alin_read_record(alin_reader_t* r, size_t* len) {
+    for (;;) {
+        char* record = NULL;
+        int rc = r->framed ? read_frame(r, &record) : read_text(r, &record);
+        if (rc == 2) continue;
+        if (rc == 0) {
+            reached_eof(r);
+            return NULL;
+        }
+        // 上游宣告升级为帧格式
+        if (!r->framed && record[0] == ALIN_FRAME_MAGIC[0] && strcmp(record, ALIN_FRAME_MAGIC) == 0) {
+            r->framed = 1;
+            continue;
+        }
+        *len = r->len;
+        return record;
+    }
+}
+
+size_t alin_output_size(size_t input_len) {
+    size_t size = input_len * 4 + 4096;
+    if (size < ALIN_MAX_OUTPUT) return ALIN_MAX_OUTPUT;
+    return size < ALIN_RECORD_LIMIT ? size : ALIN_RECORD_LIMIT;
+}
+
+alin_arena_t* alin_record_arena(void) {
+    if (!arena_ready) {
+        alin_arena_init(&record_arena, ARENA_INITIAL);
+        arena_ready = 1;
+    }
+    return &record_arena;
+}
+
+const alin_meta_t* alin_input_meta(void) {
+    return &input_meta;
+}
+
+void alin_set_output_meta(int type, int level, int64_t timestamp) {
+    output_meta.type = (uint8_t)type;
+    output_meta.level = (uint8_t)level;
+    output_meta.timestamp = timestamp;
+}
+
+int alin_input_index(alin_json_t* doc, const char* input) {
+    if (input_meta.fields && alin_json_unpack(doc, input, input_len, input_meta.fields) >= 0) {
+        return doc->count;
+    }
+    return alin_json_index(doc, input);
+}
+
+void alin_set_output_fields(const alin_json_t* doc) {
+    // 文本行带不了字段表，不必转换
+    if (!output_framed && !ring_out.ctl) return;
+    if (fields_enabled < 0) {
+        const char* env = getenv("ALIN_FIELDS");
+        fields_enabled = !(env && strcmp(env, "0") == 0);
+    }
+    if (!fields_enabled || doc->count <= 0) return;
+    alin_json_pack(doc, &output_fields);
+    output_meta.fields = &output_fields;
+}
+
+/**
+ * 写出一条记录 (环形缓冲、帧或文本行)
+ */
+static void end_output();
+
+static void emit(const char* data, size_t len) {
+    // 环中容不下的超长记录: 结束环形缓冲，此后改以帧格式写入管道 (下游读完环后退回管道)
+    if (ring_out.ctl && !alin_ring_fits(&ring_out, len + 3 + ALIN_FIELDS_SIZE(ALIN_FIELDS_MAX))) {
+        end_output();
+        fputs(ALIN_FRAME_MAGIC "\n", stdout);
+        output_framed = 1;
+    }
+
+    // 丢弃策略: 环中放不下 (发布已写入的记录后仍放不下) 即丢弃
+    if (ring_out.ctl && queue_shed) {
+        size_t need = output_meta.fields ? len + 3 + ALIN_FIELDS_SIZE(output_meta.fields->count) : len;
+        char* slot = alin_ring_reserve(&ring_out, need);
+        if (!slot) {
+            alin_ring_flush(&ring_out);
+            slot = alin_ring_reserve(&ring_out, need);
+        }
+        if (!slot) {
+            shed_count++;
+            if (metrics) alin_metrics_add(&metrics->shed, 1);
+            return;
+        }
+        memcpy(slot, data, len);
+        alin_ring_commit(&ring_out, len, &output_meta, 0);
+        records_out++;
+        return;
+    }
+
+    // 等待环形缓冲空间时同样处理控制消息 (此时处于记录边界，切换后本条写入新下游)
+    while (ring_out.ctl) {
+        int rc = alin_ring_write(&ring_out, data, len, &output_meta, 0, STDOUT_FILENO, stream_reader.ctl_fd);
+        if (rc == 0) {
+            records_out++;
+            return;
+        }
+        if (rc < 0) {
+            // 下游已退出: 与管道的 EPIPE 行为保持一致
+            raise(SIGPIPE);
+            return;
+        }
+        handle_ctl(stream_reader.ctl_fd);
+    }
+
+    const alin_fields_t* fields = output_framed && output_meta.fields && output_meta.fields->count
+                                ? output_meta.fields : NULL;
+    size_t fields_size = fields ? ALIN_FIELDS_SIZE(fields->count) : 0;
+    int admit = alin_queue_admit(output_framed ? sizeof(alin_frame_t) + len + fields_size : len + 1);
+    if (admit == 0) return;
+    if (output_framed) {
+        alin_frame_t hdr = { (uint32_t)len, output_meta.type, output_meta.level,
+                             fields ? ALIN_FRAME_FIELDS : 0, output_meta.timestamp };
+        fwrite(&hdr, sizeof(hdr), 1, stdout);
+        fwrite(data, 1, len, stdout);
+        if (fields) fwrite(fields, 1, fields_size, stdout);
+    } else {
+        fwrite(data, 1, len, stdout);
+        fputc('\n', stdout);
+    }
+    if (admit == 2) alin_queue_drain();
+    records_out++;
+}
+
+/**
+ * 写出追加的记录 (alin_emit_extra，元数据为 NONE、不带字段表)
+ */
+static void drain_extras() {
+    const char* extra;
+    size_t len;
+    while ((extra = alin_next_extra(&len)) != NULL) {
+        memset(&output_meta, 0, sizeof(output_meta));
+        emit(extra, len);
+    }
+}
+
+/**
+ * 当前下游即将不再由本节点写入: 帧格式或环形缓冲时先让它切回文本行，
+ * 以便接替的生产者 (默认文本) 继续写入同一管道
+ */
+static void end_output() {
+    if (ring_out.ctl) {
+        alin_ring_write(&ring_out, NULL, 0, NULL, ALIN_FRAME_LINES, STDOUT_FILENO, -1);
+        alin_ring_flush(&ring_out);
+        // 统计并入节点累计值后再释放
+        stall_ns += ring_out.stall_ns;
+        if (ring_out.peak > queue_peak) queue_peak = ring_out.peak;
+        alin_ring_detach(&ring_out);
+    }
+    if (output_framed) {
+        alin_frame_t hdr = { 0, 0, 0, ALIN_FRAME_LINES, 0 };
+        fwrite(&hdr, sizeof(hdr), 1, stdout);
+        output_framed = 0;
+    }
+}
+
+static void close_fds(const int* fds) {
+    for (int i = 0; i < ALIN_CTL_MAX_FDS; i++) {
+        if (fds[i] >= 0) close(fds[i]);
+    }
+}
+
+/**
+ * 控制消息处理 (在记录边界被调用)
+ */
+static void handle_ctl(int ctl_fd) {
+    alin_ctl_msg_t msg;
+    int fds[ALIN_CTL_MAX_FDS];
+    int rc;
+
+    while ((rc = alin_ctl_recv(ctl_fd, &msg, fds, 1)) > 0) {
+        if (msg.type == ALIN_CTL_REDIRECT && fds[0] >= 0) {
+            // 已完成记录全部写入旧下游后再切换; dup2 同时关闭旧写端，旧下游随即看到 EOF
+            end_output();
+            fflush(stdout);
+            dup2(fds[0], STDOUT_FILENO);
+            close(fds[0]);
+            alin_queue_open(ctl_fd);
+            alin_ctl_msg_t ack = { ALIN_CTL_ACK, 0, records_out, 0, 0 };
+            alin_ctl_send(ctl_fd, &ack, NULL, 0);
+            records_out = 0;
+        } else if (msg.type == ALIN_CTL_FRAMED) {
+            if (!output_framed && !ring_out.ctl) {
+                fputs(ALIN_FRAME_MAGIC "\n", stdout);
+                output_framed = 1;
+            }
+        } else if (msg.type == ALIN_CTL_RING && fds[ALIN_RING_FDS - 1] >= 0) {
+            if (msg.a == ALIN_RING_CONSUMER) {
+                alin_ring_detach(&ring_in_next);
+                alin_ring_attach(&ring_in_next, fds);
+            } else {
+                alin_ring_t ring;
+                if (alin_ring_attach(&ring, fds) == 0) {
+                    ring.limit = (uint64_t)msg.c;
+                    // 管道中的宣告行之后，输出全部走环形缓冲
+                    end_output();
+                    fputs(ALIN_RING_MAGIC "\n", stdout);
+                    fflush(stdout);
+                    ring_out = ring;
+                }
+            }
+        } else if (msg.type == ALIN_CTL_QUEUE) {
+            alin_queue_policy((int)msg.a);
+            close_fds(fds);
+        } else if (msg.type == ALIN_CTL_MARK) {
+            records_mark = records_in;
+            close_fds(fds);
+        } else {
+            close_fds(fds);
+        }
+    }
+    // 运行器已退出: 不再等待控制消息
+    if (rc == 0 && ctl_fd == stream_reader.ctl_fd) stream_reader.ctl_fd = -1;
+}
+
+/**
+ * 由运行器启动时接入控制通道
+ */
+static int open_ctl(int flags) {
+    const char* env = getenv("ALIN_CTL_FD");
+    if (!env || env[0] == '\0') return -1;
+
+    int fd = atoi(env);
+    if (fd < 0 || fcntl(fd, F_GETFD) < 0) return -1;
+    int caps = ALIN_CTL_CAP_FRAMED | (alin_ring_supported() ? ALIN_CTL_CAP_RING : 0);
+    if (flags & ALIN_NODE_STATELESS) caps |= ALIN_CTL_CAP_STATELESS;
+    alin_ctl_msg_t hello = { ALIN_CTL_HELLO, 0, (int64_t)getpid(), caps, 0 };
+    if (alin_ctl_send(fd, &hello, NULL, 0) != 0) return -1;
+    return fd;
+}
+
+/**
+ * 输入环暂时为空: 刷新输出后等待数据、控制消息或管道上的动静
+ * @return 1 管道可读或已关闭 (上游可能已不再使用该环), 0 其他
+ */
+static int wait_ring() {
+    flush_output();
+    if (!alin_ring_prepare_wait(&ring_in)) return 0;
+
+    struct pollfd pfd[3] = {
+        { ring_in.data_fd, POLLIN, 0 },
+        { stream_reader.fd, POLLIN, 0 },
+        { stream_reader.ctl_fd, POLLIN, 0 }
+    };
+    int n = poll(pfd, 3, -1);
+    alin_ring_finish_wait(&ring_in);
+    if (n <= 0) return 0;
+
+    if (pfd[2].revents & POLLIN) handle_ctl(stream_reader.ctl_fd);
+    return (pfd[1].revents & (POLLIN | POLLHUP | POLLERR)) ? 1 : 0;
+}
+
+/**
+ * 取下一条输入记录: 输入环与管道中的记录都原地返回
+ * @return 记录 (以 '\0' 结尾), NULL 表示 EOF
+ */
+static const char* next_record(size_t* len) {
+    alin_reader_t* r = &stream_reader;
+    int pipe_ready = 0;
+
+    for (;;) {
+        if (ring_in.ctl) {
+            const alin_frame_t* frame;
+            const char* payload;
+            if (alin_ring_read(&ring_in, &frame, &payload)) {
+                if (frame->flags & ALIN_FRAME_LINES) {
+                    alin_ring_detach(&ring_in);
+                    continue;
+                }
+                r->frame = *frame;
+                r->fields = alin_ring_fields(frame);
+                *len = frame->length;
+                return payload;
+            }
+            // 环已空而管道有动静: 上游未经结束标记就退出了，退回管道
+            if (pipe_ready) {
+                alin_ring_detach(&ring_in);
+                continue;
+            }
+            pipe_ready = wait_ring();
+            continue;
+        }
+
+        size_t n;
+        char* record = alin_read_record(r, &n);
+        if (!record) return NULL;
+        if (!r->framed) {
+            // 上游宣告此后改走环形缓冲
+            if (record[0] == ALIN_RING_MAGIC[0] && strcmp(record, ALIN_RING_MAGIC) == 0) {
+                if (!ring_in_next.ctl && r->ctl_fd >= 0) handle_ctl(r->ctl_fd);
+                ring_in = ring_in_next;
+                memset(&ring_in_next, 0, sizeof(ring_in_next));
+                pipe_ready = 0;
+                continue;
+            }
+            // 批次边界: 刷新本批输出后原样回显 (只出现在与 alin_fanout 之间的文本通道上)
+            if (record[0] == ALIN_BATCH_MAGIC[0] && strcmp(record, ALIN_BATCH_MAGIC) == 0) {
+                fputs(ALIN_BATCH_MAGIC "\n", stdout);
+                fflush(stdout);
+                continue;
+            }
+            // 帧负载由上游写出，已无首尾空白; 文本行需要去除
+            record = alin_trim_span(record, &n);
+        }
+        *len = n;
+        return record;
+    }
+}
+
+/**
+ * 指标段名称: 运行器经 ALIN_METRICS_NAME 下发槽位名，单独运行时取程序名
+ */
+static const char* metrics_name(const char* argv0) {
+    const char* name = getenv("ALIN_METRICS_NAME");
+    if (name && name[0]) return name;
+    const char* base = argv0 ? strrchr(argv0, '/') : NULL;
+    return base ? base + 1 : argv0;
+}
+
+static int run_stream(alin_process_fn process, int flags, const char* name) {
+    static char stdout_buf[ALIN_READ_BLOCK];
+    alin_reader_t* r = &stream_reader;
+    metrics = alin_metrics_open(name);
+
+    alin_reader_init(r, STDIN_FILENO);
+    r->ctl_fd = open_ctl(flags);
+    r->on_ctl = handle_ctl;
+    int ctl_fd = r->ctl_fd;
+    setvbuf(stdout, stdout_buf, _IOFBF, sizeof(stdout_buf));
+    alin_queue_open(ctl_fd);
+
+    alin_arena_t* arena = alin_record_arena();
+    const char* record;
+    size_t len;
+    while ((record = next_record(&len)) != NULL) {
+        if (record[0] == '\0') continue;
+        records_in++;
+        // 上一条记录的临时缓冲区全部失效 (块保留，稳态下不再分配)
+        alin_arena_reset(arena);
+
+        input_meta.type = r->frame.type;
+        input_meta.level = r->frame.level;
+        input_meta.timestamp = r->frame.timestamp;
+        input_meta.fields = r->fields;
+        input_len = len;
+        // 字段表只描述原记录，输出须由节点另行声明 (ALIN_PASS 时原样转发)
+        output_meta = input_meta;
+        output_meta.fields = NULL;
+
+        // 输出走环形缓冲时让节点直接写入环中预留的空间，否则从 arena 分配
+        size_t out_size = alin_output_size(len);
+        char* slot = ring_out.ctl && alin_ring_fits(&ring_out, out_size - 1)
+                   ? alin_ring_reserve(&ring_out, out_size - 1) : NULL;
+        char* out = slot ? slot : alin_arena_alloc(arena, out_size);
+        if (!out) {
+            fprintf(stderr, "Error: Out of memory (record %ld)\n", records_in);
+            continue;
+        }
+
+        out[0] = '\0';
+        uint64_t started = metrics ? monotonic_ns() : 0;
+        int rc = process(record, out, out_size);
+        if (metrics) {
+            int outcome = rc < 0 ? ALIN_OUTCOME_ERROR
+                        : (rc == ALIN_PASS || out[0] != '\0') ? ALIN_OUTCOME_EMITTED : ALIN_OUTCOME_DROPPED;
+            alin_metrics_record(metrics, monotonic_ns() - started, outcome);
+        }
+        if (rc < 0) {
+            fprintf(stderr, "Error: Processing failed (record %ld)\n", records_in);
+            continue;
+        }
+        // 上游一直有数据时不会经过 flush_output，按记录数顺带检查汇报时机
+        if ((records_in & 4095) == 0) alin_queue_report(0);
+        if (rc == ALIN_PASS) {
+            output_meta.fields = input_meta.fields;
+            emit(record, len);
+        } else if (out[0] != '\0') {
+            if (slot) {
+                alin_ring_commit(&ring_out, strlen(out), &output_meta, 0);
+                records_out++;
+            } else {
+                emit(out, strlen(out));
+            }
+        }
+        if (extra_used > 0) drain_extras();
+    }
+
+    // 输入结束: 最后一次空闲回调 (节点可在此写出尚未到期的聚合结果)
+    if (idle_hook) {
+        idle_hook(1);
+        drain_extras();
+    }
+    end_output();
+    fflush(stdout);
+    alin_reader_close(r);
+    alin_arena_free(arena);
+    if (ctl_fd >= 0) {
+        alin_queue_report(1);
+        alin_ctl_msg_t bye = { ALIN_CTL_BYE, 0, records_in, records_mark, records_out };
+        alin_ctl_send(ctl_fd, &bye, NULL, 0);
+    }
+    return 0;
+}
+
+static int run_once(alin_process_fn process, int flags) {
+    alin_input_t in;
+    alin_input_open(&in, STDIN_FILENO, ALIN_RECORD_LIMIT);
+    size_t len;
+    char* input = alin_input_all(&in, &len);
+    input = alin_trim_span(input, &len);
+    if (input[0] == '\0') {
+        alin_input_close(&in);
+        if (flags & ALIN_NODE_REQUIRE_INPUT) {
+            fprintf(stderr, "Error: No input received\n");
+            return 1;
+        }
+        return 0;
+    }
+
+    size_t output_size = alin_output_size(len);
+    char* output = alin_arena_alloc(alin_record_arena(), output_size);
+    if (!output) {
+        alin_input_close(&in);
+        return 1;
+    }
+    output[0] = '\0';
+    int rc = process(input, output, output_size);
+    if (rc < 0) {
+        fprintf(stderr, "Error: Processing failed\n");
+        alin_input_close(&in);
+        return 1;
+    }
+    if (rc == ALIN_PASS) {
+        printf("%s\n", input);
+    } else if (output[0] != '\0') {
+        printf("%s\n", output);
+    }
+    const char* extra;
+    size_t extra_len;
+    while ((extra = alin_next_extra(&extra_len)) != NULL) printf("%s\n", extra);
+    alin_input_close(&in);
+    return 0;
+}
+
+int alin_node_main(int argc, char* argv[], alin_process_fn process, int flags) {
+    if (alin_stream_enabled(argc, argv)) {
+        return run_stream(process, flags, metrics_name(argc > 0 ? argv[0] : NULL));
+    }
+    return run_once(process, flags);
+}
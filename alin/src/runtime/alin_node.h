@@ -0,0 +1,211 @@
+/**
+ * ALIN 节点运行时 (Node Runtime)
+ *
+ * 所有节点共享的 main 循环，节点只需实现 process():
+ *
+ *   int process(const char* input, char* output, size_t output_size);
+ *   int main(int argc, char* argv[]) {
+ *       return alin_node_main(argc, argv, process, 0);
+ *   }
+ *
+ * 运行模式:
+ * - 单次模式 (默认): 读取 stdin 直到 EOF，作为一个文档处理一次后退出
+ * - 流模式 (--stream 或 ALIN_STREAM=1): 每行一条记录，循环处理并常驻;
+ *   一批输入处理完、即将阻塞等待新输入前刷新一次 stdout
+ *
+ * 由 alin_runner 启动时 (ALIN_CTL_FD)，流模式节点还接入控制通道 (alin_ctl.h)，
+ * 运行器借此在记录边界把节点的 stdout 切换到新的下游，实现不停流热替换，
+ * 并在相邻两个节点都支持时把它们之间的文本行升级为帧协议 (alin_frame.h);
+ * 声明 ALIN_NODE_STATELESS 的节点可由 alin_fanout 并行运行多个副本
+ *
+ * process() 约定:
+ * - 返回 0 成功; output 为空串表示该记录被丢弃 (不输出)
+ * - 返回 ALIN_PASS 表示原样输出输入记录 (不必复制到 output)
+ * - 返回 -1 失败; 单次模式下进程以 1 退出，流模式下跳过该记录继续处理
+ * - output_size 至少为 ALIN_MAX_OUTPUT，长记录时按输入长度放大 (alin_output_size)
+ *
+ * 记录长度: 常见记录在 ALIN_MAX_RECORD 以内，更长的记录 (至多 ALIN_RECORD_LIMIT) 同样完整处理;
+ * 处理一条记录所需的临时缓冲区从 alin_record_arena() 分配，记录结束后整体重置 (见 alin_arena.h)
+ *
+ * 记录元数据: alin_input_meta() 给出当前记录帧头中的 _type/level/timestamp
+ * (以文本行到达时为 NONE，需自行解析负载); 输出默认沿用输入的元数据，
+ * 改写了这些字段的节点 (如 parse_json) 通过 alin_set_output_meta() 声明
+ *
+ * 字段表: 生成记录的节点可用 alin_set_output_fields() 附上输出记录的字段索引，
+ * 帧格式/环形缓冲的下游经 alin_input_index() 直接还原索引而不扫描负载
+ * (文本行、字段表缺失或不符时退回 alin_json_index); ALIN_PASS 原样转发输入的字段表，
+ * 环境变量 ALIN_FIELDS=0 关闭
+ */
+
+#ifndef ALIN_NODE_H
+#define ALIN_NODE_H
+
+#include <stddef.h>
+
+#include "alin_arena.h"
+#include "alin_frame.h"
+#include "alin_input.h"
+#include "alin_json.h"
+
+#define ALIN_MAX_RECORD 65536
+#define ALIN_MAX_OUTPUT (ALIN_MAX_RECORD * 2)
+#define ALIN_RECORD_LIMIT (16 << 20)          // 单条记录 (含输出) 的上限，超出部分截断丢弃
+
+// process() 返回值: 原样输出输入记录
+#define ALIN_PASS 1
+
+// alin_node_main 标志位
+#define ALIN_NODE_REQUIRE_INPUT 0x1   // 单次模式下无输入视为错误
+#define ALIN_NODE_STATELESS 0x2       // 纯逐记录函数 (无跨记录状态)，运行器可并行启动多个副本
+
+typedef int (*alin_process_fn)(const char* input, char* output, size_t output_size);
+
+// stdout 缓冲区大小
+#define ALIN_READ_BLOCK 65536
+
+// 记录读取器: 在块输入层 (alin_input.h) 之上切分文本行与帧，记录原地交出
+typedef struct {
+    int fd;
+    int ctl_fd;                      // 控制通道 (-1 表示无)
+    void (*on_ctl)(int ctl_fd);      // 控制通道可读时回调，总在记录边界触发
+    alin_input_t in;
+    int eof;
+    int framed;                      // 输入已切换为帧格式
+    alin_frame_t frame;              // 最近一条记录的帧头 (文本行时类型/级别为 NONE)
+    size_t len;                      // 最近一条记录的长度
+    const alin_fields_t* fields;     // 最近一条记录附带的字段表 (NULL 表示没有)
+    alin_fields_t fields_buf;        // 帧中读出的字段表
+} alin_reader_t;
+
+/**
+ * 是否启用流模式: 命令行 --stream 或环境变量 ALIN_STREAM (非空且不为 0)
+ */
+int alin_stream_enabled(int argc, char* argv[]);
+
+/**
+ * 去除字符串首尾空白 (原地修改)
+ */
+void alin_trim(char* str);
+
+/**
+ * 去除记录首尾空白而不移动数据: 在新的结尾写 '\0'，更新 len
+ * @return 新的起点
+ */
+char* alin_trim_span(char* str, size_t* len);
+
+/**
+ * 初始化读取器 (输入为普通文件时映射，否则分配块缓冲区)
+ */
+void alin_reader_init(alin_reader_t* r, int fd);
+
+/**
+ * 释放读取器的缓冲区或映射
+ */
+void alin_reader_close(alin_reader_t* r);
+
+/**
+ * 读取下一条记录 (一行，不含换行符; 或一帧的负载)，超过 ALIN_RECORD_LIMIT - 1 的部分截断丢弃
+ * 记录原地交出 (以 '\0' 结尾，可原地修改)，在下一次读取前有效
+ * 遇到 ALIN_FRAME_MAGIC 行时自动切换到帧格式，遇到 ALIN_FRAME_LINES 帧时切回文本
+ * 缓冲区耗尽、即将阻塞读取前先刷新 stdout，实现按批输出;
+ * 设置了 ctl_fd 时同时等待控制通道，消息在此处 (而非每条记录) 处理
+ * @return 记录, NULL 表示 EOF
+ */
+char* alin_read_record(alin_reader_t* r, size_t* len);
+
+/**
+ * 长度为 input_len 的记录交给 process() 的输出缓冲区大小:
+ * 不小于 ALIN_MAX_OUTPUT，长记录时为输入的 4 倍 (转义后连同原文一起写出的最坏情况)，
+ * 至多 ALIN_RECORD_LIMIT
+ */
+size_t alin_output_size(size_t input_len);
+
+/**
+ * 当前记录的 arena: process() 中的临时缓冲区从这里分配，不必释放
+ * (流模式下每条记录处理完后重置，单次模式下随进程退出释放)
+ */
+alin_arena_t* alin_record_arena(void);
+
+/**
+ * 当前输入记录的元数据 (流模式下每条记录更新)
+ */
+const alin_meta_t* alin_input_meta(void);
+
+/**
+ * 声明当前输出记录的元数据 (不调用则沿用输入的元数据)
+ */
+void alin_set_output_meta(int type, int level, int64_t timestamp);
+
+/**
+ * 当前输入记录的字段索引: 有字段表时直接还原，否则扫描记录
+ * @return 字段数, -1 表示不是 JSON 对象
+ */
+int alin_input_index(alin_json_t* doc, const char* input);
+
+/**
+ * 附上当前输出记录的字段索引 (doc->json 须为 process() 的 output 缓冲)，
+ * 只在输出为帧格式或环形缓冲时随记录发送
+ */
+void alin_set_output_fields(const alin_json_t* doc);
+
+/**
+ * 输出队列 (stdout 通往下游的管道) 的核算，流模式与 alin_host 共用:
+ * 接入时 (及 stdout 换了下游之后) 读取管道容量，统计经 ctl_fd 以 ALIN_CTL_STATS 汇报
+ */
+void alin_queue_open(int ctl_fd);
+
+/**
+ * 满时的策略 (ALIN_QUEUE_*，见 alin_ctl.h)，默认阻塞
+ */
+void alin_queue_policy(int policy);
+
+/**
+ * 写出 need 字节前的核算: 估算的剩余空间够用时不做系统调用，
+ * 不够时查询实际占用，仍放不下则按策略丢弃或阻塞
+ * @return 0 丢弃, 1 写入, 2 写入后调用 alin_queue_drain 等待下游 (计入等待时间)
+ */
+int alin_queue_admit(size_t need);
+
+/**
+ * 队列已满 (阻塞策略): 写出缓冲并等待下游读走
+ */
+void alin_queue_drain(void);
+
+/**
+ * 汇报输出队列统计 (累计值); force 为 0 时至多每秒一次
+ */
+void alin_queue_report(int force);
+
+/**
+ * 注册空闲回调: 流模式下一批输入处理完、即将阻塞等待新输入时调用 (final 为 0)，输入结束时
+ * 再调用一次 (final 为 1); 有状态节点借此提交攒下的写入 (如 alin_wal 的组提交)，
+ * 或用 alin_emit_extra() 写出到期的聚合结果。单次模式下不调用
+ */
+void alin_set_idle_hook(void (*hook)(int final));
+
+/**
+ * 执行已注册的空闲回调 (alin_host 在自身即将阻塞及输入结束时对各插件调用)
+ */
+void alin_node_idle(int final);
+
+/**
+ * 在当前输出之外追加一条记录 (如聚合结果)，可在 process() 或空闲回调中调用:
+ * 流模式下写在当前记录之后 (元数据为 NONE，下游按负载解析)，单次模式下随输出打印，
+ * alin_host 中交给链上的下一槽位
+ * @return 0 成功, -1 内存不足
+ */
+int alin_emit_extra(const char* record, size_t len);
+
+/**
+ * 依次取出追加的记录 (alin_host 在插件的 process() 或空闲回调返回后调用)
+ * @return 记录, NULL 表示已取完 (同时清空); 在下一次追加前有效
+ */
+const char* alin_next_extra(size_t* len);
+
+/**
+ * 节点主循环，按运行模式反复调用 process()
+ * @return 进程退出码
+ */
+int alin_node_main(int argc, char* argv[], alin_process_fn process, int flags);
+
+#endif
@@ -0,0 +1,324 @@
+/**
+ * ALIN 共享内存环形缓冲实现 (见 alin_ring.h)
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+#include "alin_ring.h"
+
+#define CTL_PAGE 4096
+#define RECORD_ALIGN 16
+#define PUBLISH_BATCH 65536     // 攒够这么多字节才发布/唤醒一次 (与节点的 stdout 缓冲相当)
+
+// 生产者与消费者各自写的字段分处不同缓存行，避免伪共享
+struct alin_ring_ctl {
+    _Atomic uint64_t head;              // 已发布的写入位置 (单调递增)
+    char pad0[56];
+    _Atomic uint64_t tail;              // 已释放的读取位置
+    char pad1[56];
+    _Atomic uint32_t reader_waiting;
+    char pad2[60];
+    _Atomic uint32_t writer_waiting;
+    char pad3[60];
+    uint64_t size;
+};
+
+/**
+ * 记录占用的字节数: 帧头 + 负载 + '\0'，带字段表时其后 (4 字节对齐) 再放 fields 字节
+ */
+static size_t record_size(size_t len, size_t fields) {
+    size_t body = sizeof(alin_frame_t) + len + 1;
+    if (fields) body = ((body + 3) & ~(size_t)3) + fields;
+    return (body + RECORD_ALIGN - 1) & ~(size_t)(RECORD_ALIGN - 1);
+}
+
+/**
+ * 随记录写入的字段表字节数 (没有字段表时为 0)
+ */
+static size_t fields_size(const alin_meta_t* meta) {
+    return meta && meta->fields && meta->fields->count ? ALIN_FIELDS_SIZE(meta->fields->count) : 0;
+}
+
+static void signal_fd(int fd) {
+    uint64_t one = 1;
+    if (write(fd, &one, sizeof(one)) < 0) {}
+}
+
+static void drain_fd(int fd) {
+    uint64_t value;
+    while (read(fd, &value, sizeof(value)) > 0) {}
+}
+
+static uint64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void wake_writer(alin_ring_t* ring) {
+    alin_ring_ctl_t* ctl = ring->ctl;
+    uint64_t tail = atomic_load_explicit(&ctl->tail, memory_order_relaxed);
+    if (tail == ring->signaled) return;
+
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ctl->writer_waiting, memory_order_relaxed)) {
+        signal_fd(ring->space_fd);
+        ring->signaled = tail;
+    }
+}
+
+int alin_ring_supported(void) {
+#ifdef __linux__
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+int alin_ring_create(size_t size, int fds[ALIN_RING_FDS]) {
+#ifdef __linux__
+    uint64_t cap = 1;
+    while (cap < size) cap <<= 1;
+
+    int memfd = memfd_create("alin-ring", MFD_CLOEXEC);
+    if (memfd < 0) return -1;
+    if (ftruncate(memfd, (off_t)(CTL_PAGE + cap)) != 0) {
+        close(memfd);
+        return -1;
+    }
+
+    alin_ring_ctl_t* ctl = mmap(NULL, CTL_PAGE, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (ctl == MAP_FAILED) {
+        close(memfd);
+        return -1;
+    }
+    memset(ctl, 0, sizeof(*ctl));
+    ctl->size = cap;
+    munmap(ctl, CTL_PAGE);
+
+    fds[0] = memfd;
+    fds[1] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    fds[2] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fds[1] < 0 || fds[2] < 0) {
+        for (int i = 0; i < ALIN_RING_FDS; i++) {
+            if (fds[i] >= 0) close(fds[i]);
+        }
+        return -1;
+    }
+    return 0;
+#else
+    (void)size;
+    (void)fds;
+    return -1;
+#endif
+}
+
+int alin_ring_attach(alin_ring_t* ring, const int fds[ALIN_RING_FDS]) {
+    struct stat st;
+    memset(ring, 0, sizeof(*ring));
+
+    if (fstat(fds[0], &st) != 0 || st.st_size <= CTL_PAGE) goto fail;
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    if (base == MAP_FAILED) goto fail;
+    close(fds[0]);
+
+    ring->ctl = base;
+    ring->data = (char*)base + CTL_PAGE;
+    ring->size = ring->ctl->size;
+    ring->map_size = (size_t)st.st_size;
+    ring->data_fd = fds[1];
+    ring->space_fd = fds[2];
+    ring->release = atomic_load_explicit(&ring->ctl->tail, memory_order_acquire);
+    ring->head = atomic_load_explicit(&ring->ctl->head, memory_order_acquire);
+    ring->signaled = ring->release;
+    return 0;
+
+fail:
+    for (int i = 0; i < ALIN_RING_FDS; i++) close(fds[i]);
+    return -1;
+}
+
+void alin_ring_detach(alin_ring_t* ring) {
+    if (!ring->ctl) return;
+    munmap(ring->ctl, ring->map_size);
+    close(ring->data_fd);
+    close(ring->space_fd);
+    memset(ring, 0, sizeof(*ring));
+}
+
+char* alin_ring_reserve(alin_ring_t* ring, size_t max_len) {
+    alin_ring_ctl_t* ctl = ring->ctl;
+    uint64_t head = ring->head;
+    uint64_t tail = atomic_load_explicit(&ctl->tail, memory_order_acquire);
+    uint64_t used = head - tail;
+    uint64_t limit = ring->limit && ring->limit < ring->size ? ring->limit : ring->size;
+    uint64_t cap = used > 0 ? limit : ring->size;
+    // 占用含回绕跳过的尾部空间，峰值按逻辑容量封顶
+    if (used > ring->peak) ring->peak = used < limit ? used : limit;
+    uint64_t free_bytes = cap > used ? cap - used : 0;
+    uint64_t pos = head & (ring->size - 1);
+    uint64_t to_end = ring->size - pos;
+    size_t need = record_size(max_len, 0);
+
+    // 记录总是连续存放: 尾部放不下时先写一个回绕标记
+    if (to_end < need) {
+        if (free_bytes < to_end + need) return NULL;
+        alin_frame_t* wrap = (alin_frame_t*)(ring->data + pos);
+        memset(wrap, 0, sizeof(*wrap));
+        wrap->flags = ALIN_FRAME_WRAP;
+        head += to_end;
+        pos = 0;
+    } else if (free_bytes < need) {
+        return NULL;
+    }
+
+    ring->reserved = head;
+    ring->room = max_len;
+    return ring->data + pos + sizeof(alin_frame_t);
+}
+
+int alin_ring_fits(const alin_ring_t* ring, size_t max_len) {
+    return record_size(max_len, 0) <= ring->size / 2;
+}
+
+void alin_ring_commit(alin_ring_t* ring, size_t len, const alin_meta_t* meta, int flags) {
+    uint64_t head = ring->reserved;
+    alin_frame_t* hdr = (alin_frame_t*)(ring->data + (head & (ring->size - 1)));
+
+    hdr->length = (uint32_t)len;
+    hdr->type = meta ? meta->type : ALIN_TYPE_NONE;
+    hdr->level = meta ? meta->level : ALIN_LEVEL_NONE;
+    hdr->flags = (uint16_t)flags;
+    hdr->timestamp = meta ? meta->timestamp : 0;
+    ((char*)(hdr + 1))[len] = '\0';
+
+    // 字段表紧随负载; 预留空间放不下时不带 (下游退回扫描负载)
+    size_t fields = fields_size(meta);
+    if (fields && record_size(len, fields) > record_size(ring->room, 0)) fields = 0;
+    if (fields) {
+        memcpy((char*)hdr + ((sizeof(*hdr) + len + 1 + 3) & ~(size_t)3), meta->fields, fields);
+        hdr->flags |= ALIN_FRAME_FIELDS;
+    }
+
+    // 逐条发布会让消费者逐条跟随 (缓存行来回迁移，且从不阻塞、无暇处理控制消息);
+    // 不足一批时留给 alin_ring_flush
+    ring->head = head + record_size(len, fields);
+    if (ring->head - ring->signaled >= PUBLISH_BATCH) alin_ring_flush(ring);
+}
+
+void alin_ring_flush(alin_ring_t* ring) {
+    alin_ring_ctl_t* ctl = ring->ctl;
+    if (ring->head == ring->signaled) return;
+
+    atomic_store_explicit(&ctl->head, ring->head, memory_order_release);
+    ring->signaled = ring->head;
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ctl->reader_waiting, memory_order_relaxed)) {
+        signal_fd(ring->data_fd);
+    }
+}
+
+int alin_ring_write(alin_ring_t* ring, const char* data, size_t len,
+                    const alin_meta_t* meta, int flags, int peer_fd, int wake_fd) {
+    alin_ring_ctl_t* ctl = ring->ctl;
+
+    size_t fields = fields_size(meta);
+    size_t need = fields ? len + 3 + fields : len;
+
+    for (;;) {
+        char* slot = alin_ring_reserve(ring, need);
+        if (slot) {
+            if (len > 0) memcpy(slot, data, len);
+            alin_ring_commit(ring, len, meta, flags);
+            return 0;
+        }
+
+        // 声明等待后再确认一次，避免与消费者的释放交错而漏掉唤醒
+        alin_ring_flush(ring);
+        atomic_store_explicit(&ctl->writer_waiting, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (alin_ring_reserve(ring, need)) {
+            atomic_store_explicit(&ctl->writer_waiting, 0, memory_order_relaxed);
+            continue;
+        }
+
+        struct pollfd pfd[3] = {
+            { ring->space_fd, POLLIN, 0 },
+            { peer_fd, 0, 0 },
+            { wake_fd, POLLIN, 0 }
+        };
+        uint64_t t0 = monotonic_ns();
+        int n = poll(pfd, 3, -1);
+        ring->stall_ns += monotonic_ns() - t0;
+        atomic_store_explicit(&ctl->writer_waiting, 0, memory_order_relaxed);
+        if (n < 0 && errno != EINTR) return -1;
+        if (peer_fd >= 0 && (pfd[1].revents & (POLLERR | POLLHUP))) return -1;
+        drain_fd(ring->space_fd);
+        if (pfd[2].revents & POLLIN) return 1;
+    }
+}
+
+int alin_ring_read(alin_ring_t* ring, const alin_frame_t** frame, const char** payload) {
+    alin_ring_ctl_t* ctl = ring->ctl;
+    uint64_t pos = ring->release;
+
+    // 上一条记录已处理完毕，归还其空间 (攒够一批再唤醒等待空间的生产者)
+    if (atomic_load_explicit(&ctl->tail, memory_order_relaxed) != pos) {
+        atomic_store_explicit(&ctl->tail, pos, memory_order_release);
+        if (pos - ring->signaled >= PUBLISH_BATCH) wake_writer(ring);
+    }
+
+    uint64_t head = atomic_load_explicit(&ctl->head, memory_order_acquire);
+    while (pos != head) {
+        const alin_frame_t* hdr = (const alin_frame_t*)(ring->data + (pos & (ring->size - 1)));
+        if (hdr->flags & ALIN_FRAME_WRAP) {
+            pos += ring->size - (pos & (ring->size - 1));
+            ring->release = pos;
+            continue;
+        }
+        const alin_fields_t* fields = alin_ring_fields(hdr);
+        *frame = hdr;
+        *payload = (const char*)(hdr + 1);
+        ring->release = pos + record_size(hdr->length, fields ? ALIN_FIELDS_SIZE(fields->count) : 0);
+        return 1;
+    }
+    return 0;
+}
+
+const alin_fields_t* alin_ring_fields(const alin_frame_t* frame) {
+    if (!(frame->flags & ALIN_FRAME_FIELDS)) return NULL;
+    return (const alin_fields_t*)((const char*)frame + ((sizeof(*frame) + frame->length + 1 + 3) & ~(size_t)3));
+}
+
+int alin_ring_prepare_wait(alin_ring_t* ring) {
+    alin_ring_ctl_t* ctl = ring->ctl;
+    wake_writer(ring);
+    atomic_store_explicit(&ctl->reader_waiting, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ctl->head, memory_order_acquire) != ring->release) {
+        atomic_store_explicit(&ctl->reader_waiting, 0, memory_order_relaxed);
+        return 0;
+    }
+    return 1;
+}
+
+void alin_ring_finish_wait(alin_ring_t* ring) {
+    drain_fd(ring->data_fd);
+    atomic_store_explicit(&ring->ctl->reader_waiting, 0, memory_order_relaxed);
+}
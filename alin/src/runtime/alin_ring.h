@@ -0,0 +1,138 @@
+/**
+ * ALIN 共享内存环形缓冲 (Shared-Memory SPSC Ring)
+ *
+ * 相邻两级节点之间的单生产者/单消费者记录队列，替代管道承载数据:
+ * - 存储: memfd 映射到两个进程，首页为控制块，其后为 2 的幂大小的数据区
+ * - 记录: alin_frame_t 帧头 + 负载 + '\0' (+ 4 字节对齐的字段表)，按 16 字节对齐连续存放，
+ *         消费者直接把负载指针交给 process() (原地读取，不再复制)
+ * - 发布: 生产者按批 (约 64KB，相当于 stdout 缓冲) 或在即将阻塞时 (alin_ring_flush)
+ *         才发布写入位置，消费者同样在批次之间阻塞并处理控制消息
+ * - 唤醒: 两个 eventfd (有数据 / 有空间)，只有对端声明等待时才写入;
+ *         两端都忙时读写只有原子操作，没有系统调用
+ *
+ * 容量: 生产者可设逻辑上限 (limit，运行器按边的队列容量下发)，占用达到上限即视为满;
+ *       等待空间的时间与占用峰值记在生产者一端，供节点经控制通道汇报
+ *
+ * 由运行器创建并经控制通道 (ALIN_CTL_RING) 交给两端;
+ * 生产者在原管道中写一行 ALIN_RING_MAGIC 表示此后的数据走环形缓冲，
+ * 在环中写一条带 ALIN_FRAME_LINES 标志的空记录表示结束 (消费者退回管道)
+ * 仅 Linux 可用 (memfd/eventfd)，其他平台节点不声明该能力，继续使用管道
+ */
+
+#ifndef ALIN_RING_H
+#define ALIN_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "alin_frame.h"
+
+#define ALIN_RING_MAGIC "\036ALIN-RING/1"
+#define ALIN_RING_DEFAULT_SIZE (1u << 20)
+#define ALIN_RING_MIN_SIZE (1u << 20)         // 至少容纳数条最大输出记录 (ALIN_MAX_OUTPUT)
+#define ALIN_RING_FDS 3                    // memfd, 数据 eventfd, 空间 eventfd
+
+// ALIN_CTL_RING 消息中的角色 (msg.a)
+enum {
+    ALIN_RING_CONSUMER = 0,
+    ALIN_RING_PRODUCER
+};
+
+typedef struct alin_ring_ctl alin_ring_ctl_t;
+
+typedef struct {
+    alin_ring_ctl_t* ctl;       // 共享控制块 (NULL 表示未接入)
+    char* data;                 // 数据区
+    uint64_t size;
+    size_t map_size;
+    int data_fd;                // eventfd: 生产者 → 消费者
+    int space_fd;               // eventfd: 消费者 → 生产者
+    uint64_t head;              // 生产者: 本地写入位置 (按批发布到控制块)
+    uint64_t reserved;          // 生产者: 预留记录的起点
+    size_t room;                // 生产者: 预留的负载空间 (提交时字段表也须放得下)
+    uint64_t release;           // 消费者: 上一条记录的结束位置，读取下一条时释放
+    uint64_t signaled;          // 上次发布的 head (生产者) / 上次唤醒生产者时的 tail (消费者)
+    uint64_t limit;             // 生产者: 逻辑容量 (0 表示整个数据区)
+    uint64_t peak;              // 生产者: 占用峰值 (字节)
+    uint64_t stall_ns;          // 生产者: 等待空间的累计时间
+} alin_ring_t;
+
+/**
+ * 创建环形缓冲 (运行器调用)，fds 依次为 memfd、数据 eventfd、空间 eventfd
+ * @return 0 成功, -1 失败或平台不支持
+ */
+int alin_ring_create(size_t size, int fds[ALIN_RING_FDS]);
+
+/**
+ * 是否支持环形缓冲
+ */
+int alin_ring_supported(void);
+
+/**
+ * 接入 (映射) 环形缓冲，接管 fds
+ * @return 0 成功, -1 失败 (fds 已关闭)
+ */
+int alin_ring_attach(alin_ring_t* ring, const int fds[ALIN_RING_FDS]);
+
+/**
+ * 断开并释放映射
+ */
+void alin_ring_detach(alin_ring_t* ring);
+
+/**
+ * 生产者: 非阻塞地预留可容纳 max_len 字节负载的连续空间
+ * 占用超过 limit 时视为空间不足 (环为空时例外，保证单条超长记录也能写入)
+ * @return 负载写入位置, NULL 表示空间不足 (改用 alin_ring_write，或按策略丢弃)
+ */
+char* alin_ring_reserve(alin_ring_t* ring, size_t max_len);
+
+/**
+ * 生产者: 可容纳 max_len 字节负载 (含字段表，与 alin_ring_reserve 相同) 的记录能否写入本环
+ * 超过数据区一半的记录在回绕处可能永远等不到连续空间，须改走管道
+ */
+int alin_ring_fits(const alin_ring_t* ring, size_t max_len);
+
+/**
+ * 生产者: 提交预留空间中写好的 len 字节负载
+ * meta 带字段表且预留空间放得下时一并写入 (帧标志 ALIN_FRAME_FIELDS)
+ */
+void alin_ring_commit(alin_ring_t* ring, size_t len, const alin_meta_t* meta, int flags);
+
+/**
+ * 生产者: 立即发布已提交的记录并按需唤醒消费者 (本端即将阻塞或切换前调用)
+ */
+void alin_ring_flush(alin_ring_t* ring);
+
+/**
+ * 生产者: 写入一条记录，空间不足时阻塞等待
+ * peer_fd 为通往消费者的管道写端，消费者退出时据此发现 (POLLERR);
+ * wake_fd >= 0 时等待期间该 fd 可读即放弃写入返回 (供节点处理控制消息)
+ * @return 0 成功, 1 wake_fd 可读 (未写入), -1 消费者已不存在
+ */
+int alin_ring_write(alin_ring_t* ring, const char* data, size_t len,
+                    const alin_meta_t* meta, int flags, int peer_fd, int wake_fd);
+
+/**
+ * 消费者: 释放上一条记录并读取下一条 (非阻塞)
+ * @return 1 读到记录 (*frame / *payload 指向环内), 0 暂无数据
+ */
+int alin_ring_read(alin_ring_t* ring, const alin_frame_t** frame, const char** payload);
+
+/**
+ * 消费者: 环内记录附带的字段表 (原地，随记录一同释放)
+ * @return 字段表, NULL 表示没有
+ */
+const alin_fields_t* alin_ring_fields(const alin_frame_t* frame);
+
+/**
+ * 消费者: 准备阻塞等待数据，返回前已声明等待
+ * @return 1 可以阻塞 (poll ring->data_fd), 0 数据已到达无需等待
+ */
+int alin_ring_prepare_wait(alin_ring_t* ring);
+
+/**
+ * 消费者: 等待结束 (被唤醒或放弃等待)
+ */
+void alin_ring_finish_wait(alin_ring_t* ring);
+
+#endif
@@ -0,0 +1,208 @@
+/**
+ * ALIN 向量化字节扫描实现 (见 alin_scan.h)
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alin_scan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ALIN_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+#define PAGE_SIZE 4096
+#define PAGE_ROOM(p) (PAGE_SIZE - ((uintptr_t)(p) & (PAGE_SIZE - 1)))
+
+// 标量实现与页尾处理共用的字符表
+#define STRING_SET 0x1
+#define ESCAPE_SET 0x2
+
+static const uint8_t scan_class[256] = {
+    ['\0'] = STRING_SET | ESCAPE_SET,
+    ['"'] = STRING_SET | ESCAPE_SET,
+    ['\\'] = STRING_SET | ESCAPE_SET,
+    ['\n'] = ESCAPE_SET,
+    ['\r'] = ESCAPE_SET,
+    ['\t'] = ESCAPE_SET
+};
+
+static const char* string_scalar(const char* p) {
+    while (!(scan_class[(unsigned char)*p] & STRING_SET)) p++;
+    return p;
+}
+
+static const char* escape_scalar(const char* p) {
+    while (!(scan_class[(unsigned char)*p] & ESCAPE_SET)) p++;
+    return p;
+}
+
+/**
+ * 逐字节扫描到页尾
+ * @return 命中位置, NULL 表示本页剩余部分没有命中
+ */
+static inline const char* scan_page_tail(const char* p, int set) {
+    const char* end = p + PAGE_ROOM(p);
+    for (; p < end; p++) {
+        if (scan_class[(unsigned char)*p] & set) return p;
+    }
+    return NULL;
+}
+
+#ifdef ALIN_SCAN_X86
+
+__attribute__((target("avx2")))
+static inline unsigned match_avx2(__m256i v, int set) {
+    __m256i m = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_setzero_si256()), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))),
+        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+    if (set == ESCAPE_SET) {
+        m = _mm256_or_si256(m, _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))),
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))));
+    }
+    return (unsigned)_mm256_movemask_epi8(m);
+}
+
+__attribute__((target("avx2")))
+static inline const char* scan_avx2(const char* p, int set) {
+    for (;;) {
+        if (PAGE_ROOM(p) < 32) {
+            const char* hit = scan_page_tail(p, set);
+            if (hit) return hit;
+            p += PAGE_ROOM(p);
+            continue;
+        }
+        unsigned mask = match_avx2(_mm256_loadu_si256((const __m256i*)p), set);
+        if (mask) return p + __builtin_ctz(mask);
+        p += 32;
+    }
+}
+
+__attribute__((target("avx2")))
+static const char* string_avx2(const char* p) {
+    return scan_avx2(p, STRING_SET);
+}
+
+__attribute__((target("avx2")))
+static const char* escape_avx2(const char* p) {
+    return scan_avx2(p, ESCAPE_SET);
+}
+
+// PCMPISTRI: 字符集以 '\0' 结束 (隐式长度)，数据中的 '\0' 同样终止比较
+#define SSE42_MODE (_SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT)
+
+__attribute__((target("sse4.2")))
+static inline const char* scan_sse42(const char* p, __m128i needles, int set) {
+    for (;;) {
+        if (PAGE_ROOM(p) < 16) {
+            const char* hit = scan_page_tail(p, set);
+            if (hit) return hit;
+            p += PAGE_ROOM(p);
+            continue;
+        }
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        int idx = _mm_cmpistri(needles, v, SSE42_MODE);
+        if (idx < 16) return p + idx;
+        if (_mm_cmpistrz(needles, v, SSE42_MODE)) return p + strlen(p);
+        p += 16;
+    }
+}
+
+__attribute__((target("sse4.2")))
+static const char* string_sse42(const char* p) {
+    return scan_sse42(p, _mm_setr_epi8('"', '\\', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0), STRING_SET);
+}
+
+__attribute__((target("sse4.2")))
+static const char* escape_sse42(const char* p) {
+    return scan_sse42(p, _mm_setr_epi8('"', '\\', '\n', '\r', '\t', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0), ESCAPE_SET);
+}
+
+#endif
+
+typedef struct {
+    const char* name;
+    const char* (*string)(const char*);
+    const char* (*escape)(const char*);
+} ScanImpl;
+
+static const ScanImpl impls[] = {
+#ifdef ALIN_SCAN_X86
+    { "avx2", string_avx2, escape_avx2 },
+    { "sse4.2", string_sse42, escape_sse42 },
+#endif
+    { "scalar", string_scalar, escape_scalar }
+};
+
+#define IMPL_COUNT (int)(sizeof(impls) / sizeof(impls[0]))
+
+static int supported(const ScanImpl* impl) {
+#ifdef ALIN_SCAN_X86
+    if (strcmp(impl->name, "avx2") == 0) return __builtin_cpu_supports("avx2");
+    if (strcmp(impl->name, "sse4.2") == 0) return __builtin_cpu_supports("sse4.2");
+#endif
+    return 1;
+}
+
+static const char* dispatch_string(const char* p);
+static const char* dispatch_escape(const char* p);
+
+static const ScanImpl* current = NULL;
+static const char* (*scan_string_fn)(const char*) = dispatch_string;
+static const char* (*scan_escape_fn)(const char*) = dispatch_escape;
+
+static void select_impl(const ScanImpl* impl) {
+    current = impl;
+    scan_string_fn = impl->string;
+    scan_escape_fn = impl->escape;
+}
+
+int alin_scan_use(const char* isa) {
+    for (int i = 0; i < IMPL_COUNT; i++) {
+        if (strcmp(impls[i].name, isa) == 0 && supported(&impls[i])) {
+            select_impl(&impls[i]);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * 首次调用时选择: ALIN_SIMD 指定且可用时用它，否则取最快的可用实现
+ */
+static void init_impl(void) {
+    const char* env = getenv("ALIN_SIMD");
+    if (env && env[0] && alin_scan_use(env) == 0) return;
+    for (int i = 0; i < IMPL_COUNT; i++) {
+        if (supported(&impls[i])) {
+            select_impl(&impls[i]);
+            return;
+        }
+    }
+}
+
+static const char* dispatch_string(const char* p) {
+    init_impl();
+    return scan_string_fn(p);
+}
+
+static const char* dispatch_escape(const char* p) {
+    init_impl();
+    return scan_escape_fn(p);
+}
+
+const char* alin_scan_string(const char* p) {
+    return scan_string_fn(p);
+}
+
+const char* alin_scan_escape(const char* p) {
+    return scan_escape_fn(p);
+}
+
+const char* alin_scan_isa(void) {
+    if (!current) init_impl();
+    return current->name;
+}
@@ -0,0 +1,39 @@
+/**
+ * ALIN 向量化字节扫描 (SIMD Byte Scanner)
+ *
+ * JSON 解析与转义的热点是在记录中寻找少数几种字符 (引号、反斜杠、需转义的控制字符)。
+ * 这里按 CPU 在运行时选择实现，一次比较 16/32 字节:
+ * - avx2:   32 字节一组，逐字符比较后合并为位掩码
+ * - sse4.2: 16 字节一组，PCMPISTRI 一条指令完成字符集匹配与结尾检测
+ * - scalar: 查表逐字节 (非 x86 平台或 CPU 不支持时)
+ * 首次调用时选择 (环境变量 ALIN_SIMD=avx2|sse4.2|scalar 可强制指定，用于对比与排查)
+ *
+ * 输入是以 '\0' 结尾的字符串: 向量读取不跨越页边界 (临近页尾时改为逐字节)，
+ * 因此可能读到 '\0' 之后同一页内的字节，但不会访问未映射的内存
+ */
+
+#ifndef ALIN_SCAN_H
+#define ALIN_SCAN_H
+
+/**
+ * 第一个 '"'、'\\' 或 '\0' 的位置 (JSON 字符串内需要停下的字符)
+ */
+const char* alin_scan_string(const char* p);
+
+/**
+ * 第一个需要 JSON 转义的字符 ('"'、'\\'、'\n'、'\r'、'\t') 或 '\0' 的位置
+ */
+const char* alin_scan_escape(const char* p);
+
+/**
+ * 指定实现 ("avx2"、"sse4.2"、"scalar")
+ * @return 0 成功, -1 未知或当前 CPU 不支持
+ */
+int alin_scan_use(const char* isa);
+
+/**
+ * 当前使用的实现名称
+ */
+const char* alin_scan_isa(void);
+
+#endif
@@ -0,0 +1,185 @@
+/**
+ * ALIN 原始记录暂存区实现 (见 alin_spool.h)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "alin_spool.h"
+
+#define SPOOL_MAGIC 0x31535a4e494c41ull     // "ALINZS1"
+#define SPOOL_HDR_SIZE 4096
+#define FETCH_CACHE 8                       // 读者同时映射的暂存区个数 (每个生产者实例一个)
+
+struct alin_spool_hdr {
+    uint64_t magic;
+    uint64_t capacity;
+    _Atomic uint64_t head;                  // 已写入的总字节数 (单调递增)
+};
+
+int alin_spool_open(alin_spool_t* spool, const char* prefix) {
+    memset(spool, 0, sizeof(*spool));
+    const char* dir = getenv("ALIN_SPOOL_DIR");
+    if (!dir || !dir[0]) return -1;
+
+    uint64_t capacity = ALIN_SPOOL_DEFAULT_SIZE;
+    const char* size_env = getenv("ALIN_SPOOL_SIZE");
+    if (size_env && atol(size_env) > 0) capacity = (uint64_t)atol(size_env);
+
+    // 同一进程中可能有多个实例 (alin_host 加载多个 parse_json)，重名时追加序号
+    char path[4096];
+    int fd = -1;
+    for (int seq = 0; seq < 100 && fd < 0; seq++) {
+        if (seq == 0) snprintf(spool->name, sizeof(spool->name), "%s.%d", prefix, (int)getpid());
+        else snprintf(spool->name, sizeof(spool->name), "%s.%d.%d", prefix, (int)getpid(), seq);
+        snprintf(path, sizeof(path), "%s/%s%s", dir, spool->name, ALIN_SPOOL_SUFFIX);
+        fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0 && errno != EEXIST) break;
+    }
+    if (fd < 0) {
+        fprintf(stderr, "[SPOOL] Cannot create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    size_t map_size = SPOOL_HDR_SIZE + capacity;
+    if (ftruncate(fd, (off_t)map_size) < 0) {
+        close(fd);
+        unlink(path);
+        return -1;
+    }
+    void* map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        unlink(path);
+        return -1;
+    }
+
+    spool->hdr = map;
+    spool->data = (char*)map + SPOOL_HDR_SIZE;
+    spool->capacity = capacity;
+    spool->map_size = map_size;
+    spool->hdr->capacity = capacity;
+    atomic_thread_fence(memory_order_release);
+    spool->hdr->magic = SPOOL_MAGIC;
+    return 0;
+}
+
+int64_t alin_spool_append(alin_spool_t* spool, const char* data, size_t len) {
+    if (!spool->hdr || len > spool->capacity) return -1;
+
+    uint64_t pos = atomic_load_explicit(&spool->hdr->head, memory_order_relaxed);
+    uint64_t at = pos % spool->capacity;
+    size_t first = spool->capacity - at < len ? (size_t)(spool->capacity - at) : len;
+    memcpy(spool->data + at, data, first);
+    if (first < len) memcpy(spool->data, data + first, len - first);
+    atomic_store_explicit(&spool->hdr->head, pos + len, memory_order_release);
+    return (int64_t)pos;
+}
+
+typedef struct {
+    char name[ALIN_SPOOL_NAME_MAX];
+    alin_spool_hdr_t* hdr;
+    size_t map_size;
+} FetchEntry;
+
+static FetchEntry fetch_cache[FETCH_CACHE];
+static int fetch_next = 0;
+
+/**
+ * 按名称取得暂存区的只读映射 (缓存已映射的，满时替换最早映射的)
+ */
+static alin_spool_hdr_t* map_spool(const char* name) {
+    for (int i = 0; i < FETCH_CACHE; i++) {
+        if (fetch_cache[i].hdr && strcmp(fetch_cache[i].name, name) == 0) return fetch_cache[i].hdr;
+    }
+
+    // 名称来自事件内容，只接受目录下的文件名
+    const char* dir = getenv("ALIN_SPOOL_DIR");
+    if (!dir || !dir[0] || !name[0] || strchr(name, '/') || strcmp(name, "..") == 0) return NULL;
+    if (strlen(name) >= ALIN_SPOOL_NAME_MAX) return NULL;
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s%s", dir, name, ALIN_SPOOL_SUFFIX);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size <= SPOOL_HDR_SIZE) {
+        close(fd);
+        return NULL;
+    }
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    alin_spool_hdr_t* hdr = map;
+    if (hdr->magic != SPOOL_MAGIC || hdr->capacity + SPOOL_HDR_SIZE > (uint64_t)st.st_size) {
+        munmap(map, (size_t)st.st_size);
+        return NULL;
+    }
+
+    FetchEntry* e = &fetch_cache[fetch_next];
+    fetch_next = (fetch_next + 1) % FETCH_CACHE;
+    if (e->hdr) munmap(e->hdr, e->map_size);
+    snprintf(e->name, sizeof(e->name), "%s", name);
+    e->hdr = hdr;
+    e->map_size = (size_t)st.st_size;
+    return hdr;
+}
+
+long alin_spool_fetch(const char* name, uint64_t pos, size_t len, char* out, size_t max_size) {
+    if (max_size == 0) return -1;
+    alin_spool_hdr_t* hdr = map_spool(name);
+    if (!hdr) return -1;
+
+    uint64_t capacity = hdr->capacity;
+    uint64_t head = atomic_load_explicit(&hdr->head, memory_order_acquire);
+    if (len > capacity || pos + len > head || head - pos > capacity) return -1;
+
+    size_t take = len < max_size - 1 ? len : max_size - 1;
+    const char* data = (const char*)hdr + SPOOL_HDR_SIZE;
+    uint64_t at = pos % capacity;
+    size_t first = capacity - at < take ? (size_t)(capacity - at) : take;
+    memcpy(out, data + at, first);
+    if (first < take) memcpy(out + first, data, take - first);
+    out[take] = '\0';
+
+    // 复制期间生产者可能已经绕回覆盖了这段内容
+    atomic_thread_fence(memory_order_acquire);
+    head = atomic_load_explicit(&hdr->head, memory_order_relaxed);
+    if (head - pos > capacity) return -1;
+    return (long)take;
+}
+
+long alin_spool_raw(const alin_json_t* doc, char* out, size_t max_size) {
+    if (alin_json_string(doc, "_raw", out, max_size)) return (long)strlen(out);
+
+    char name[ALIN_SPOOL_NAME_MAX];
+    if (!alin_json_string(doc, "_raw_ref.spool", name, sizeof(name))) return -1;
+    long pos = alin_json_long(doc, "_raw_ref.pos");
+    long len = alin_json_long(doc, "_raw_ref.len");
+    if (pos < 0 || len < 0) return -1;
+    return alin_spool_fetch(name, (uint64_t)pos, (size_t)len, out, max_size);
+}
+
+void alin_spool_clear(const char* dir) {
+    DIR* d = opendir(dir);
+    if (!d) return;
+    size_t m = strlen(ALIN_SPOOL_SUFFIX);
+    struct dirent* ent;
+    while ((ent = readdir(d)) != NULL) {
+        size_t n = strlen(ent->d_name);
+        if (n <= m || strcmp(ent->d_name + n - m, ALIN_SPOOL_SUFFIX) != 0) continue;
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        unlink(path);
+    }
+    closedir(d);
+}
@@ -0,0 +1,69 @@
+/**
+ * ALIN 原始记录暂存区 (Raw Record Spool)
+ *
+ * parse_json 默认把整条原始输入转义后嵌入 _raw，事件体积至少翻倍，每一跳都要搬运并扫描它。
+ * 引用模式 (ALIN_RAW=ref) 下原文改为追加到本进程的暂存区，事件只携带引用:
+ *
+ *   "_raw_ref":{"spool":"parse_json.1234","pos":1048576,"len":230}
+ *
+ * 需要原文的下游 (如 alert_console 设置 ALIN_ALERT_RAW=1) 再用 alin_spool_raw() 取回。
+ *
+ * 存储: <ALIN_SPOOL_DIR>/<名称>.spool，一页头部 (含单调递增的写入位置 head) + 定长循环数据区，
+ *       两端 mmap 共享; 原文写在 pos % capacity 处 (跨过末尾时分两段)
+ * 容量: ALIN_SPOOL_SIZE 字节 (默认 64MB)，写满后覆盖最旧的内容; 引用的内容已被覆盖时取回失败
+ *       (读者复制后再检查一次 head，确认复制期间未被覆盖)
+ * 单写者: 只有创建暂存区的进程写入; 文件不随进程退出删除 (下游可能还在取回)，运行器启动时清理
+ */
+
+#ifndef ALIN_SPOOL_H
+#define ALIN_SPOOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "alin_json.h"
+
+#define ALIN_SPOOL_SUFFIX ".spool"
+#define ALIN_SPOOL_NAME_MAX 128
+#define ALIN_SPOOL_DEFAULT_SIZE (64u << 20)
+
+typedef struct alin_spool_hdr alin_spool_hdr_t;
+
+typedef struct {
+    char name[ALIN_SPOOL_NAME_MAX];  // 引用中的名称 (文件名去掉后缀)
+    alin_spool_hdr_t* hdr;           // NULL 表示未打开
+    char* data;
+    uint64_t capacity;
+    size_t map_size;
+} alin_spool_t;
+
+/**
+ * 创建本进程的暂存区 <ALIN_SPOOL_DIR>/<prefix>.<pid>.spool (同一进程内重名时追加序号)
+ * @return 0 成功, -1 未设置 ALIN_SPOOL_DIR 或创建失败
+ */
+int alin_spool_open(alin_spool_t* spool, const char* prefix);
+
+/**
+ * 追加一段原文
+ * @return 写入位置 (引用中的 pos), -1 表示超过容量
+ */
+int64_t alin_spool_append(alin_spool_t* spool, const char* data, size_t len);
+
+/**
+ * 按引用取回原文 (按名称映射对应的暂存区并缓存映射)，超出 max_size - 1 的部分截断
+ * @return 取回的字节数, -1 表示暂存区不存在或内容已被覆盖
+ */
+long alin_spool_fetch(const char* name, uint64_t pos, size_t len, char* out, size_t max_size);
+
+/**
+ * 事件的原始输入: 内嵌的 _raw 或 _raw_ref 引用的原文
+ * @return 字节数, -1 表示没有或取回失败
+ */
+long alin_spool_raw(const alin_json_t* doc, char* out, size_t max_size);
+
+/**
+ * 删除目录下的所有暂存区 (运行器启动时)
+ */
+void alin_spool_clear(const char* dir);
+
+#endif
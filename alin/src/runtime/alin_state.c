@@ -0,0 +1,153 @@
+/**
+ * ALIN 节点状态文件实现 (见 alin_state.h)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "alin_state.h"
+
+_Static_assert(sizeof(alin_state_header_t) <= ALIN_STATE_HEADER_SIZE, "state header exceeds its reserved size");
+
+static int64_t monotonic_ns() {
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * 读取并校验头部
+ * @return ALIN_STATE_OK, 文件为空时返回 ALIN_STATE_ERROR 且 *empty 置 1
+ */
+static int read_header(int fd, const char* kind, alin_state_header_t* h, int* empty) {
+    struct stat sb;
+    *empty = 0;
+    if (fstat(fd, &sb) < 0) return ALIN_STATE_ERROR;
+    if (sb.st_size == 0) {
+        *empty = 1;
+        return ALIN_STATE_ERROR;
+    }
+    memset(h, 0, sizeof(*h));
+    if (sb.st_size < ALIN_STATE_HEADER_SIZE || pread(fd, h, sizeof(*h), 0) != (ssize_t)sizeof(*h) ||
+        h->magic != ALIN_STATE_MAGIC || h->header_size != ALIN_STATE_HEADER_SIZE) {
+        return ALIN_STATE_FOREIGN;
+    }
+    if (strncmp(h->kind, kind, ALIN_STATE_KIND_MAX) != 0) return ALIN_STATE_MISMATCH;
+    // 截断过的文件按实际长度计 (缺少的部分视为 0)
+    if ((uint64_t)(sb.st_size - ALIN_STATE_HEADER_SIZE) < h->body_size) {
+        h->body_size = (uint64_t)(sb.st_size - ALIN_STATE_HEADER_SIZE);
+    }
+    return ALIN_STATE_OK;
+}
+
+void* alin_state_open(alin_state_t* st, const char* path, const char* kind, uint32_t version, size_t body_size) {
+    memset(st, 0, sizeof(*st));
+    st->error = ALIN_STATE_ERROR;
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "[STATE] Cannot open %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    alin_state_header_t h;
+    int empty;
+    int rc = read_header(fd, kind, &h, &empty);
+    if (rc != ALIN_STATE_OK && !empty) {
+        close(fd);
+        st->error = rc;
+        return NULL;
+    }
+
+    uint64_t size = empty || h.body_size < body_size ? body_size : h.body_size;
+    st->map_size = ALIN_STATE_HEADER_SIZE + size;
+    if (ftruncate(fd, (off_t)st->map_size) < 0) {
+        fprintf(stderr, "[STATE] Cannot extend %s: %s\n", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    void* base = mmap(NULL, st->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "[STATE] Cannot map %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    st->header = base;
+    st->body = (char*)base + ALIN_STATE_HEADER_SIZE;
+    if (empty) {
+        // 新建: 扩展出的内容全为 0; magic 最后写入，读者据此跳过尚未就绪的文件
+        st->header->header_size = ALIN_STATE_HEADER_SIZE;
+        snprintf(st->header->kind, sizeof(st->header->kind), "%s", kind);
+        st->header->created = (int64_t)time(NULL);
+        st->version = 0;
+        atomic_thread_fence(memory_order_release);
+        st->header->magic = ALIN_STATE_MAGIC;
+    } else {
+        st->version = h.version;
+    }
+    if (st->header->version < version) st->header->version = version;
+    st->header->body_size = size;
+
+    const char* sync_ms = getenv("ALIN_STATE_SYNC_MS");
+    long ms = sync_ms && sync_ms[0] ? atol(sync_ms) : 1000;
+    st->sync_ns = ms > 0 ? (int64_t)ms * 1000000 : 0;
+    st->last_sync = monotonic_ns();
+    st->error = ALIN_STATE_OK;
+    return st->body;
+}
+
+int alin_state_read(const char* path, const char* kind, void* body, size_t body_size, alin_state_header_t* header) {
+    memset(body, 0, body_size);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return ALIN_STATE_ERROR;
+
+    alin_state_header_t h;
+    int empty;
+    int rc = read_header(fd, kind, &h, &empty);
+    if (rc == ALIN_STATE_OK) {
+        size_t n = h.body_size < body_size ? (size_t)h.body_size : body_size;
+        if (pread(fd, body, n, ALIN_STATE_HEADER_SIZE) != (ssize_t)n) rc = ALIN_STATE_ERROR;
+        if (header) *header = h;
+    }
+    close(fd);
+    return rc;
+}
+
+void alin_state_checkpoint(alin_state_t* st) {
+    if (!st->header) return;
+    if (msync(st->header, st->map_size, MS_SYNC) < 0) {
+        fprintf(stderr, "[STATE] msync failed: %s\n", strerror(errno));
+        return;
+    }
+    alin_state_add(&st->header->checkpoints, 1);
+    atomic_store_explicit(&st->header->checkpointed, (int64_t)time(NULL), memory_order_relaxed);
+    st->dirty = 0;
+    st->last_sync = monotonic_ns();
+}
+
+void alin_state_touch(alin_state_t* st) {
+    if (!st->header) return;
+    st->dirty++;
+    if (st->sync_ns == 0 || monotonic_ns() - st->last_sync >= st->sync_ns) {
+        alin_state_checkpoint(st);
+    }
+}
+
+void alin_state_close(alin_state_t* st) {
+    if (!st->header) return;
+    if (st->dirty > 0) alin_state_checkpoint(st);
+    munmap(st->header, st->map_size);
+    st->header = NULL;
+    st->body = NULL;
+}
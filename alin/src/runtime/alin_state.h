@@ -0,0 +1,105 @@
+/**
+ * ALIN 节点状态文件 (Memory-Mapped State Store)
+ *
+ * 有状态节点 (如 agg_count) 的状态保存在定长布局的二进制文件中，首条记录前映射一次，
+ * 之后直接在映射上原地更新，不再每条事件重写整个文件:
+ *
+ *   [ 头部 128 字节: magic、种类、布局版本、状态体长度、检查点信息 ][ 状态体 (节点定义的结构) ]
+ *
+ * 版本兼容: 状态体只在末尾追加字段 (已有字段的偏移与含义不变)，追加时版本号加一
+ * - 旧版本的文件: 文件按新的长度扩展，新增字段为 0 (节点可按 alin_state_t.version 补初值)
+ * - 新版本的文件: 映射整个文件，旧程序只读写自己认识的前缀，新增字段原样保留
+ * 热替换前后的两个版本因此可以互相读取对方留下的状态; 种类不同或 magic 不符的文件拒绝打开
+ *
+ * 检查点: 更新后调用 alin_state_touch()，距上次检查点超过 ALIN_STATE_SYNC_MS (默认 1000) 毫秒时
+ *         msync 一次 (状态只有几页，同步的代价与间隔无关); 设为 0 时每次更新都同步。
+ *         进程崩溃不丢失已写入映射的内容 (页缓存仍在)，检查点只决定掉电或系统崩溃时
+ *         最多丢失多长时间的更新
+ * 单写者: 计数器用 relaxed 原子读写 (同 alin_metrics)，其他进程 (如 --dump-state) 随时映射读取
+ */
+
+#ifndef ALIN_STATE_H
+#define ALIN_STATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define ALIN_STATE_MAGIC 0x3154534e494c41ull    // "ALINST1"
+#define ALIN_STATE_KIND_MAX 32
+#define ALIN_STATE_HEADER_SIZE 128
+
+typedef _Atomic int64_t alin_state_counter_t;
+
+// 文件头部 (布局固定，修改时须更换 ALIN_STATE_MAGIC)
+typedef struct {
+    uint64_t magic;
+    char kind[ALIN_STATE_KIND_MAX];  // 节点种类 (如 "agg_count")
+    uint32_t version;                // 写过该文件的最高布局版本
+    uint32_t header_size;
+    uint64_t body_size;              // 状态体长度 (各版本中的最大值)
+    int64_t created;                 // 创建时间 (秒)
+    alin_state_counter_t checkpoints;    // 检查点次数
+    alin_state_counter_t checkpointed;   // 最近一次检查点的时间 (秒)
+} alin_state_header_t;
+
+// 打开失败的原因
+enum {
+    ALIN_STATE_OK = 0,
+    ALIN_STATE_ERROR,                // 无法创建、扩展或映射
+    ALIN_STATE_FOREIGN,              // 文件非空但不是状态文件 (如旧的文本格式)
+    ALIN_STATE_MISMATCH              // 其他种类节点的状态文件
+};
+
+typedef struct {
+    alin_state_header_t* header;     // NULL 表示未打开
+    void* body;
+    size_t map_size;
+    uint32_t version;                // 打开前文件中的布局版本 (0 表示新建)
+    int error;                       // 打开失败的原因
+    int64_t sync_ns;                 // 检查点间隔 (0 表示每次更新都同步)
+    int64_t last_sync;
+    long dirty;                      // 上次检查点以来的更新次数
+} alin_state_t;
+
+/**
+ * 打开 (不存在时创建) 状态文件并映射
+ * @param kind 节点种类，与文件中记录的不同时拒绝打开
+ * @param version 本程序的布局版本
+ * @param body_size 本程序的状态体长度 (文件更短时扩展，新增部分为 0)
+ * @return 状态体, NULL 表示失败 (原因见 st->error)
+ */
+void* alin_state_open(alin_state_t* st, const char* path, const char* kind, uint32_t version, size_t body_size);
+
+/**
+ * 读取已有状态文件的快照 (供 --dump-state 等外部读者使用，不修改文件)
+ * 文件中的状态体比 body_size 短时其余部分填 0，更长时只取前缀
+ * @param header 非 NULL 时同时取回头部
+ * @return ALIN_STATE_OK 或失败原因
+ */
+int alin_state_read(const char* path, const char* kind, void* body, size_t body_size, alin_state_header_t* header);
+
+/**
+ * 检查点: 把映射中的修改写回文件 (msync MS_SYNC)
+ */
+void alin_state_checkpoint(alin_state_t* st);
+
+/**
+ * 更新后调用，按检查点策略决定是否同步
+ */
+void alin_state_touch(alin_state_t* st);
+
+/**
+ * 同步并解除映射
+ */
+void alin_state_close(alin_state_t* st);
+
+static inline void alin_state_add(alin_state_counter_t* c, int64_t n) {
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static inline int64_t alin_state_load(alin_state_counter_t* c) {
+    return atomic_load_explicit(c, memory_order_relaxed);
+}
+
+#endif
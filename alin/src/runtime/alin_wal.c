@@ -0,0 +1,359 @@
+/**
+ * ALIN 预写日志 + 快照实现 (见 alin_wal.h)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "alin_wal.h"
+
+typedef struct {
+    uint64_t magic;
+    char kind[ALIN_WAL_KIND_MAX];
+    uint32_t version;
+    uint32_t reserved;
+} wal_header_t;
+
+typedef struct {
+    uint64_t magic;
+    char kind[ALIN_WAL_KIND_MAX];
+    uint32_t version;
+    uint32_t crc;                    // 状态的 CRC32
+    uint64_t seq;                    // 快照包含的最后一个序号
+    uint64_t size;                   // 状态长度
+} snap_header_t;
+
+// 记录按 8 字节对齐存放 (增量补零)
+typedef struct {
+    uint32_t len;                    // 增量长度 (不含补齐)
+    uint32_t crc;                    // 序号与增量的 CRC32
+    uint64_t seq;
+} record_header_t;
+
+#define PAD8(n) (((n) + 7) & ~(size_t)7)
+
+// ===== CRC32 (IEEE 802.3) =====
+
+static uint32_t crc_table[256];
+static int crc_ready = 0;
+
+static uint32_t crc32_update(uint32_t crc, const void* data, size_t len) {
+    if (!crc_ready) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            crc_table[i] = c;
+        }
+        crc_ready = 1;
+    }
+    const unsigned char* p = data;
+    crc = ~crc;
+    while (len--) crc = crc_table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static uint32_t record_crc(uint64_t seq, const void* delta, size_t len) {
+    return crc32_update(crc32_update(0, &seq, sizeof(seq)), delta, len);
+}
+
+static int64_t monotonic_ns() {
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int write_all(int fd, const void* data, size_t len) {
+    const char* p = data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * 同步文件所在的目录 (rename 之后，保证新的目录项落盘)
+ */
+static void sync_parent(const char* path) {
+    char dir[ALIN_WAL_PATH_MAX];
+    snprintf(dir, sizeof(dir), "%s", path);
+    char* slash = strrchr(dir, '/');
+    if (slash == dir) dir[1] = '\0';
+    else if (slash) *slash = '\0';
+    else snprintf(dir, sizeof(dir), ".");
+    int fd = open(dir, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+// ===== 恢复 =====
+
+/**
+ * 读入快照 (不存在时状态保持为 0，*seq 为 0)
+ * @return 0 成功, -1 种类不符或校验失败
+ */
+static int load_snapshot(const char* path, const char* kind, void* state, size_t state_size, uint64_t* seq) {
+    *seq = 0;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return errno == ENOENT ? 0 : -1;
+
+    snap_header_t h;
+    int rc = -1;
+    if (read(fd, &h, sizeof(h)) == (ssize_t)sizeof(h) && h.magic == ALIN_SNAP_MAGIC &&
+        strncmp(h.kind, kind, ALIN_WAL_KIND_MAX) == 0 && h.size <= ((uint64_t)1 << 32)) {
+        char* body = malloc(h.size ? h.size : 1);
+        if (body && pread(fd, body, h.size, sizeof(h)) == (ssize_t)h.size &&
+            crc32_update(0, body, h.size) == h.crc) {
+            memcpy(state, body, h.size < state_size ? h.size : state_size);
+            *seq = h.seq;
+            rc = 0;
+        }
+        free(body);
+    }
+    close(fd);
+    if (rc < 0) fprintf(stderr, "[WAL] %s is not a valid %s snapshot\n", path, kind);
+    return rc;
+}
+
+/**
+ * 重放 WAL 中序号大于 after 的记录，遇到残缺或校验失败的记录时停止
+ * @param end 有效内容的结尾 (其后为残缺部分)
+ * @return 0 成功, -1 不是该种类的 WAL
+ */
+static int replay(int fd, const char* kind, void* state, alin_wal_apply_fn apply, uint64_t after,
+                  uint64_t* seq, uint64_t* end, uint64_t* replayed) {
+    struct stat sb;
+    if (fstat(fd, &sb) < 0) return -1;
+    size_t size = (size_t)sb.st_size;
+    if (size < sizeof(wal_header_t)) {
+        *end = 0;
+        return 0;
+    }
+    const char* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) return -1;
+
+    wal_header_t h;
+    memcpy(&h, data, sizeof(h));
+    if (h.magic != ALIN_WAL_MAGIC || strncmp(h.kind, kind, ALIN_WAL_KIND_MAX) != 0) {
+        munmap((void*)data, size);
+        return -1;
+    }
+
+    size_t off = sizeof(h);
+    while (off + sizeof(record_header_t) <= size) {
+        record_header_t r;
+        memcpy(&r, data + off, sizeof(r));
+        size_t next = off + sizeof(r) + PAD8((size_t)r.len);
+        if (r.len > ALIN_WAL_DELTA_MAX || next > size) break;
+        const char* delta = data + off + sizeof(r);
+        if (record_crc(r.seq, delta, r.len) != r.crc) break;
+        if (r.seq > after) {
+            apply(state, delta, r.len);
+            (*replayed)++;
+        }
+        if (r.seq > *seq) *seq = r.seq;
+        off = next;
+    }
+    *end = off;
+    munmap((void*)data, size);
+    return 0;
+}
+
+// ===== 打开与关闭 =====
+
+int alin_wal_open(alin_wal_t* w, const char* path, const char* kind, uint32_t version,
+                  void* state, size_t state_size, alin_wal_apply_fn apply) {
+    memset(w, 0, sizeof(*w));
+    w->fd = -1;
+    snprintf(w->wal_path, sizeof(w->wal_path), "%s.wal", path);
+    snprintf(w->snap_path, sizeof(w->snap_path), "%s.snap", path);
+    snprintf(w->kind, sizeof(w->kind), "%s", kind);
+    w->version = version;
+    w->state = state;
+    w->state_size = state_size;
+    w->apply = apply;
+
+    const char* env = getenv("ALIN_WAL_GROUP");
+    w->group = env && atol(env) > 0 ? atol(env) : 256;
+    env = getenv("ALIN_WAL_COMMIT_MS");
+    w->commit_ns = (int64_t)(env && env[0] ? atol(env) : 10) * 1000000;
+    env = getenv("ALIN_WAL_SNAPSHOT_KB");
+    w->snapshot_size = (uint64_t)(env && atol(env) > 0 ? atol(env) : 4096) << 10;
+    env = getenv("ALIN_WAL_SYNC");
+    w->sync = !(env && strcmp(env, "0") == 0);
+
+    if (load_snapshot(w->snap_path, kind, state, state_size, &w->snapshot_seq) < 0) return -1;
+    w->seq = w->snapshot_seq;
+
+    int fd = open(w->wal_path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "[WAL] Cannot open %s: %s\n", w->wal_path, strerror(errno));
+        return -1;
+    }
+    struct stat sb;
+    uint64_t end = 0;
+    if (fstat(fd, &sb) < 0 || replay(fd, kind, state, apply, w->snapshot_seq, &w->seq, &end, &w->replayed) < 0) {
+        fprintf(stderr, "[WAL] %s is not a %s write-ahead log\n", w->wal_path, kind);
+        close(fd);
+        return -1;
+    }
+
+    if (end == 0) {
+        wal_header_t h = { ALIN_WAL_MAGIC, "", version, 0 };
+        snprintf(h.kind, sizeof(h.kind), "%s", kind);
+        if (ftruncate(fd, 0) < 0 || pwrite(fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h)) {
+            fprintf(stderr, "[WAL] Cannot initialize %s: %s\n", w->wal_path, strerror(errno));
+            close(fd);
+            return -1;
+        }
+        end = sizeof(h);
+    } else if (end < (uint64_t)sb.st_size) {
+        // 写入一半时崩溃留下的残缺记录
+        w->truncated = (uint64_t)sb.st_size - end;
+        if (ftruncate(fd, (off_t)end) < 0) {
+            close(fd);
+            return -1;
+        }
+    }
+    lseek(fd, (off_t)end, SEEK_SET);
+    w->fd = fd;
+    w->wal_size = end;
+
+    if (w->replayed > 0 || w->truncated > 0) {
+        fprintf(stderr, "[WAL] Recovered %s: snapshot at #%llu + %llu replayed records%s\n", kind,
+            (unsigned long long)w->snapshot_seq, (unsigned long long)w->replayed,
+            w->truncated ? " (torn tail dropped)" : "");
+    }
+    return 0;
+}
+
+int alin_wal_read(const char* path, const char* kind, void* state, size_t state_size, alin_wal_apply_fn apply) {
+    char wal_path[ALIN_WAL_PATH_MAX], snap_path[ALIN_WAL_PATH_MAX];
+    snprintf(wal_path, sizeof(wal_path), "%s.wal", path);
+    snprintf(snap_path, sizeof(snap_path), "%s.snap", path);
+    memset(state, 0, state_size);
+
+    uint64_t snapshot_seq, seq, end, replayed = 0;
+    if (load_snapshot(snap_path, kind, state, state_size, &snapshot_seq) < 0) return -1;
+    int found = access(snap_path, F_OK) == 0;
+    seq = snapshot_seq;
+    int fd = open(wal_path, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        if (replay(fd, kind, state, apply, snapshot_seq, &seq, &end, &replayed) == 0) found = 1;
+        close(fd);
+    }
+    return found ? 0 : -1;
+}
+
+// ===== 更新与提交 =====
+
+int alin_wal_update(alin_wal_t* w, const void* delta, size_t len) {
+    w->apply(w->state, delta, len);
+    if (w->fd < 0) return 0;
+    if (len > ALIN_WAL_DELTA_MAX) return -1;
+
+    size_t need = sizeof(record_header_t) + PAD8(len);
+    if (w->used + need > w->cap) {
+        size_t cap = w->cap ? w->cap : 65536;
+        while (w->used + need > cap) cap *= 2;
+        char* buf = realloc(w->buf, cap);
+        if (!buf) return -1;
+        w->buf = buf;
+        w->cap = cap;
+    }
+    record_header_t r = { (uint32_t)len, 0, ++w->seq };
+    r.crc = record_crc(r.seq, delta, len);
+    char* p = w->buf + w->used;
+    memcpy(p, &r, sizeof(r));
+    memcpy(p + sizeof(r), delta, len);
+    memset(p + sizeof(r) + len, 0, PAD8(len) - len);
+    w->used += need;
+
+    int64_t now = monotonic_ns();
+    if (w->pending++ == 0) w->group_start = now;
+    if (w->pending >= w->group || now - w->group_start >= w->commit_ns) return alin_wal_commit(w);
+    return 0;
+}
+
+int alin_wal_commit(alin_wal_t* w) {
+    if (w->fd < 0 || w->pending == 0) return 0;
+    if (write_all(w->fd, w->buf, w->used) < 0 || (w->sync && fdatasync(w->fd) < 0)) {
+        // 去掉可能写了一半的组，下次连同新的记录一起重试
+        fprintf(stderr, "[WAL] Commit to %s failed: %s\n", w->wal_path, strerror(errno));
+        if (ftruncate(w->fd, (off_t)w->wal_size) == 0) lseek(w->fd, (off_t)w->wal_size, SEEK_SET);
+        return -1;
+    }
+    w->wal_size += w->used;
+    w->used = 0;
+    w->pending = 0;
+    w->commits++;
+    if (w->wal_size >= w->snapshot_size) return alin_wal_snapshot(w);
+    return 0;
+}
+
+int alin_wal_snapshot(alin_wal_t* w) {
+    if (w->fd < 0) return -1;
+    if (w->pending > 0 && alin_wal_commit(w) < 0) return -1;
+    if (w->seq == w->snapshot_seq) return 0;
+
+    char tmp[ALIN_WAL_PATH_MAX + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", w->snap_path);
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "[WAL] Cannot create %s: %s\n", tmp, strerror(errno));
+        return -1;
+    }
+    snap_header_t h = { ALIN_SNAP_MAGIC, "", w->version, 0, w->seq, w->state_size };
+    snprintf(h.kind, sizeof(h.kind), "%s", w->kind);
+    h.crc = crc32_update(0, w->state, w->state_size);
+    if (write_all(fd, &h, sizeof(h)) < 0 || write_all(fd, w->state, w->state_size) < 0 || fsync(fd) < 0) {
+        fprintf(stderr, "[WAL] Cannot write %s: %s\n", tmp, strerror(errno));
+        close(fd);
+        unlink(tmp);
+        return -1;
+    }
+    close(fd);
+    if (rename(tmp, w->snap_path) < 0) {
+        unlink(tmp);
+        return -1;
+    }
+    sync_parent(w->snap_path);
+
+    // 快照已落盘: WAL 只留头部 (截断失败也无妨，重放时跳过快照已包含的序号)
+    if (ftruncate(w->fd, sizeof(wal_header_t)) == 0) {
+        lseek(w->fd, sizeof(wal_header_t), SEEK_SET);
+        w->wal_size = sizeof(wal_header_t);
+        if (w->sync) fdatasync(w->fd);
+    }
+    w->snapshot_seq = w->seq;
+    w->snapshots++;
+    return 0;
+}
+
+void alin_wal_close(alin_wal_t* w) {
+    if (w->fd < 0) return;
+    alin_wal_snapshot(w);
+    close(w->fd);
+    w->fd = -1;
+    free(w->buf);
+    w->buf = NULL;
+    w->used = w->cap = 0;
+}
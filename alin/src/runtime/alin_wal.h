@@ -0,0 +1,109 @@
+/**
+ * ALIN 预写日志 + 快照 (Write-Ahead Log & Snapshot)
+ *
+ * 有状态节点的另一种持久化方式: 状态保存在进程内存中 (定长的一块)，每次更新只把增量
+ * 追加到 WAL，定期把整块状态压缩为快照; 启动时在最近的快照上重放 WAL 恢复状态。
+ *
+ *   <路径>.wal   头部 (magic、种类、布局版本) + 记录 [长度 u32][CRC32 u32][序号 u64][增量]
+ *   <路径>.snap  头部 (magic、种类、布局版本、序号、长度、CRC32) + 状态
+ *
+ * 更新: alin_wal_update() 先把增量交给节点的 apply 回调作用到内存中的状态，再追加到组缓冲;
+ *       重放时用同一个回调，恢复出的状态与崩溃前完全一致
+ * 组提交: 一组增量一次 write + fdatasync，满 ALIN_WAL_GROUP 条 (默认 256)、组内首条等待超过
+ *       ALIN_WAL_COMMIT_MS (默认 10) 或节点即将阻塞等待输入 (alin_set_idle_hook) 时提交;
+ *       崩溃至多丢失未提交的一组。ALIN_WAL_SYNC=0 时只 write 不同步 (只防进程崩溃)
+ * 快照: WAL 超过 ALIN_WAL_SNAPSHOT_KB (默认 4096) 时把状态写入临时文件、同步后 rename 覆盖快照，
+ *       再把 WAL 截断为只剩头部; 截断前崩溃时 WAL 中序号不大于快照的记录在重放时跳过
+ * 恢复: 快照校验失败时拒绝打开; WAL 末尾的残缺记录 (写入一半时崩溃) 截去，之前的记录照常重放
+ * 版本: 状态只在末尾追加字段 (同 alin_state)，较短的快照读入前缀，其余为 0
+ */
+
+#ifndef ALIN_WAL_H
+#define ALIN_WAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ALIN_WAL_MAGIC 0x314c574e494c41ull      // "ALINWL1"
+#define ALIN_SNAP_MAGIC 0x31534e4e494c41ull     // "ALINNS1"
+#define ALIN_WAL_KIND_MAX 32
+#define ALIN_WAL_PATH_MAX 1040
+#define ALIN_WAL_DELTA_MAX 65536                // 单条增量的上限
+
+/**
+ * 把一条增量作用到状态上 (更新与重放共用)
+ */
+typedef void (*alin_wal_apply_fn)(void* state, const void* delta, size_t len);
+
+typedef struct {
+    char wal_path[ALIN_WAL_PATH_MAX];
+    char snap_path[ALIN_WAL_PATH_MAX];
+    char kind[ALIN_WAL_KIND_MAX];
+    uint32_t version;
+    int fd;                          // WAL (-1 表示未打开)
+    void* state;
+    size_t state_size;
+    alin_wal_apply_fn apply;
+
+    // 组缓冲: 尚未提交的记录
+    char* buf;
+    size_t used;
+    size_t cap;
+    long pending;
+    int64_t group_start;
+
+    uint64_t seq;                    // 最近一条增量的序号
+    uint64_t snapshot_seq;           // 快照包含的最后一个序号
+    uint64_t wal_size;               // WAL 文件长度
+
+    // 策略
+    long group;
+    int64_t commit_ns;
+    uint64_t snapshot_size;
+    int sync;
+
+    // 统计
+    uint64_t commits;
+    uint64_t snapshots;
+    uint64_t replayed;               // 启动时重放的记录数
+    uint64_t truncated;              // 启动时截去的残缺字节数
+} alin_wal_t;
+
+/**
+ * 打开 WAL 与快照并恢复状态: state (调用方清零) 读入快照后重放其后的 WAL 记录
+ * @param path 路径前缀 (文件为 <path>.wal 与 <path>.snap)
+ * @return 0 成功, -1 失败 (种类不符、快照损坏或无法创建)
+ */
+int alin_wal_open(alin_wal_t* w, const char* path, const char* kind, uint32_t version,
+                  void* state, size_t state_size, alin_wal_apply_fn apply);
+
+/**
+ * 只读恢复 (供 --dump-state 等外部读者使用，不修改文件、不截去残缺记录)
+ * @return 0 成功, -1 没有可用的状态
+ */
+int alin_wal_read(const char* path, const char* kind, void* state, size_t state_size, alin_wal_apply_fn apply);
+
+/**
+ * 更新状态: 作用增量并追加到组缓冲，按组提交策略提交
+ * @return 0 成功, -1 写入失败 (状态已更新，只是未能持久化)
+ */
+int alin_wal_update(alin_wal_t* w, const void* delta, size_t len);
+
+/**
+ * 提交组缓冲中的记录 (write + fdatasync)，WAL 过长时接着做快照
+ * @return 0 成功, -1 失败
+ */
+int alin_wal_commit(alin_wal_t* w);
+
+/**
+ * 把当前状态写为快照并截断 WAL (先提交组缓冲)
+ * @return 0 成功, -1 失败
+ */
+int alin_wal_snapshot(alin_wal_t* w);
+
+/**
+ * 提交、压缩为快照并关闭
+ */
+void alin_wal_close(alin_wal_t* w);
+
+#endif
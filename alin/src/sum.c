@@ -11,47 +11,9 @@
 #include <string.h>
 #include <ctype.h>
 
-#define MAX_INPUT_SIZE 65536
-#define MAX_NUMBERS 1024
+#include "alin_node.h"
 
-/**
- * 从 stdin 读取全部输入
- */
-int read_stdin(char* buffer, size_t max_size) {
-    size_t total = 0;
-    int c;
-    while ((c = getchar()) != EOF && total < max_size - 1) {
-        buffer[total++] = (char)c;
-    }
-    buffer[total] = '\0';
-    return (int)total;
-}
-
-/**
- * 去除字符串首尾空白
- */
-void trim(char* str) {
-    char* start = str;
-    char* end;
-    
-    while (*start == ' ' || *start == '\n' || *start == '\r' || *start == '\t') {
-        start++;
-    }
-    
-    if (*start == '\0') {
-        str[0] = '\0';
-        return;
-    }
-    
-    end = start + strlen(start) - 1;
-    while (end > start && (*end == ' ' || *end == '\n' || *end == '\r' || *end == '\t')) {
-        end--;
-    }
-    
-    size_t len = end - start + 1;
-    memmove(str, start, len);
-    str[len] = '\0';
-}
+#define MAX_NUMBERS 1024
 
 /**
  * 简单解析 JSON 数组中的数字
@@ -110,22 +72,5 @@ int process(const char* input, char* output, size_t output_size) {
 }
 
 int main(int argc, char* argv[]) {
-    char input[MAX_INPUT_SIZE];
-    char output[MAX_INPUT_SIZE];
-    
-    if (read_stdin(input, MAX_INPUT_SIZE) <= 0) {
-        fprintf(stderr, "Error: No input received\n");
-        return 1;
-    }
-    
-    trim(input);
-    
-    if (process(input, output, MAX_INPUT_SIZE) != 0) {
-        fprintf(stderr, "Error: Processing failed\n");
-        return 1;
-    }
-    
-    printf("%s\n", output);
-    
-    return 0;
+    return alin_node_main(argc, argv, process, ALIN_NODE_REQUIRE_INPUT);
 }
@@ -0,0 +1,199 @@
+/**
+ * ALIN JSON 字段索引测试 (JSON Index Tests)
+ *
+ * - 宽记录: 超过 ALIN_JSON_MAX_FIELDS 个成员时靠后的字段仍可查 (退回扫描记录)
+ * - 嵌套对象: 点分路径、跨越索引上限的嵌套成员、满表时仍在展开的对象长度
+ * - 转义: 字符串值与键中的引号、反斜杠不会提前结束扫描，取值时反转义
+ * - 不完整的记录: 已编入的字段照常可查，残缺部分查不到且不越界
+ * - 字段表往返: pack/unpack 之后满表的索引同样退回扫描
+ *
+ * 使用方式:
+ *   make test
+ *   alin/bin/alin_test_json
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alin_json.h"
+
+static int passed = 0;
+static int failed = 0;
+
+#define CHECK(cond) do { \
+    if (cond) passed++; \
+    else { failed++; fprintf(stderr, "❌ %s:%d: %s\n", __FILE__, __LINE__, #cond); } \
+} while (0)
+
+static int string_is(const alin_json_t* doc, const char* path, const char* expected) {
+    char value[256];
+    return alin_json_string(doc, path, value, sizeof(value)) && strcmp(value, expected) == 0;
+}
+
+/**
+ * {"f0":0,"f1":1,...,"f<n-1>":<n-1>,<tail>}
+ */
+static char* wide_record(int n, const char* tail) {
+    size_t size = (size_t)n * 24 + strlen(tail) + 8;
+    char* json = malloc(size);
+    size_t pos = 0;
+    json[pos++] = '{';
+    for (int i = 0; i < n; i++) pos += (size_t)snprintf(json + pos, size - pos, "\"f%d\":%d,", i, i);
+    snprintf(json + pos, size - pos, "%s}", tail);
+    return json;
+}
+
+static void test_wide(void) {
+    char* json = wide_record(100, "\"level\":\"ERROR\",\"msg\":\"late \\\"quoted\\\"\"");
+    alin_json_t doc;
+    CHECK(alin_json_index(&doc, json) == ALIN_JSON_MAX_FIELDS);
+    CHECK(doc.overflow);
+    CHECK(alin_json_long(&doc, "f0") == 0);
+    CHECK(alin_json_long(&doc, "f63") == 63);
+    CHECK(alin_json_long(&doc, "f64") == 64);
+    CHECK(alin_json_long(&doc, "f99") == 99);
+    CHECK(string_is(&doc, "level", "ERROR"));
+    CHECK(string_is(&doc, "msg", "late \"quoted\""));
+    CHECK(alin_json_find(&doc, "missing") == NULL);
+    CHECK(alin_json_find(&doc, "f1.x") == NULL);
+
+    // 扫描结果轮流存放: 最近 ALIN_JSON_MAX_FOUND 次查找的结果同时有效
+    const alin_json_field_t* found[ALIN_JSON_MAX_FOUND];
+    char path[16];
+    for (int i = 0; i < ALIN_JSON_MAX_FOUND; i++) {
+        snprintf(path, sizeof(path), "f%d", 70 + i);
+        found[i] = alin_json_find(&doc, path);
+    }
+    for (int i = 0; i < ALIN_JSON_MAX_FOUND; i++) {
+        CHECK(found[i] && atoi(found[i]->value) == 70 + i);
+    }
+    free(json);
+
+    // 恰好 ALIN_JSON_MAX_FIELDS 个成员: 没有溢出
+    json = wide_record(ALIN_JSON_MAX_FIELDS - 1, "\"last\":true");
+    CHECK(alin_json_index(&doc, json) == ALIN_JSON_MAX_FIELDS);
+    CHECK(!doc.overflow);
+    CHECK(alin_json_find(&doc, "last")->type == ALIN_JSON_TRUE);
+    free(json);
+}
+
+static void test_nested(void) {
+    alin_json_t doc;
+    const char* json = "{\"_agg\":{\"total\":42,\"by_level\":{\"ERROR\":3}},\"tags\":[{\"a\":1}],\"a\":2}";
+    CHECK(alin_json_index(&doc, json) == 6);
+    CHECK(!doc.overflow);
+    CHECK(alin_json_long(&doc, "_agg.total") == 42);
+    CHECK(alin_json_long(&doc, "_agg.by_level.ERROR") == 3);
+    CHECK(alin_json_long(&doc, "a") == 2);
+    CHECK(alin_json_find(&doc, "_agg.a") == NULL);
+    CHECK(alin_json_find(&doc, "tags")->type == ALIN_JSON_ARRAY);
+    const alin_json_field_t* agg = alin_json_find(&doc, "_agg");
+    CHECK(agg->value_len == strlen("{\"total\":42,\"by_level\":{\"ERROR\":3}}"));
+
+    // 嵌套对象跨越索引上限: 已编入的前半可查，其余退回扫描，对象长度按原文补上
+    char* json2 = wide_record(60, "\"obj\":{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":{\"x\":\"deep\"}},\"after\":7");
+    CHECK(alin_json_index(&doc, json2) == ALIN_JSON_MAX_FIELDS);
+    CHECK(doc.overflow);
+    CHECK(alin_json_long(&doc, "obj.a") == 1);
+    CHECK(alin_json_long(&doc, "obj.d") == 4);
+    CHECK(string_is(&doc, "obj.e.x", "deep"));
+    CHECK(alin_json_long(&doc, "after") == 7);
+    CHECK(alin_json_find(&doc, "obj.x") == NULL);
+    CHECK(alin_json_find(&doc, "obj.a.b") == NULL);
+    agg = alin_json_find(&doc, "obj");
+    CHECK(agg->value_len == strlen("{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":{\"x\":\"deep\"}}"));
+    free(json2);
+}
+
+static void test_escaped(void) {
+    alin_json_t doc;
+    const char* json = "{\"msg\":\"say \\\"level\\\":\\\"ERROR\\\" \\\\ \\u00e9\\n\",\"le\\\"vel\":1,\"level\":\"INFO\"}";
+    CHECK(alin_json_index(&doc, json) == 3);
+    CHECK(string_is(&doc, "level", "INFO"));
+    CHECK(string_is(&doc, "msg", "say \"level\":\"ERROR\" \\ \xc3\xa9\n"));
+    CHECK(alin_json_find(&doc, "msg")->escaped);
+
+    // 同样的内容排在索引上限之后
+    char* wide = wide_record(70, "\"msg\":\"say \\\"level\\\":\\\"ERROR\\\"\",\"level\":\"WARN\"");
+    CHECK(alin_json_index(&doc, wide) == ALIN_JSON_MAX_FIELDS);
+    CHECK(string_is(&doc, "level", "WARN"));
+    CHECK(string_is(&doc, "msg", "say \"level\":\"ERROR\""));
+    free(wide);
+}
+
+static void test_truncated(void) {
+    alin_json_t doc;
+    CHECK(alin_json_index(&doc, "{\"level\":\"ERROR\",\"msg\":\"cut") == 1);
+    CHECK(string_is(&doc, "level", "ERROR"));
+    CHECK(alin_json_find(&doc, "msg") == NULL);
+    CHECK(alin_json_index(&doc, "{\"a\":{\"b\":1,\"c\":") == 2);
+    CHECK(alin_json_long(&doc, "a.b") == 1);
+    CHECK(alin_json_find(&doc, "a")->value_len == 0);
+    CHECK(alin_json_index(&doc, "not json") == -1);
+    CHECK(alin_json_index(&doc, "{") == 0);
+
+    // 宽记录在索引上限之后被截断: 扫描不越过结尾
+    char* wide = wide_record(80, "\"level\":\"ERROR\"");
+    char* cut = strstr(wide, "\"f75\"");
+    strcpy(cut, "\"f75\":75,\"msg\":\"cut \\");
+    CHECK(alin_json_index(&doc, wide) == ALIN_JSON_MAX_FIELDS);
+    CHECK(alin_json_long(&doc, "f75") == 75);
+    CHECK(alin_json_find(&doc, "msg") == NULL);
+    CHECK(alin_json_find(&doc, "level") == NULL);
+    strcpy(cut, "\"f75\":{\"x\":[1,");
+    CHECK(alin_json_find(&doc, "f75.x") == NULL);
+    CHECK(alin_json_find(&doc, "f75.y") == NULL);
+    free(wide);
+}
+
+static void test_pack(void) {
+    char* json = wide_record(90, "\"level\":\"ERROR\"");
+    alin_json_t doc, copy;
+    alin_fields_t fields;
+    alin_json_index(&doc, json);
+    CHECK(alin_json_pack(&doc, &fields) == ALIN_JSON_MAX_FIELDS);
+    CHECK(alin_json_unpack(&copy, json, strlen(json), &fields) == ALIN_JSON_MAX_FIELDS);
+    CHECK(copy.overflow);
+    CHECK(string_is(&copy, "level", "ERROR"));
+    CHECK(alin_json_long(&copy, "f89") == 89);
+    free(json);
+
+    const char* small = "{\"level\":\"INFO\"}";
+    alin_json_index(&doc, small);
+    alin_json_pack(&doc, &fields);
+    CHECK(alin_json_unpack(&copy, small, strlen(small), &fields) == 1);
+    CHECK(!copy.overflow);
+
+    // alin_json_add 写满后同样记下溢出
+    char* built = wide_record(70, "\"level\":\"DEBUG\"");
+    alin_json_t out;
+    out.json = built;
+    out.count = 0;
+    out.overflow = 0;
+    out.found_next = 0;
+    for (int i = 0; i < 70; i++) {
+        char key[8];
+        int key_len = snprintf(key, sizeof(key), "\"f%d\"", i);
+        const char* k = strstr(built, key) + 1;
+        if (alin_json_add(&out, k, (size_t)key_len - 2, k + key_len, 1, ALIN_JSON_NUMBER, -1) < 0) break;
+    }
+    CHECK(out.count == ALIN_JSON_MAX_FIELDS && out.overflow);
+    CHECK(string_is(&out, "level", "DEBUG"));
+    free(built);
+}
+
+int main(void) {
+    test_wide();
+    test_nested();
+    test_escaped();
+    test_truncated();
+    test_pack();
+
+    if (failed) {
+        printf("test_json: %d failed, %d passed\n", failed, passed);
+        return 1;
+    }
+    printf("test_json: %d passed\n", passed);
+    return 0;
+}
@@ -5,6 +5,9 @@
  * - 模拟实时事件流
  * - 更新统计数据
  * - 热切换控制
+ * - 实时指标: 轮询同目录下的 metrics.json (alin/bin/alin_exporter -o docs/metrics.json 生成)，
+ *   存在时停止模拟，改为显示运行器中各节点的吞吐与 p99 延迟
+ *   (需经 HTTP 访问，如 python3 -m http.server -d docs)
  */
 
 // State
@@ -20,9 +23,15 @@ const state = {
     filterLevel: 'WARN',
     threshold: 10,
     events: [],
-    startTime: Date.now()
+    startTime: Date.now(),
+    live: false,
+    simulation: null
 };
 
+// 指标快照中的槽位名 → 拓扑中的节点框 (按名称中的关键字匹配)
+const METRICS_URL = 'metrics.json';
+const METRICS_NODES = { parse: 'parser', filter: 'filter', agg: 'agg', alert: 'alert' };
+
 // Sample messages for simulation
 const MESSAGES = {
     ERROR: [
@@ -178,6 +187,50 @@ function updateTopology() {
     document.getElementById('inode-alert').textContent = randomInode();
 }
 
+function formatLatency(ns) {
+    if (ns < 1000) return `${ns}ns`;
+    if (ns < 1e6) return `${(ns / 1e3).toFixed(1)}us`;
+    if (ns < 1e9) return `${(ns / 1e6).toFixed(2)}ms`;
+    return `${(ns / 1e9).toFixed(2)}s`;
+}
+
+// Apply a metrics snapshot from alin_exporter
+function applyMetrics(snapshot) {
+    const stages = snapshot.stages || [];
+    if (stages.length === 0) return;
+
+    // 槽位按名称排序，第一个即管道入口
+    elements.totalEvents.textContent = stages[0].processed.toLocaleString();
+    elements.eventRate.textContent = stages[0].rate.toFixed(1);
+
+    // 同一类节点出现多次 (如分叉内外各有一个过滤器) 时显示最慢的
+    const worst = {};
+    for (const stage of stages) {
+        const key = Object.keys(METRICS_NODES).find(k => stage.name.includes(k));
+        if (!key) continue;
+        const p99 = stage.latency_ns.p99;
+        if (!(key in worst) || p99 > worst[key]) worst[key] = p99;
+    }
+    for (const [key, id] of Object.entries(METRICS_NODES)) {
+        document.getElementById(`p99-${id}`).textContent = key in worst ? formatLatency(worst[key]) : '--';
+    }
+}
+
+// Poll metrics.json; switch to live mode on the first snapshot
+function pollMetrics() {
+    fetch(METRICS_URL, { cache: 'no-store' })
+        .then(res => res.ok ? res.json() : null)
+        .then(snapshot => {
+            if (!snapshot) return;
+            if (!state.live) {
+                state.live = true;
+                clearInterval(state.simulation);
+            }
+            applyMetrics(snapshot);
+        })
+        .catch(() => {});
+}
+
 // Event handlers
 function setupEventHandlers() {
     // Level filter buttons
@@ -226,7 +279,7 @@ function setupEventHandlers() {
 
 // Auto-generate events
 function startAutoGeneration() {
-    setInterval(() => {
+    state.simulation = setInterval(() => {
         // Random chance to generate event
         if (Math.random() < 0.3) {
             addEvent(generateEvent());
@@ -239,6 +292,8 @@ function init() {
     updateTopology();
     setupEventHandlers();
     startAutoGeneration();
+    pollMetrics();
+    setInterval(pollMetrics, 1000);
 
     // Initial events
     for (let i = 0; i < 5; i++) {
@@ -14,6 +14,9 @@
 #   ./alin_link.sh health_check 01_dbl
 #   ./alin_link.sh rollback 01_dbl
 #   ./alin_link.sh list
+#
+# 分叉槽位中的链接以相对路径作为别名，例如:
+#   ./alin_link.sh swap_logic 02_fork/a_alert/01_filter filter_level
 
 set -e
 
@@ -80,7 +83,7 @@ cmd_swap_logic() {
     # 备份当前链接
     if [ -L "$link_path" ]; then
         local current=$(readlink "$link_path")
-        echo "$current" > "$BACKUP_DIR/${alias}.prev"
+        echo "$current" > "$BACKUP_DIR/${alias//\//__}.prev"
         log_info "Backed up previous link: $(basename "$current")"
     fi
     
@@ -133,7 +136,7 @@ cmd_rollback() {
         log_error "Usage: rollback <alias>"
     fi
     
-    local backup_file="$BACKUP_DIR/${alias}.prev"
+    local backup_file="$BACKUP_DIR/${alias//\//__}.prev"
     
     if [ ! -f "$backup_file" ]; then
         log_error "No backup found for: $alias"
@@ -165,17 +168,31 @@ cmd_list() {
     printf "%-20s %-30s %s\n" "ALIAS" "TARGET" "INODE"
     printf "%-20s %-30s %s\n" "-----" "------" "-----"
     
-    for link in $(ls -1 "$ACTIVE_DIR" | sort); do
-        local link_path="$ACTIVE_DIR/$link"
-        if [ -L "$link_path" ]; then
+    list_slots "$ACTIVE_DIR" ""
+    
+    echo ""
+}
+
+# 逐级列出槽位，分叉目录递归展开其分支
+list_slots() {
+    local dir="$1"
+    local prefix="$2"
+    local link branch
+    
+    for link in $(ls -1 "$dir" | sort); do
+        local link_path="$dir/$link"
+        if [ -d "$link_path" ]; then
+            printf "%-20s %s\n" "$prefix$link" "(fork)"
+            for branch in $(ls -1 "$link_path" | sort); do
+                [ -d "$link_path/$branch" ] && list_slots "$link_path/$branch" "$prefix$link/$branch/"
+            done
+        elif [ -L "$link_path" ]; then
             local target=$(readlink "$link_path")
             local target_name=$(basename "$target")
             local inode=$(ls -i "$target" 2>/dev/null | awk '{print $1}')
-            printf "%-20s %-30s %s\n" "$link" "$target_name" "$inode"
+            printf "%-20s %-30s %s\n" "$prefix$link" "$target_name" "$inode"
         fi
     done
-    
-    echo ""
 }
 
 # 列出可用节点
@@ -36,27 +36,53 @@ echo ">> Resetting Active Logic Gates..."
 # rm -f $ACTIVE_DIR/* 
 
 # 3. 开始逐个插槽“烧录” (Routing)
-jq -r '.topology | to_entries[] | "\(.key) \(.value)"' "$BITSTREAM" | while read -r slot logic_id; do
-    
-    # 在 Nodes 仓库中寻找对应的二进制 (支持模糊匹配 name_hash)
-    # 逻辑：找到最新的那个版本
-    target_inode=$(ls -t $NODES_DIR/${logic_id}* 2>/dev/null | head -n 1)
-
-    if [ -z "$target_inode" ]; then
-        echo "❌ [Error] Logic Cell not found for ID: $logic_id"
-        continue
-    fi
-
-    target_filename=$(basename "$target_inode")
-    
-    # 原子链接切换 (The Atomic Flash)
-    mkdir -p "$ACTIVE_DIR"
-    ln -sf "$target_inode" "$ACTIVE_DIR/$slot"
-    
-    # 模拟硬件烧录的微小延迟 (视觉效果)
-    sleep 0.1
-    echo "🟢 [Flashed] Slot [$slot] <== $target_filename"
-done
+# 值为节点名时建立链接; 值为对象时是分叉槽位: 每个键是一条分支 (其值同样是槽位表)，
+# 对应 active 下的目录 <slot>/<branch>/ (见 alin/src/runner/alin_topology.h)
+flash_slots() {
+    local path="$1"      # 槽位表在 Bitstream 中的 JSON 路径 (数组)
+    local dir="$2"       # 对应的 active 目录
+    local indent="$3"
+
+    jq -r --argjson p "$path" 'getpath($p) | to_entries[] | "\(.key) \(.value | type) \(.value)"' "$BITSTREAM" |
+    while read -r slot kind logic_id; do
+        if [ "$kind" = "object" ]; then
+            # 分叉槽位: 逐条分支递归烧录
+            if [ -L "$dir/$slot" ]; then rm -f "$dir/$slot"; fi
+            echo "${indent}⑂ [Fork] Slot [$slot]"
+            jq -r --argjson p "$path" --arg s "$slot" 'getpath($p)[$s] | keys[]' "$BITSTREAM" |
+            while read -r branch; do
+                mkdir -p "$dir/$slot/$branch"
+                echo "${indent}  ├─ Branch [$branch]"
+                flash_slots "$(jq -cn --argjson p "$path" --arg s "$slot" --arg b "$branch" '$p + [$s, $b]')" \
+                    "$dir/$slot/$branch" "${indent}  │  "
+            done
+            continue
+        fi
+
+        # 在 Nodes 仓库中寻找对应的二进制 (支持模糊匹配 name_hash)
+        # 逻辑：找到最新的那个版本
+        # 排除 .so 插件，路由只指向可执行节点
+        target_inode=$(ls -t $NODES_DIR/${logic_id}* 2>/dev/null | grep -v "\.so$" | head -n 1)
+
+        if [ -z "$target_inode" ]; then
+            echo "${indent}❌ [Error] Logic Cell not found for ID: $logic_id"
+            continue
+        fi
+
+        target_filename=$(basename "$target_inode")
+
+        # 原子链接切换 (The Atomic Flash); 原来是分叉目录时整体替换
+        mkdir -p "$dir"
+        if [ -d "$dir/$slot" ] && [ ! -L "$dir/$slot" ]; then rm -rf "$dir/$slot"; fi
+        ln -sfn "$target_inode" "$dir/$slot"
+
+        # 模拟硬件烧录的微小延迟 (视觉效果)
+        sleep 0.1
+        echo "${indent}🟢 [Flashed] Slot [$slot] <== $target_filename"
+    done
+}
+
+flash_slots '["topology"]' "$ACTIVE_DIR" ""
 
 echo "=========================================="
 echo "✅ Bitstream Loaded. Circuit is LIVE."
@@ -82,6 +82,15 @@ fi
 # 生成时间戳
 TIMESTAMP=$(date -u +"%Y-%m-%dT%H:%M:%SZ")
 
+# 使用节点运行时的节点支持流模式 (每行一条记录，进程常驻)、帧协议与共享内存环形缓冲
+if grep -q "alin_node_main" "$SRC_FILE"; then
+    STREAM_MODE="ALIN_STREAM=1 | --stream"
+    WIRE_FORMAT="json-lines | alin-frame/1 | alin-ring/1"
+else
+    STREAM_MODE="none"
+    WIRE_FORMAT="json-lines"
+fi
+
 # 提取信息
 DESCRIPTION=$(extract_description)
 INPUT_FORMAT=$(extract_input)
@@ -113,6 +122,8 @@ output = $OUTPUT_FORMAT
 [protocol]
 encoding = json
 streaming = stdin/stdout
+stream_mode = $STREAM_MODE
+wire = $WIRE_FORMAT
 
 [dependencies]
 none
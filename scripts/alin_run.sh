@@ -77,13 +77,19 @@ for link in $LINKS; do
         
         log_topology "  $link -> $(basename "$target") [Inode: $target_inode]"
         
-        # 检查目标是否可执行
-        if [ -x "$target" ]; then
+        # 检查目标是否可执行 (分叉槽位只能由 alin_runner / alin_host 执行)
+        if [ -d "$target" ]; then
+            log_error "Fork slot not supported here, use alin_runner: $link"
+            exit 1
+        elif [ -x "$target" ]; then
             NODES+=("$target")
         else
             log_error "Target not executable: $target"
             exit 1
         fi
+    elif [ -d "$link_path" ]; then
+        log_error "Fork slot not supported here, use alin_runner: $link"
+        exit 1
     else
         log_error "Not a symbolic link: $link_path"
         exit 1
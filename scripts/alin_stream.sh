@@ -9,6 +9,10 @@
 # 3. 支持批处理和实时模式
 # 4. 状态检查点
 #
+# 已编译 alin/bin/alin_runner (make runner) 时直接交给常驻运行器:
+# 每个节点只启动一次并以流模式常驻。设置 ALIN_LEGACY_STREAM=1
+# 可退回逐行 fork 的旧路径。
+#
 # 使用方式:
 #   cat logs.jsonl | ./scripts/alin_stream.sh
 #   ./scripts/alin_stream.sh demo/sample_logs/app.log
@@ -20,6 +24,7 @@ SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
 PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
 ACTIVE_DIR="$PROJECT_DIR/alin/active"
 STATE_DIR="$PROJECT_DIR/alin/state"
+RUNNER="$PROJECT_DIR/alin/bin/alin_runner"
 
 # 颜色输出
 RED='\033[0;31m'
@@ -91,8 +96,9 @@ process_line() {
     # 获取管道节点
     local nodes=($(get_pipeline))
     
-    # 设置环境变量
+    # 设置环境变量 (逐行路径下节点必须以单次模式运行)
     export ALIN_STATE_FILE="$STATE_DIR/agg_count.state"
+    export ALIN_STREAM=0
     
     # 流经每个节点
     for node in "${nodes[@]}"; do
@@ -136,6 +142,11 @@ process_batch() {
 
 # 主入口
 main() {
+    if [ -x "$RUNNER" ] && [ "${ALIN_LEGACY_STREAM:-0}" != "1" ]; then
+        export ALIN_STATE_FILE="$STATE_DIR/agg_count.state"
+        exec "$RUNNER" -a "$ACTIVE_DIR" -s "$STATE_DIR" "$@"
+    fi
+    
     show_topology
     
     if [ -n "$1" ] && [ -f "$1" ]; then
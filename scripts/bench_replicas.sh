@@ -0,0 +1,94 @@
+#!/bin/bash
+# =========================================
+# ALIN 并行副本扩展性基准 (Replica Scaling Benchmark)
+# =========================================
+#
+# 在临时拓扑 parse_json → filter_level → agg_count 上，
+# 以不同副本数运行无状态的前两级 (alin_runner -r)，输出吞吐与加速比;
+# 每一轮的输出都与单副本结果比对，确认副本不改变记录顺序
+#
+# 使用方式:
+#   ./scripts/bench_replicas.sh                 # 默认 300000 条, 副本数 1 2 4 8
+#   ./scripts/bench_replicas.sh 1000000 1 2 4   # 指定条数与副本数
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+
+cd "$PROJECT_DIR"
+
+# 颜色输出
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+NC='\033[0m'
+
+COUNT=${1:-300000}
+shift || true
+COUNTS=("$@")
+[ ${#COUNTS[@]} -eq 0 ] && COUNTS=(1 2 4 8)
+
+NODES_DIR="$PROJECT_DIR/alin/nodes"
+WORK_DIR=$(mktemp -d /tmp/alin-bench.XXXXXX)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+latest_node() {
+    ls -1t "$NODES_DIR" 2>/dev/null | grep -E "^$1_[0-9a-f]{8}$" | head -1
+}
+
+echo -e "${YELLOW}▶ 编译运行器与流处理节点${NC}"
+make -s runner stream ${CC:+CC=$CC} >/dev/null
+
+mkdir -p "$WORK_DIR/active" "$WORK_DIR/state"
+for spec in 01_parse:parse_json 02_filter:filter_level 03_agg:agg_count; do
+    node=$(latest_node "${spec#*:}")
+    if [ -z "$node" ]; then
+        echo -e "${RED}❌ 未找到节点: ${spec#*:}${NC}" >&2
+        exit 1
+    fi
+    ln -s "$NODES_DIR/$node" "$WORK_DIR/active/${spec%%:*}"
+done
+
+echo -e "${YELLOW}▶ 生成 $COUNT 条日志${NC}"
+awk -v n="$COUNT" 'BEGIN {
+    split("DEBUG INFO INFO INFO WARN ERROR", levels, " ")
+    split("api auth database cache queue worker", services, " ")
+    srand(42)
+    for (i = 0; i < n; i++) {
+        printf "{\"level\":\"%s\",\"service\":\"%s\",\"msg\":\"event %d\",\"timestamp\":%d,\"latency_ms\":%d}\n",
+            levels[int(rand() * 6) + 1], services[int(rand() * 6) + 1], i, 1700000000 + i, int(rand() * 3000)
+    }
+}' > "$WORK_DIR/input.jsonl"
+
+export ALIN_FILTER_LEVEL="WARN"
+export ALIN_STATE_FILE="$WORK_DIR/state/agg_count.state"
+
+echo -e "${YELLOW}▶ 运行 (CPU: $(nproc))${NC}"
+echo ""
+printf "%-10s %12s %14s %10s\n" "replicas" "seconds" "events/sec" "speedup"
+
+base_ns=""
+for n in "${COUNTS[@]}"; do
+    rm -f "$WORK_DIR/state/"*
+    start=$(date +%s%N)
+    ./alin/bin/alin_runner -a "$WORK_DIR/active" -s "$WORK_DIR/state" \
+        -r 01_parse=$n -r 02_filter=$n "$WORK_DIR/input.jsonl" \
+        > "$WORK_DIR/out_$n.txt" 2> "$WORK_DIR/err_$n.txt"
+    elapsed=$(( $(date +%s%N) - start ))
+    [ -z "$base_ns" ] && base_ns=$elapsed
+
+    # rate 字段随运行时间变化，比对时去掉
+    sed 's/"rate":[^,}]*//' "$WORK_DIR/out_$n.txt" > "$WORK_DIR/cmp_$n.txt"
+    if ! cmp -s "$WORK_DIR/cmp_${COUNTS[0]}.txt" "$WORK_DIR/cmp_$n.txt"; then
+        echo -e "${RED}❌ 副本数 $n 的输出与基准不一致${NC}" >&2
+        exit 1
+    fi
+
+    awk -v n="$n" -v ns="$elapsed" -v base="$base_ns" -v count="$COUNT" 'BEGIN {
+        printf "%-10s %12.3f %14.0f %9.2fx\n", n, ns / 1e9, count / (ns / 1e9), base / ns
+    }'
+done
+
+echo ""
+echo -e "${GREEN}✅ 各副本数输出一致 ($(wc -l < "$WORK_DIR/out_${COUNTS[0]}.txt") 行)${NC}"
@@ -111,7 +111,7 @@ cat alin/data/test_logs.jsonl | ./scripts/alin_stream.sh 2>&1 | tail -20
 section "步骤 6: 查看聚合统计状态"
 if [ -f alin/state/agg_count.state ]; then
     echo "--- alin/state/agg_count.state ---"
-    cat alin/state/agg_count.state
+    ./alin/active/03_agg --dump-state alin/state/agg_count.state
     echo "-----------------------------------"
 fi
 